@@ -2,16 +2,37 @@
 
 #include "renderer/Camera.h"
 #include "renderer/CubeRenderer.h"
+#include "renderer/FrustumCuller.h"
+#include "renderer/OcclusionCuller.h"
 #include "util/ImGUIHelper.h"
+#include "util/JobSystem.h"
+#include "util/Morton.h"
 #include "util/display/RenderSystem.h"
 #include "util/display/device/SwapchainHandler.h"
 #include "util/display/Window.h"
+#include "world/ChunkResidency.h"
+#include "world/ChunkStreamer.h"
+#include "world/ChunkVisibility.h"
+#include "world/World.h"
+#include "world/chunk/types/EightBitChunk.h"
+#include "world/gen/TerrainGenerator.h"
+#include "world/storage/ChunkIO.h"
+#include "world/storage/RegionStorage.h"
 #include <imgui.h>
 #include <backends/imgui_impl_sdl3.h>
 #include <backends/imgui_impl_vulkan.h>
 #include <Test.cpp>
 #include <SDL3/SDL_timer.h>
 
+std::unique_ptr<World> App::sWorld;
+std::unique_ptr<ChunkStreamer> App::sStreamer;
+std::unique_ptr<TerrainGenerator> App::sTerrain;
+std::unique_ptr<OcclusionCuller> App::sOcclusion;
+std::unique_ptr<ChunkVisibility> App::sVisibility;
+std::unique_ptr<ChunkResidency> App::sResidency;
+std::unique_ptr<RegionStorage> App::sStorage;
+std::unique_ptr<ChunkIO> App::sIO;
+std::vector<ChunkNode*> App::sVisibleChunks;
 bool App::sRunning = true;
 float App::sDeltaTime = 0.0f;
 float App::sLastFrame = 0.0f;
@@ -51,6 +72,31 @@ void App::Init() {
     // ImGUIHelper::Initialize();
 
     CubeRenderer::Initialize();
+
+    JobSystem::Initialize();
+    Morton::InitializeLookupTables();
+
+    sWorld = std::make_unique<World>();
+    sStreamer = std::make_unique<ChunkStreamer>(*sWorld, ChunkStreamer::Settings());
+    sTerrain = std::make_unique<TerrainGenerator>(TerrainGenerator::Settings());
+    sOcclusion = std::make_unique<OcclusionCuller>();
+    sVisibility = std::make_unique<ChunkVisibility>(ChunkVisibility::Settings());
+    sStreamer->SetVisibility(sVisibility.get());
+    sResidency = std::make_unique<ChunkResidency>(*sWorld, ChunkResidency::Settings());
+    sResidency->SetStreamer(sStreamer.get());
+    sStreamer->SetGenerator([](ChunkNode& node) {
+        sTerrain->Generate(node);
+    });
+
+    // Only edited chunks are saved, everything else is generated again. Disk access goes through
+    // the I/O thread.
+    sStorage = std::make_unique<RegionStorage>(GetRootDir() + "world");
+    sIO = std::make_unique<ChunkIO>(*sStorage, ChunkIO::Settings());
+    sStreamer->SetIO(sIO.get());
+    sWorld->SetSaver([](ChunkNode& node) {
+        if (const EightBitChunk* chunk = dynamic_cast<const EightBitChunk*>(node.m_chunk.get()))
+            sIO->RequestSave(node.m_pos, *chunk);
+    });
 }
 
 void App::MainLoop() {
@@ -74,6 +120,25 @@ void App::MainLoop() {
 
     Camera::Update();
 
+    // Walked before streaming so that this frame's meshing already favors the chunks it reached.
+    sVisibility->Update(*sWorld, Camera::GetPos());
+    sStreamer->Update(Camera::GetPos(), Camera::GetTarget());
+    sWorld->GetLight().Update();
+    const glm::mat4 viewProjection = Camera::GetProj() * Camera::GetView();
+    sWorld->CullChunks(FrustumCuller::ExtractPlanes(viewProjection), sVisibleChunks);
+    sVisibility->Cull(sVisibleChunks);
+
+    // Potentially visible chunks count as needed even if they end up occluded, as that changes quickly.
+    sResidency->Touch(sVisibleChunks);
+    sResidency->Update(Camera::GetPos());
+
+    // Chunks in the frustum are both the occluders and the candidates for occlusion.
+    sOcclusion->Begin(viewProjection);
+    for (const ChunkNode* node : sVisibleChunks)
+        sOcclusion->AddChunkOccluders(*node);
+    sOcclusion->Render();
+    sOcclusion->Cull(sVisibleChunks);
+
     RenderSystem::UpdateDisplay();
 }
 
@@ -109,6 +174,21 @@ void App::Cleanup() {
 
     CubeRenderer::Destroy();
 
+    sVisibleChunks.clear();
+    sWorld->SaveAll();
+    sIO->Flush();
+    sStorage->Flush();
+    sOcclusion.reset();
+    sResidency.reset();
+    sStreamer.reset();
+    sVisibility.reset();
+    sTerrain.reset();
+    sWorld.reset();
+    sIO.reset();
+    sStorage.reset();
+
+    JobSystem::Destroy();
+
     RenderSystem::Destroy();
     Window::Destroy();
 }
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <memory>
+#include <vector>
 #include <SDL3/SDL_filesystem.h>
 // Makes sure to remove constructors for structs.
 #define VULKAN_HPP_NO_CONSTRUCTORS
 #include <vulkan/vulkan.hpp>
 
 class Renderer;
+class World;
+class ChunkStreamer;
+class TerrainGenerator;
+class OcclusionCuller;
+class ChunkVisibility;
+class ChunkResidency;
+class RegionStorage;
+class ChunkIO;
+struct ChunkNode;
 
 // App utility.
 class App final {
@@ -27,7 +38,20 @@ public:
     static VXL_INLINE std::string GetShadersDir() {
         return std::string(SDL_GetBasePath()) + "assets/shaders";
     }
+
+    static VXL_INLINE World& GetWorld() noexcept {
+        return *sWorld;
+    }
 private:
+    static std::unique_ptr<World> sWorld;
+    static std::unique_ptr<ChunkStreamer> sStreamer;
+    static std::unique_ptr<TerrainGenerator> sTerrain;
+    static std::unique_ptr<OcclusionCuller> sOcclusion;
+    static std::unique_ptr<ChunkVisibility> sVisibility;
+    static std::unique_ptr<ChunkResidency> sResidency;
+    static std::unique_ptr<RegionStorage> sStorage;
+    static std::unique_ptr<ChunkIO> sIO;
+    static std::vector<ChunkNode*> sVisibleChunks; // Chunks inside the camera frustum, reachable and not occluded this frame.
     static bool sRunning;
     static float sDeltaTime;
     static float sLastFrame;
@@ -1,10 +1,88 @@
+#include <bit>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <random>
+#include <unordered_set>
+#include "renderer/FrustumCuller.h"
+#include "renderer/OcclusionCuller.h"
+#include "util/JobSystem.h"
 #include "util/Logger.h"
 #include "util/Morton.h"
+#include "world/Brush.h"
+#include "world/ChunkResidency.h"
+#include "world/ChunkStreamer.h"
+#include "world/ChunkVisibility.h"
+#include "world/Collision.h"
+#include "world/ComponentLabeler.h"
+#include "world/EditJournal.h"
+#include "world/FluidSimulator.h"
+#include "world/LightEngine.h"
+#include "world/Pathfinder.h"
+#include "world/Raycaster.h"
+#include "world/SparseVoxelDAG.h"
+#include "world/TickScheduler.h"
+#include "world/World.h"
+#include "world/gen/Noise.h"
+#include "world/gen/TerrainGenerator.h"
+#include "world/storage/ChunkIO.h"
+#include "world/storage/RegionFile.h"
+#include "world/storage/RegionStorage.h"
+#include "world/storage/VolumeImporter.h"
 #include "world/chunk/IChunk.h"
 #include "world/chunk/types/EightBitChunk.h"
 #include "world/chunk/ChunkBitmap.h"
+#include "world/chunk/ChunkCodec.h"
+#include "world/chunk/ChunkInterner.h"
+#include "world/chunk/ChunkSerializer.h"
+#include "world/chunk/ChunkVerifier.h"
+
+// Loads the chunks from min to max, exclusive, and fills them with terrain like the streamer does.
+static void GenerateChunks(World& world, const glm::ivec3& min, const glm::ivec3& max) {
+    TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+    for (int32_t x = min.x; x < max.x; x++) {
+        for (int32_t y = min.y; y < max.y; y++) {
+            for (int32_t z = min.z; z < max.z; z++) {
+                ChunkNode* node = world.LoadChunk({.m_x = x, .m_y = y, .m_z = z});
+                terrain.Generate(*node);
+                node->m_solid = node->m_chunk->GetBlockBitmap(BlockTypes::eAir, true);
+                node->m_state = ChunkState::eLoaded;
+            }
+        }
+    }
+}
+
+// Blocks, solid voxels and palette counts of the world's chunks that differ from the reference's.
+// A chunk the reference lacks counts once.
+static uint64_t CountMismatches(World& world, World& reference) {
+    uint64_t mismatches = 0;
+    world.GetChunks().ForEach([&](ChunkNode& node) {
+        const ChunkNode* other = reference.GetChunk(node.m_pos);
+        if (other == nullptr) {
+            mismatches++;
+            return;
+        }
+
+        const uint8_t* blocks = static_cast<EightBitChunk*>(node.m_chunk.get())->Data();
+        const uint8_t* otherBlocks = static_cast<EightBitChunk*>(other->m_chunk.get())->Data();
+        for (uint32_t i = 0; i < 32768; i++)
+            mismatches += blocks[i] != otherBlocks[i];
+        for (uint32_t row = 0; row < 1024; row++)
+            mismatches += node.m_solid[row] != other->m_solid[row];
+        for (uint16_t block = 0; block < 64; block++)
+            mismatches += node.m_chunk->m_blockPaletteCounts[block] != other->m_chunk->m_blockPaletteCounts[block];
+    });
+    return mismatches;
+}
+
+// Light levels of every chunk of the world, in the order of its chunk map.
+static std::vector<uint8_t> GetLightLevels(World& world) {
+    std::vector<uint8_t> levels;
+    world.GetChunks().ForEach([&](ChunkNode& node) {
+        levels.insert(levels.end(), node.m_light->m_levels.begin(), node.m_light->m_levels.end());
+    });
+    return levels;
+}
 
 static void Test() {
     Logger log = Logger("Test");
@@ -155,6 +233,1880 @@ static void Test() {
     // xyzTest.CullLeastSigBits();
     // xyzTest.LogInnerSlice();
 
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk map:");
+    {
+        ChunkMap chunkMap;
+        std::vector<ChunkPos> positions;
+        std::uniform_int_distribution<int32_t> coord(-400, 400);
+        for (int i = 0; i < 300000; i++)
+            positions.push_back({.m_x = coord(gen), .m_y = coord(gen) / 8, .m_z = coord(gen)});
+
+        start = std::chrono::high_resolution_clock::now();
+        for (const ChunkPos& pos : positions)
+            chunkMap.Insert(pos);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Inserted ", chunkMap.Size(), " chunks! Time taken: ", end - start);
+
+        uint64_t found = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 10; i++) {
+            for (const ChunkPos& pos : positions)
+                found += chunkMap.Find({.m_x = pos.m_x, .m_y = pos.m_y + i, .m_z = pos.m_z}) != nullptr;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("3M lookups (", found, " hits)! Time taken: ", end - start);
+
+        for (size_t i = 0; i < positions.size(); i += 2)
+            chunkMap.Remove(positions[i]);
+
+        if (chunkMap.Verify())
+            log.Verbose("Verified chunk map after removing half of the chunks! (", chunkMap.Size(), " left)");
+        else
+            log.Warning("Chunk map failed verification!");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk streaming:");
+    {
+        World world;
+        ChunkStreamer streamer(world, ChunkStreamer::Settings());
+        streamer.SetGenerator([](ChunkNode& node) {
+            if (node.m_pos.m_y != 0)
+                return;
+            for (uint8_t x = 0; x < 32; x++) {
+                for (uint8_t z = 0; z < 32; z++)
+                    node.m_chunk->SetBlock(BlockTypes::eGrass, x, 0, z);
+            }
+        });
+
+        // Fly along x at 8 blocks per frame.
+        std::chrono::nanoseconds slowest(0);
+        start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < 600; frame++) {
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            streamer.Update({frame * 8.0f, 16.0f, 0.0f}, {1.0f, 0.0f, 0.0f});
+            slowest = std::max(slowest, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now() - frameStart));
+        }
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Streamed 600 frames with ", world.GetChunks().Size(), " resident chunks! Average frame: ",
+            (end - start) / 600, ", slowest frame: ", slowest);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing job system:");
+    {
+        JobSystem::Initialize();
+
+        // Continuations have to see the work of the jobs they depend on.
+        std::atomic<uint32_t> counter = 0;
+        JobSystem::Job* first = JobSystem::Create([&counter]() { counter.fetch_add(1); });
+        JobSystem::Job* second = JobSystem::Create([&counter]() { counter.fetch_add(counter.load() == 1 ? 1 : 100); });
+        JobSystem::AddDependency(second, first);
+        JobSystem::Submit(second);
+        JobSystem::Submit(first);
+        JobSystem::Release(first);
+        JobSystem::Wait(second);
+        if (counter.load() != 2)
+            log.Warning("Job dependencies ran out of order!");
+
+        std::vector<std::unique_ptr<EightBitChunk>> chunks;
+        std::uniform_int_distribution<uint32_t> density(0, 3);
+        for (int i = 0; i < 256; i++) {
+            chunks.push_back(std::make_unique<EightBitChunk>());
+            for (uint8_t x = 0; x < 32; x++) {
+                for (uint8_t y = 0; y < 32; y++) {
+                    for (uint8_t z = 0; z < 32; z++) {
+                        if (density(gen) == 0)
+                            chunks.back()->SetBlock(BlockTypes::eDirt, x, y, z);
+                    }
+                }
+            }
+        }
+
+        std::vector<ChunkMesh::Greedy> serialMeshes(chunks.size());
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < chunks.size(); i++)
+            chunks[i]->MeshGreedy(serialMeshes[i]);
+        end = std::chrono::high_resolution_clock::now();
+        const auto serialTime = end - start;
+        log.Verbose("Meshed ", chunks.size(), " chunks on one thread! Time taken: ", serialTime);
+
+        std::vector<ChunkMesh::Greedy> parallelMeshes(chunks.size());
+        start = std::chrono::high_resolution_clock::now();
+        JobSystem::ParallelFor(static_cast<uint32_t>(chunks.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                chunks[i]->MeshGreedy(parallelMeshes[i]);
+        });
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Meshed ", chunks.size(), " chunks on ", JobSystem::GetWorkerCount(), " workers! Time taken: ",
+            end - start, ", speedup: ", std::chrono::duration<float>(serialTime).count() /
+            std::chrono::duration<float>(end - start).count(), "x");
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (serialMeshes[i].m_vertices != parallelMeshes[i].m_vertices) {
+                log.Warning("Parallel mesh ", i, " differs from the serial one!");
+                break;
+            }
+        }
+
+        JobSystem::Destroy();
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing noise:");
+    {
+        Noise noise(1337);
+        if (!noise.TestAccuracy())
+            log.Warning("Noise failed verification!");
+
+        // A chunk worth of 3D fractal samples, as rows along z.
+        const Noise::Fractal fractal = {.m_type = Noise::Type::ePerlin, .m_octaves = 4, .m_frequency = 0.02f};
+        Noise::Row rowX, rowY, rowZ, out;
+        Noise::FillRow(rowZ, 0.0f, 1.0f);
+        float checksum = 0.0f;
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t x = 0; x < 32; x++) {
+            rowX.fill(static_cast<float>(x));
+            for (uint32_t y = 0; y < 32; y++) {
+                rowY.fill(static_cast<float>(y));
+                noise.Fractal3D(fractal, rowX, rowY, rowZ, out);
+                checksum += out[y];
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Simd fractal noise - 32768 samples: ", end - start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t x = 0; x < 32; x++) {
+            for (uint32_t y = 0; y < 32; y++) {
+                for (uint32_t z = 0; z < 32; z++)
+                    checksum += noise.FractalScalar3D(fractal, x, y, z);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Scalar fractal noise - 32768 samples: ", end - start, " (checksum ", checksum, ")");
+
+        TerrainGenerator terrain{TerrainGenerator::Settings()};
+        std::vector<EightBitChunk> chunks(64);
+        start = std::chrono::high_resolution_clock::now();
+        for (int32_t i = 0; i < 64; i++)
+            terrain.Generate(chunks[i], {.m_x = i % 8, .m_y = i / 8 - 4, .m_z = 0});
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Generated 64 chunks of terrain! Average time taken: ", (end - start) / 64);
+
+        for (EightBitChunk& chunk : chunks) {
+            if (!ChunkVerifier::VerifyBlockBitmaps(chunk) || !ChunkVerifier::VerifyGreedyMesh(chunk)) {
+                log.Warning("Generated terrain failed chunk verification!");
+                break;
+            }
+        }
+
+        // Blocks past the palette must be rejected rather than counted as other blocks.
+        chunks[0].Data()[1234] = 64;
+        try {
+            chunks[0].RecountPalette();
+            log.Warning("Recounting a palette accepted a block past it!");
+        } catch (const std::runtime_error&) {}
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing raycasts:");
+    {
+        World world;
+        GenerateChunks(world, glm::ivec3(-4, -3, -4), glm::ivec3(4, 2, 4));
+
+        // Edits have to show up in the cached solid bitmaps.
+        std::uniform_int_distribution<int32_t> editCoord(-128, 127);
+        for (int i = 0; i < 2000; i++)
+            world.SetBlock(i % 2 == 0 ? BlockTypes::eStone : BlockTypes::eAir, editCoord(gen), editCoord(gen) / 2 - 32, editCoord(gen));
+
+        std::vector<Raycaster::Ray> rays;
+        std::uniform_real_distribution<float> origin(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        for (int i = 0; i < 20000; i++) {
+            glm::vec3 pos = {origin(gen), origin(gen) * 0.3f + 10.0f, origin(gen)};
+            glm::vec3 dir = {direction(gen), direction(gen), direction(gen)};
+
+            // Some rays are axis aligned or exact diagonals from block centers to hit the tie breaking paths.
+            if (i % 4 == 0) {
+                dir[i % 3] = 0.0f;
+            } else if (i % 4 == 1) {
+                pos = glm::floor(pos) + 0.5f;
+                dir = {dir.x < 0.0f ? -1.0f : 1.0f, dir.y < 0.0f ? -1.0f : 1.0f, dir.z < 0.0f ? -1.0f : 1.0f};
+            }
+            rays.push_back({.m_origin = pos, .m_direction = dir, .m_maxDistance = 200.0f});
+        }
+
+        std::vector<Raycaster::Hit> naiveHits(rays.size());
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < rays.size(); i++)
+            naiveHits[i] = Raycaster::CastNaive(world, rays[i]);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Naive raycasts - Average time taken: ", (end - start) / rays.size());
+
+        std::vector<Raycaster::Hit> hits(rays.size());
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < rays.size(); i++)
+            hits[i] = Raycaster::Cast(world, rays[i]);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Bitmap raycasts - Average time taken: ", (end - start) / rays.size());
+
+        start = std::chrono::high_resolution_clock::now();
+        Raycaster::CastBatch(world, rays, hits);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Batched raycasts - Average time taken: ", (end - start) / rays.size());
+
+        uint32_t hitCount = 0;
+        for (size_t i = 0; i < rays.size(); i++) {
+            const Raycaster::Hit& a = hits[i];
+            const Raycaster::Hit& b = naiveHits[i];
+            hitCount += a.m_hit;
+            if (a.m_hit != b.m_hit || (a.m_hit && (a.m_block != b.m_block || a.m_face != b.m_face
+                || a.m_distance != b.m_distance || a.m_blockType != b.m_blockType))) {
+                log.Warning("Raycast ", i, " differs from the naive DDA!");
+                break;
+            }
+        }
+        log.Verbose("Verified ", rays.size(), " raycasts against the naive DDA! (", hitCount, " hits)");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing frustum culling:");
+    {
+        const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 10000.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.2f, 0.3f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const FrustumCuller::Planes planes = FrustumCuller::ExtractPlanes(projection * view);
+
+        // 100k chunk sized boxes scattered around the camera.
+        FrustumCuller culler;
+        std::uniform_int_distribution<int32_t> chunkCoord(-60, 60);
+        for (int i = 0; i < 100000; i++) {
+            const glm::vec3 min = glm::vec3(chunkCoord(gen) * 32.0f, chunkCoord(gen) * 8.0f, chunkCoord(gen) * 32.0f);
+            culler.Insert(min, min + glm::vec3(32.0f, 32.0f, 32.0f));
+        }
+
+        std::vector<uint32_t> visible;
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 100; i++)
+            culler.Cull(planes, visible);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Simd culled 100k boxes to ", visible.size(), "! Average time taken: ", (end - start) / 100);
+
+        std::vector<uint32_t> scalarVisible;
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 100; i++)
+            culler.CullScalar(planes, scalarVisible);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Scalar culled 100k boxes to ", scalarVisible.size(), "! Average time taken: ", (end - start) / 100);
+
+        if (visible != scalarVisible)
+            log.Warning("Simd frustum culling differs from the scalar reference!");
+
+        // Chunks in the world keep their boxes in sync through loads and unloads. The camera sits on the
+        // edge of chunk x = 0, so nothing further back than x = -1 can be visible.
+        World world;
+        for (int32_t x = -4; x <= 4; x++) {
+            for (int32_t z = -4; z <= 4; z++)
+                world.LoadChunk({.m_x = x, .m_y = 0, .m_z = z});
+        }
+        for (int32_t x = -4; x <= 4; x += 2)
+            world.UnloadChunk({.m_x = x, .m_y = 0, .m_z = 0});
+        // A node that never got a box leaves the others where they are.
+        world.GetChunks().Insert({.m_x = 8, .m_y = 0, .m_z = 0});
+        world.UnloadChunk({.m_x = 8, .m_y = 0, .m_z = 0});
+
+        std::vector<ChunkNode*> visibleChunks;
+        world.CullChunks(planes, visibleChunks);
+        bool correct = true;
+        for (const ChunkNode* node : visibleChunks)
+            correct &= node->m_pos.m_x >= -1 && world.GetChunk(node->m_pos) == node;
+        if (!correct || world.GetChunk({.m_x = 4, .m_y = 0, .m_z = 1}) == nullptr)
+            log.Warning("World frustum culling returned chunks behind the camera or stale nodes!");
+        else
+            log.Verbose("World culled ", world.GetChunks().Size(), " chunks to ", visibleChunks.size(), "!");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing occlusion culling:");
+    {
+        const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 10000.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(-200.0f, 16.0f, 16.0f), glm::vec3(40.0f, 18.0f, 20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const glm::mat4 viewProjection = projection * view;
+
+        // A solid wall of chunks at x = 2 with a hole in front of the camera and a field of chunks behind it.
+        World world;
+        for (int32_t y = -6; y <= 6; y++) {
+            for (int32_t z = -8; z <= 8; z++) {
+                if (y != 0 || z != 0)
+                    world.LoadChunk({.m_x = 2, .m_y = y, .m_z = z})->m_fullFaces = 0x3F;
+            }
+        }
+        for (int32_t x = 4; x <= 12; x++) {
+            for (int32_t y = -2; y <= 2; y++) {
+                for (int32_t z = -2; z <= 2; z++)
+                    world.LoadChunk({.m_x = x, .m_y = y, .m_z = z});
+            }
+        }
+
+        std::vector<ChunkNode*> visibleChunks;
+        world.CullChunks(FrustumCuller::ExtractPlanes(viewProjection), visibleChunks);
+        const size_t frustumVisible = visibleChunks.size();
+
+        OcclusionCuller occlusion;
+        occlusion.Begin(viewProjection);
+        for (const ChunkNode* node : visibleChunks)
+            occlusion.AddChunkOccluders(*node);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 100; i++)
+            occlusion.Render();
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Rendered ", occlusion.GetOccluderCount(), " occluders! Average time taken: ", (end - start) / 100);
+
+        std::vector<float> depths(occlusion.GetWidth() * occlusion.GetHeight());
+        for (uint32_t y = 0; y < occlusion.GetHeight(); y++) {
+            for (uint32_t x = 0; x < occlusion.GetWidth(); x++)
+                depths[y * occlusion.GetWidth() + x] = occlusion.GetDepth(x, y);
+        }
+
+        occlusion.RenderScalar();
+        bool correct = true;
+        for (uint32_t y = 0; y < occlusion.GetHeight(); y++) {
+            for (uint32_t x = 0; x < occlusion.GetWidth(); x++)
+                correct &= depths[y * occlusion.GetWidth() + x] == occlusion.GetDepth(x, y);
+        }
+        if (!correct)
+            log.Warning("Tiled occlusion rasterization differs from the scalar reference!");
+
+        start = std::chrono::high_resolution_clock::now();
+        occlusion.Cull(visibleChunks);
+        end = std::chrono::high_resolution_clock::now();
+
+        bool wallVisible = false, holeVisible = false, cornerVisible = false;
+        for (const ChunkNode* node : visibleChunks) {
+            const ChunkPos& pos = node->m_pos;
+            wallVisible |= pos.m_x == 2 && pos.m_y == 1 && pos.m_z == 1;
+            holeVisible |= pos.m_x == 4 && pos.m_y == 0 && pos.m_z == 0;
+            cornerVisible |= pos.m_x >= 4 && std::abs(pos.m_y) == 2 && std::abs(pos.m_z) == 2;
+        }
+        if (!wallVisible || !holeVisible || cornerVisible)
+            log.Warning("Occlusion culling hid a chunk in view or kept one behind the wall!");
+        else
+            log.Verbose("Occlusion culled ", frustumVisible, " chunks to ", visibleChunks.size(), "! Time taken: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing cave culling:");
+    {
+        // Open sky above y = 0, solid ground below with a shaft down at (4, 4) and a sealed cave at (2, -3, 2).
+        // The shaft wall at x = 5 faces the camera, the one at x = 3 faces away from it.
+        ChunkBitmap solidBitmap = ChunkBitmap(std::array<uint32_t, 1024>{});
+        ChunkBitmap caveBitmap = ChunkBitmap(std::array<uint32_t, 1024>{});
+        for (uint32_t i = 0; i < 1024; i++) {
+            solidBitmap[i] = ~0u;
+            const uint32_t x = i >> 5, y = i & 31;
+            caveBitmap[i] = (x == 0 || x == 31 || y == 0 || y == 31) ? ~0u : 0x80000001u;
+        }
+
+        World world;
+        for (int32_t x = 0; x < 8; x++) {
+            for (int32_t y = -6; y < 2; y++) {
+                for (int32_t z = 0; z < 8; z++) {
+                    ChunkNode* node = world.LoadChunk({.m_x = x, .m_y = y, .m_z = z});
+                    if (y < 0 && !(x == 4 && z == 4))
+                        node->m_solid = x == 2 && y == -3 && z == 2 ? caveBitmap : solidBitmap;
+                    node->m_connectivity = ChunkConnectivity::Compute(node->m_solid);
+                }
+            }
+        }
+
+        ChunkVisibility visibility = ChunkVisibility(ChunkVisibility::Settings());
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 100; i++)
+            visibility.Update(world, glm::vec3(100.0f, 40.0f, 100.0f));
+        end = std::chrono::high_resolution_clock::now();
+
+        const auto isVisible = [&](const int32_t x, const int32_t y, const int32_t z) {
+            return visibility.IsVisible(*world.GetChunk({.m_x = x, .m_y = y, .m_z = z}));
+        };
+        const bool correct = ChunkConnectivity::Compute(caveBitmap) == ChunkConnectivity::sNone
+            && isVisible(0, 1, 7) && isVisible(6, -1, 1) && !isVisible(6, -2, 1)
+            && isVisible(4, -6, 4) && isVisible(5, -6, 4) && !isVisible(3, -6, 4) && !isVisible(2, -3, 2);
+        if (!correct)
+            log.Warning("Cave culling reached a sealed chunk or missed an open one!");
+        else
+            log.Verbose("Walk reached ", visibility.GetVisibleCount(), " of ", world.GetChunks().Size(), " chunks! Average time taken: ", (end - start) / 100);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing sparse voxel DAG:");
+    {
+        Morton::InitializeLookupTables();
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        SparseVoxelDAG dag;
+        std::vector<ChunkPos> positions;
+        std::vector<ChunkBitmap> bitmaps;
+
+        // A slab of terrain from the surface down, the part of the far field that isn't just air.
+        for (int32_t x = 0; x < 8; x++) {
+            for (int32_t y = -2; y < 2; y++) {
+                for (int32_t z = 0; z < 8; z++) {
+                    std::unique_ptr<EightBitChunk> chunk = std::make_unique<EightBitChunk>();
+                    terrain.Generate(*chunk, {.m_x = x, .m_y = y, .m_z = z});
+                    positions.push_back({.m_x = x, .m_y = y, .m_z = z});
+                    bitmaps.push_back(chunk->GetBlockBitmap(BlockTypes::eAir, true));
+                }
+            }
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < bitmaps.size(); i++)
+            dag.SetChunk(positions[i], bitmaps[i]);
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Built ", bitmaps.size(), " chunks into ", dag.GetNodeCount(), " nodes and ", dag.GetLeafCount(), " leaves! Average time taken: ", (end - start) / bitmaps.size());
+
+        const size_t paletteBytes = bitmaps.size() * sizeof(EightBitChunk);
+        log.Verbose("Far field takes ", dag.GetMemoryUsage(), " bytes against ", paletteBytes, " bytes of palette chunks! (",
+            paletteBytes / std::max<size_t>(dag.GetMemoryUsage(), 1), "x smaller)");
+
+        // Stored chunks must decompress and answer queries exactly, including after every chunk was
+        // replaced a few times, which compacts the garbage away.
+        std::uniform_int_distribution<uint32_t> coord(0, 31);
+        bool correct = true;
+        for (size_t round = 0; round < 3; round++) {
+            if (round > 0) {
+                for (size_t i = 0; i < bitmaps.size(); i++)
+                    dag.SetChunk(positions[i], bitmaps[(i + round) % bitmaps.size()]);
+            }
+
+            ChunkBitmap extracted;
+            for (size_t i = 0; i < bitmaps.size(); i++) {
+                const ChunkBitmap& expected = bitmaps[(i + round) % bitmaps.size()];
+                uint32_t root;
+                correct &= dag.FindChunk(positions[i], root);
+                dag.Extract(root, extracted);
+                correct &= extracted == expected;
+
+                for (int j = 0; j < 64; j++) {
+                    const uint8_t x = coord(gen), y = coord(gen), z = coord(gen);
+                    correct &= dag.IsSolid(positions[i].m_x * 32 + x, positions[i].m_y * 32 + y, positions[i].m_z * 32 + z) == expected.GetBit(x, y, z);
+                }
+            }
+        }
+
+        if (!correct)
+            log.Warning("Sparse voxel DAG doesn't match the bitmaps it was built from!");
+        else
+            log.Verbose("Verified ", dag.GetChunkCount(), " far field chunks after replacing them! (", dag.GetMemoryUsage(), " bytes)");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing lighting:");
+    {
+        World world;
+        GenerateChunks(world, glm::ivec3(0, -2, 0), glm::ivec3(4, 2, 4));
+
+        // A sealed cave deep underground, lit only by what is placed inside it.
+        for (int32_t x = -6; x <= 6; x++) {
+            for (int32_t y = -6; y <= 6; y++) {
+                for (int32_t z = -6; z <= 6; z++) {
+                    const bool inside = std::max({std::abs(x), std::abs(y), std::abs(z)}) < 6;
+                    world.SetBlock(inside ? BlockTypes::eAir : BlockTypes::eStone, 64 + x, -48 + y, 64 + z);
+                }
+            }
+        }
+
+        LightEngine& light = world.GetLight();
+        world.GetChunks().ForEach([&](ChunkNode& node) {
+            node.m_solid = node.m_chunk->GetBlockBitmap(BlockTypes::eAir, true);
+            light.QueueChunk(node.m_pos);
+        });
+        start = std::chrono::high_resolution_clock::now();
+        light.Update();
+        end = std::chrono::high_resolution_clock::now();
+        log.Verbose("Lit ", world.GetChunks().Size(), " chunks! Time taken: ", end - start);
+
+        const auto getLight = [&](const int32_t x, const int32_t y, const int32_t z, const ChunkLight::Channel channel) {
+            return light.GetLight(x, y, z, channel);
+        };
+        bool correct = getLight(64, -48, 64, ChunkLight::eSky) == 0 && getLight(64, -48, 64, ChunkLight::eBlock) == 0;
+
+        world.SetBlock(BlockTypes::eLamp, 64, -48, 64);
+        light.Update();
+        correct &= getLight(64, -48, 64, ChunkLight::eBlock) == LightEngine::sMaxLevel && getLight(67, -48, 64, ChunkLight::eBlock) == 12
+            && getLight(66, -46, 63, ChunkLight::eBlock) == 10 && getLight(64, -48, 70, ChunkLight::eBlock) == 0;
+        world.SetBlock(BlockTypes::eAir, 64, -48, 64);
+        light.Update();
+        correct &= getLight(64, -48, 64, ChunkLight::eBlock) == 0 && getLight(67, -48, 64, ChunkLight::eBlock) == 0;
+        if (!correct)
+            log.Warning("Lamp in a sealed cave lit the wrong blocks!");
+
+        // An explosion at the surface, followed by a few lamps and pillars. The incremental result
+        // has to match lighting everything again from scratch.
+        int32_t surface = 63;
+        while (surface > -64 && world.GetBlock(64, surface, 64) == BlockTypes::eAir)
+            surface--;
+
+        uint32_t changed = 0;
+        for (int32_t x = -12; x <= 12; x++) {
+            for (int32_t y = -12; y <= 12; y++) {
+                for (int32_t z = -12; z <= 12; z++) {
+                    if (x * x + y * y + z * z <= 144)
+                        changed += world.SetBlock(BlockTypes::eAir, 64 + x, surface + y, 64 + z) != BlockTypes::eAir;
+                }
+            }
+        }
+
+        std::uniform_int_distribution<int32_t> offset(-10, 10);
+        for (int i = 0; i < 16; i++) {
+            world.SetBlock(BlockTypes::eLamp, 64 + offset(gen), surface + offset(gen), 64 + offset(gen));
+            const int32_t x = 64 + offset(gen), z = 64 + offset(gen);
+            for (int32_t y = surface - 12; y < surface + 4; y++)
+                world.SetBlock(BlockTypes::eStone, x, y, z);
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        light.Update();
+        end = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::array<uint8_t, 32768>> incremental;
+        world.GetChunks().ForEach([&](const ChunkNode& node) {
+            incremental.push_back(node.m_light->m_levels);
+        });
+        light.Relight();
+        size_t i = 0;
+        world.GetChunks().ForEach([&](const ChunkNode& node) {
+            correct &= node.m_light->m_levels == incremental[i++];
+        });
+
+        if (!correct)
+            log.Warning("Incremental lighting doesn't match lighting from scratch!");
+        else
+            log.Verbose("Relit an explosion of ", changed, " blocks! Time taken: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing collision:");
+    {
+        World world;
+        GenerateChunks(world, glm::ivec3(0, -2, 0), glm::ivec3(4, 2, 4));
+
+        // Random boxes around the surface, some of them reaching past the resident chunks.
+        std::uniform_real_distribution<float> position(-8.0f, 136.0f);
+        std::uniform_real_distribution<float> height(-24.0f, 24.0f);
+        std::uniform_real_distribution<float> size(0.1f, 3.0f);
+        std::uniform_real_distribution<float> motion(-12.0f, 12.0f);
+        std::vector<Collision::Box> boxes;
+        std::vector<glm::vec3> motions;
+        for (int i = 0; i < 4096; i++) {
+            const glm::vec3 min = glm::vec3(position(gen), height(gen), position(gen));
+            boxes.push_back({.m_min = min, .m_max = min + glm::vec3(size(gen), size(gen), size(gen))});
+            motions.push_back(glm::vec3(motion(gen), motion(gen), motion(gen)));
+        }
+
+        bool correct = true;
+        size_t hits = 0;
+        for (size_t i = 0; i < boxes.size(); i++) {
+            correct &= Collision::IsSolid(world, boxes[i]) == Collision::IsSolidNaive(world, boxes[i]);
+            const Collision::Sweep sweep = Collision::SweepBox(world, boxes[i], motions[i]);
+            const Collision::Sweep naive = Collision::SweepBoxNaive(world, boxes[i], motions[i]);
+            correct &= sweep.m_hit == naive.m_hit && sweep.m_fraction == naive.m_fraction;
+            hits += sweep.m_hit;
+        }
+        if (!correct)
+            log.Warning("Collision queries don't match testing every block!");
+        else
+            log.Verbose("Swept ", boxes.size(), " boxes, ", hits, " of them hit something!");
+
+        // Moving boxes that start out free must never end up inside a block.
+        std::vector<bool> free(boxes.size());
+        for (size_t i = 0; i < boxes.size(); i++)
+            free[i] = !Collision::IsSolid(world, boxes[i]);
+
+        start = std::chrono::high_resolution_clock::now();
+        Collision::MoveBatch(world, boxes, motions);
+        end = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < boxes.size(); i++)
+            correct &= !free[i] || !Collision::IsSolid(world, boxes[i]);
+
+        // A box dropped onto the surface lands on it.
+        int32_t surface = 63;
+        while (surface > -64 && world.GetBlock(64, surface, 64) == BlockTypes::eAir)
+            surface--;
+        Collision::Box body = {.m_min = glm::vec3(63.7f, surface + 5.0f, 63.7f), .m_max = glm::vec3(64.3f, surface + 6.8f, 64.3f)};
+        Collision::Move(world, body, glm::vec3(0.0f, -20.0f, 0.0f));
+        correct &= std::abs(body.m_min.y - (surface + 1.0f)) < Collision::sSkin;
+
+        if (!correct)
+            log.Warning("Moved boxes ended up inside solid blocks!");
+        else
+            log.Verbose("Moved ", boxes.size(), " boxes! Time taken: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk residency:");
+    {
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        World world;
+        std::vector<std::pair<ChunkPos, std::array<uint8_t, 32768>>> snapshots;
+        for (int32_t x = -4; x < 4; x++) {
+            for (int32_t y = -2; y < 2; y++) {
+                for (int32_t z = -4; z < 4; z++) {
+                    ChunkNode* node = world.LoadChunk({.m_x = x, .m_y = y, .m_z = z});
+                    terrain.Generate(*node);
+                    node->m_solid = node->m_chunk->GetBlockBitmap(BlockTypes::eAir, true);
+                    node->m_chunk->MeshGreedy(node->m_mesh);
+                    node->m_state = ChunkState::eMeshed;
+
+                    std::array<uint8_t, 32768> blocks;
+                    std::memcpy(blocks.data(), static_cast<EightBitChunk*>(node->m_chunk.get())->Data(), blocks.size());
+                    snapshots.push_back({node->m_pos, blocks});
+                }
+            }
+        }
+
+        ChunkResidency::Settings settings;
+        settings.m_budget = ~0ull;
+        ChunkResidency measure = ChunkResidency(world, settings);
+        measure.Update(glm::vec3(0.0f, 0.0f, 0.0f));
+        const ChunkResidency::Usage full = measure.GetUsage();
+        log.Verbose("Resident chunks take ", full.GetTotal(), " bytes! (", full.m_voxels, " voxels, ", full.m_meshes, " meshes)");
+
+        // Dropping meshes covers the first cut, compressing the second, and only the last one unloads.
+        settings.m_maxEvictionsPerFrame = 1024;
+        settings.m_pinRadius = 1;
+        const std::array<size_t, 3> budgets = {
+            full.GetTotal() - full.m_meshes / 2,
+            full.GetTotal() - full.m_meshes - full.m_voxels / 2,
+            full.m_nodes / 2
+        };
+
+        bool correct = true;
+        const ChunkPos farAway = {.m_x = 3, .m_y = 1, .m_z = 3};
+        for (size_t step = 0; step < budgets.size(); step++) {
+            // Every residency starts counting frames from the same point, so what the last one needed is forgotten.
+            world.GetChunks().ForEach([](ChunkNode& node) {
+                node.m_lastNeeded = 0;
+            });
+            settings.m_budget = budgets[step];
+            ChunkResidency residency = ChunkResidency(world, settings);
+            residency.Touch({world.GetChunk(farAway)});
+            residency.Update(glm::vec3(0.0f, 0.0f, 0.0f));
+
+            const ChunkResidency::Stats& stats = residency.GetStats();
+            correct &= step == 0 ? stats.m_droppedMeshes > 0 && stats.m_compressed == 0 && stats.m_unloaded == 0
+                : step == 1 ? stats.m_compressed > 0 && stats.m_unloaded == 0
+                : stats.m_unloaded > 0;
+            correct &= residency.GetUsage().GetTotal() <= settings.m_budget || step == 2;
+
+            // Pinned and touched chunks keep everything.
+            const ChunkNode* pinned = world.GetChunk({.m_x = 1, .m_y = -1, .m_z = 0});
+            const ChunkNode* touched = world.GetChunk(farAway);
+            correct &= pinned != nullptr && pinned->m_state == ChunkState::eMeshed && pinned->m_chunk != nullptr;
+            correct &= touched != nullptr && touched->m_state == ChunkState::eMeshed && touched->m_chunk != nullptr;
+            log.Verbose("Budget of ", settings.m_budget, " bytes dropped ", stats.m_droppedMeshes, " meshes, compressed ", stats.m_compressed,
+                " chunks and unloaded ", stats.m_unloaded, "! (", residency.GetUsage().GetTotal(), " bytes left)");
+
+            // Compressed chunks still read the same, and come back when written to.
+            for (const auto& [pos, blocks] : snapshots) {
+                const ChunkNode* node = world.GetChunk(pos);
+                if (node == nullptr || !node->IsCompressed())
+                    continue;
+
+                for (uint32_t i = 0; i < 32768; i += 97)
+                    correct &= world.GetBlock(pos.m_x * 32 + (i >> 10), pos.m_y * 32 + ((i >> 5) & 31), pos.m_z * 32 + (i & 31)) == blocks[i];
+            }
+        }
+
+        for (const auto& [pos, blocks] : snapshots) {
+            ChunkNode* node = world.GetChunk(pos);
+            if (node == nullptr || !node->IsCompressed())
+                continue;
+
+            world.SetBlock(blocks[0], pos.m_x * 32, pos.m_y * 32, pos.m_z * 32);
+            correct &= node->m_chunk != nullptr && std::memcmp(static_cast<EightBitChunk*>(node->m_chunk.get())->Data(), blocks.data(), blocks.size()) == 0;
+        }
+
+        // Unloaded chunks live on in the far field until they are loaded again.
+        for (const auto& [pos, blocks] : snapshots) {
+            if (world.GetChunk(pos) != nullptr)
+                continue;
+
+            uint32_t root;
+            correct &= world.GetFarField().FindChunk(pos, root);
+            world.LoadChunk(pos);
+            correct &= !world.GetFarField().FindChunk(pos, root);
+        }
+
+        // Dropped meshes come back as soon as their chunks are needed again, without the camera
+        // moving into another chunk.
+        ChunkStreamer::Settings streamerSettings;
+        streamerSettings.m_loadRadius = 0;
+        streamerSettings.m_maxMeshesPerFrame = 1024;
+        streamerSettings.m_maxMillisPerFrame = INFINITY;
+        ChunkStreamer streamer = ChunkStreamer(world, streamerSettings);
+        streamer.Update(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        measure.Update(glm::vec3(0.0f, 0.0f, 0.0f));
+        world.GetChunks().ForEach([](ChunkNode& node) {
+            node.m_lastNeeded = 0;
+        });
+        settings.m_budget = measure.GetUsage().GetTotal() - measure.GetUsage().m_meshes / 2;
+        settings.m_pinRadius = 0;
+        ChunkResidency residency = ChunkResidency(world, settings);
+        residency.SetStreamer(&streamer);
+        residency.Update(glm::vec3(0.0f, 0.0f, 0.0f));
+
+        std::vector<ChunkNode*> dropped;
+        world.GetChunks().ForEach([&](ChunkNode& node) {
+            if (node.m_state == ChunkState::eLoaded && node.m_meshDirty)
+                dropped.push_back(&node);
+        });
+        residency.Touch(dropped);
+        streamer.Update(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        correct &= !dropped.empty();
+        for (const ChunkNode* node : dropped)
+            correct &= node->m_state == ChunkState::eMeshed && !node->m_mesh.m_vertices.empty();
+
+        // Chunks unloaded within the load radius are loaded again, without the camera moving either.
+        // The residency's camera is elsewhere, so that none of them are pinned.
+        streamerSettings.m_loadRadius = 1;
+        streamerSettings.m_maxLoadsPerFrame = 1024;
+        ChunkStreamer loader = ChunkStreamer(world, streamerSettings);
+        loader.Update(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        world.GetChunks().ForEach([](ChunkNode& node) {
+            node.m_lastNeeded = 0;
+        });
+        settings.m_budget = 0;
+        settings.m_maxEvictionsPerFrame = 4096;
+        ChunkResidency evicting = ChunkResidency(world, settings);
+        evicting.SetStreamer(&loader);
+        evicting.Update(glm::vec3(10000.0f, 0.0f, 0.0f));
+        correct &= evicting.GetStats().m_unloaded > 0 && world.GetChunk({.m_x = 0, .m_y = 0, .m_z = 0}) == nullptr;
+        loader.Update(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        for (const Direction direction : Directions::sAll) {
+            const ChunkNode* node = world.GetChunk(ChunkPos{.m_x = 0, .m_y = 0, .m_z = 0}.Offset(direction));
+            correct &= node != nullptr && node->m_state != ChunkState::eEmpty;
+        }
+        correct &= world.GetChunk({.m_x = 0, .m_y = 0, .m_z = 0}) != nullptr;
+
+        if (!correct)
+            log.Warning("Residency evicted in the wrong order or lost voxel data!");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk serialization:");
+    {
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        std::vector<std::unique_ptr<EightBitChunk>> chunks;
+        std::vector<uint8_t> buffer;
+        std::vector<size_t> offsets;
+        for (int32_t x = 0; x < 8; x++) {
+            for (int32_t y = -2; y < 2; y++) {
+                for (int32_t z = 0; z < 8; z++) {
+                    chunks.push_back(std::make_unique<EightBitChunk>());
+                    terrain.Generate(*chunks.back(), {.m_x = x, .m_y = y, .m_z = z});
+                    offsets.push_back(buffer.size());
+                    ChunkSerializer::Serialize(*chunks.back(), buffer);
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<EightBitChunk>> loaded;
+        for (size_t i = 0; i < chunks.size(); i++)
+            loaded.push_back(std::make_unique<EightBitChunk>());
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < chunks.size(); i++)
+            ChunkSerializer::Deserialize(buffer.data() + offsets[i], buffer.size() - offsets[i], *loaded[i]);
+        end = std::chrono::high_resolution_clock::now();
+
+        const auto memcpyStart = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < chunks.size(); i++)
+            std::memcpy(loaded[i]->Data(), buffer.data() + offsets[i] + ChunkSerializer::sPayloadAlignment, 32768);
+        const auto memcpyEnd = std::chrono::high_resolution_clock::now();
+
+        bool correct = true;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            correct &= std::memcmp(loaded[i]->Data(), chunks[i]->Data(), 32768) == 0;
+            correct &= loaded[i]->m_blockPaletteCounts == chunks[i]->m_blockPaletteCounts;
+            correct &= (offsets[i] & (ChunkSerializer::sPayloadAlignment - 1)) == 0;
+        }
+
+        // A palette that misses a block type present in the data must be rejected.
+        std::vector<uint8_t> corrupt;
+        for (size_t i = 0; i < chunks.size() && corrupt.empty(); i++) {
+            if (std::count_if(chunks[i]->m_blockPaletteCounts.begin(), chunks[i]->m_blockPaletteCounts.end(), [](uint16_t count) { return count != 0; }) > 1)
+                ChunkSerializer::Serialize(*chunks[i], corrupt);
+        }
+        corrupt[sizeof(ChunkSerializer::Header)] ^= 1;
+        try {
+            ChunkSerializer::Deserialize(corrupt.data(), corrupt.size(), *loaded[0]);
+            correct = false;
+        } catch (const std::runtime_error&) {}
+
+        if (!correct)
+            log.Warning("Deserialized chunks don't match the serialized ones!");
+        else
+            log.Verbose("Loaded ", chunks.size(), " chunks from ", buffer.size(), " bytes! Time taken: ", end - start, " against ", memcpyEnd - memcpyStart, " for memcpy");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing region files:");
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "vxl-region-test";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        const std::string path = (directory / "test.vxr").string();
+
+        // Random records of every size written, rewritten and removed, checked against a copy in memory.
+        std::unordered_map<uint32_t, std::vector<uint8_t>> expected;
+        std::uniform_int_distribution<uint32_t> index(0, 511);
+        std::uniform_int_distribution<uint32_t> size(1, 40000);
+        std::uniform_int_distribution<uint32_t> byte(0, 255);
+        bool correct = true;
+        {
+            RegionFile file = RegionFile(path);
+            for (int i = 0; i < 4000; i++) {
+                const uint32_t chunk = index(gen);
+                if (i % 5 == 4) {
+                    correct &= file.Remove(chunk) == (expected.erase(chunk) != 0);
+                    continue;
+                }
+
+                std::vector<uint8_t> record(size(gen));
+                for (uint8_t& value : record)
+                    value = static_cast<uint8_t>(byte(gen));
+                file.Write(chunk, record.data(), record.size());
+                expected[chunk] = std::move(record);
+            }
+            log.Verbose("Region file holds ", expected.size(), " records in ", file.GetUsedSectorCount(), " of ", file.GetSectorCount(), " sectors!");
+        }
+
+        std::vector<uint8_t> record;
+        for (const uint32_t compact : {0, 1}) {
+            start = std::chrono::high_resolution_clock::now();
+            RegionFile file = RegionFile(path);
+            end = std::chrono::high_resolution_clock::now();
+            if (compact) {
+                file.Compact();
+                correct &= file.GetSectorCount() == RegionFile::sIndexSectors + file.GetUsedSectorCount();
+            } else {
+                log.Verbose("Opened the region file! Time taken: ", end - start);
+            }
+
+            for (uint32_t chunk = 0; chunk < 512; chunk++) {
+                const auto it = expected.find(chunk);
+                correct &= file.Read(chunk, record) == (it != expected.end());
+                correct &= it == expected.end() || record == it->second;
+            }
+        }
+
+        // Whole chunks through the storage, across region borders.
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        std::vector<std::pair<ChunkPos, std::unique_ptr<EightBitChunk>>> chunks;
+        for (int32_t x = -4; x < 4; x++) {
+            for (int32_t y = -2; y < 2; y++) {
+                for (int32_t z = -4; z < 4; z++) {
+                    const ChunkPos pos = {.m_x = x * 5, .m_y = y, .m_z = z * 5};
+                    chunks.push_back({pos, std::make_unique<EightBitChunk>()});
+                    terrain.Generate(*chunks.back().second, pos);
+                }
+            }
+        }
+        {
+            RegionStorage storage = RegionStorage(directory.string());
+            for (const auto& [pos, chunk] : chunks)
+                storage.Save(pos, *chunk);
+            storage.Flush();
+        }
+
+        RegionStorage storage = RegionStorage(directory.string(), 2);
+        EightBitChunk loaded;
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& [pos, chunk] : chunks) {
+            correct &= storage.Load(pos, loaded);
+            correct &= std::memcmp(loaded.Data(), chunk->Data(), 32768) == 0 && loaded.m_blockPaletteCounts == chunk->m_blockPaletteCounts;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        correct &= !storage.Load({.m_x = 1, .m_y = 0, .m_z = 0}, loaded) && !storage.Load({.m_x = 100, .m_y = 0, .m_z = 0}, loaded);
+        storage.CompactAll();
+
+        // A region file that fails to open stays out of the open files, and keeps failing.
+        FILE* corrupt = std::fopen((directory / "r.7.0.0.vxr").string().c_str(), "wb");
+        std::fwrite("VXGR", 1, 4, corrupt);
+        std::fclose(corrupt);
+        for (int attempt = 0; attempt < 2; attempt++) {
+            try {
+                storage.Load({.m_x = 7 * 32, .m_y = 0, .m_z = 0}, loaded);
+                correct = false;
+            } catch (const std::runtime_error&) {}
+        }
+
+        std::filesystem::remove_all(directory);
+        if (!correct)
+            log.Warning("Region files returned different records than were written!");
+        else
+            log.Verbose("Loaded ", chunks.size(), " chunks from region files! Time taken: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk I/O:");
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "vxl-io-test";
+        std::filesystem::remove_all(directory);
+
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        std::unordered_map<uint64_t, std::unique_ptr<EightBitChunk>> chunks;
+        std::vector<ChunkPos> positions;
+        for (int32_t x = -6; x < 6; x++) {
+            for (int32_t y = -2; y < 2; y++) {
+                for (int32_t z = -6; z < 6; z++) {
+                    const ChunkPos pos = {.m_x = x * 3, .m_y = y, .m_z = z * 3};
+                    positions.push_back(pos);
+                    if ((x + y + z) % 4 == 0)
+                        continue;
+
+                    std::unique_ptr<EightBitChunk> chunk = std::make_unique<EightBitChunk>();
+                    terrain.Generate(*chunk, pos);
+                    chunks[pos.Pack()] = std::move(chunk);
+                }
+            }
+        }
+
+        // Loads queued right behind the saves of the same chunks have to see them. Loads are refused
+        // while the queue is saturated and retried, as the streamer does.
+        RegionStorage storage = RegionStorage(directory.string());
+        bool correct = true;
+        size_t refused = 0;
+        {
+            ChunkIO::Settings settings;
+            settings.m_maxPending = 64;
+            ChunkIO io = ChunkIO(storage, settings);
+
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& [key, chunk] : chunks)
+                io.RequestSave(ChunkPos::Unpack(key), *chunk);
+
+            size_t next = 0, received = 0;
+            while (received < positions.size()) {
+                while (next < positions.size() && io.RequestLoad(positions[next]))
+                    next++;
+                refused += next < positions.size();
+
+                io.Poll([&](const ChunkPos& pos, std::unique_ptr<EightBitChunk> chunk) {
+                    const auto it = chunks.find(pos.Pack());
+                    received++;
+                    if (it == chunks.end()) {
+                        correct &= chunk == nullptr;
+                        return;
+                    }
+
+                    correct &= chunk != nullptr && std::memcmp(chunk->Data(), it->second->Data(), 32768) == 0 && chunk->m_blockPaletteCounts == it->second->m_blockPaletteCounts;
+                });
+                std::this_thread::yield();
+            }
+            end = std::chrono::high_resolution_clock::now();
+            correct &= io.GetPendingCount() == 0;
+
+            // Writes still queued on destruction are finished.
+            for (const auto& [key, chunk] : chunks)
+                io.RequestSave(ChunkPos::Unpack(key), *chunk);
+        }
+
+        EightBitChunk loaded;
+        for (const ChunkPos& pos : positions)
+            correct &= storage.Load(pos, loaded) == chunks.contains(pos.Pack());
+
+        std::filesystem::remove_all(directory);
+        if (!correct)
+            log.Warning("Chunk I/O returned different chunks than were saved!");
+        else if (refused == 0)
+            log.Warning("Chunk I/O never refused a load while saturated!");
+        else
+            log.Verbose("Saved ", chunks.size(), " and loaded ", positions.size(), " chunks asynchronously, ", refused, " times saturated! Time taken: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk compression:");
+    {
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        std::vector<std::unique_ptr<EightBitChunk>> chunks;
+        for (int32_t x = -4; x < 4; x++) {
+            for (int32_t y = -2; y < 2; y++) {
+                for (int32_t z = -4; z < 4; z++) {
+                    chunks.push_back(std::make_unique<EightBitChunk>());
+                    terrain.Generate(*chunks.back(), {.m_x = x, .m_y = y, .m_z = z});
+                }
+            }
+        }
+
+        // Random blocks from palettes of every index width.
+        std::uniform_int_distribution<uint32_t> block(0, 63);
+        for (const uint32_t types : {1, 2, 3, 9, 40}) {
+            chunks.push_back(std::make_unique<EightBitChunk>());
+            for (uint32_t i = 0; i < 32768; i++)
+                chunks.back()->Data()[i] = static_cast<uint8_t>(block(gen) % types * 7 % 64);
+            chunks.back()->RecountPalette();
+        }
+
+        std::vector<std::vector<uint8_t>> encoded(chunks.size());
+        size_t encodedSize = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < chunks.size(); i++) {
+            ChunkCodec::Encode(*chunks[i], encoded[i]);
+            encodedSize += encoded[i].size();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        const auto encodeTime = end - start;
+
+        std::vector<EightBitChunk> decoded(chunks.size());
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < chunks.size(); i++)
+            ChunkCodec::Decode(encoded[i], decoded[i]);
+        end = std::chrono::high_resolution_clock::now();
+
+        bool correct = true;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            correct &= std::memcmp(decoded[i].Data(), chunks[i]->Data(), 32768) == 0 && decoded[i].m_blockPaletteCounts == chunks[i]->m_blockPaletteCounts;
+            for (uint32_t j = 0; j < 32768; j += 61)
+                correct &= ChunkCodec::GetBlock(encoded[i], j >> 10, (j >> 5) & 31, j & 31) == chunks[i]->Data()[j];
+        }
+
+        std::vector<uint8_t> truncated = encoded[chunks.size() / 2];
+        truncated.pop_back();
+        try {
+            ChunkCodec::Decode(truncated, decoded[0]);
+            correct = false;
+        } catch (const std::runtime_error&) {}
+
+        // Records that keep their size but break the header, the palette or the indices must be
+        // rejected too. The chunk of 9 block types has 4 bit indices and no uniform rows.
+        const std::vector<uint8_t>& mixed = encoded[chunks.size() - 2];
+        const size_t paletteSize = mixed[0];
+        for (uint32_t corruption = 0; corruption < 5; corruption++) {
+            std::vector<uint8_t> malformed = mixed;
+            if (corruption == 0)
+                malformed[1] = 3;
+            else if (corruption == 1)
+                malformed[6 + paletteSize - 1] = 64;
+            else if (corruption == 2)
+                malformed[6 + paletteSize]++;
+            else if (corruption == 3)
+                malformed[6 + paletteSize * 3] ^= 1;
+            else
+                malformed.back() = 0xFF;
+
+            try {
+                ChunkCodec::Decode(malformed, decoded[0]);
+                correct = false;
+            } catch (const std::runtime_error&) {}
+            try {
+                ChunkCodec::GetBlock(malformed, 31, 31, corruption == 4 ? 31 : 0);
+                correct = false;
+            } catch (const std::runtime_error&) {}
+        }
+
+        // Chunks nobody needed for long enough are compressed without any memory pressure.
+        World world;
+        GenerateChunks(world, glm::ivec3(-2, 0, -2), glm::ivec3(2, 1, 2));
+        ChunkResidency::Settings settings;
+        settings.m_budget = ~0ull;
+        settings.m_pinRadius = 0;
+        settings.m_idleFrames = 3;
+        ChunkResidency residency = ChunkResidency(world, settings);
+        uint32_t compressed = 0;
+        for (int frame = 0; frame < 4; frame++) {
+            residency.Touch({world.GetChunk({.m_x = 1, .m_y = 0, .m_z = 1})});
+            residency.Update(glm::vec3(0.0f, 0.0f, 0.0f));
+            compressed += residency.GetStats().m_compressed;
+        }
+        correct &= compressed == 14 && world.GetChunk({.m_x = 1, .m_y = 0, .m_z = 1})->m_chunk != nullptr;
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        if (!correct)
+            log.Warning("Compressed chunks don't decode to the original ones!");
+        else
+            log.Verbose("Compressed ", chunks.size(), " chunks ", chunks.size() * 32768.0 / encodedSize, "x! Encode time taken: ", encodeTime, ", decode: ", end - start,
+                " (", chunks.size() * 32768.0 / seconds / 1e9, " GB/s)");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing chunk interning:");
+    {
+        // Deep and high chunks are all stone or all air, and end up sharing a single payload each.
+        World world;
+        GenerateChunks(world, glm::ivec3(-4, -4, -4), glm::ivec3(4, 4, 4));
+        std::vector<std::pair<ChunkPos, uint64_t>> hashes;
+        world.GetChunks().ForEach([&](ChunkNode& node) {
+            hashes.push_back({node.m_pos, ChunkInterner::Hash(*static_cast<EightBitChunk*>(node.m_chunk.get()))});
+        });
+
+        ChunkResidency::Usage before;
+        world.GetChunks().ForEach([&](const ChunkNode& node) {
+            ChunkResidency::Measure(node, before);
+        });
+
+        std::vector<uint16_t> blocks;
+        std::chrono::nanoseconds internTime = {};
+        for (const auto& [pos, hash] : hashes) {
+            ChunkNode* node = world.GetChunk(pos);
+            for (uint32_t i = 0; i < 32768; i += 131)
+                blocks.push_back(world.GetBlock(pos.m_x * 32 + (i >> 10), pos.m_y * 32 + ((i >> 5) & 31), pos.m_z * 32 + (i & 31)));
+            start = std::chrono::high_resolution_clock::now();
+            node->m_chunk = world.GetInterner().Intern(std::move(node->m_chunk), hash);
+            internTime += std::chrono::high_resolution_clock::now() - start;
+        }
+
+        ChunkResidency::Usage after;
+        std::unordered_set<const IChunk*> payloads;
+        world.GetChunks().ForEach([&](const ChunkNode& node) {
+            ChunkResidency::Measure(node, after);
+            payloads.insert(node.m_chunk.get());
+        });
+
+        // Lookups read the same blocks, and writes only reach the chunk written to.
+        bool correct = payloads.size() + world.GetInterner().GetHits() == hashes.size() && after.m_voxels <= payloads.size() * sizeof(EightBitChunk);
+        size_t next = 0;
+        for (const auto& [pos, hash] : hashes) {
+            for (uint32_t i = 0; i < 32768; i += 131)
+                correct &= world.GetBlock(pos.m_x * 32 + (i >> 10), pos.m_y * 32 + ((i >> 5) & 31), pos.m_z * 32 + (i & 31)) == blocks[next++];
+        }
+
+        const ChunkPos edited = {.m_x = 0, .m_y = 3, .m_z = 0};
+        const IChunk* shared = world.GetChunk(edited)->m_chunk.get();
+        correct &= world.GetChunk(edited)->m_chunk.use_count() > 2;
+        world.SetBlock(BlockTypes::eStone, 5, 100, 7);
+        correct &= world.GetChunk(edited)->m_chunk.get() != shared && world.GetBlock(5, 100, 7) == BlockTypes::eStone;
+        correct &= world.GetChunk({.m_x = 1, .m_y = 3, .m_z = 0})->m_chunk.get() == shared && world.GetBlock(37, 100, 7) == BlockTypes::eAir;
+
+        // Entries of payloads nobody uses anymore are swept away.
+        for (const auto& [pos, hash] : hashes)
+            world.UnloadChunk(pos);
+        world.GetInterner().Sweep(hashes.size());
+        world.GetInterner().Sweep(hashes.size());
+        correct &= world.GetInterner().GetEntryCount() == 0;
+
+        if (!correct)
+            log.Warning("Interned chunks don't match the originals!");
+        else
+            log.Verbose("Interned ", hashes.size(), " chunks into ", payloads.size(), " payloads, from ", before.m_voxels, " to ", after.m_voxels, " bytes! Time taken: ", internTime);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing edit journal:");
+    {
+        World world;
+        GenerateChunks(world, glm::ivec3(-2, -2, -2), glm::ivec3(2, 2, 2));
+
+        const auto snapshot = [&]() {
+            std::vector<uint8_t> blocks;
+            world.GetChunks().ForEach([&](ChunkNode& node) {
+                const uint8_t* data = static_cast<EightBitChunk*>(node.m_chunk.get())->Data();
+                blocks.insert(blocks.end(), data, data + 32768);
+            });
+            return blocks;
+        };
+        const std::vector<uint8_t> original = snapshot();
+
+        // A sphere carved out of the terrain and a block of stone in the sky, about two million blocks.
+        EditJournal journal = EditJournal(world, EditJournal::Settings());
+        journal.Begin();
+        journal.Capture(glm::ivec3(-64, -64, -64), glm::ivec3(63, 63, 63));
+        for (int32_t x = -64; x < 64; x++) {
+            for (int32_t y = -64; y < 64; y++) {
+                for (int32_t z = -64; z < 64; z++) {
+                    if (x * x + y * y + z * z < 40 * 40)
+                        world.SetBlock(BlockTypes::eAir, x, y, z);
+                    else if (y >= 40)
+                        world.SetBlock(BlockTypes::eStone, x, y, z);
+                }
+            }
+        }
+        start = std::chrono::high_resolution_clock::now();
+        bool correct = journal.Commit();
+        end = std::chrono::high_resolution_clock::now();
+        const auto commitTime = end - start;
+        const size_t journaled = journal.GetMemoryUsage();
+        const std::vector<uint8_t> edited = snapshot();
+
+        journal.Begin();
+        journal.Capture(glm::ivec3(0, 0, 0), glm::ivec3(0, 0, 0));
+        correct &= !journal.Commit();
+
+        start = std::chrono::high_resolution_clock::now();
+        correct &= journal.Undo(nullptr);
+        end = std::chrono::high_resolution_clock::now();
+        correct &= snapshot() == original && !journal.CanUndo();
+        correct &= journal.Redo(nullptr) && snapshot() == edited && !journal.CanRedo();
+        correct &= world.GetChunk({.m_x = 0, .m_y = 1, .m_z = 0})->m_solid.GetBit(0, 31, 0) && world.GetBlock(0, 0, 0) == BlockTypes::eAir;
+
+        // A new edit after an undo can't redo the old one anymore.
+        journal.Undo(nullptr);
+        journal.Begin();
+        journal.Capture(glm::ivec3(0, 0, 0), glm::ivec3(0, 0, 0));
+        world.SetBlock(BlockTypes::eLamp, 0, 0, 0);
+        correct &= journal.Commit() && !journal.CanRedo() && journal.Undo(nullptr) && snapshot() == original;
+
+        // The light of an undone lamp leaves the neighboring chunks too, as if lit from scratch.
+        world.GetLight().Relight();
+        journal.Begin();
+        journal.Capture(glm::ivec3(0, 50, 0), glm::ivec3(0, 50, 0));
+        world.SetBlock(BlockTypes::eLamp, 0, 50, 0);
+        world.GetLight().Update();
+        correct &= journal.Commit() && world.GetLight().GetLight(-1, 50, 0, ChunkLight::eBlock) == 14;
+        correct &= journal.Undo(nullptr);
+        world.GetLight().Update();
+        const std::vector<uint8_t> relit = GetLightLevels(world);
+        world.GetLight().Relight();
+        correct &= relit == GetLightLevels(world) && world.GetLight().GetLight(-1, 50, 0, ChunkLight::eBlock) == 0;
+
+        // A chunk changed outside of the journal since is left as it is, the others are undone.
+        const uint16_t untouched = world.GetBlock(33, 1, 1);
+        journal.Begin();
+        journal.Capture(glm::ivec3(1, 1, 1), glm::ivec3(33, 1, 1));
+        world.SetBlock(BlockTypes::eLamp, 1, 1, 1);
+        world.SetBlock(BlockTypes::eLamp, 33, 1, 1);
+        correct &= journal.Commit();
+        world.SetBlock(BlockTypes::eDirt, 2, 2, 2);
+        correct &= journal.Undo(nullptr) && world.GetBlock(1, 1, 1) == BlockTypes::eLamp && world.GetBlock(2, 2, 2) == BlockTypes::eDirt;
+        correct &= world.GetBlock(33, 1, 1) == untouched;
+
+        if (!correct)
+            log.Warning("Undoing and redoing edits doesn't restore the world!");
+        else
+            log.Verbose("Journaled ", original.size(), " blocks in ", journaled, " bytes! Commit time taken: ", commitTime, ", undo: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing brushes:");
+    {
+        World world, reference;
+        GenerateChunks(world, glm::ivec3(-2), glm::ivec3(2));
+        GenerateChunks(reference, glm::ivec3(-2), glm::ivec3(2));
+
+        // Off center and uneven, so that shapes end partway into blocks and cross chunk borders.
+        std::vector<Brush::Settings> brushes = {
+            {.m_shape = Brush::Shape::eSphere, .m_center = {3.3f, -2.7f, 5.1f}, .m_extent = {40.0f, 27.5f, 33.2f}, .m_block = BlockTypes::eAir},
+            {.m_shape = Brush::Shape::eBox, .m_center = {-20.5f, 10.0f, -7.25f}, .m_extent = {12.3f, 30.0f, 5.5f}, .m_block = BlockTypes::eLamp},
+            {.m_shape = Brush::Shape::eCylinder, .m_center = {17.0f, 5.5f, 20.2f}, .m_extent = {9.7f, 40.0f, 14.1f}, .m_block = BlockTypes::eStone},
+        };
+        bool correct = true;
+        for (const Brush::Settings& brush : brushes) {
+            Brush::Apply(world, brush, nullptr);
+            Brush::ApplyNaive(reference, brush);
+            correct &= CountMismatches(world, reference) == 0;
+        }
+
+        // Vector and scalar noise round differently, so a few blocks at the threshold may differ.
+        const Brush::Settings noisy = {.m_shape = Brush::Shape::eNoise, .m_center = {-4.0f, 8.0f, 2.0f}, .m_extent = {50.0f, 50.0f, 50.0f}, .m_block = BlockTypes::eDirt, .m_noise = {.m_frequency = 0.05f}, .m_seed = 7};
+        Brush::Apply(world, noisy, nullptr);
+        const uint64_t noisyBlocks = Brush::ApplyNaive(reference, noisy);
+        correct &= CountMismatches(world, reference) * 1000 < noisyBlocks && noisyBlocks > 0;
+
+        // Brushing the lamps away takes their light out of the neighboring chunks too.
+        world.GetLight().Relight();
+        Brush::Settings unlit = brushes[1];
+        unlit.m_block = BlockTypes::eAir;
+        Brush::Apply(world, unlit, nullptr);
+        world.GetLight().Update();
+        const std::vector<uint8_t> relit = GetLightLevels(world);
+        world.GetLight().Relight();
+        correct &= relit == GetLightLevels(world);
+
+        // A sphere of radius 64 centered on a chunk corner spans 64 chunks.
+        World large, largeReference;
+        GenerateChunks(large, glm::ivec3(-3), glm::ivec3(3));
+        GenerateChunks(largeReference, glm::ivec3(-3), glm::ivec3(3));
+        const Brush::Settings sphere = {.m_extent = {64.0f, 64.0f, 64.0f}, .m_block = BlockTypes::eStone};
+        start = std::chrono::high_resolution_clock::now();
+        const uint32_t chunks = Brush::Apply(large, sphere, nullptr);
+        end = std::chrono::high_resolution_clock::now();
+        const auto brushTime = end - start;
+        start = std::chrono::high_resolution_clock::now();
+        const uint64_t blocks = Brush::ApplyNaive(largeReference, sphere);
+        end = std::chrono::high_resolution_clock::now();
+        correct &= CountMismatches(large, largeReference) == 0;
+
+        // Blocks past the palette must be rejected rather than written as other blocks.
+        Brush::Settings invalid = sphere;
+        invalid.m_block = 64;
+        try {
+            Brush::Apply(large, invalid, nullptr);
+            log.Warning("Brushing accepted a block past the palette!");
+        } catch (const std::runtime_error&) {}
+        correct &= CountMismatches(large, largeReference) == 0;
+
+        if (!correct)
+            log.Warning("Brushes don't match setting their blocks one by one!");
+        else
+            log.Verbose("Painted ", blocks, " blocks in ", chunks, " chunks! Time taken: ", brushTime, ", naive: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing fluids:");
+    {
+        World world, reference;
+        GenerateChunks(world, glm::ivec3(-2), glm::ivec3(2));
+        GenerateChunks(reference, glm::ivec3(-2), glm::ivec3(2));
+
+        // Sources a few blocks above the ground, one of them on a chunk corner.
+        FluidSimulator water = FluidSimulator(world, FluidSimulator::Settings());
+        FluidSimulator waterReference = FluidSimulator(reference, FluidSimulator::Settings());
+        std::vector<glm::ivec3> sources;
+        for (const auto [x, z] : {std::pair(5, 7), std::pair(-1, -1), std::pair(20, -12)}) {
+            int32_t y = 63;
+            while (y > -64 && world.GetBlock(x, y, z) == BlockTypes::eAir)
+                y--;
+            sources.push_back(glm::ivec3(x, std::min(y + 4, 63), z));
+        }
+
+        bool correct = true;
+        for (const glm::ivec3& source : sources)
+            correct &= water.AddSource(source.x, source.y, source.z) && waterReference.AddSource(source.x, source.y, source.z);
+
+        const auto compare = [&]() {
+            uint64_t mismatches = CountMismatches(world, reference);
+            world.GetChunks().ForEach([&](ChunkNode& node) {
+                for (int32_t x = 0; x < 32; x++) {
+                    for (int32_t y = 0; y < 32; y++) {
+                        for (int32_t z = 0; z < 32; z++) {
+                            const int32_t wx = node.m_pos.m_x * 32 + x, wy = node.m_pos.m_y * 32 + y, wz = node.m_pos.m_z * 32 + z;
+                            mismatches += water.GetLevel(wx, wy, wz) != waterReference.GetLevel(wx, wy, wz);
+                        }
+                    }
+                }
+            });
+            return mismatches;
+        };
+
+        std::chrono::nanoseconds stepTime = {};
+        uint32_t steps = 0, stepped = 0;
+        for (; steps < 24; steps++) {
+            start = std::chrono::high_resolution_clock::now();
+            stepped += water.Step(nullptr);
+            end = std::chrono::high_resolution_clock::now();
+            stepTime += end - start;
+            waterReference.StepNaive();
+        }
+        correct &= compare() == 0;
+
+        // Settled fluid isn't stepped anymore, and drains once the sources are gone.
+        while (water.GetActiveCount() > 0 && steps < 500) {
+            water.Step(nullptr);
+            steps++;
+        }
+        uint32_t flooded = 0;
+        world.GetChunks().ForEach([&](ChunkNode& node) {
+            flooded += node.m_chunk->m_blockPaletteCounts[BlockTypes::eWater];
+        });
+        correct &= water.GetActiveCount() == 0 && flooded > sources.size();
+
+        for (const glm::ivec3& source : sources)
+            correct &= water.RemoveSource(source.x, source.y, source.z);
+        while (water.GetActiveCount() > 0 && steps < 1000) {
+            water.Step(nullptr);
+            steps++;
+        }
+        world.GetChunks().ForEach([&](ChunkNode& node) {
+            correct &= node.m_chunk->m_blockPaletteCounts[BlockTypes::eWater] == 0;
+        });
+        correct &= water.GetChunkCount() == 0;
+
+        // Flowing and draining lava relights the blocks it changed as if the world was lit from scratch.
+        world.GetLight().Relight();
+        FluidSimulator lava = FluidSimulator(world, FluidSimulator::Settings{.m_block = BlockTypes::eLava});
+        correct &= lava.AddSource(sources[1].x, sources[1].y, sources[1].z);
+        for (uint32_t step = 0; step < 16; step++) {
+            lava.Step(nullptr);
+            world.GetLight().Update();
+        }
+        std::vector<uint8_t> relit = GetLightLevels(world);
+        world.GetLight().Relight();
+        correct &= relit == GetLightLevels(world);
+
+        correct &= lava.RemoveSource(sources[1].x, sources[1].y, sources[1].z);
+        for (uint32_t step = 0; step < 1000 && lava.GetActiveCount() > 0; step++) {
+            lava.Step(nullptr);
+            world.GetLight().Update();
+        }
+        relit = GetLightLevels(world);
+        world.GetLight().Relight();
+        correct &= lava.GetChunkCount() == 0 && relit == GetLightLevels(world);
+
+        if (!correct)
+            log.Warning("Fluid doesn't flow like the reference!");
+        else
+            log.Verbose("Flooded ", flooded, " blocks and drained them in ", steps, " steps! Time taken per step: ", stepTime / 24, " for ", stepped / 24.0f, " chunks");
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing tick scheduling:");
+    {
+        // Chunks sharing a phase never share a neighbor.
+        bool correct = true;
+        for (int32_t a = 0; a < 7 * 7 * 7; a++) {
+            for (int32_t b = a + 1; b < 7 * 7 * 7; b++) {
+                const ChunkPos first = {.m_x = a % 7 - 3, .m_y = a / 7 % 7 - 3, .m_z = a / 49 - 3};
+                const ChunkPos second = {.m_x = b % 7 - 3, .m_y = b / 7 % 7 - 3, .m_z = b / 49 - 3};
+                const int32_t distance = std::max({std::abs(first.m_x - second.m_x), std::abs(first.m_y - second.m_y), std::abs(first.m_z - second.m_z)});
+                correct &= TickScheduler::GetPhase(first) != TickScheduler::GetPhase(second) || distance >= 3;
+            }
+        }
+
+        // Grass stripped from half the terrain, and lamps in the air that fall through chunk borders.
+        std::vector<glm::ivec3> lamps;
+        for (uint32_t i = 0; i < 2000; i++)
+            lamps.push_back(glm::ivec3(gen() % 128 - 64, gen() % 128 - 64, gen() % 128 - 64));
+        World world, reference;
+        for (World* target : {&world, &reference}) {
+            GenerateChunks(*target, glm::ivec3(-2), glm::ivec3(2));
+            for (int32_t x = -64; x < 0; x++) {
+                for (int32_t z = -64; z < 64; z++) {
+                    for (int32_t y = -64; y < 64; y++) {
+                        if (target->GetBlock(x, y, z) == BlockTypes::eGrass)
+                            target->SetBlock(BlockTypes::eDirt, x, y, z);
+                    }
+                }
+            }
+            for (const glm::ivec3& lamp : lamps) {
+                if (target->GetBlock(lamp.x, lamp.y, lamp.z) == BlockTypes::eAir)
+                    target->SetBlock(BlockTypes::eLamp, lamp.x, lamp.y, lamp.z);
+            }
+
+            // Sky chunks with a lamp at the same spot share their payloads, as do the empty ones the
+            // lamps fall into, so chunks of a phase copy the same payloads at once.
+            GenerateChunks(*target, glm::ivec3(-2, 2, -2), glm::ivec3(2, 4, 2));
+            for (int32_t x = -2; x < 2; x++) {
+                for (int32_t z = -2; z < 2; z++)
+                    target->SetBlock(BlockTypes::eLamp, x * 32 + 5, 96, z * 32 + 7);
+            }
+            target->GetChunks().ForEach([&](ChunkNode& node) {
+                const uint64_t hash = ChunkInterner::Hash(static_cast<const EightBitChunk&>(*node.m_chunk));
+                node.m_chunk = target->GetInterner().Intern(std::move(node.m_chunk), hash);
+            });
+        }
+
+        const auto countStripped = [&]() {
+            uint32_t blocks = 0;
+            world.GetChunks().ForEach([&](ChunkNode& node) {
+                if (node.m_pos.m_x < 0)
+                    blocks += node.m_chunk->m_blockPaletteCounts[BlockTypes::eGrass];
+            });
+            return blocks;
+        };
+        const uint32_t grass = countStripped();
+
+        TickScheduler scheduler = TickScheduler(world, TickScheduler::Settings{.m_randomTicks = 1024});
+        TickScheduler schedulerReference = TickScheduler(reference, TickScheduler::Settings{.m_randomTicks = 1024});
+        for (TickScheduler* target : {&scheduler, &schedulerReference}) {
+            // Lamps fall a block per tick, bottom up so that stacks fall together.
+            target->AddTicker([](TickScheduler::Context& context) {
+                const ChunkNode& node = context.GetNode();
+                const ChunkBitmap lamps = node.m_chunk->GetBlockBitmap(BlockTypes::eLamp);
+                for (int32_t y = 0; y < 32; y++) {
+                    for (int32_t x = 0; x < 32; x++) {
+                        for (uint32_t bits = lamps[(x << 5) | y]; bits != 0; bits &= bits - 1) {
+                            const int32_t wx = node.m_pos.m_x * 32 + x, wy = node.m_pos.m_y * 32 + y, wz = node.m_pos.m_z * 32 + std::countr_zero(bits);
+                            if (context.GetBlock(wx, wy - 1, wz) == BlockTypes::eAir) {
+                                context.SetBlock(BlockTypes::eAir, wx, wy, wz);
+                                context.SetBlock(BlockTypes::eLamp, wx, wy - 1, wz);
+                            }
+                        }
+                    }
+                }
+            });
+
+            // Grass dies under blocks and spreads to dirt under air around it.
+            target->SetRandomTicker(BlockTypes::eGrass, [](TickScheduler::Context& context, const int32_t x, const int32_t y, const int32_t z) {
+                if (context.GetBlock(x, y + 1, z) != BlockTypes::eAir) {
+                    context.SetBlock(BlockTypes::eDirt, x, y, z);
+                    return;
+                }
+
+                const uint32_t offset = context.Random() % 27;
+                const int32_t nx = x + static_cast<int32_t>(offset % 3) - 1, ny = y + static_cast<int32_t>(offset / 3 % 3) - 1, nz = z + static_cast<int32_t>(offset / 9) - 1;
+                if (context.GetBlock(nx, ny, nz) == BlockTypes::eDirt && context.GetBlock(nx, ny + 1, nz) == BlockTypes::eAir)
+                    context.SetBlock(BlockTypes::eGrass, nx, ny, nz);
+            });
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < 64; i++)
+            scheduler.Tick();
+        end = std::chrono::high_resolution_clock::now();
+        const auto tickTime = (end - start) / 64;
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < 64; i++)
+            schedulerReference.TickNaive();
+        end = std::chrono::high_resolution_clock::now();
+
+        correct &= CountMismatches(world, reference) == 0;
+        correct &= scheduler.GetRandomTickCount() == schedulerReference.GetRandomTickCount() && countStripped() > grass;
+
+        if (!correct)
+            log.Warning("Parallel ticks don't match ticking one chunk at a time!");
+        else
+            log.Verbose("Grass spread from ", grass, " to ", countStripped(), " blocks in ", scheduler.GetRandomTickCount(), " random ticks! Time taken per tick: ", tickTime, ", naive: ", (end - start) / 64);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing pathfinding:");
+    {
+        World world;
+        GenerateChunks(world, glm::ivec3(-2), glm::ivec3(2));
+
+        // Walls on the surface to walk around, some crossing chunk borders.
+        const auto getSurface = [&](const int32_t x, const int32_t z) {
+            int32_t y = 62;
+            while (y > -64 && (world.GetBlock(x, y, z) != BlockTypes::eAir || world.GetBlock(x, y + 1, z) != BlockTypes::eAir || world.GetBlock(x, y - 1, z) == BlockTypes::eAir))
+                y--;
+            return y;
+        };
+        for (uint32_t i = 0; i < 120; i++) {
+            const int32_t x = static_cast<int32_t>(gen() % 120) - 60, z = static_cast<int32_t>(gen() % 120) - 60;
+            const bool alongX = gen() % 2 == 0;
+            for (int32_t j = 0; j < 12; j++) {
+                const int32_t wx = alongX ? x + j : x, wz = alongX ? z : z + j;
+                const int32_t y = getSurface(wx, wz);
+                world.SetBlock(BlockTypes::eStone, wx, y, wz);
+                world.SetBlock(BlockTypes::eStone, wx, y + 1, wz);
+            }
+        }
+
+        std::vector<std::pair<glm::ivec3, glm::ivec3>> pairs;
+        while (pairs.size() < 60) {
+            const int32_t x0 = static_cast<int32_t>(gen() % 120) - 60, z0 = static_cast<int32_t>(gen() % 120) - 60;
+            const int32_t x1 = static_cast<int32_t>(gen() % 120) - 60, z1 = static_cast<int32_t>(gen() % 120) - 60;
+            const int32_t y0 = getSurface(x0, z0), y1 = getSurface(x1, z1);
+            if (y0 > -64 && y1 > -64)
+                pairs.push_back({glm::ivec3(x0, y0, z0), glm::ivec3(x1, y1, z1)});
+        }
+
+        Pathfinder pathfinder = Pathfinder(world, Pathfinder::Settings{.m_maxExpanded = 1u << 20});
+        bool correct = true;
+        uint32_t found = 0, expanded = 0;
+        std::vector<glm::ivec3> path, reference;
+        const auto check = [&](const glm::ivec3& from, const glm::ivec3& to) {
+            const bool any = pathfinder.FindPath(from, to, path);
+            expanded += pathfinder.GetExpandedCount();
+            correct &= any == pathfinder.FindPathNaive(from, to, reference) && path.size() == reference.size();
+            if (!any)
+                return;
+
+            // Every step is a move an agent can make.
+            found++;
+            correct &= path.front() == from && path.back() == to;
+            for (size_t i = 1; i < path.size(); i++) {
+                glm::ivec3 next;
+                const int32_t dx = path[i].x - path[i - 1].x, dz = path[i].z - path[i - 1].z;
+                correct &= std::abs(dx) + std::abs(dz) == 1 && pathfinder.Move(path[i - 1], dx, dz, next) && next == path[i];
+            }
+        };
+        for (const auto& [from, to] : pairs)
+            check(from, to);
+
+        // Edits show up in the next search, paths that crossed the wall now go around it.
+        for (int32_t x = -64; x < 64; x++) {
+            const int32_t y = getSurface(x, 3);
+            if (y > -64) {
+                world.SetBlock(BlockTypes::eStone, x, y, 3);
+                world.SetBlock(BlockTypes::eStone, x, y + 1, 3);
+            }
+        }
+        for (const auto& [from, to] : pairs) {
+            if (pathfinder.IsWalkable(from.x, from.y, from.z) && pathfinder.IsWalkable(to.x, to.y, to.z))
+                check(from, to);
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& [from, to] : pairs)
+            pathfinder.FindPath(from, to, path);
+        end = std::chrono::high_resolution_clock::now();
+        const auto searchTime = (end - start) / pairs.size();
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& [from, to] : pairs)
+            pathfinder.FindPathNaive(from, to, reference);
+        end = std::chrono::high_resolution_clock::now();
+        const size_t cached = pathfinder.GetCachedCount();
+
+        // Unloaded chunks leave the cache with the next search, and searches treat them as air.
+        for (int32_t y = -2; y < 2; y++) {
+            for (int32_t z = -2; z < 2; z++)
+                world.UnloadChunk({.m_x = -2, .m_y = y, .m_z = z});
+        }
+        for (const auto& [from, to] : pairs) {
+            if (pathfinder.IsWalkable(from.x, from.y, from.z) && pathfinder.IsWalkable(to.x, to.y, to.z))
+                check(from, to);
+        }
+        correct &= pathfinder.GetCachedCount() <= world.GetChunks().Size();
+
+        // A chunk edited, unloaded and read back before the next search takes over the same node, but
+        // not the walkable blocks cached from before the edit.
+        World reloaded;
+        GenerateChunks(reloaded, glm::ivec3(-1), glm::ivec3(1));
+        Pathfinder reloadedPathfinder = Pathfinder(reloaded, Pathfinder::Settings());
+        const auto getReloadedSurface = [&](const int32_t x, const int32_t z) {
+            int32_t y = 30;
+            while (y > -32 && (reloaded.GetBlock(x, y, z) != BlockTypes::eAir || reloaded.GetBlock(x, y + 1, z) != BlockTypes::eAir || reloaded.GetBlock(x, y - 1, z) == BlockTypes::eAir))
+                y--;
+            return y;
+        };
+        const glm::ivec3 from = glm::ivec3(5, getReloadedSurface(5, 5), 5), to = glm::ivec3(6, getReloadedSurface(6, 6), 6);
+        correct &= reloadedPathfinder.FindPath(from, to, path);
+        const ChunkPos pos = ChunkPos::FromBlock(from.x, from.y, from.z);
+        reloaded.SetBlock(BlockTypes::eStone, from.x, from.y, from.z);
+        const std::shared_ptr<IChunk> saved = reloaded.GetChunk(pos)->m_chunk;
+        reloaded.UnloadChunk(pos);
+        ChunkNode* node = reloaded.LoadChunk(pos);
+        node->m_chunk = saved;
+        node->m_solid = saved->GetBlockBitmap(BlockTypes::eAir, true);
+        node->m_state = ChunkState::eLoaded;
+        correct &= !reloadedPathfinder.FindPath(from, to, path) && !reloadedPathfinder.FindPathNaive(from, to, reference);
+
+        if (!correct)
+            log.Warning("Jump point search doesn't match the reference paths!");
+        else
+            log.Verbose("Found ", found, " paths expanding ", expanded, " jump points over ", cached, " cached chunks! Time taken per search: ", searchTime, ", naive: ", (end - start) / pairs.size());
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing connected components:");
+    {
+        // 256 blocks on each side, generated across the job system.
+        TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        World world;
+        std::vector<ChunkNode*> nodes;
+        for (int32_t x = -4; x < 4; x++) {
+            for (int32_t y = -4; y < 4; y++) {
+                for (int32_t z = -4; z < 4; z++)
+                    nodes.push_back(world.LoadChunk({.m_x = x, .m_y = y, .m_z = z}));
+            }
+        }
+        JobSystem::ParallelFor(static_cast<uint32_t>(nodes.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                terrain.Generate(*nodes[i]);
+                nodes[i]->m_solid = nodes[i]->m_chunk->GetBlockBitmap(BlockTypes::eAir, true);
+                nodes[i]->m_state = ChunkState::eLoaded;
+            }
+        });
+
+        // A floating cube, and a hollow shell around a room, both crossing chunk borders.
+        for (int32_t x = 60; x < 65; x++) {
+            for (int32_t y = 90; y < 95; y++) {
+                for (int32_t z = -3; z < 2; z++)
+                    world.SetBlockUnlit(BlockTypes::eStone, x, y, z);
+            }
+        }
+        for (int32_t x = -37; x < -27; x++) {
+            for (int32_t y = 100; y < 110; y++) {
+                for (int32_t z = 27; z < 37; z++) {
+                    const bool inside = x > -37 && x < -28 && y > 100 && y < 109 && z > 27 && z < 36;
+                    world.SetBlockUnlit(inside ? BlockTypes::eAir : BlockTypes::eStone, x, y, z);
+                }
+            }
+        }
+
+        const auto order = [](const ComponentLabeler::Component& a, const ComponentLabeler::Component& b) {
+            return std::tie(a.m_min.x, a.m_min.y, a.m_min.z, a.m_max.x, a.m_max.y, a.m_max.z, a.m_blocks, a.m_bounded) < std::tie(b.m_min.x, b.m_min.y, b.m_min.z, b.m_max.x, b.m_max.y, b.m_max.z, b.m_blocks, b.m_bounded);
+        };
+        const auto matches = [&](const ComponentLabeler& labeler) {
+            std::vector<ComponentLabeler::Component> components = labeler.GetComponents(), reference = labeler.LabelNaive();
+            std::sort(components.begin(), components.end(), order);
+            std::sort(reference.begin(), reference.end(), order);
+            return components.size() == reference.size() && std::equal(components.begin(), components.end(), reference.begin(), [&](const auto& a, const auto& b) {
+                return !order(a, b) && !order(b, a);
+            });
+        };
+
+        ComponentLabeler solid = ComponentLabeler(world, ComponentLabeler::Settings());
+        ComponentLabeler air = ComponentLabeler(world, ComponentLabeler::Settings{.m_air = true});
+        start = std::chrono::high_resolution_clock::now();
+        solid.Label();
+        end = std::chrono::high_resolution_clock::now();
+        const auto labelTime = end - start;
+        air.Label();
+        bool correct = matches(solid) && matches(air);
+
+        // The cube and the shell float, the room inside is enclosed.
+        const uint32_t cube = solid.GetLabel(62, 92, 0), shell = solid.GetLabel(-37, 100, 27), room = air.GetLabel(-32, 104, 32);
+        correct &= cube != ComponentLabeler::sNone && solid.GetComponents()[cube].m_bounded && solid.GetComponents()[cube].m_blocks == 125;
+        correct &= shell != ComponentLabeler::sNone && solid.GetComponents()[shell].m_bounded;
+        correct &= room != ComponentLabeler::sNone && air.GetComponents()[room].m_bounded && air.GetComponents()[room].m_blocks == 8 * 8 * 8;
+        uint32_t cubeBlocks = 0;
+        for (const ChunkPos& pos : {ChunkPos{.m_x = 1, .m_y = 2, .m_z = -1}, ChunkPos{.m_x = 1, .m_y = 2, .m_z = 0}, ChunkPos{.m_x = 2, .m_y = 2, .m_z = -1}, ChunkPos{.m_x = 2, .m_y = 2, .m_z = 0}}) {
+            const ChunkBitmap mask = solid.GetMask(pos, cube);
+            for (uint32_t row = 0; row < 1024; row++)
+                cubeBlocks += std::popcount(mask[row]);
+        }
+        correct &= cubeBlocks == 125;
+
+        // Breaking the shell opens the room to the sky, only relabeling the edited chunk.
+        world.SetBlockUnlit(BlockTypes::eAir, -32, 109, 32);
+        start = std::chrono::high_resolution_clock::now();
+        air.Label();
+        end = std::chrono::high_resolution_clock::now();
+        correct &= matches(air) && air.GetRelabeledCount() == 1 && !air.GetComponents()[air.GetLabel(-32, 104, 32)].m_bounded;
+
+        // A chunk edited, unloaded and read back with the same payload takes over the same node, but
+        // not the labels from before the edit.
+        const ChunkPos pos = ChunkPos::FromBlock(10, 80, 10);
+        world.SetBlockUnlit(BlockTypes::eStone, 10, 80, 10);
+        const std::shared_ptr<IChunk> saved = world.GetChunk(pos)->m_chunk;
+        world.UnloadChunk(pos);
+        ChunkNode* node = world.LoadChunk(pos);
+        node->m_chunk = saved;
+        node->m_solid = saved->GetBlockBitmap(BlockTypes::eAir, true);
+        node->m_state = ChunkState::eLoaded;
+        solid.Label();
+        correct &= matches(solid) && solid.GetLabel(10, 80, 10) != ComponentLabeler::sNone;
+
+        if (!correct)
+            log.Warning("Labeled components don't match the flood fill!");
+        else
+            log.Verbose("Labeled ", solid.GetComponents().size(), " solid and ", air.GetComponents().size(), " air components! Time taken for 256^3: ", labelTime, ", after an edit: ", end - start);
+    }
+
+    log.Println("\n-+-+-+-+-+-+-+ Testing volume imports:");
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "vxl-import-test";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+
+        // A vox file with a small model before the imported one, and a palette.
+        std::vector<uint8_t> vox;
+        const auto append = [&](const void* data, const size_t size) {
+            vox.insert(vox.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        };
+        const auto appendChunk = [&](const char* id, const std::vector<uint8_t>& content) {
+            const int32_t sizes[2] = {static_cast<int32_t>(content.size()), 0};
+            append(id, 4);
+            append(sizes, sizeof(sizes));
+            append(content.data(), content.size());
+        };
+        const auto appendModel = [&](const glm::ivec3& size, const uint32_t modulo) {
+            std::vector<uint8_t> sizeContent(12), voxels(4);
+            std::memcpy(sizeContent.data(), &size, sizeof(size));
+            for (int32_t x = 0; x < size.x; x++) {
+                for (int32_t y = 0; y < size.y; y++) {
+                    for (int32_t z = 0; z < size.z; z++) {
+                        if ((x * 7 + y * 13 + z * 5) % modulo < 4)
+                            voxels.insert(voxels.end(), {static_cast<uint8_t>(x), static_cast<uint8_t>(y), static_cast<uint8_t>(z), static_cast<uint8_t>(1 + (x + y + z) % 200)});
+                    }
+                }
+            }
+            const uint32_t count = static_cast<uint32_t>(voxels.size() / 4 - 1);
+            std::memcpy(voxels.data(), &count, sizeof(count));
+            appendChunk("SIZE", sizeContent);
+            appendChunk("XYZI", voxels);
+        };
+        append("VOX ", 4);
+        const int32_t version = 150;
+        append(&version, sizeof(version));
+        appendChunk("MAIN", {});
+        const size_t children = vox.size();
+        appendModel(glm::ivec3(4, 4, 4), 5);
+        const size_t sizeOffset = vox.size() + 12;
+        appendModel(glm::ivec3(200, 180, 150), 11);
+        std::vector<uint8_t> palette(1024);
+        for (uint8_t& byte : palette)
+            byte = static_cast<uint8_t>(gen());
+        appendChunk("RGBA", palette);
+        const int32_t childrenSize = static_cast<int32_t>(vox.size() - children);
+        std::memcpy(vox.data() + children - 4, &childrenSize, sizeof(childrenSize));
+        const std::string voxPath = (directory / "model.vox").string();
+        FILE* file = std::fopen(voxPath.c_str(), "wb");
+        std::fwrite(vox.data(), 1, vox.size(), file);
+        std::fclose(file);
+
+        // A raw ball with layers of values.
+        const glm::uvec3 rawSize = glm::uvec3(320, 256, 288);
+        std::vector<uint8_t> raw(static_cast<size_t>(rawSize.x) * rawSize.y * rawSize.z);
+        size_t index = 0;
+        for (uint32_t z = 0; z < rawSize.z; z++) {
+            for (uint32_t y = 0; y < rawSize.y; y++) {
+                for (uint32_t x = 0; x < rawSize.x; x++, index++) {
+                    const glm::vec3 offset = glm::vec3(x, y, z) - glm::vec3(rawSize) * 0.5f;
+                    const float distance = glm::length(offset);
+                    raw[index] = distance < 120.0f ? static_cast<uint8_t>(distance) : 0;
+                }
+            }
+        }
+        const std::string rawPath = (directory / "volume.raw").string();
+        file = std::fopen(rawPath.c_str(), "wb");
+        std::fwrite(raw.data(), 1, raw.size(), file);
+        std::fclose(file);
+
+        // Both land partly on lit terrain and partly outside of it, where nothing is written without a
+        // streamer. The raw volume covers a lamp whose light reaches into a chunk it isn't written to.
+        World world, reference;
+        for (World* target : {&world, &reference}) {
+            GenerateChunks(*target, glm::ivec3(-2), glm::ivec3(2));
+            target->SetBlock(BlockTypes::eLamp, -45, 60, 0);
+        }
+        world.GetLight().Relight();
+
+        VolumeImporter::Settings voxSettings = {.m_origin = {40, -100, -90}, .m_model = 1, .m_batchVoxels = 1u << 18};
+        voxSettings.m_mapper = [](const uint8_t value, const uint32_t color) {
+            return value == 0 ? BlockTypes::eAir : (color & 0xFF) > 128 ? BlockTypes::eStone : BlockTypes::eLamp;
+        };
+        VolumeImporter::Settings rawSettings = {.m_origin = {-320, -68, -144}};
+        rawSettings.m_mapper = [](const uint8_t value, const uint32_t) {
+            return value == 0 ? BlockTypes::eAir : value < 60 ? BlockTypes::eDirt : BlockTypes::eGrass;
+        };
+
+        start = std::chrono::high_resolution_clock::now();
+        const VolumeImporter::Result voxResult = VolumeImporter::ImportVox(world, voxPath, voxSettings, nullptr);
+        end = std::chrono::high_resolution_clock::now();
+        const auto voxTime = end - start;
+        start = std::chrono::high_resolution_clock::now();
+        const VolumeImporter::Result rawResult = VolumeImporter::ImportRaw(world, rawPath, rawSize, rawSettings, nullptr);
+        end = std::chrono::high_resolution_clock::now();
+        const auto rawTime = end - start;
+        start = std::chrono::high_resolution_clock::now();
+        const uint64_t blocks = VolumeImporter::ImportVoxNaive(reference, voxPath, voxSettings) + VolumeImporter::ImportRawNaive(reference, rawPath, rawSize, rawSettings);
+        end = std::chrono::high_resolution_clock::now();
+
+        // The models shade the terrain around them, chunks they weren't written to included.
+        bool correct = world.GetChunks().Size() == 64 && reference.GetChunks().Size() == 64 && CountMismatches(world, reference) == 0;
+        world.GetLight().Update();
+        const std::vector<uint8_t> relit = GetLightLevels(world);
+        world.GetLight().Relight();
+        correct &= relit == GetLightLevels(world);
+
+        // Every voxel that wasn't set is counted as dropped.
+        uint64_t modelBlocks = std::count_if(raw.begin(), raw.end(), [](const uint8_t value) {
+            return value != 0;
+        });
+        for (int32_t x = 0; x < 200; x++) {
+            for (int32_t y = 0; y < 180; y++) {
+                for (int32_t z = 0; z < 150; z++)
+                    modelBlocks += (x * 7 + y * 13 + z * 5) % 11 < 4;
+            }
+        }
+        correct &= voxResult.m_dropped + rawResult.m_dropped == modelBlocks - blocks && voxResult.m_queued + rawResult.m_queued == 0;
+
+        // With a streamer, the parts outside of the resident chunks are laid over the generated blocks
+        // once the chunks are loaded, and saved with them.
+        World streamed, streamedReference;
+        GenerateChunks(streamed, glm::ivec3(0), glm::ivec3(1));
+        GenerateChunks(streamedReference, glm::ivec3(-1), glm::ivec3(2));
+        ChunkStreamer::Settings streamerSettings;
+        streamerSettings.m_loadRadius = 1;
+        streamerSettings.m_maxLoadsPerFrame = 1024;
+        streamerSettings.m_maxMillisPerFrame = INFINITY;
+        ChunkStreamer streamer = ChunkStreamer(streamed, streamerSettings);
+        const TerrainGenerator terrain = TerrainGenerator(TerrainGenerator::Settings());
+        streamer.SetGenerator([&](ChunkNode& node) {
+            terrain.Generate(node);
+        });
+        VolumeImporter::Settings smallSettings = voxSettings;
+        smallSettings.m_origin = {30, 10, 10};
+        smallSettings.m_model = 0;
+        const VolumeImporter::Result smallResult = VolumeImporter::ImportVox(streamed, voxPath, smallSettings, &streamer);
+        VolumeImporter::ImportVoxNaive(streamedReference, voxPath, smallSettings);
+        correct &= smallResult.m_written == 1 && smallResult.m_queued == 1 && smallResult.m_dropped == 0;
+        streamer.Update(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        const ChunkNode* overlaid = streamed.GetChunk({.m_x = 1, .m_y = 0, .m_z = 0});
+        correct &= overlaid != nullptr && overlaid->m_state != ChunkState::eEmpty && overlaid->m_modified && streamer.GetStats().m_pendingOverlays == 0;
+        correct &= streamed.GetChunks().Size() == 7 && CountMismatches(streamed, streamedReference) == 0;
+
+        // Models larger than 256 voxels on a side must be rejected.
+        const int32_t oversized = 300;
+        std::memcpy(vox.data() + sizeOffset, &oversized, sizeof(oversized));
+        file = std::fopen(voxPath.c_str(), "wb");
+        std::fwrite(vox.data(), 1, vox.size(), file);
+        std::fclose(file);
+        try {
+            VolumeImporter::ImportVox(world, voxPath, voxSettings, nullptr);
+            correct = false;
+        } catch (const std::runtime_error&) {}
+        std::filesystem::remove_all(directory);
+
+        if (!correct)
+            log.Warning("Imported chunks don't match setting the blocks one by one!");
+        else
+            log.Verbose("Imported ", blocks, " blocks into ", voxResult.m_written, " + ", rawResult.m_written, " chunks! Time taken for the vox model: ", voxTime, ", raw volume (", raw.size() >> 20, " MB): ", rawTime, ", naive: ", end - start);
+    }
+
     log.Println("\n-+-+-+-+-+-+-+ Testing transposition:");
 
     // ChunkBitmap xyz = xyzBitmap;
@@ -162,6 +2114,13 @@ static void Test() {
     xyz.TestOuterTransposes();
     xyz.TestInnerTransposes();
 
+    log.Println("\n-+-+-+-+-+-+-+ Fuzzing chunk kernels:");
+    start = std::chrono::high_resolution_clock::now();
+    if (!ChunkVerifier::Run(100, 200))
+        log.Warning("Chunk kernels failed verification!");
+    end = std::chrono::high_resolution_clock::now();
+    log.Verbose("Chunk kernel verification time taken: ", end - start);
+
     ChunkBitmap innerTestScalar = xyz.Copy();
     start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < 100000; i++)
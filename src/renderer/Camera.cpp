@@ -4,6 +4,8 @@
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/trigonometric.hpp>
 #include "util/display/Window.h"
+#include "world/Collision.h"
+#include "world/World.h"
 
 glm::mat4 Camera::sProjection;
 glm::mat4 Camera::sView;
@@ -16,6 +18,7 @@ float Camera::sPitch = 0.0f;
 float Camera::sSpeed = 0.03f;
 float Camera::sFOV = 60.0f;
 float Camera::sSensitivity = 0.01f;
+bool Camera::sCollide = true;
 
 void Camera::Update() {
     if (sSpeed < 0.0f)
@@ -61,32 +64,39 @@ void Camera::Update() {
         sTarget = glm::normalize(direction);
 
         const bool* keyStates = Window::GetKeyStates();
+        glm::vec3 motion = glm::vec3(0.0f, 0.0f, 0.0f);
 
         if (keyStates[SDL_SCANCODE_W]) {
-            sPosition.x += std::cos(glm::radians(sYaw)) * GetSpeed();
-            sPosition.z += std::sin(glm::radians(sYaw)) * GetSpeed();
+            motion.x += std::cos(glm::radians(sYaw)) * GetSpeed();
+            motion.z += std::sin(glm::radians(sYaw)) * GetSpeed();
         }
 
         if (keyStates[SDL_SCANCODE_S]) {
-            sPosition.x -= std::cos(glm::radians(sYaw)) * GetSpeed();
-            sPosition.z -= std::sin(glm::radians(sYaw)) * GetSpeed();
+            motion.x -= std::cos(glm::radians(sYaw)) * GetSpeed();
+            motion.z -= std::sin(glm::radians(sYaw)) * GetSpeed();
         }
 
         if (keyStates[SDL_SCANCODE_A]) {
-            sPosition.x -= std::cos(glm::radians(sYaw + 90)) * GetSpeed();
-            sPosition.z -= std::sin(glm::radians(sYaw + 90)) * GetSpeed();
+            motion.x -= std::cos(glm::radians(sYaw + 90)) * GetSpeed();
+            motion.z -= std::sin(glm::radians(sYaw + 90)) * GetSpeed();
         }
 
         if (keyStates[SDL_SCANCODE_D]) {
-            sPosition.x += std::cos(glm::radians(sYaw + 90)) * GetSpeed();
-            sPosition.z += std::sin(glm::radians(sYaw + 90)) * GetSpeed();
+            motion.x += std::cos(glm::radians(sYaw + 90)) * GetSpeed();
+            motion.z += std::sin(glm::radians(sYaw + 90)) * GetSpeed();
         }
 
         if (keyStates[SDL_SCANCODE_SPACE])
-            sPosition.y += GetSpeed();
+            motion.y += GetSpeed();
 
         if (keyStates[SDL_SCANCODE_LSHIFT])
-            sPosition.y -= GetSpeed();
+            motion.y -= GetSpeed();
+
+        if (sCollide) {
+            Collision::Box box = {.m_min = sPosition + sBoxMin, .m_max = sPosition + sBoxMax};
+            motion = Collision::Move(App::GetWorld(), box, motion);
+        }
+        sPosition += motion;
 
         sView = glm::lookAt(sPosition, sPosition + sTarget, sUp);
     }
@@ -114,5 +124,8 @@ void Camera::TickEvents() {
 
         if (Window::GetEvent()->key.key == SDLK_COMMA)
             sSensitivity -= 0.01f;
+
+        if (Window::GetEvent()->key.key == SDLK_N)
+            sCollide = !sCollide;
     }
 }
@@ -48,4 +48,9 @@ private:
     static float sSpeed;
     static float sFOV;
     static float sSensitivity;
+    static bool sCollide; // Whether movement stops at solid blocks, toggled with N.
+
+    // Collision box around the camera position, from the feet to just above the eyes.
+    static constexpr glm::vec3 sBoxMin = {-0.3f, -1.6f, -0.3f};
+    static constexpr glm::vec3 sBoxMax = {0.3f, 0.2f, 0.3f};
 };
@@ -0,0 +1,162 @@
+#include "renderer/FrustumCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ========== SIMD ==========
+
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+
+namespace HWY_NAMESPACE {
+namespace hw = hwy::HWY_NAMESPACE;
+
+uint32_t CullBoxesImpl(const std::array<const float*, 6>& bounds, const float* planes, const uint32_t count, uint32_t* visible) {
+    const hw::ScalableTag<float> f32Tag;
+    const hw::RebindToUnsigned<hw::ScalableTag<float>> u32Tag;
+    const uint32_t numLanes = hw::Lanes(f32Tag);
+
+    // The corner of a box furthest along a plane normal is picked per plane, not per box.
+    std::array<const float*, 18> corners;
+    for (uint32_t plane = 0; plane < 6; plane++) {
+        for (uint32_t axis = 0; axis < 3; axis++)
+            corners[plane * 3 + axis] = planes[plane * 4 + axis] >= 0.0f ? bounds[axis + 3] : bounds[axis];
+    }
+
+    const auto zero = hw::Zero(f32Tag);
+    uint32_t numVisible = 0;
+    for (uint32_t i = 0; i < count; i += numLanes) {
+        auto inside = hw::FirstN(f32Tag, count - i);
+
+        for (uint32_t plane = 0; plane < 6 && !hw::AllFalse(f32Tag, inside); plane++) {
+            const float* normal = planes + plane * 4;
+            auto distance = hw::Set(f32Tag, normal[3]);
+            distance = hw::MulAdd(hw::Set(f32Tag, normal[0]), hw::LoadU(f32Tag, corners[plane * 3] + i), distance);
+            distance = hw::MulAdd(hw::Set(f32Tag, normal[1]), hw::LoadU(f32Tag, corners[plane * 3 + 1] + i), distance);
+            distance = hw::MulAdd(hw::Set(f32Tag, normal[2]), hw::LoadU(f32Tag, corners[plane * 3 + 2] + i), distance);
+            inside = hw::And(inside, hw::Ge(distance, zero));
+        }
+
+        // Writes a full vector, the output is padded to allow it.
+        numVisible += hw::CompressStore(hw::Iota(u32Tag, i), hw::RebindMask(u32Tag, inside), u32Tag, visible + numVisible);
+    }
+
+    return numVisible;
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+// ========== SIMD Wrappers ==========
+
+#if HWY_ONCE
+
+void FrustumCuller::Cull(const Planes& planes, std::vector<uint32_t>& visible) const {
+    visible.resize(m_size + sPadding);
+
+    const std::array<const float*, 6> bounds = {m_minX.data(), m_minY.data(), m_minZ.data(), m_maxX.data(), m_maxY.data(), m_maxZ.data()};
+    const uint32_t numVisible = HWY_STATIC_DISPATCH(CullBoxesImpl)(bounds, &planes[0].x, m_size, visible.data());
+    visible.resize(numVisible);
+}
+
+// ========== Scalar ==========
+
+Logger FrustumCuller::sLogger = Logger("FrustumCuller");
+
+FrustumCuller::Planes FrustumCuller::ExtractPlanes(const glm::mat4& viewProjection) {
+    // Rows of the matrix, glm stores columns.
+    std::array<glm::vec4, 4> rows;
+    for (uint32_t row = 0; row < 4; row++)
+        rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+
+    Planes planes = {
+        rows[3] + rows[0], // Left
+        rows[3] - rows[0], // Right
+        rows[3] + rows[1], // Bottom
+        rows[3] - rows[1], // Top
+        rows[3] + rows[2], // Near
+        rows[3] - rows[2] // Far
+    };
+
+    for (glm::vec4& plane : planes) {
+        const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        plane = plane / length;
+    }
+
+    return planes;
+}
+
+uint32_t FrustumCuller::Insert(const glm::vec3& min, const glm::vec3& max) {
+    const uint32_t slot = m_size;
+    Reserve(m_size + 1);
+    m_size++;
+    Update(slot, min, max);
+    return slot;
+}
+
+uint32_t FrustumCuller::Remove(const uint32_t slot) {
+    const uint32_t last = --m_size;
+    if (slot == last)
+        return sInvalidSlot;
+
+    m_minX[slot] = m_minX[last];
+    m_minY[slot] = m_minY[last];
+    m_minZ[slot] = m_minZ[last];
+    m_maxX[slot] = m_maxX[last];
+    m_maxY[slot] = m_maxY[last];
+    m_maxZ[slot] = m_maxZ[last];
+    return last;
+}
+
+void FrustumCuller::Update(const uint32_t slot, const glm::vec3& min, const glm::vec3& max) {
+    m_minX[slot] = min.x;
+    m_minY[slot] = min.y;
+    m_minZ[slot] = min.z;
+    m_maxX[slot] = max.x;
+    m_maxY[slot] = max.y;
+    m_maxZ[slot] = max.z;
+}
+
+void FrustumCuller::Clear() {
+    m_size = 0;
+}
+
+void FrustumCuller::CullScalar(const Planes& planes, std::vector<uint32_t>& visible) const {
+    visible.clear();
+
+    for (uint32_t i = 0; i < m_size; i++) {
+        bool inside = true;
+        for (const glm::vec4& plane : planes) {
+            const float x = plane.x >= 0.0f ? m_maxX[i] : m_minX[i];
+            const float y = plane.y >= 0.0f ? m_maxY[i] : m_minY[i];
+            const float z = plane.z >= 0.0f ? m_maxZ[i] : m_minZ[i];
+            // Same order as the vectorized version so boxes touching a plane agree.
+            if (plane.w + plane.x * x + plane.y * y + plane.z * z < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+
+        if (inside)
+            visible.push_back(i);
+    }
+}
+
+void FrustumCuller::Reserve(const uint32_t size) {
+    const uint32_t padded = (size + sPadding - 1) / sPadding * sPadding;
+    if (padded <= m_minX.size())
+        return;
+
+    // Grow geometrically, the padding past the size is never part of a result.
+    const uint32_t capacity = std::max(padded, static_cast<uint32_t>(m_minX.size()) * 2);
+    m_minX.resize(capacity);
+    m_minY.resize(capacity);
+    m_minZ.resize(capacity);
+    m_maxX.resize(capacity);
+    m_maxY.resize(capacity);
+    m_maxZ.resize(capacity);
+}
+
+#endif
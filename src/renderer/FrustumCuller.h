@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "util/Logger.h"
+
+// Frustum culling of axis aligned boxes. Boxes are stored as separate arrays per coordinate so
+// that every vector instruction tests a full register of boxes against one plane. The culled
+// result is a compact list of the slots of the visible boxes.
+class FrustumCuller final {
+public:
+    // Plane as (normal, distance), with the normal pointing into the frustum.
+    using Planes = std::array<glm::vec4, 6>;
+
+    static constexpr uint32_t sInvalidSlot = ~0u;
+
+    // Extracts the normalized frustum planes from a projection * view matrix (Gribb & Hartmann).
+    // Expects glm's default clip space with depth in [-1, 1].
+    static Planes ExtractPlanes(const glm::mat4& viewProjection);
+
+    // Adds a box and returns its slot.
+    uint32_t Insert(const glm::vec3& min, const glm::vec3& max);
+
+    // Removes a box by moving the last box into its slot. Returns the old slot of the moved box,
+    // or sInvalidSlot if the removed box was the last one.
+    uint32_t Remove(const uint32_t slot);
+
+    void Update(const uint32_t slot, const glm::vec3& min, const glm::vec3& max);
+
+    void Clear();
+
+    // Writes the slots of every box that is at least partially inside the frustum, in slot order.
+    void Cull(const Planes& planes, std::vector<uint32_t>& visible) const;
+
+    // Scalar reference of Cull().
+    void CullScalar(const Planes& planes, std::vector<uint32_t>& visible) const;
+
+    VXL_INLINE uint32_t Size() const noexcept {
+        return m_size;
+    }
+private:
+    static Logger sLogger;
+
+    // Arrays are padded to a multiple of this so full vectors can always be loaded.
+    static constexpr uint32_t sPadding = 16;
+
+    void Reserve(const uint32_t size);
+
+    uint32_t m_size = 0;
+    std::vector<float> m_minX, m_minY, m_minZ;
+    std::vector<float> m_maxX, m_maxY, m_maxZ;
+};
@@ -0,0 +1,388 @@
+#include "renderer/OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <unordered_set>
+#include "util/JobSystem.h"
+#include "world/ChunkNode.h"
+
+// ========== SIMD ==========
+
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+
+namespace HWY_NAMESPACE {
+namespace hw = hwy::HWY_NAMESPACE;
+
+void OcclusionRasterizeTileImpl(float* depth, const uint32_t width, const OcclusionCuller::Occluder* occluders, const uint32_t* indices, const uint32_t count, const int32_t tileX, const int32_t tileY) {
+    const hw::CappedTag<float, 16> f32Tag;
+    const int32_t numLanes = static_cast<int32_t>(hw::Lanes(f32Tag));
+    const int32_t tileEndX = tileX + static_cast<int32_t>(OcclusionCuller::sTileSize);
+    const int32_t tileEndY = tileY + static_cast<int32_t>(OcclusionCuller::sTileSize);
+    const auto half = hw::Set(f32Tag, 0.5f);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const OcclusionCuller::Occluder& occluder = occluders[indices[i]];
+        const int32_t minY = std::max(occluder.m_minY, tileY);
+        const int32_t maxY = std::min(occluder.m_maxY, tileEndY - 1);
+        const int32_t maxX = std::min(occluder.m_maxX, tileEndX - 1);
+        // Vectors start on lane aligned columns of the tile.
+        const int32_t minX = tileX + (std::max(occluder.m_minX, tileX) - tileX) / numLanes * numLanes;
+
+        const auto occluderDepth = hw::Set(f32Tag, occluder.m_depth);
+        const auto a0 = hw::Set(f32Tag, occluder.m_a[0]);
+        const auto a1 = hw::Set(f32Tag, occluder.m_a[1]);
+        const auto a2 = hw::Set(f32Tag, occluder.m_a[2]);
+        const auto a3 = hw::Set(f32Tag, occluder.m_a[3]);
+
+        for (int32_t y = minY; y <= maxY; y++) {
+            const float centerY = static_cast<float>(y) + 0.5f;
+            const auto threshold0 = hw::Set(f32Tag, occluder.RowThreshold(0, centerY));
+            const auto threshold1 = hw::Set(f32Tag, occluder.RowThreshold(1, centerY));
+            const auto threshold2 = hw::Set(f32Tag, occluder.RowThreshold(2, centerY));
+            const auto threshold3 = hw::Set(f32Tag, occluder.RowThreshold(3, centerY));
+            float* row = depth + y * width;
+
+            for (int32_t x = minX; x <= maxX; x += numLanes) {
+                const auto centerX = hw::Add(hw::Iota(f32Tag, x), half);
+                // Never writes past the tile, another worker may be drawing the next one.
+                auto covered = hw::FirstN(f32Tag, tileEndX - x);
+                covered = hw::And(covered, hw::Ge(hw::Mul(a0, centerX), threshold0));
+                covered = hw::And(covered, hw::Ge(hw::Mul(a1, centerX), threshold1));
+                covered = hw::And(covered, hw::Ge(hw::Mul(a2, centerX), threshold2));
+                covered = hw::And(covered, hw::Ge(hw::Mul(a3, centerX), threshold3));
+                if (hw::AllFalse(f32Tag, covered))
+                    continue;
+
+                const auto old = hw::LoadU(f32Tag, row + x);
+                hw::BlendedStore(hw::Min(old, occluderDepth), covered, f32Tag, row + x);
+            }
+        }
+    }
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+// ========== SIMD Wrappers ==========
+
+#if HWY_ONCE
+
+void OcclusionCuller::Render() {
+    AddChunkFaces();
+    for (std::vector<uint32_t>& bin : m_bins)
+        bin.clear();
+
+    const int32_t tileSize = static_cast<int32_t>(sTileSize);
+    for (uint32_t i = 0; i < m_occluders.size(); i++) {
+        const Occluder& occluder = m_occluders[i];
+        for (int32_t tileY = occluder.m_minY / tileSize; tileY <= occluder.m_maxY / tileSize; tileY++) {
+            for (int32_t tileX = occluder.m_minX / tileSize; tileX <= occluder.m_maxX / tileSize; tileX++)
+                m_bins[tileY * m_tilesX + tileX].push_back(i);
+        }
+    }
+
+    // Every tile clears and draws only its own pixels, so tiles need no synchronization.
+    float* depth = m_levels[0].data();
+    JobSystem::ParallelFor(m_tilesX * m_tilesY, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t tile = begin; tile < end; tile++) {
+            const uint32_t tileX = tile % m_tilesX * sTileSize;
+            const uint32_t tileY = tile / m_tilesX * sTileSize;
+            for (uint32_t y = tileY; y < tileY + sTileSize; y++)
+                std::fill_n(depth + y * m_width + tileX, sTileSize, INFINITY);
+
+            const std::vector<uint32_t>& bin = m_bins[tile];
+            HWY_STATIC_DISPATCH(OcclusionRasterizeTileImpl)(depth, m_width, m_occluders.data(), bin.data(), static_cast<uint32_t>(bin.size()), tileX, tileY);
+        }
+    });
+
+    BuildHiZ();
+}
+
+// ========== Scalar ==========
+
+Logger OcclusionCuller::sLogger = Logger("OcclusionCuller");
+
+OcclusionCuller::OcclusionCuller(const uint32_t width, const uint32_t height) : m_width(width), m_height(height) {
+    if (width == 0 || height == 0 || width % sTileSize != 0 || height % sTileSize != 0)
+        throw sLogger.RuntimeError("Occlusion buffer size must be a non-zero multiple of ", sTileSize, "!");
+
+    m_tilesX = width / sTileSize;
+    m_tilesY = height / sTileSize;
+    m_bins.resize(m_tilesX * m_tilesY);
+
+    glm::uvec2 size = glm::uvec2(width, height);
+    m_levelSizes.push_back(size);
+    while (size.x > 1 || size.y > 1) {
+        size = glm::uvec2((size.x + 1) / 2, (size.y + 1) / 2);
+        m_levelSizes.push_back(size);
+    }
+
+    m_levels.resize(m_levelSizes.size());
+    for (size_t level = 0; level < m_levels.size(); level++)
+        m_levels[level].assign(m_levelSizes[level].x * m_levelSizes[level].y, INFINITY);
+}
+
+void OcclusionCuller::Begin(const glm::mat4& viewProjection) {
+    m_viewProjection = viewProjection;
+    m_faces.clear();
+    m_occluders.clear();
+}
+
+void OcclusionCuller::AddQuad(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3) {
+    const std::array<glm::vec3, 4> screen = {Project(v0), Project(v1), Project(v2), Project(v3)};
+
+    // Clipping against the near plane is skipped, dropping an occluder is always safe.
+    Occluder occluder;
+    occluder.m_depth = 0.0f;
+    glm::vec2 min = glm::vec2(INFINITY, INFINITY);
+    glm::vec2 max = glm::vec2(-INFINITY, -INFINITY);
+    float area = 0.0f;
+    for (uint32_t i = 0; i < 4; i++) {
+        const glm::vec3& point = screen[i];
+        if (!(point.z >= sMinDepth))
+            return;
+
+        occluder.m_depth = std::max(occluder.m_depth, point.z);
+        min = glm::vec2(std::min(min.x, point.x), std::min(min.y, point.y));
+        max = glm::vec2(std::max(max.x, point.x), std::max(max.y, point.y));
+        area += point.x * screen[(i + 1) & 3].y - screen[(i + 1) & 3].x * point.y;
+    }
+
+    if (!std::isfinite(area) || area == 0.0f)
+        return;
+
+    occluder.m_minX = static_cast<int32_t>(std::clamp(std::floor(min.x), 0.0f, static_cast<float>(m_width)));
+    occluder.m_minY = static_cast<int32_t>(std::clamp(std::floor(min.y), 0.0f, static_cast<float>(m_height)));
+    occluder.m_maxX = static_cast<int32_t>(std::clamp(std::ceil(max.x), 0.0f, static_cast<float>(m_width))) - 1;
+    occluder.m_maxY = static_cast<int32_t>(std::clamp(std::ceil(max.y), 0.0f, static_cast<float>(m_height))) - 1;
+    if (occluder.m_minX > occluder.m_maxX || occluder.m_minY > occluder.m_maxY)
+        return;
+
+    // Edge functions with the inside positive for either winding. Each edge is moved inwards by half
+    // a pixel along both axes, so a pixel's center only passes if the whole pixel is inside and the
+    // occluder never hides more than it covers.
+    const float sign = area > 0.0f ? 1.0f : -1.0f;
+    for (uint32_t i = 0; i < 4; i++) {
+        const glm::vec3& from = screen[i];
+        const glm::vec3& to = screen[(i + 1) & 3];
+        const float a = (from.y - to.y) * sign;
+        const float b = (to.x - from.x) * sign;
+        occluder.m_a[i] = a;
+        occluder.m_b[i] = b;
+        occluder.m_c[i] = -(a * from.x + b * from.y) - 0.5f * (std::abs(a) + std::abs(b));
+    }
+
+    m_occluders.push_back(occluder);
+}
+
+void OcclusionCuller::AddChunkOccluders(const ChunkNode& node) {
+    if (node.m_fullFaces == 0)
+        return;
+
+    const std::array<int32_t, 3> pos = {node.m_pos.m_x, node.m_pos.m_y, node.m_pos.m_z};
+    for (const Direction face : Directions::sAll) {
+        if (((node.m_fullFaces >> face) & 1) == 0)
+            continue;
+
+        const uint8_t axis = Directions::Axis(face);
+        const int32_t plane = pos[axis] + (Directions::IsPositive(face) ? 1 : 0);
+        m_faces.push_back({
+            .m_plane = (static_cast<uint64_t>(face) << 32) | static_cast<uint32_t>(plane),
+            .m_u = pos[(axis + 1) % 3],
+            .m_v = pos[(axis + 2) % 3]
+        });
+    }
+}
+
+void OcclusionCuller::AddChunkFaces() {
+    std::sort(m_faces.begin(), m_faces.end(), [](const ChunkFace& a, const ChunkFace& b) {
+        return std::tie(a.m_plane, a.m_v, a.m_u) < std::tie(b.m_plane, b.m_v, b.m_u);
+    });
+
+    const auto key = [](const int32_t u, const int32_t v) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(u)) << 32) | static_cast<uint32_t>(v);
+    };
+    std::unordered_set<uint64_t> remaining;
+    for (size_t first = 0; first < m_faces.size();) {
+        size_t last = first;
+        remaining.clear();
+        for (; last < m_faces.size() && m_faces[last].m_plane == m_faces[first].m_plane; last++)
+            remaining.insert(key(m_faces[last].m_u, m_faces[last].m_v));
+
+        // Every side not yet merged starts a rectangle, growing along u first, then along v while
+        // the whole row is there.
+        const Direction face = static_cast<Direction>(m_faces[first].m_plane >> 32);
+        const float plane = static_cast<float>(static_cast<int32_t>(m_faces[first].m_plane)) * 32.0f;
+        const uint8_t axis = Directions::Axis(face);
+        const uint8_t u = (axis + 1) % 3;
+        const uint8_t v = (axis + 2) % 3;
+        for (size_t i = first; i < last; i++) {
+            const int32_t startU = m_faces[i].m_u, startV = m_faces[i].m_v;
+            if (!remaining.contains(key(startU, startV)))
+                continue;
+
+            int32_t endU = startU + 1;
+            while (remaining.contains(key(endU, startV)))
+                endU++;
+
+            int32_t endV = startV + 1;
+            for (bool full = true; full; endV += full) {
+                for (int32_t cu = startU; cu < endU && full; cu++)
+                    full = remaining.contains(key(cu, endV));
+            }
+
+            for (int32_t cv = startV; cv < endV; cv++) {
+                for (int32_t cu = startU; cu < endU; cu++)
+                    remaining.erase(key(cu, cv));
+            }
+
+            std::array<glm::vec3, 4> corners;
+            for (glm::vec3& corner : corners)
+                corner[axis] = plane;
+            corners[0][u] = corners[3][u] = static_cast<float>(startU) * 32.0f;
+            corners[1][u] = corners[2][u] = static_cast<float>(endU) * 32.0f;
+            corners[0][v] = corners[1][v] = static_cast<float>(startV) * 32.0f;
+            corners[2][v] = corners[3][v] = static_cast<float>(endV) * 32.0f;
+            AddQuad(corners[0], corners[1], corners[2], corners[3]);
+        }
+
+        first = last;
+    }
+
+    m_faces.clear();
+}
+
+void OcclusionCuller::RenderScalar() {
+    AddChunkFaces();
+    std::vector<float>& depth = m_levels[0];
+    std::fill(depth.begin(), depth.end(), INFINITY);
+
+    for (const Occluder& occluder : m_occluders) {
+        for (int32_t y = occluder.m_minY; y <= occluder.m_maxY; y++) {
+            const float centerY = static_cast<float>(y) + 0.5f;
+            std::array<float, 4> thresholds;
+            for (uint32_t edge = 0; edge < 4; edge++)
+                thresholds[edge] = occluder.RowThreshold(edge, centerY);
+
+            for (int32_t x = occluder.m_minX; x <= occluder.m_maxX; x++) {
+                const float centerX = static_cast<float>(x) + 0.5f;
+                bool covered = true;
+                for (uint32_t edge = 0; edge < 4; edge++)
+                    covered &= occluder.m_a[edge] * centerX >= thresholds[edge];
+
+                if (covered)
+                    depth[y * m_width + x] = std::min(depth[y * m_width + x], occluder.m_depth);
+            }
+        }
+    }
+
+    BuildHiZ();
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3& min, const glm::vec3& max) const {
+    glm::vec2 screenMin = glm::vec2(INFINITY, INFINITY);
+    glm::vec2 screenMax = glm::vec2(-INFINITY, -INFINITY);
+    float nearest = INFINITY;
+    for (uint32_t i = 0; i < 8; i++) {
+        const glm::vec3 corner = glm::vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+        const glm::vec3 point = Project(corner);
+        if (!(point.z >= sMinDepth))
+            return true;
+
+        nearest = std::min(nearest, point.z);
+        screenMin = glm::vec2(std::min(screenMin.x, point.x), std::min(screenMin.y, point.y));
+        screenMax = glm::vec2(std::max(screenMax.x, point.x), std::max(screenMax.y, point.y));
+    }
+
+    const float width = static_cast<float>(m_width);
+    const float height = static_cast<float>(m_height);
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= width || screenMin.y >= height)
+        return false;
+
+    const int32_t minX = static_cast<int32_t>(std::floor(std::max(screenMin.x, 0.0f)));
+    const int32_t minY = static_cast<int32_t>(std::floor(std::max(screenMin.y, 0.0f)));
+    const int32_t maxX = static_cast<int32_t>(std::floor(std::min(screenMax.x, width - 1.0f)));
+    const int32_t maxY = static_cast<int32_t>(std::floor(std::min(screenMax.y, height - 1.0f)));
+
+    // Starts at the coarsest level that covers the box with at most 4x4 texels.
+    uint32_t level = 0;
+    while (level + 1 < m_levels.size() && ((maxX >> level) - (minX >> level) > 3 || (maxY >> level) - (minY >> level) > 3))
+        level++;
+
+    const glm::ivec4 bounds = glm::ivec4(minX, minY, maxX, maxY);
+    for (int32_t y = minY >> level; y <= maxY >> level; y++) {
+        for (int32_t x = minX >> level; x <= maxX >> level; x++) {
+            if (IsTexelVisible(level, x, y, bounds, nearest))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::Cull(std::vector<ChunkNode*>& chunks) const {
+    std::erase_if(chunks, [&](const ChunkNode* node) {
+        const glm::vec3 min = glm::vec3(node->m_pos.m_x * 32.0f, node->m_pos.m_y * 32.0f, node->m_pos.m_z * 32.0f);
+        return !IsVisible(min, min + glm::vec3(32.0f, 32.0f, 32.0f));
+    });
+}
+
+glm::vec3 OcclusionCuller::Project(const glm::vec3& point) const {
+    const glm::vec4 clip = m_viewProjection * glm::vec4(point, 1.0f);
+    return glm::vec3(
+        (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(m_width),
+        (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float>(m_height),
+        clip.w
+    );
+}
+
+bool OcclusionCuller::IsTexelVisible(const uint32_t level, const int32_t x, const int32_t y, const glm::ivec4& bounds, const float nearest) const {
+    if (m_levels[level][y * m_levelSizes[level].x + x] < nearest)
+        return false;
+    if (level == 0)
+        return true;
+
+    // Something farther than the box may show through, look at the texels below that overlap it.
+    const uint32_t child = level - 1;
+    const int32_t minX = std::max(x * 2, bounds.x >> child);
+    const int32_t minY = std::max(y * 2, bounds.y >> child);
+    const int32_t maxX = std::min({x * 2 + 1, bounds.z >> child, static_cast<int32_t>(m_levelSizes[child].x) - 1});
+    const int32_t maxY = std::min({y * 2 + 1, bounds.w >> child, static_cast<int32_t>(m_levelSizes[child].y) - 1});
+    for (int32_t childY = minY; childY <= maxY; childY++) {
+        for (int32_t childX = minX; childX <= maxX; childX++) {
+            if (IsTexelVisible(child, childX, childY, bounds, nearest))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::BuildHiZ() {
+    for (size_t level = 1; level < m_levels.size(); level++) {
+        const std::vector<float>& source = m_levels[level - 1];
+        const glm::uvec2 sourceSize = m_levelSizes[level - 1];
+        const glm::uvec2 size = m_levelSizes[level];
+        std::vector<float>& destination = m_levels[level];
+
+        for (uint32_t y = 0; y < size.y; y++) {
+            // Odd sizes repeat the last row or column of the source.
+            const uint32_t y0 = y * 2;
+            const uint32_t y1 = std::min(y0 + 1, sourceSize.y - 1);
+            for (uint32_t x = 0; x < size.x; x++) {
+                const uint32_t x0 = x * 2;
+                const uint32_t x1 = std::min(x0 + 1, sourceSize.x - 1);
+                destination[y * size.x + x] = std::max(
+                    std::max(source[y0 * sourceSize.x + x0], source[y0 * sourceSize.x + x1]),
+                    std::max(source[y1 * sourceSize.x + x0], source[y1 * sourceSize.x + x1])
+                );
+            }
+        }
+    }
+}
+
+#endif
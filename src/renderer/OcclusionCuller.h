@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "util/Logger.h"
+
+struct ChunkNode;
+
+// Software occlusion culling on the CPU. Occluders are convex quads rasterized into a low
+// resolution buffer of view depths, split into tiles that are drawn in parallel. Occluders are
+// conservative: only entirely solid chunk sides are drawn, only pixels a quad fully covers are
+// written, and every quad writes its farthest depth. Boxes are then tested against a max depth
+// pyramid (Hi-Z) built from that buffer, refining into finer levels only where a coarse texel can't
+// reject the box.
+class OcclusionCuller final {
+public:
+    // A quad in screen space, ready to rasterize. A pixel is covered if a * (x + 0.5) >= the
+    // threshold of every edge, where the threshold of a row is -(b * (y + 0.5) + c). The edges are
+    // already shrunk by half a pixel, so only pixels entirely inside the quad are covered.
+    struct Occluder {
+        std::array<float, 4> m_a, m_b, m_c;
+        float m_depth; // Farthest view depth of the quad.
+        int32_t m_minX, m_minY, m_maxX, m_maxY; // Inclusive pixel bounds, clamped to the buffer.
+
+        // Shared by every rasterizer so they agree exactly on which pixels are covered.
+        VXL_INLINE float RowThreshold(const uint32_t edge, const float centerY) const noexcept {
+            return -(m_b[edge] * centerY + m_c[edge]);
+        }
+    };
+
+    static constexpr uint32_t sTileSize = 32;
+
+    // Width and height must be multiples of the tile size.
+    OcclusionCuller(const uint32_t width = 320, const uint32_t height = 192);
+
+    // Clears the occluders for a new frame.
+    void Begin(const glm::mat4& viewProjection);
+
+    // Adds a planar convex quad with its corners in order. Quads crossing the near plane are skipped.
+    void AddQuad(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3);
+
+    // Adds the entirely solid sides of the chunk. Sides in the same plane are merged into larger
+    // quads before rendering, since the pixels along an edge two quads share aren't fully covered by
+    // either of them.
+    void AddChunkOccluders(const ChunkNode& node);
+
+    // Clears the depth buffer and rasterizes the occluders tile by tile across the job system, then
+    // builds the Hi-Z pyramid.
+    void Render();
+
+    // Scalar reference of Render(), drawing every occluder pixel by pixel on the calling thread.
+    void RenderScalar();
+
+    // Whether any part of the box may be visible. Boxes crossing the near plane are always visible.
+    bool IsVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+    // Removes the chunks hidden behind the occluders, keeping the order of the rest.
+    void Cull(std::vector<ChunkNode*>& chunks) const;
+
+    VXL_INLINE float GetDepth(const uint32_t x, const uint32_t y) const noexcept {
+        return m_levels[0][y * m_width + x];
+    }
+
+    VXL_INLINE uint32_t GetWidth() const noexcept {
+        return m_width;
+    }
+
+    VXL_INLINE uint32_t GetHeight() const noexcept {
+        return m_height;
+    }
+
+    VXL_INLINE uint32_t GetOccluderCount() const noexcept {
+        return static_cast<uint32_t>(m_occluders.size());
+    }
+private:
+    static Logger sLogger;
+
+    // View depth below which points count as crossing the near plane.
+    static constexpr float sMinDepth = 1e-3f;
+
+    // Projects a point to (screen x, screen y, view depth).
+    glm::vec3 Project(const glm::vec3& point) const;
+
+    // Whether the box may show through the texel, descending into finer levels until it is either
+    // entirely behind the stored depths or a single pixel lets it through.
+    bool IsTexelVisible(const uint32_t level, const int32_t x, const int32_t y, const glm::ivec4& bounds, const float nearest) const;
+
+    void BuildHiZ();
+
+    // Merges the chunk sides into rectangles greedily and adds them as quads.
+    void AddChunkFaces();
+
+    uint32_t m_width, m_height;
+    uint32_t m_tilesX, m_tilesY;
+    glm::mat4 m_viewProjection = glm::mat4(1.0f);
+
+    // An entirely solid chunk side waiting to be merged.
+    struct ChunkFace {
+        uint64_t m_plane; // Direction of the side and its coordinate along its axis, in chunks.
+        int32_t m_u, m_v; // Chunk coordinates along the other two axes.
+    };
+
+    std::vector<ChunkFace> m_faces;
+    std::vector<Occluder> m_occluders;
+    std::vector<std::vector<uint32_t>> m_bins; // Occluders overlapping every tile.
+
+    // Level 0 is the depth buffer, every further level holds the max of 2x2 texels of the previous.
+    std::vector<std::vector<float>> m_levels;
+    std::vector<glm::uvec2> m_levelSizes;
+};
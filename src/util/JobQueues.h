@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free work-stealing deque (Chase-Lev, with the memory orders from Le et al. 2013). Only the
+// owning thread may push and pop at the bottom, any thread may steal from the top.
+template<typename DataType, size_t Capacity>
+class WorkStealingDeque final {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+public:
+    VXL_INLINE WorkStealingDeque() = default;
+
+    // Pushes a value to the bottom. Returns false if the deque is full.
+    VXL_INLINE bool Push(DataType* value) {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<int64_t>(Capacity))
+            return false;
+
+        // Release so a thief that sees the new bottom also sees the value.
+        m_buffer[bottom & sMask].store(value, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops the most recently pushed value, or nullptr if the deque is empty.
+    VXL_INLINE DataType* Pop() {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        DataType* value = m_buffer[bottom & sMask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last value, race the thieves for it.
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                value = nullptr;
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return value;
+    }
+
+    // Steals the oldest value, or nullptr if the deque is empty or another thread won the race.
+    VXL_INLINE DataType* Steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return nullptr;
+
+        DataType* value = m_buffer[top & sMask].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return value;
+    }
+private:
+    static constexpr int64_t sMask = Capacity - 1;
+
+    alignas(64) std::atomic<int64_t> m_top = 0;
+    alignas(64) std::atomic<int64_t> m_bottom = 0;
+    alignas(64) std::array<std::atomic<DataType*>, Capacity> m_buffer{};
+};
+
+// Lock-free bounded multi-producer multi-consumer queue (Vyukov). Every cell carries a sequence
+// number that tells producers and consumers whose turn it is.
+template<typename DataType, size_t Capacity>
+class MPMCQueue final {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+public:
+    VXL_INLINE MPMCQueue() {
+        for (size_t i = 0; i < Capacity; i++)
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Pushes a value. Returns false if the queue is full.
+    VXL_INLINE bool Push(DataType* value) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & sMask];
+            const size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->m_value = value;
+        cell->m_sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops the oldest value, or nullptr if the queue is empty.
+    VXL_INLINE DataType* Pop() {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & sMask];
+            const size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        DataType* value = cell->m_value;
+        cell->m_sequence.store(pos + Capacity, std::memory_order_release);
+        return value;
+    }
+private:
+    static constexpr size_t sMask = Capacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> m_sequence;
+        DataType* m_value = nullptr;
+    };
+
+    alignas(64) std::atomic<size_t> m_enqueuePos = 0;
+    alignas(64) std::atomic<size_t> m_dequeuePos = 0;
+    alignas(64) std::array<Cell, Capacity> m_cells;
+};
@@ -0,0 +1,251 @@
+#include "util/JobSystem.h"
+
+#include <algorithm>
+
+// A node in the lock-free list of jobs waiting on another job.
+struct DependentNode {
+    JobSystem::Job* m_job;
+    DependentNode* m_next;
+};
+
+// Marks a dependent list as closed, new dependents of a finished job can run right away.
+static DependentNode sClosedList = {nullptr, nullptr};
+
+class JobSystem::Job final {
+public:
+    JobFunction m_function;
+    Job* m_parent = nullptr;
+    std::atomic<int32_t> m_unfinished = 1; // Itself plus every unfinished child.
+    std::atomic<int32_t> m_pendingDependencies = 1; // Unfinished dependencies, plus one until submitted.
+    std::atomic<int32_t> m_references = 2; // The handle given out, plus the system until the job finishes.
+    std::atomic<DependentNode*> m_dependents = nullptr;
+};
+
+Logger JobSystem::sLogger = Logger("JobSystem");
+std::vector<std::unique_ptr<JobSystem::Worker>> JobSystem::sWorkers;
+MPMCQueue<JobSystem::Job, JobSystem::sInjectionCapacity> JobSystem::sInjectionQueue;
+std::atomic<bool> JobSystem::sRunning = false;
+std::atomic<uint32_t> JobSystem::sEpoch = 0;
+std::atomic<uint32_t> JobSystem::sSleepers = 0;
+thread_local int32_t JobSystem::sWorkerIndex = -1;
+
+void JobSystem::Initialize(uint32_t workerCount) {
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+    sRunning.store(true, std::memory_order_release);
+
+    for (uint32_t i = 0; i < workerCount; i++)
+        sWorkers.push_back(std::make_unique<Worker>());
+
+    // The calling thread is worker 0 and doesn't get a thread of its own.
+    sWorkerIndex = 0;
+    for (uint32_t i = 1; i < workerCount; i++)
+        sWorkers[i]->m_thread = std::thread(WorkerLoop, static_cast<int32_t>(i));
+
+    sLogger.Info("Started job system with ", workerCount, " workers.");
+}
+
+void JobSystem::Destroy() {
+    sRunning.store(false, std::memory_order_release);
+    sEpoch.fetch_add(1, std::memory_order_seq_cst);
+    sEpoch.notify_all();
+
+    for (std::unique_ptr<Worker>& worker : sWorkers) {
+        if (worker->m_thread.joinable())
+            worker->m_thread.join();
+    }
+
+    sWorkers.clear();
+    sWorkerIndex = -1;
+}
+
+JobSystem::Job* JobSystem::Create(JobFunction function, Job* parent) {
+    Job* job = new Job();
+    job->m_function = std::move(function);
+    job->m_parent = parent;
+
+    if (parent != nullptr)
+        parent->m_unfinished.fetch_add(1, std::memory_order_relaxed);
+
+    return job;
+}
+
+void JobSystem::AddDependency(Job* job, Job* dependency) {
+    job->m_pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+
+    DependentNode* node = new DependentNode{job, nullptr};
+    DependentNode* head = dependency->m_dependents.load(std::memory_order_acquire);
+    do {
+        // The dependency already finished, so there is nothing to wait on.
+        if (head == &sClosedList) {
+            delete node;
+            job->m_pendingDependencies.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        node->m_next = head;
+    } while (!dependency->m_dependents.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_acquire));
+}
+
+JobSystem::Job* JobSystem::Continue(Job* job, JobFunction function) {
+    Job* continuation = Create(std::move(function));
+    AddDependency(continuation, job);
+    Submit(continuation);
+    return continuation;
+}
+
+void JobSystem::Submit(Job* job) {
+    if (job->m_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        Schedule(job);
+}
+
+void JobSystem::Wait(Job* job) {
+    while (!IsFinished(job)) {
+        Job* next = FindJob();
+        if (next != nullptr)
+            Execute(next);
+        else
+            std::this_thread::yield();
+    }
+
+    Release(job);
+}
+
+void JobSystem::Release(Job* job) {
+    if (job->m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete job;
+}
+
+bool JobSystem::IsFinished(const Job* job) {
+    return job->m_unfinished.load(std::memory_order_acquire) == 0;
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain, const RangeFunction& function) {
+    if (count == 0)
+        return;
+
+    grain = std::max(grain, 1u);
+    if (sWorkers.size() <= 1 || count <= grain) {
+        function(0, count);
+        return;
+    }
+
+    // The root only finishes once every range has, and the caller helps out while waiting.
+    Job* root = Create(nullptr);
+    for (uint32_t begin = 0; begin < count; begin += grain) {
+        const uint32_t end = std::min(begin + grain, count);
+        Job* range = Create([&function, begin, end]() { function(begin, end); }, root);
+        Submit(range);
+        Release(range);
+    }
+
+    Submit(root);
+    Wait(root);
+}
+
+void JobSystem::WorkerLoop(int32_t index) {
+    sWorkerIndex = index;
+    uint32_t spins = 0;
+
+    while (sRunning.load(std::memory_order_acquire)) {
+        const uint32_t epoch = sEpoch.load(std::memory_order_acquire);
+
+        Job* job = FindJob();
+        if (job != nullptr) {
+            Execute(job);
+            spins = 0;
+            continue;
+        }
+
+        if (++spins < sSpinsBeforeSleep) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Schedule() bumps the epoch before checking for sleepers, so either it sees this worker
+        // or the wait returns right away.
+        sSleepers.fetch_add(1, std::memory_order_seq_cst);
+        sEpoch.wait(epoch, std::memory_order_seq_cst);
+        sSleepers.fetch_sub(1, std::memory_order_seq_cst);
+        spins = 0;
+    }
+}
+
+void JobSystem::Schedule(Job* job) {
+    // Without workers everything runs inline.
+    if (sWorkers.empty()) {
+        Execute(job);
+        return;
+    }
+
+    bool queued = sWorkerIndex >= 0 && sWorkers[sWorkerIndex]->m_deque.Push(job);
+    if (!queued)
+        queued = sInjectionQueue.Push(job);
+
+    // Both queues are full, so the scheduling thread does the work itself.
+    if (!queued) {
+        Execute(job);
+        return;
+    }
+
+    sEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sSleepers.load(std::memory_order_seq_cst) > 0)
+        sEpoch.notify_one();
+}
+
+JobSystem::Job* JobSystem::FindJob() {
+    if (sWorkerIndex >= 0) {
+        Job* job = sWorkers[sWorkerIndex]->m_deque.Pop();
+        if (job != nullptr)
+            return job;
+    }
+
+    Job* job = sInjectionQueue.Pop();
+    if (job != nullptr)
+        return job;
+
+    // Start stealing at a different victim every time so the thieves spread out.
+    thread_local uint32_t victimSeed = static_cast<uint32_t>(sWorkerIndex + 1) * 0x9E3779B9u;
+    victimSeed = victimSeed * 1664525u + 1013904223u;
+
+    const uint32_t count = static_cast<uint32_t>(sWorkers.size());
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t victim = ((victimSeed >> 16) + i) % count;
+        if (static_cast<int32_t>(victim) == sWorkerIndex)
+            continue;
+
+        job = sWorkers[victim]->m_deque.Steal();
+        if (job != nullptr)
+            return job;
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Execute(Job* job) {
+    if (job->m_function)
+        job->m_function();
+
+    Finish(job);
+}
+
+void JobSystem::Finish(Job* job) {
+    if (job->m_unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    // Close the dependent list and schedule every job that was only waiting on this one.
+    DependentNode* node = job->m_dependents.exchange(&sClosedList, std::memory_order_acq_rel);
+    while (node != nullptr) {
+        DependentNode* next = node->m_next;
+        if (node->m_job->m_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Schedule(node->m_job);
+        delete node;
+        node = next;
+    }
+
+    Job* parent = job->m_parent;
+    Release(job);
+
+    if (parent != nullptr)
+        Finish(parent);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "util/JobQueues.h"
+#include "util/Logger.h"
+
+// Work-stealing job system. Every worker owns a lock-free deque it pushes to and pops from, idle
+// workers steal from the others, and threads outside the pool submit through a lock-free queue.
+// The thread that initializes the system becomes worker 0 and runs jobs while it waits on them.
+class JobSystem final {
+public:
+    class Job;
+    using JobFunction = std::function<void()>;
+    // Runs over the range [begin, end).
+    using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+    // Starts the worker threads. A worker count of 0 sizes the pool to the number of cores.
+    static void Initialize(uint32_t workerCount = 0);
+
+    // Stops and joins the worker threads. Jobs that haven't run yet are dropped.
+    static void Destroy();
+
+    // Creates a job that doesn't run until it is submitted. A parent only finishes once all of its
+    // children have, so children have to be created before the parent finishes. The returned
+    // handle has to be given back with Wait() or Release().
+    static Job* Create(JobFunction function, Job* parent = nullptr);
+
+    // Makes the job wait for the dependency to finish before it runs. Has to be called before
+    // the job is submitted.
+    static void AddDependency(Job* job, Job* dependency);
+
+    // Creates and submits a job that runs once the given job has finished.
+    static Job* Continue(Job* job, JobFunction function);
+
+    // Allows the job to run once its dependencies have finished.
+    static void Submit(Job* job);
+
+    // Runs other jobs until the given one has finished, then releases the handle.
+    static void Wait(Job* job);
+
+    // Gives back a job handle without waiting for it.
+    static void Release(Job* job);
+
+    static bool IsFinished(const Job* job);
+
+    // Creates, submits and releases a job in one go.
+    static VXL_INLINE void Run(JobFunction function) {
+        Job* job = Create(std::move(function));
+        Submit(job);
+        Release(job);
+    }
+
+    // Splits [0, count) into ranges of at most grain items, runs them across the workers and waits.
+    static void ParallelFor(uint32_t count, uint32_t grain, const RangeFunction& function);
+
+    // Number of threads running jobs, including the thread that initialized the system.
+    static VXL_INLINE uint32_t GetWorkerCount() noexcept {
+        return static_cast<uint32_t>(sWorkers.size());
+    }
+private:
+    static constexpr size_t sDequeCapacity = 4096;
+    static constexpr size_t sInjectionCapacity = 8192;
+    static constexpr uint32_t sSpinsBeforeSleep = 64;
+
+    struct Worker {
+        WorkStealingDeque<Job, sDequeCapacity> m_deque;
+        std::thread m_thread;
+    };
+
+    static Logger sLogger;
+    static std::vector<std::unique_ptr<Worker>> sWorkers;
+    static MPMCQueue<Job, sInjectionCapacity> sInjectionQueue;
+    static std::atomic<bool> sRunning;
+    static std::atomic<uint32_t> sEpoch; // Bumped on every schedule so sleeping workers notice new jobs.
+    static std::atomic<uint32_t> sSleepers;
+    static thread_local int32_t sWorkerIndex;
+
+    static void WorkerLoop(int32_t index);
+    static void Schedule(Job* job);
+    static Job* FindJob();
+    static void Execute(Job* job);
+    static void Finish(Job* job);
+};
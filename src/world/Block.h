@@ -5,5 +5,14 @@
 enum BlockTypes : uint16_t {
     eAir = 0,
     eDirt = 1,
-    eGrass = 2
+    eGrass = 2,
+    eStone = 3,
+    eLamp = 4,
+    eWater = 5,
+    eLava = 6
 };
+
+// Block light level a block emits, from 0 for none to 15.
+VXL_INLINE uint8_t GetBlockEmission(const uint16_t block) noexcept {
+    return block == BlockTypes::eLamp || block == BlockTypes::eLava ? 15 : 0;
+}
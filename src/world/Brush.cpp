@@ -0,0 +1,191 @@
+#include "world/Brush.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "util/JobSystem.h"
+#include "world/ChunkStreamer.h"
+#include "world/World.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+Logger Brush::sLogger = Logger("Brush");
+
+// Offset of a block's center from the center of the brush along an axis, normalized by the extent.
+static float GetOffset(const Brush::Settings& settings, const int32_t block, const uint32_t axis) {
+    return (static_cast<float>(block) + 0.5f - settings.m_center[axis]) / settings.m_extent[axis];
+}
+
+void Brush::GetBounds(const Settings& settings, glm::ivec3& min, glm::ivec3& max) {
+    // A block further out to cover rounding, the masks decide exactly.
+    for (uint32_t axis = 0; axis < 3; axis++) {
+        min[axis] = static_cast<int32_t>(std::floor(settings.m_center[axis] - settings.m_extent[axis] - 0.5f));
+        max[axis] = static_cast<int32_t>(std::ceil(settings.m_center[axis] + settings.m_extent[axis] - 0.5f));
+    }
+}
+
+bool Brush::BuildMask(const Settings& settings, const ChunkPos& pos, ChunkBitmap& mask) {
+    const int32_t baseX = pos.m_x * 32, baseY = pos.m_y * 32, baseZ = pos.m_z * 32;
+    const bool noisy = settings.m_shape == Shape::eNoise;
+    const Noise noise = Noise(settings.m_seed);
+    Noise::Row xs, ys, zs, values;
+    Noise::FillRow(zs, baseZ + 0.5f, 1.0f);
+
+    bool any = false;
+    for (int32_t x = 0; x < 32; x++) {
+        const float dx = GetOffset(settings, baseX + x, 0);
+        for (int32_t y = 0; y < 32; y++) {
+            const uint32_t index = (x << 5) | y;
+            const float limit = GetRowLimit(settings, dx, GetOffset(settings, baseY + y, 1));
+            mask[index] = 0;
+            if (limit < 0.0f)
+                continue;
+
+            // The extent along z from the limit, with its ends moved to where Contains() puts them
+            // in case rounding disagrees.
+            const auto inside = [&](const int32_t z) {
+                const float dz = GetOffset(settings, z, 2);
+                return dz * dz <= limit;
+            };
+            const float half = settings.m_extent.z * std::sqrt(limit);
+            int32_t first = static_cast<int32_t>(std::ceil(settings.m_center.z - 0.5f - half));
+            int32_t last = static_cast<int32_t>(std::floor(settings.m_center.z - 0.5f + half));
+            while (inside(first - 1))
+                first--;
+            while (first <= last && !inside(first))
+                first++;
+            while (inside(last + 1))
+                last++;
+            while (last >= first && !inside(last))
+                last--;
+
+            first = std::max(first, baseZ);
+            last = std::min(last, baseZ + 31);
+            if (first > last)
+                continue;
+
+            uint32_t row = (last - first == 31 ? ~0u : (1u << (last - first + 1)) - 1) << (first - baseZ);
+            if (noisy) {
+                Noise::FillRow(xs, baseX + x + 0.5f, 0.0f);
+                Noise::FillRow(ys, baseY + y + 0.5f, 0.0f);
+                noise.Fractal3D(settings.m_noise, xs, ys, zs, values);
+
+                uint32_t above = 0;
+                for (uint32_t z = 0; z < 32; z++)
+                    above |= static_cast<uint32_t>(values[z] > settings.m_threshold) << z;
+                row &= above;
+            }
+
+            mask[index] = row;
+            any |= row != 0;
+        }
+    }
+
+    return any;
+}
+
+uint32_t Brush::Apply(World& world, const Settings& settings, ChunkStreamer* streamer) {
+    if (settings.m_block >= 64)
+        throw sLogger.RuntimeError("Block ", settings.m_block, " doesn't fit a chunk's palette!");
+
+    glm::ivec3 min, max;
+    GetBounds(settings, min, max);
+    const ChunkPos first = ChunkPos::FromBlock(min.x, min.y, min.z);
+    const ChunkPos last = ChunkPos::FromBlock(max.x, max.y, max.z);
+
+    std::vector<ChunkNode*> nodes;
+    for (int32_t x = first.m_x; x <= last.m_x; x++) {
+        for (int32_t y = first.m_y; y <= last.m_y; y++) {
+            for (int32_t z = first.m_z; z <= last.m_z; z++) {
+                ChunkNode* node = world.GetChunk({.m_x = x, .m_y = y, .m_z = z});
+                if (node != nullptr && node->m_state != ChunkState::eEmpty)
+                    nodes.push_back(node);
+            }
+        }
+    }
+
+    std::vector<ChunkBitmap> masks(nodes.size());
+    std::vector<uint8_t> hit(nodes.size());
+    JobSystem::ParallelFor(static_cast<uint32_t>(nodes.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            hit[i] = BuildMask(settings, nodes[i]->m_pos, masks[i]);
+    });
+
+    std::vector<uint32_t> targets;
+    std::vector<ChunkNode*> written;
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        if (hit[i] && world.BeginBulkEdit(*nodes[i])) {
+            targets.push_back(i);
+            written.push_back(nodes[i]);
+        }
+    }
+
+    const uint8_t block = static_cast<uint8_t>(settings.m_block);
+    JobSystem::ParallelFor(static_cast<uint32_t>(targets.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            ChunkNode& node = *nodes[targets[i]];
+            const ChunkBitmap& mask = masks[targets[i]];
+            EightBitChunk& chunk = static_cast<EightBitChunk&>(*node.m_chunk);
+            chunk.FillMasked(mask, block);
+
+            // Only the block types the chunk held and the brush's own can be left.
+            std::array<uint16_t, 64> types;
+            size_t numTypes = 0;
+            for (uint16_t type = 0; type < 64; type++) {
+                if (chunk.m_blockPaletteCounts[type] != 0 || type == block)
+                    types[numTypes++] = type;
+            }
+            if (!chunk.RecountPalette(types.data(), numTypes))
+                chunk.RecountPalette();
+
+            for (uint32_t row = 0; row < 1024; row++)
+                node.m_solid[row] = block == BlockTypes::eAir ? node.m_solid[row] & ~mask[row] : node.m_solid[row] | mask[row];
+        }
+    });
+
+    world.EndBulkEdit(written, streamer);
+
+    return static_cast<uint32_t>(targets.size());
+}
+
+bool Brush::Contains(const Settings& settings, const int32_t x, const int32_t y, const int32_t z) {
+    const float limit = GetRowLimit(settings, GetOffset(settings, x, 0), GetOffset(settings, y, 1));
+    const float dz = GetOffset(settings, z, 2);
+    if (limit < 0.0f || dz * dz > limit)
+        return false;
+
+    return settings.m_shape != Shape::eNoise || Noise(settings.m_seed).FractalScalar3D(settings.m_noise, x + 0.5f, y + 0.5f, z + 0.5f) > settings.m_threshold;
+}
+
+uint64_t Brush::ApplyNaive(World& world, const Settings& settings) {
+    glm::ivec3 min, max;
+    GetBounds(settings, min, max);
+
+    uint64_t count = 0;
+    for (int32_t x = min.x; x <= max.x; x++) {
+        for (int32_t y = min.y; y <= max.y; y++) {
+            for (int32_t z = min.z; z <= max.z; z++) {
+                if (Contains(settings, x, y, z)) {
+                    world.SetBlock(settings.m_block, x, y, z);
+                    count++;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+float Brush::GetRowLimit(const Settings& settings, const float dx, const float dy) {
+    switch (settings.m_shape) {
+        case Shape::eSphere:
+        case Shape::eNoise:
+            return 1.0f - dx * dx - dy * dy;
+        case Shape::eBox:
+            return dx * dx <= 1.0f && dy * dy <= 1.0f ? 1.0f : -1.0f;
+        case Shape::eCylinder:
+            return dy * dy <= 1.0f ? 1.0f - dx * dx : -1.0f;
+    }
+
+    return -1.0f;
+}
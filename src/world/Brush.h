@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "util/Logger.h"
+#include "world/Block.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+#include "world/gen/Noise.h"
+
+class World;
+class ChunkStreamer;
+
+// Shaped edits across chunks. The shape is turned into a bitmap mask per chunk it overlaps, a z
+// row at a time from the row's analytic extent, and every chunk is then written in parallel with
+// masked vector stores. A block is inside the shape if the center of the block is.
+class Brush final {
+public:
+    enum class Shape : uint8_t {
+        eSphere = 0, // Ellipsoid with the extent as its radii.
+        eBox = 1, // Box with the extent as its half size.
+        eCylinder = 2, // Upright, the extent's x and z are its radii and y its half height.
+        eNoise = 3 // Ellipsoid filled where fractal noise is above the threshold.
+    };
+
+    struct Settings {
+        Shape m_shape = Shape::eSphere;
+        glm::vec3 m_center = {0.0f, 0.0f, 0.0f}; // In world coordinates.
+        glm::vec3 m_extent = {8.0f, 8.0f, 8.0f};
+        uint16_t m_block = BlockTypes::eStone; // Air to carve.
+        Noise::Fractal m_noise;
+        uint32_t m_seed = 0;
+        float m_threshold = 0.0f;
+    };
+
+    // Range of blocks the brush can touch, inclusive.
+    static void GetBounds(const Settings& settings, glm::ivec3& min, glm::ivec3& max);
+
+    // Builds the mask of the brush over a chunk in the xyz order. Returns false if it is empty.
+    static bool BuildMask(const Settings& settings, const ChunkPos& pos, ChunkBitmap& mask);
+
+    // Paints the brush into every resident chunk it overlaps, across the job system, and queues the
+    // changed chunks for remeshing on the streamer, which may be null. Returns the number of chunks
+    // that were written to. Throws if the block doesn't fit a chunk's palette.
+    static uint32_t Apply(World& world, const Settings& settings, ChunkStreamer* streamer);
+
+    // Whether the block at the world position is inside the brush.
+    static bool Contains(const Settings& settings, const int32_t x, const int32_t y, const int32_t z);
+
+    // Reference version that sets every block inside the brush through World::SetBlock. Noise is
+    // sampled with the scalar reference, so blocks right at the threshold may differ from Apply().
+    static uint64_t ApplyNaive(World& world, const Settings& settings);
+private:
+    static Logger sLogger;
+
+    // Largest squared normalized z offset a block in the row may have, negative if the row is
+    // outside the shape. Offsets are normalized by the extent.
+    static float GetRowLimit(const Settings& settings, const float dx, const float dy);
+};
@@ -0,0 +1,166 @@
+#include "world/ChunkMap.h"
+
+#include <algorithm>
+#include <bit>
+
+Logger ChunkMap::sLogger = Logger("ChunkMap");
+
+ChunkMap::ChunkMap() {
+    Rehash(sMinCapacity);
+}
+
+ChunkNode* ChunkMap::Insert(const ChunkPos& pos) {
+    ChunkNode* existing = Find(pos);
+    if (existing != nullptr)
+        return existing;
+
+    // Keep the load factor at or below one half so probe sequences stay short.
+    if ((m_size + 1) * 2 > m_keys.size())
+        Rehash(m_keys.size() * 2);
+
+    ChunkNode* node = AllocateNode();
+    node->m_pos = pos;
+
+    const uint64_t key = pos.Pack();
+    uint64_t slot = Hash(key) & m_mask;
+    while (m_keys[slot] != ChunkPos::sInvalidKey)
+        slot = (slot + 1) & m_mask;
+
+    m_keys[slot] = key;
+    m_nodes[slot] = node;
+    m_size++;
+
+    // Link the neighbors both ways so passes over the world never have to hash.
+    for (const Direction direction : Directions::sAll) {
+        ChunkNode* neighbor = Find(pos.Offset(direction));
+        node->m_neighbors[direction] = neighbor;
+        if (neighbor != nullptr)
+            neighbor->m_neighbors[Directions::Opposite(direction)] = node;
+    }
+
+    return node;
+}
+
+bool ChunkMap::Remove(const ChunkPos& pos) {
+    const uint64_t key = pos.Pack();
+    uint64_t slot = Hash(key) & m_mask;
+    while (m_keys[slot] != key) {
+        if (m_keys[slot] == ChunkPos::sInvalidKey)
+            return false;
+        slot = (slot + 1) & m_mask;
+    }
+
+    ChunkNode* node = m_nodes[slot];
+    for (const Direction direction : Directions::sAll) {
+        ChunkNode* neighbor = node->m_neighbors[direction];
+        if (neighbor != nullptr)
+            neighbor->m_neighbors[Directions::Opposite(direction)] = nullptr;
+    }
+    FreeNode(node);
+
+    // Backward shift deletion: pull later entries of the probe sequence into the hole as long as
+    // that doesn't move them in front of their home slot.
+    uint64_t hole = slot;
+    for (uint64_t next = (hole + 1) & m_mask; m_keys[next] != ChunkPos::sInvalidKey; next = (next + 1) & m_mask) {
+        const uint64_t home = Hash(m_keys[next]) & m_mask;
+        if (((next - home) & m_mask) >= ((next - hole) & m_mask)) {
+            m_keys[hole] = m_keys[next];
+            m_nodes[hole] = m_nodes[next];
+            hole = next;
+        }
+    }
+
+    m_keys[hole] = ChunkPos::sInvalidKey;
+    m_nodes[hole] = nullptr;
+    m_size--;
+
+    return true;
+}
+
+void ChunkMap::Clear() {
+    for (size_t slot = 0; slot < m_keys.size(); slot++) {
+        if (m_keys[slot] != ChunkPos::sInvalidKey)
+            FreeNode(m_nodes[slot]);
+    }
+
+    std::fill(m_keys.begin(), m_keys.end(), ChunkPos::sInvalidKey);
+    std::fill(m_nodes.begin(), m_nodes.end(), nullptr);
+    m_size = 0;
+}
+
+void ChunkMap::Reserve(size_t count) {
+    const size_t capacity = std::bit_ceil(std::max(count * 2, sMinCapacity));
+    if (capacity > m_keys.size())
+        Rehash(capacity);
+}
+
+bool ChunkMap::Verify() const {
+    size_t count = 0;
+    for (size_t slot = 0; slot < m_keys.size(); slot++) {
+        if (m_keys[slot] == ChunkPos::sInvalidKey)
+            continue;
+
+        const ChunkNode* node = m_nodes[slot];
+        count++;
+
+        if (Find(node->m_pos) != node) {
+            sLogger.Warning("Chunk node at slot ", slot, " can't be found through its key!");
+            return false;
+        }
+
+        for (const Direction direction : Directions::sAll) {
+            if (node->m_neighbors[direction] != Find(node->m_pos.Offset(direction))) {
+                sLogger.Warning("Chunk node at slot ", slot, " has a stale neighbor link!");
+                return false;
+            }
+        }
+    }
+
+    if (count != m_size) {
+        sLogger.Warning("Chunk map holds ", count, " nodes but reports ", m_size, "!");
+        return false;
+    }
+
+    return true;
+}
+
+void ChunkMap::Rehash(size_t capacity) {
+    std::vector<uint64_t> oldKeys = std::move(m_keys);
+    std::vector<ChunkNode*> oldNodes = std::move(m_nodes);
+
+    m_keys.assign(capacity, ChunkPos::sInvalidKey);
+    m_nodes.assign(capacity, nullptr);
+    m_mask = capacity - 1;
+
+    for (size_t i = 0; i < oldKeys.size(); i++) {
+        if (oldKeys[i] == ChunkPos::sInvalidKey)
+            continue;
+
+        uint64_t slot = Hash(oldKeys[i]) & m_mask;
+        while (m_keys[slot] != ChunkPos::sInvalidKey)
+            slot = (slot + 1) & m_mask;
+
+        m_keys[slot] = oldKeys[i];
+        m_nodes[slot] = oldNodes[i];
+    }
+}
+
+ChunkNode* ChunkMap::AllocateNode() {
+    if (m_freeNodes.empty()) {
+        m_nodeBlocks.push_back(std::make_unique<ChunkNode[]>(sNodesPerBlock));
+        ChunkNode* block = m_nodeBlocks.back().get();
+
+        // Push in reverse so nodes get handed out in address order.
+        for (size_t i = sNodesPerBlock; i > 0; i--)
+            m_freeNodes.push_back(block + i - 1);
+    }
+
+    ChunkNode* node = m_freeNodes.back();
+    m_freeNodes.pop_back();
+    return node;
+}
+
+void ChunkMap::FreeNode(ChunkNode* node) {
+    *node = ChunkNode();
+    m_freeNodes.push_back(node);
+}
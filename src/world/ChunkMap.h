@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkNode.h"
+#include "world/ChunkPos.h"
+
+// Flat open-addressing hash map from packed chunk positions to chunk nodes. Keys and nodes are
+// stored in separate arrays so that probing only touches the keys, and removal uses backward
+// shifting so the table never fills up with tombstones.
+class ChunkMap final {
+public:
+    ChunkMap();
+
+    ChunkMap(const ChunkMap&) = delete;
+    ChunkMap& operator=(const ChunkMap&) = delete;
+
+    // Finds the node at the given position, or nullptr if it isn't resident.
+    VXL_INLINE ChunkNode* Find(const ChunkPos& pos) const noexcept {
+        const uint64_t key = pos.Pack();
+        for (uint64_t slot = Hash(key) & m_mask;; slot = (slot + 1) & m_mask) {
+            if (m_keys[slot] == key)
+                return m_nodes[slot];
+            if (m_keys[slot] == ChunkPos::sInvalidKey)
+                return nullptr;
+        }
+    }
+
+    // Inserts an empty node at the given position and links it to its neighbors. Returns the
+    // existing node if there already is one.
+    ChunkNode* Insert(const ChunkPos& pos);
+
+    // Unlinks and removes the node at the given position. Returns false if it wasn't resident.
+    bool Remove(const ChunkPos& pos);
+
+    // Removes every node.
+    void Clear();
+
+    // Grows the table so the given number of nodes fit without rehashing.
+    void Reserve(size_t count);
+
+    // Checks that every node is reachable through the table and that its neighbor links match lookups.
+    bool Verify() const;
+
+    // Calls the function for every resident node.
+    template<typename Func>
+    VXL_INLINE void ForEach(Func&& func) const {
+        for (size_t slot = 0; slot < m_keys.size(); slot++) {
+            if (m_keys[slot] != ChunkPos::sInvalidKey)
+                func(*m_nodes[slot]);
+        }
+    }
+
+    VXL_INLINE size_t Size() const noexcept {
+        return m_size;
+    }
+
+    VXL_INLINE size_t Capacity() const noexcept {
+        return m_keys.size();
+    }
+private:
+    static Logger sLogger;
+
+    static constexpr size_t sMinCapacity = 64;
+    static constexpr size_t sNodesPerBlock = 256;
+
+    // Finalizer from MurmurHash3, spreads the packed axes over the whole key.
+    static VXL_INLINE uint64_t Hash(uint64_t key) noexcept {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDULL;
+        key ^= key >> 33;
+        key *= 0xC4CEB9FE1A85EC53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    void Rehash(size_t capacity);
+    ChunkNode* AllocateNode();
+    void FreeNode(ChunkNode* node);
+
+    std::vector<uint64_t> m_keys;
+    std::vector<ChunkNode*> m_nodes;
+    uint64_t m_mask = 0;
+    size_t m_size = 0;
+
+    // Nodes are allocated in blocks so they keep a stable address and stay close in memory.
+    std::vector<std::unique_ptr<ChunkNode[]>> m_nodeBlocks;
+    std::vector<ChunkNode*> m_freeNodes;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include "world/ChunkPos.h"
+#include "world/Direction.h"
+#include "world/chunk/ChunkBitmap.h"
+#include "world/chunk/ChunkConnectivity.h"
+#include "world/chunk/ChunkLight.h"
+#include "world/chunk/ChunkMesh.h"
+#include "world/chunk/IChunk.h"
+
+// Streaming state of a chunk node.
+enum class ChunkState : uint8_t {
+    eEmpty = 0, // Inserted, but the voxel data hasn't been loaded or generated yet.
+    eLoaded = 1, // Voxel data is ready.
+    eMeshed = 2 // Voxel data and mesh are ready.
+};
+
+// A chunk resident in the world along with cached links to its six neighbors. Nodes are owned by
+// the ChunkMap and never move in memory, so neighbor pointers stay valid until a node is removed.
+struct ChunkNode final {
+    ChunkPos m_pos;
+    std::shared_ptr<IChunk> m_chunk; // May be shared with chunks of the same blocks, see ChunkInterner.
+    std::vector<uint8_t> m_compressed; // Voxel data while m_chunk is dropped to save memory, see ChunkCodec.
+    std::array<ChunkNode*, 6> m_neighbors{};
+
+    // Non-air blocks in the xyz order, kept in sync with the chunk for queries like raycasts.
+    ChunkBitmap m_solid = ChunkBitmap(std::array<uint32_t, 1024>{});
+    uint8_t m_fullFaces = 0; // Sides of m_solid that are entirely solid, see ChunkBitmap::GetFullFaces.
+    // Faces connected through non-solid blocks. Everything counts as connected until computed.
+    ChunkConnectivity::Mask m_connectivity = ChunkConnectivity::sAll;
+    uint32_t m_visibleWalk = 0; // Last visibility walk that reached the chunk, see ChunkVisibility.
+    std::unique_ptr<ChunkLight> m_light; // Allocated once the LightEngine lit the chunk.
+
+    uint32_t m_cullSlot = ~0u; // Slot of the chunk's bounding box in the world's frustum culler.
+    uint32_t m_lastNeeded = 0; // Last frame the chunk was drawn or near the camera, see ChunkResidency.
+
+    ChunkState m_state = ChunkState::eEmpty;
+    bool m_meshDirty = false;
+    bool m_modified = false; // Blocks were set since the chunk was loaded or last saved.
+    // Stamped whenever the chunk is loaded or its blocks are set, for caches built from its blocks.
+    // Unique across the world, so a chunk that was unloaded and loaded again never matches.
+    uint64_t m_generation = 0;
+    bool m_reading = false; // A read of the chunk from storage is in flight, see ChunkIO.
+    ChunkMesh::Greedy m_mesh;
+
+    VXL_INLINE ChunkNode* GetNeighbor(const Direction direction) const noexcept {
+        return m_neighbors[direction];
+    }
+
+    VXL_INLINE bool IsCompressed() const noexcept {
+        return m_chunk == nullptr && !m_compressed.empty();
+    }
+};
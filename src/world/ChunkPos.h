@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include "world/Direction.h"
+
+// Position of a chunk in chunk coordinates. Packs into a 64-bit key with 21 bits per axis.
+struct ChunkPos final {
+    int32_t m_x = 0;
+    int32_t m_y = 0;
+    int32_t m_z = 0;
+
+    // Key that is never produced by Pack(), used to mark empty slots.
+    static constexpr uint64_t sInvalidKey = ~0ULL;
+
+    VXL_INLINE uint64_t Pack() const noexcept {
+        return ((static_cast<uint64_t>(m_x) & 0x1FFFFF) << 42)
+            | ((static_cast<uint64_t>(m_y) & 0x1FFFFF) << 21)
+            | (static_cast<uint64_t>(m_z) & 0x1FFFFF);
+    }
+
+    static VXL_INLINE ChunkPos Unpack(const uint64_t key) noexcept {
+        // Shift each axis to the top of the word and back down to sign extend it.
+        return {
+            .m_x = static_cast<int32_t>(static_cast<int64_t>(key << 1) >> 43),
+            .m_y = static_cast<int32_t>(static_cast<int64_t>(key << 22) >> 43),
+            .m_z = static_cast<int32_t>(static_cast<int64_t>(key << 43) >> 43)
+        };
+    }
+
+    // Gets the position of the chunk holding the given block.
+    static VXL_INLINE ChunkPos FromBlock(const int32_t x, const int32_t y, const int32_t z) noexcept {
+        return {.m_x = x >> 5, .m_y = y >> 5, .m_z = z >> 5};
+    }
+
+    VXL_INLINE ChunkPos Offset(const Direction direction) const noexcept {
+        return {
+            .m_x = m_x + Directions::Offset(direction, 0),
+            .m_y = m_y + Directions::Offset(direction, 1),
+            .m_z = m_z + Directions::Offset(direction, 2)
+        };
+    }
+
+    VXL_INLINE bool operator==(const ChunkPos& other) const noexcept {
+        return m_x == other.m_x && m_y == other.m_y && m_z == other.m_z;
+    }
+};
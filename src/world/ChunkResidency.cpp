@@ -0,0 +1,131 @@
+#include "world/ChunkResidency.h"
+
+#include <algorithm>
+#include <cmath>
+#include "world/ChunkStreamer.h"
+#include "world/World.h"
+
+Logger ChunkResidency::sLogger = Logger("ChunkResidency");
+
+void ChunkResidency::Touch(const std::vector<ChunkNode*>& chunks) {
+    for (ChunkNode* node : chunks)
+        Need(*node);
+}
+
+void ChunkResidency::Update(const glm::vec3& pos) {
+    m_stats = {};
+
+    const ChunkPos center = ChunkPos::FromBlock(std::floor(pos.x), std::floor(pos.y), std::floor(pos.z));
+    const int32_t radius = m_settings.m_pinRadius;
+    for (int32_t x = -radius; x <= radius; x++) {
+        for (int32_t y = -radius; y <= radius; y++) {
+            for (int32_t z = -radius; z <= radius; z++) {
+                ChunkNode* node = m_world.GetChunk({.m_x = center.m_x + x, .m_y = center.m_y + y, .m_z = center.m_z + z});
+                if (node != nullptr)
+                    Need(*node);
+            }
+        }
+    }
+
+    m_usage = {};
+    m_candidates.clear();
+    m_world.GetChunks().ForEach([&](ChunkNode& node) {
+        Measure(node, m_usage);
+        if (node.m_lastNeeded != m_frame && node.m_state != ChunkState::eEmpty)
+            m_candidates.push_back(&node);
+    });
+    m_usage.m_farField = m_world.GetFarField().GetMemoryUsage();
+
+    // Idle chunks read through the codec until they are edited or meshed, so ones still waiting
+    // for their mesh are left alone.
+    uint32_t budget = m_settings.m_maxEvictionsPerFrame;
+    if (m_settings.m_idleFrames > 0) {
+        for (auto it = m_candidates.begin(); it != m_candidates.end() && budget > 0; it++) {
+            if (m_frame - (*it)->m_lastNeeded >= m_settings.m_idleFrames && !(*it)->m_meshDirty)
+                budget -= Compress(**it);
+        }
+    }
+
+    if (m_usage.GetTotal() > m_settings.m_budget && !m_candidates.empty()) {
+        // Least recently needed first, and the furthest away among chunks needed in the same frame.
+        const auto distance = [&](const ChunkNode* node) {
+            const int64_t x = node->m_pos.m_x - center.m_x, y = node->m_pos.m_y - center.m_y, z = node->m_pos.m_z - center.m_z;
+            return x * x + y * y + z * z;
+        };
+        std::sort(m_candidates.begin(), m_candidates.end(), [&](const ChunkNode* a, const ChunkNode* b) {
+            return a->m_lastNeeded != b->m_lastNeeded ? a->m_lastNeeded < b->m_lastNeeded : distance(a) > distance(b);
+        });
+
+        // Every step runs over all candidates before the next, harsher one starts.
+        for (auto it = m_candidates.begin(); it != m_candidates.end() && budget > 0 && m_usage.GetTotal() > m_settings.m_budget; it++)
+            budget -= DropMesh(**it);
+        for (auto it = m_candidates.begin(); it != m_candidates.end() && budget > 0 && m_usage.GetTotal() > m_settings.m_budget; it++)
+            budget -= Compress(**it);
+        for (auto it = m_candidates.begin(); it != m_candidates.end() && budget > 0 && m_usage.GetTotal() > m_settings.m_budget; it++) {
+            Usage freed;
+            Measure(**it, freed);
+            const ChunkPos pos = (*it)->m_pos;
+            if (!m_world.UnloadChunk(pos))
+                continue;
+            if (m_streamer != nullptr)
+                m_streamer->QueueLoad(pos);
+
+            m_usage.m_nodes -= freed.m_nodes;
+            m_usage.m_voxels -= freed.m_voxels;
+            m_usage.m_compressed -= freed.m_compressed;
+            m_usage.m_meshes -= freed.m_meshes;
+            m_usage.m_light -= freed.m_light;
+            m_stats.m_unloaded++;
+            budget--;
+        }
+
+        // The far field takes the solid voxels of the unloaded chunks.
+        m_usage.m_farField = m_world.GetFarField().GetMemoryUsage();
+    }
+
+    m_frame++;
+}
+
+void ChunkResidency::Measure(const ChunkNode& node, Usage& usage) {
+    usage.m_nodes += sizeof(ChunkNode);
+    // Shared payloads are split evenly between the chunks using them.
+    usage.m_voxels += node.m_chunk != nullptr ? node.m_chunk->GetMemoryUsage() / node.m_chunk.use_count() : 0;
+    usage.m_compressed += node.m_compressed.capacity();
+    usage.m_meshes += node.m_mesh.m_vertices.capacity() * sizeof(uint32_t);
+    usage.m_light += node.m_light != nullptr ? sizeof(ChunkLight) : 0;
+}
+
+bool ChunkResidency::DropMesh(ChunkNode& node) {
+    if (node.m_mesh.m_vertices.capacity() == 0)
+        return false;
+
+    // The chunk is meshed again once it's needed, see Need().
+    m_usage.m_meshes -= node.m_mesh.m_vertices.capacity() * sizeof(uint32_t);
+    node.m_mesh.m_vertices = std::vector<uint32_t>();
+    node.m_state = ChunkState::eLoaded;
+    node.m_meshDirty = true;
+    m_stats.m_droppedMeshes++;
+    return true;
+}
+
+bool ChunkResidency::Compress(ChunkNode& node) {
+    if (node.m_chunk == nullptr)
+        return false;
+
+    const size_t voxels = node.m_chunk->GetMemoryUsage();
+    m_world.CompressChunk(node);
+    if (node.m_chunk != nullptr)
+        return false;
+
+    m_usage.m_voxels -= voxels;
+    m_usage.m_compressed += node.m_compressed.capacity();
+    m_stats.m_compressed++;
+    return true;
+}
+
+void ChunkResidency::Need(ChunkNode& node) {
+    // Only a chunk that wasn't needed the frame before can have lost its mesh since.
+    if (m_streamer != nullptr && node.m_lastNeeded + 1 < m_frame && node.m_state == ChunkState::eLoaded && node.m_meshDirty)
+        m_streamer->QueueMesh(node.m_pos);
+    node.m_lastNeeded = m_frame;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+
+class World;
+class ChunkStreamer;
+struct ChunkNode;
+
+// Keeps the memory of the resident chunks under a budget. Once over it, the least recently needed
+// chunks give up memory in three steps: meshes are dropped first, then voxel data is compressed,
+// and only then are chunks unloaded. Chunks that go unneeded for long enough are compressed even
+// under budget. Chunks near the camera are pinned and never touched.
+class ChunkResidency final {
+public:
+    struct Settings {
+        size_t m_budget = 1024ull << 20; // In bytes, for everything counted by Usage except the far field.
+        int32_t m_pinRadius = 2; // In chunks along every axis from the camera chunk.
+        uint32_t m_maxEvictionsPerFrame = 64; // Meshes dropped, chunks compressed and unloaded combined.
+        uint32_t m_idleFrames = 300; // Frames without being needed before a chunk is compressed regardless of the budget, 0 to never.
+    };
+
+    // Live memory by category, in bytes.
+    struct Usage {
+        size_t m_nodes = 0; // Chunk nodes, including their solid bitmaps.
+        size_t m_voxels = 0;
+        size_t m_compressed = 0;
+        size_t m_meshes = 0;
+        size_t m_light = 0;
+        size_t m_farField = 0; // Not part of the budget, see World::GetFarField.
+
+        VXL_INLINE size_t GetTotal() const noexcept {
+            return m_nodes + m_voxels + m_compressed + m_meshes + m_light;
+        }
+    };
+
+    // Counts of the evictions during the last update.
+    struct Stats {
+        uint32_t m_droppedMeshes = 0;
+        uint32_t m_compressed = 0;
+        uint32_t m_unloaded = 0;
+    };
+
+    ChunkResidency(World& world, const Settings& settings) : m_world(world), m_settings(settings) {}
+
+    // Marks the chunks as needed this frame, e.g. the ones that were drawn.
+    void Touch(const std::vector<ChunkNode*>& chunks);
+
+    // Measures the resident chunks and evicts until they are back under budget, starting a new frame.
+    void Update(const glm::vec3& pos);
+
+    // Queues chunks whose meshes were dropped for meshing once they are needed again, and unloaded
+    // chunks within its load radius for loading, since the streamer only looks for missing chunks
+    // and meshes when the camera enters another chunk. May be null.
+    VXL_INLINE void SetStreamer(ChunkStreamer* streamer) {
+        m_streamer = streamer;
+    }
+
+    // Adds the memory held by a single chunk.
+    static void Measure(const ChunkNode& node, Usage& usage);
+
+    VXL_INLINE const Usage& GetUsage() const noexcept {
+        return m_usage;
+    }
+
+    VXL_INLINE const Stats& GetStats() const noexcept {
+        return m_stats;
+    }
+
+    VXL_INLINE const Settings& GetSettings() const noexcept {
+        return m_settings;
+    }
+private:
+    static Logger sLogger;
+
+    // Drops what a single step frees from the candidate and updates the usage. Returns false if the
+    // step had nothing to free.
+    bool DropMesh(ChunkNode& node);
+    bool Compress(ChunkNode& node);
+
+    // Marks the chunk as needed this frame, queueing it for meshing if it was just needed again.
+    void Need(ChunkNode& node);
+
+    World& m_world;
+    ChunkStreamer* m_streamer = nullptr;
+    Settings m_settings;
+    Usage m_usage;
+    Stats m_stats;
+    uint32_t m_frame = 1; // Nodes start at 0, so they are never needed in the current frame.
+    std::vector<ChunkNode*> m_candidates;
+};
@@ -0,0 +1,258 @@
+#include "world/ChunkStreamer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "util/JobSystem.h"
+#include "world/ChunkVisibility.h"
+#include "world/World.h"
+#include "world/storage/ChunkIO.h"
+
+Logger ChunkStreamer::sLogger = Logger("ChunkStreamer");
+
+ChunkStreamer::ChunkStreamer(World& world, const Settings& settings) : m_world(world), m_settings(settings) {
+    if (m_settings.m_unloadRadius < m_settings.m_loadRadius)
+        m_settings.m_unloadRadius = m_settings.m_loadRadius;
+}
+
+void ChunkStreamer::Update(const glm::vec3& pos, const glm::vec3& viewDir) {
+    m_frameStart = std::chrono::steady_clock::now();
+    m_pos = pos;
+    m_viewDir = viewDir;
+    m_stats = {};
+
+    const ChunkPos center = ChunkPos::FromBlock(std::floor(pos.x), std::floor(pos.y), std::floor(pos.z));
+    if (!m_scanned || !(center == m_center)) {
+        Rescan(center);
+        m_center = center;
+        m_scanned = true;
+    }
+
+    // Unloads go first since they free memory and are cheap, then voxel data, then meshes.
+    RunUnloads(m_settings.m_maxUnloadsPerFrame);
+    RunLoads(m_settings.m_maxLoadsPerFrame);
+    RunMeshes(m_settings.m_maxMeshesPerFrame);
+
+    m_stats.m_pendingLoads = m_loadQueue.size();
+    m_stats.m_pendingMeshes = m_meshQueue.size();
+    m_stats.m_pendingUnloads = m_unloadQueue.size();
+    m_stats.m_pendingOverlays = m_overlays.size();
+}
+
+void ChunkStreamer::QueueLoad(const ChunkPos& pos) {
+    const int32_t x = pos.m_x - m_center.m_x;
+    const int32_t y = pos.m_y - m_center.m_y;
+    const int32_t z = pos.m_z - m_center.m_z;
+    if (m_scanned && x * x + y * y + z * z <= m_settings.m_loadRadius * m_settings.m_loadRadius)
+        m_loadQueue.push_back(pos);
+}
+
+void ChunkStreamer::QueueOverlay(const ChunkPos& pos, std::unique_ptr<EightBitChunk> overlay) {
+    m_overlays[pos.Pack()].push_back(std::move(overlay));
+}
+
+void ChunkStreamer::Rescan(const ChunkPos& center) {
+    const int32_t loadRadius = m_settings.m_loadRadius;
+    const int32_t unloadRadius = m_settings.m_unloadRadius;
+
+    m_loadQueue.clear();
+    for (int32_t x = -loadRadius; x <= loadRadius; x++) {
+        for (int32_t y = -loadRadius; y <= loadRadius; y++) {
+            for (int32_t z = -loadRadius; z <= loadRadius; z++) {
+                if (x * x + y * y + z * z > loadRadius * loadRadius)
+                    continue;
+
+                const ChunkPos pos = {.m_x = center.m_x + x, .m_y = center.m_y + y, .m_z = center.m_z + z};
+                const ChunkNode* node = m_world.GetChunk(pos);
+                if (node == nullptr || node->m_state == ChunkState::eEmpty)
+                    m_loadQueue.push_back(pos);
+            }
+        }
+    }
+
+    m_unloadQueue.clear();
+    m_meshQueue.clear();
+    m_world.GetChunks().ForEach([&](const ChunkNode& node) {
+        const int32_t x = node.m_pos.m_x - center.m_x;
+        const int32_t y = node.m_pos.m_y - center.m_y;
+        const int32_t z = node.m_pos.m_z - center.m_z;
+
+        if (x * x + y * y + z * z > unloadRadius * unloadRadius)
+            m_unloadQueue.push_back(node.m_pos);
+        else if (node.m_meshDirty)
+            m_meshQueue.push_back(node.m_pos);
+    });
+}
+
+void ChunkStreamer::SelectHighestPriority(std::vector<ChunkPos>& queue, size_t count, bool meshing) {
+    count = std::min(count, queue.size());
+    if (count == 0)
+        return;
+
+    // Priorities are computed once per position, as mesh priorities look the chunks up.
+    m_priorities.resize(queue.size());
+    for (size_t i = 0; i < queue.size(); i++)
+        m_priorities[i] = {meshing ? GetMeshPriority(queue[i]) : GetPriority(queue[i]), queue[i]};
+
+    // Partition so the selected chunks sit at the back, then order just those.
+    const auto compare = [](const std::pair<float, ChunkPos>& a, const std::pair<float, ChunkPos>& b) {
+        return a.first > b.first;
+    };
+    const auto split = m_priorities.end() - count;
+    std::nth_element(m_priorities.begin(), split, m_priorities.end(), compare);
+    std::sort(split, m_priorities.end(), compare);
+    for (size_t i = 0; i < queue.size(); i++)
+        queue[i] = m_priorities[i].second;
+}
+
+float ChunkStreamer::GetPriority(const ChunkPos& pos) const {
+    const glm::vec3 chunkCenter = glm::vec3(pos.m_x * 32.0f + 16.0f, pos.m_y * 32.0f + 16.0f, pos.m_z * 32.0f + 16.0f);
+    const glm::vec3 offset = chunkCenter - m_pos;
+    const float distanceSquared = glm::dot(offset, offset);
+
+    // Chunks straight ahead keep their distance, chunks straight behind count as further away.
+    const float facing = distanceSquared > 0.0f ? glm::dot(offset, m_viewDir) / std::sqrt(distanceSquared) : 1.0f;
+    return distanceSquared * (1.0f + m_settings.m_viewWeight * (1.0f - facing));
+}
+
+float ChunkStreamer::GetMeshPriority(const ChunkPos& pos) const {
+    const float priority = GetPriority(pos);
+    if (m_visibility == nullptr)
+        return priority;
+
+    const ChunkNode* node = m_world.GetChunk(pos);
+    return node != nullptr && !m_visibility->IsVisible(*node) ? priority * (1.0f + m_settings.m_hiddenWeight) : priority;
+}
+
+void ChunkStreamer::RunLoads(uint32_t budget) {
+    SelectHighestPriority(m_loadQueue, budget, false);
+    m_batch.clear();
+    m_read.clear();
+
+    // Finished reads join the batch regardless of the budget, they were paid for when requested.
+    // Nodes that were unloaded or reinserted since have nothing waiting on the read anymore.
+    if (m_io != nullptr) {
+        m_io->Poll([this](const ChunkPos& pos, std::unique_ptr<EightBitChunk> chunk) {
+            ChunkNode* node = m_world.GetChunk(pos);
+            if (node == nullptr || !node->m_reading)
+                return;
+
+            node->m_reading = false;
+            m_read.push_back(chunk != nullptr);
+            if (chunk != nullptr)
+                node->m_chunk = std::move(chunk);
+            m_batch.push_back(node);
+        });
+    }
+
+    // Inserting touches the map and neighbor links, so it stays on this thread.
+    while (budget > 0 && !m_loadQueue.empty() && !IsOverTime()) {
+        const ChunkPos pos = m_loadQueue.back();
+        ChunkNode* node = m_world.LoadChunk(pos);
+        if (node->m_state != ChunkState::eEmpty || node->m_reading) {
+            m_loadQueue.pop_back();
+            continue;
+        }
+
+        // The position stays queued while the I/O is saturated.
+        if (m_io != nullptr && !m_io->RequestLoad(pos))
+            break;
+
+        m_loadQueue.pop_back();
+        budget--;
+        if (m_io != nullptr) {
+            node->m_reading = true;
+        } else {
+            m_batch.push_back(node);
+            m_read.push_back(false);
+        }
+    }
+
+    // Filling only touches each node's own chunk, so the batch is spread over the workers.
+    std::atomic<uint32_t> loaded = 0;
+    m_hashes.assign(m_batch.size(), 0);
+    JobSystem::ParallelFor(static_cast<uint32_t>(m_batch.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            ChunkNode& node = *m_batch[i];
+            if (m_read[i] || (m_loader && m_loader(node)))
+                loaded.fetch_add(1, std::memory_order_relaxed);
+            else if (m_generator)
+                m_generator(node);
+
+            EightBitChunk* chunk = dynamic_cast<EightBitChunk*>(node.m_chunk.get());
+            const auto overlays = m_overlays.find(node.m_pos.Pack());
+            if (chunk != nullptr && overlays != m_overlays.end()) {
+                for (const std::unique_ptr<EightBitChunk>& overlay : overlays->second)
+                    chunk->Overlay(*overlay);
+                chunk->RecountPalette();
+            }
+
+            node.m_solid = node.m_chunk->GetBlockBitmap(BlockTypes::eAir, true);
+            node.m_fullFaces = node.m_solid.GetFullFaces();
+            node.m_connectivity = ChunkConnectivity::Compute(node.m_solid);
+            if (chunk != nullptr)
+                m_hashes[i] = ChunkInterner::Hash(*chunk);
+        }
+    });
+
+    // The interning table isn't thread safe, so chunks are swapped for shared payloads here.
+    for (size_t i = 0; i < m_batch.size(); i++) {
+        ChunkNode* node = m_batch[i];
+        node->m_chunk = m_world.GetInterner().Intern(std::move(node->m_chunk), m_hashes[i]);
+        node->m_state = ChunkState::eLoaded;
+        node->m_meshDirty = true;
+        node->m_modified |= m_overlays.erase(node->m_pos.Pack()) > 0;
+        m_world.Stamp(*node);
+        m_meshQueue.push_back(node->m_pos);
+        m_world.GetLight().QueueChunk(node->m_pos);
+    }
+
+    m_stats.m_loaded += loaded.load(std::memory_order_relaxed);
+    m_stats.m_generated += static_cast<uint32_t>(m_batch.size()) - loaded.load(std::memory_order_relaxed);
+}
+
+void ChunkStreamer::RunMeshes(uint32_t budget) {
+    SelectHighestPriority(m_meshQueue, budget, true);
+
+    m_batch.clear();
+    while (budget > 0 && !m_meshQueue.empty() && !IsOverTime()) {
+        const ChunkPos pos = m_meshQueue.back();
+        m_meshQueue.pop_back();
+
+        // The chunk may have been unloaded or already picked through a duplicate entry.
+        ChunkNode* node = m_world.GetChunk(pos);
+        if (node == nullptr || node->m_state == ChunkState::eEmpty || !node->m_meshDirty)
+            continue;
+
+        m_world.DecompressChunk(*node);
+        budget--;
+        node->m_meshDirty = false;
+        m_batch.push_back(node);
+    }
+
+    JobSystem::ParallelFor(static_cast<uint32_t>(m_batch.size()), 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            ChunkNode& node = *m_batch[i];
+            // The blocks may have been edited since the load, whether or not the chunk was meshed.
+            node.m_connectivity = ChunkConnectivity::Compute(node.m_solid);
+
+            node.m_mesh.m_vertices.clear();
+            node.m_chunk->MeshGreedy(node.m_mesh);
+        }
+    });
+
+    for (ChunkNode* node : m_batch)
+        node->m_state = ChunkState::eMeshed;
+    m_stats.m_meshed += static_cast<uint32_t>(m_batch.size());
+}
+
+void ChunkStreamer::RunUnloads(uint32_t budget) {
+    while (budget > 0 && !m_unloadQueue.empty()) {
+        const ChunkPos pos = m_unloadQueue.back();
+        m_unloadQueue.pop_back();
+        budget--;
+
+        if (m_world.UnloadChunk(pos))
+            m_stats.m_unloaded++;
+    }
+}
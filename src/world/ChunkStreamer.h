@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+class World;
+class ChunkIO;
+class ChunkVisibility;
+struct ChunkNode;
+
+// Keeps the chunks within a radius of the camera resident. Work is ordered by distance and view
+// direction, and capped per frame so that the frame time stays flat while moving.
+class ChunkStreamer final {
+public:
+    struct Settings {
+        int32_t m_loadRadius = 8; // In chunks.
+        int32_t m_unloadRadius = 10; // In chunks, larger than the load radius to avoid thrashing at the border.
+        uint32_t m_maxLoadsPerFrame = 8; // Loads and generations.
+        uint32_t m_maxMeshesPerFrame = 8;
+        uint32_t m_maxUnloadsPerFrame = 32;
+        float m_maxMillisPerFrame = 4.0f; // Stops issuing load and mesh work once exceeded.
+        float m_viewWeight = 1.0f; // How much chunks behind the camera are pushed back.
+        float m_hiddenWeight = 4.0f; // How much chunks the visibility walk didn't reach are pushed back when meshing.
+    };
+
+    // Fills a newly inserted chunk from storage. Returns false if there was nothing to load. Both
+    // callbacks run on the job system and may be called for several chunks at once.
+    using Loader = std::function<bool(ChunkNode&)>;
+    // Fills a newly inserted chunk that couldn't be loaded.
+    using Generator = std::function<void(ChunkNode&)>;
+
+    // Counts of the work done during the last update.
+    struct Stats {
+        uint32_t m_loaded = 0;
+        uint32_t m_generated = 0;
+        uint32_t m_meshed = 0;
+        uint32_t m_unloaded = 0;
+        size_t m_pendingLoads = 0;
+        size_t m_pendingMeshes = 0;
+        size_t m_pendingUnloads = 0;
+        size_t m_pendingOverlays = 0; // Chunks with overlays waiting for them to be loaded.
+    };
+
+    ChunkStreamer(World& world, const Settings& settings);
+
+    // Schedules and runs this frame's work around the given position and normalized view direction.
+    void Update(const glm::vec3& pos, const glm::vec3& viewDir);
+
+    // Queues a resident chunk to be remeshed, e.g. after its blocks were edited.
+    VXL_INLINE void QueueMesh(const ChunkPos& pos) {
+        m_meshQueue.push_back(pos);
+    }
+
+    // Queues a chunk that was unloaded to be loaded again if it's within the load radius, since
+    // missing chunks are only looked for when the camera enters another chunk.
+    void QueueLoad(const ChunkPos& pos);
+
+    // Lays blocks over a chunk that isn't resident once it's loaded or generated, where air keeps
+    // the chunk's blocks, and marks it modified so that it's saved. Overlays of the same chunk are
+    // applied in the order they were queued.
+    void QueueOverlay(const ChunkPos& pos, std::unique_ptr<EightBitChunk> overlay);
+
+    VXL_INLINE void SetLoader(Loader loader) {
+        m_loader = std::move(loader);
+    }
+
+    // Reads chunks from storage asynchronously instead of through the loader, chunks are only
+    // generated once their read found nothing. Loads wait while the I/O is saturated. May be null.
+    VXL_INLINE void SetIO(ChunkIO* io) {
+        m_io = io;
+    }
+
+    VXL_INLINE void SetGenerator(Generator generator) {
+        m_generator = std::move(generator);
+    }
+
+    // Meshes chunks reached by the visibility's last walk first. May be null.
+    VXL_INLINE void SetVisibility(const ChunkVisibility* visibility) {
+        m_visibility = visibility;
+    }
+
+    VXL_INLINE const Settings& GetSettings() const noexcept {
+        return m_settings;
+    }
+
+    VXL_INLINE const Stats& GetStats() const noexcept {
+        return m_stats;
+    }
+private:
+    static Logger sLogger;
+
+    // Rebuilds the load and unload queues around the new center chunk.
+    void Rescan(const ChunkPos& center);
+
+    // Moves the count highest priority positions to the back of the queue, highest last.
+    void SelectHighestPriority(std::vector<ChunkPos>& queue, size_t count, bool meshing);
+
+    // Lower is sooner. Squared distance pushed back by how far the chunk is from the view direction.
+    float GetPriority(const ChunkPos& pos) const;
+
+    // GetPriority() pushed back further for resident chunks that can't currently be seen.
+    float GetMeshPriority(const ChunkPos& pos) const;
+
+    void RunLoads(uint32_t budget);
+    void RunMeshes(uint32_t budget);
+    void RunUnloads(uint32_t budget);
+
+    VXL_INLINE bool IsOverTime() const {
+        const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - m_frameStart;
+        return elapsed.count() > m_settings.m_maxMillisPerFrame;
+    }
+
+    World& m_world;
+    Settings m_settings;
+    Loader m_loader;
+    Generator m_generator;
+    ChunkIO* m_io = nullptr;
+    const ChunkVisibility* m_visibility = nullptr;
+    Stats m_stats;
+
+    glm::vec3 m_pos = {0.0f, 0.0f, 0.0f};
+    glm::vec3 m_viewDir = {0.0f, 0.0f, 1.0f};
+    ChunkPos m_center;
+    bool m_scanned = false;
+    std::chrono::steady_clock::time_point m_frameStart;
+
+    std::vector<ChunkPos> m_loadQueue;
+    std::vector<ChunkPos> m_meshQueue;
+    std::vector<ChunkPos> m_unloadQueue;
+    std::unordered_map<uint64_t, std::vector<std::unique_ptr<EightBitChunk>>> m_overlays; // Packed chunk position to its overlays.
+    std::vector<std::pair<float, ChunkPos>> m_priorities; // A queue along with the priority of every position.
+    std::vector<ChunkNode*> m_batch; // This frame's chunks, handed to the job system.
+    std::vector<uint8_t> m_read; // Per chunk of a load batch, whether its blocks came from ChunkIO.
+    std::vector<uint64_t> m_hashes; // Per chunk of a load batch, the hash of its blocks for interning.
+};
@@ -0,0 +1,61 @@
+#include "world/ChunkVisibility.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "world/World.h"
+
+Logger ChunkVisibility::sLogger = Logger("ChunkVisibility");
+
+void ChunkVisibility::Update(const World& world, const glm::vec3& pos) {
+    // Zero is what new nodes start with, so it never marks a walk.
+    if (++m_walk == 0)
+        m_walk = 1;
+
+    const ChunkPos center = ChunkPos::FromBlock(std::floor(pos.x), std::floor(pos.y), std::floor(pos.z));
+    ChunkNode* start = world.GetChunk(center);
+    m_active = start != nullptr;
+    m_visibleCount = 0;
+    if (!m_active)
+        return;
+
+    // The steps double as the queue, everything before the head has been expanded.
+    m_steps.clear();
+    m_steps.push_back({.m_node = start, .m_entered = sNoFace, .m_directions = 0});
+    start->m_visibleWalk = m_walk;
+
+    for (size_t head = 0; head < m_steps.size(); head++) {
+        const Step step = m_steps[head];
+
+        for (const Direction direction : Directions::sAll) {
+            if ((step.m_directions >> Directions::Opposite(direction)) & 1)
+                continue;
+            if (step.m_entered != sNoFace && !ChunkConnectivity::IsConnected(step.m_node->m_connectivity, static_cast<Direction>(step.m_entered), direction))
+                continue;
+
+            ChunkNode* neighbor = step.m_node->GetNeighbor(direction);
+            if (neighbor == nullptr || neighbor->m_visibleWalk == m_walk)
+                continue;
+
+            const ChunkPos& neighborPos = neighbor->m_pos;
+            const int32_t distance = std::max({std::abs(neighborPos.m_x - center.m_x), std::abs(neighborPos.m_y - center.m_y), std::abs(neighborPos.m_z - center.m_z)});
+            if (distance > m_settings.m_maxDistance)
+                continue;
+
+            neighbor->m_visibleWalk = m_walk;
+            m_steps.push_back({
+                .m_node = neighbor,
+                .m_entered = Directions::Opposite(direction),
+                .m_directions = static_cast<uint8_t>(step.m_directions | (1u << direction))
+            });
+        }
+    }
+
+    m_visibleCount = static_cast<uint32_t>(m_steps.size());
+}
+
+void ChunkVisibility::Cull(std::vector<ChunkNode*>& chunks) const {
+    std::erase_if(chunks, [this](const ChunkNode* node) {
+        return !IsVisible(*node);
+    });
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkNode.h"
+
+class World;
+
+// Cave culling. A breadth first walk from the camera chunk only passes through a chunk between
+// faces that its connectivity links, and never steps back against a direction it already took, so
+// chunks that can't be seen through any chain of open chunks are never reached.
+class ChunkVisibility final {
+public:
+    struct Settings {
+        int32_t m_maxDistance = 32; // In chunks along every axis from the camera chunk.
+    };
+
+    ChunkVisibility(const Settings& settings) : m_settings(settings) {}
+
+    // Walks the resident chunks from the chunk containing the position.
+    void Update(const World& world, const glm::vec3& pos);
+
+    // Whether the last walk reached the chunk. Everything counts as visible while the camera
+    // chunk isn't resident, as nothing can be ruled out.
+    VXL_INLINE bool IsVisible(const ChunkNode& node) const noexcept {
+        return !m_active || node.m_visibleWalk == m_walk;
+    }
+
+    // Removes the chunks the last walk didn't reach, keeping the order of the rest.
+    void Cull(std::vector<ChunkNode*>& chunks) const;
+
+    VXL_INLINE uint32_t GetVisibleCount() const noexcept {
+        return m_visibleCount;
+    }
+private:
+    static Logger sLogger;
+
+    // Marks a walk that started in the camera chunk rather than entering it through a face.
+    static constexpr uint8_t sNoFace = 6;
+
+    struct Step {
+        ChunkNode* m_node;
+        uint8_t m_entered; // Face of the node the walk came in through.
+        uint8_t m_directions; // Bit per Direction taken to get here.
+    };
+
+    Settings m_settings;
+    uint32_t m_walk = 0;
+    bool m_active = false;
+    uint32_t m_visibleCount = 0;
+    std::vector<Step> m_steps;
+};
@@ -0,0 +1,223 @@
+#include "world/Collision.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include "util/JobSystem.h"
+#include "world/World.h"
+
+Logger Collision::sLogger = Logger("Collision");
+
+// Blocks the box overlaps by more than the skin, inclusive.
+static void BlockRange(const Collision::Box& box, glm::ivec3& min, glm::ivec3& max) {
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        min[axis] = static_cast<int32_t>(std::floor(box.m_min[axis] + Collision::sSkin));
+        max[axis] = static_cast<int32_t>(std::ceil(box.m_max[axis] - Collision::sSkin)) - 1;
+    }
+}
+
+// Calls the function with every solid block in the inclusive range until it returns true, and
+// returns whether it did. Each row of a chunk is masked to the range along z, so only the solid
+// blocks are ever visited.
+template<typename Func>
+static bool ForEachSolid(const World& world, const glm::ivec3& min, const glm::ivec3& max, Func&& func) {
+    if (min.x > max.x || min.y > max.y || min.z > max.z)
+        return false;
+
+    for (int32_t chunkX = min.x >> 5; chunkX <= max.x >> 5; chunkX++) {
+        for (int32_t chunkY = min.y >> 5; chunkY <= max.y >> 5; chunkY++) {
+            for (int32_t chunkZ = min.z >> 5; chunkZ <= max.z >> 5; chunkZ++) {
+                const ChunkNode* node = world.GetChunk({.m_x = chunkX, .m_y = chunkY, .m_z = chunkZ});
+                if (node == nullptr)
+                    continue;
+
+                const glm::ivec3 origin = glm::ivec3(chunkX * 32, chunkY * 32, chunkZ * 32);
+                const int32_t minX = std::max(min.x - origin.x, 0), maxX = std::min(max.x - origin.x, 31);
+                const int32_t minY = std::max(min.y - origin.y, 0), maxY = std::min(max.y - origin.y, 31);
+                const int32_t minZ = std::max(min.z - origin.z, 0), maxZ = std::min(max.z - origin.z, 31);
+                const uint32_t zMask = (~0u << minZ) & (~0u >> (31 - maxZ));
+
+                for (int32_t x = minX; x <= maxX; x++) {
+                    for (int32_t y = minY; y <= maxY; y++) {
+                        for (uint32_t bits = node->m_solid[(x << 5) | y] & zMask; bits != 0; bits &= bits - 1) {
+                            if (func(glm::ivec3(origin.x + x, origin.y + y, origin.z + std::countr_zero(bits))))
+                                return true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// Slab test of the moving box against a block. Returns false if the box misses it, or already
+// overlaps it by more than the skin at the start.
+static bool TimeOfImpact(const Collision::Box& box, const glm::vec3& motion, const glm::ivec3& block, float& time, uint8_t& hitAxis) {
+    float enter = -std::numeric_limits<float>::infinity();
+    float exit = std::numeric_limits<float>::infinity();
+    float penetration = 0.0f;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        const float low = static_cast<float>(block[axis]);
+        const float high = low + 1.0f;
+        if (motion[axis] == 0.0f) {
+            if (box.m_max[axis] - Collision::sSkin <= low || box.m_min[axis] + Collision::sSkin >= high)
+                return false;
+            continue;
+        }
+
+        const bool positive = motion[axis] > 0.0f;
+        const float near = positive ? low - box.m_max[axis] : high - box.m_min[axis];
+        const float far = positive ? high - box.m_min[axis] : low - box.m_max[axis];
+        const float axisEnter = near / motion[axis];
+        if (axisEnter > enter) {
+            enter = axisEnter;
+            hitAxis = axis;
+            penetration = positive ? -near : near;
+        }
+        exit = std::min(exit, far / motion[axis]);
+    }
+
+    // Not moving along any axis the block overlaps on is the same as already being inside it.
+    if (enter == -std::numeric_limits<float>::infinity())
+        return false;
+    if (enter >= exit || enter > 1.0f || exit <= 0.0f || (enter < 0.0f && penetration > Collision::sSkin))
+        return false;
+
+    time = std::max(enter, 0.0f);
+    return true;
+}
+
+// Clips the motion along one axis to the first layer of solid blocks ahead of the box.
+static float ClipAxis(const World& world, const Collision::Box& box, const uint8_t axis, const float motion) {
+    if (motion == 0.0f)
+        return 0.0f;
+
+    glm::ivec3 min, max;
+    BlockRange(box, min, max);
+    const auto stop = [](const glm::ivec3&) {
+        return true;
+    };
+
+    if (motion > 0.0f) {
+        const float edge = box.m_max[axis];
+        const int32_t last = static_cast<int32_t>(std::ceil(edge + motion)) - 1;
+        for (int32_t layer = static_cast<int32_t>(std::ceil(edge - Collision::sSkin)); layer <= last; layer++) {
+            min[axis] = max[axis] = layer;
+            if (ForEachSolid(world, min, max, stop))
+                return std::min(motion, static_cast<float>(layer) - edge);
+        }
+    } else {
+        const float edge = box.m_min[axis];
+        const int32_t last = static_cast<int32_t>(std::floor(edge + motion));
+        for (int32_t layer = static_cast<int32_t>(std::floor(edge + Collision::sSkin)) - 1; layer >= last; layer--) {
+            min[axis] = max[axis] = layer;
+            if (ForEachSolid(world, min, max, stop))
+                return std::max(motion, static_cast<float>(layer + 1) - edge);
+        }
+    }
+
+    return motion;
+}
+
+bool Collision::IsSolid(const World& world, const Box& box) {
+    glm::ivec3 min, max;
+    BlockRange(box, min, max);
+    return ForEachSolid(world, min, max, [](const glm::ivec3&) {
+        return true;
+    });
+}
+
+Collision::Sweep Collision::SweepBox(const World& world, const Box& box, const glm::vec3& motion) {
+    // Only the blocks within the bounds of the whole move can be hit.
+    Box bounds;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        bounds.m_min[axis] = box.m_min[axis] + std::min(motion[axis], 0.0f);
+        bounds.m_max[axis] = box.m_max[axis] + std::max(motion[axis], 0.0f);
+    }
+
+    glm::ivec3 min, max;
+    BlockRange(bounds, min, max);
+
+    Sweep sweep;
+    ForEachSolid(world, min, max, [&](const glm::ivec3& block) {
+        float time;
+        uint8_t axis;
+        if (TimeOfImpact(box, motion, block, time, axis) && (!sweep.m_hit || time < sweep.m_fraction)) {
+            sweep.m_hit = true;
+            sweep.m_fraction = time;
+            sweep.m_block = block;
+            sweep.m_face = static_cast<Direction>(axis * 2 + (motion[axis] < 0.0f));
+        }
+        return false;
+    });
+
+    return sweep;
+}
+
+glm::vec3 Collision::Move(const World& world, Box& box, const glm::vec3& motion) {
+    glm::vec3 applied = glm::vec3(0.0f, 0.0f, 0.0f);
+    for (const uint8_t axis : {1, 0, 2}) {
+        applied[axis] = ClipAxis(world, box, axis, motion[axis]);
+        box.m_min[axis] += applied[axis];
+        box.m_max[axis] += applied[axis];
+    }
+
+    return applied;
+}
+
+void Collision::MoveBatch(const World& world, std::vector<Box>& boxes, const std::vector<glm::vec3>& motions) {
+    JobSystem::ParallelFor(static_cast<uint32_t>(boxes.size()), 256, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            Move(world, boxes[i], motions[i]);
+    });
+}
+
+bool Collision::IsSolidNaive(const World& world, const Box& box) {
+    glm::ivec3 min, max;
+    BlockRange(box, min, max);
+    for (int32_t x = min.x; x <= max.x; x++) {
+        for (int32_t y = min.y; y <= max.y; y++) {
+            for (int32_t z = min.z; z <= max.z; z++) {
+                if (world.GetBlock(x, y, z) != BlockTypes::eAir)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+Collision::Sweep Collision::SweepBoxNaive(const World& world, const Box& box, const glm::vec3& motion) {
+    Box bounds;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        bounds.m_min[axis] = box.m_min[axis] + std::min(motion[axis], 0.0f);
+        bounds.m_max[axis] = box.m_max[axis] + std::max(motion[axis], 0.0f);
+    }
+
+    glm::ivec3 min, max;
+    BlockRange(bounds, min, max);
+
+    Sweep sweep;
+    for (int32_t x = min.x; x <= max.x; x++) {
+        for (int32_t y = min.y; y <= max.y; y++) {
+            for (int32_t z = min.z; z <= max.z; z++) {
+                float time;
+                uint8_t axis;
+                if (world.GetBlock(x, y, z) == BlockTypes::eAir || !TimeOfImpact(box, motion, glm::ivec3(x, y, z), time, axis))
+                    continue;
+
+                if (!sweep.m_hit || time < sweep.m_fraction) {
+                    sweep.m_hit = true;
+                    sweep.m_fraction = time;
+                    sweep.m_block = glm::ivec3(x, y, z);
+                    sweep.m_face = static_cast<Direction>(axis * 2 + (motion[axis] < 0.0f));
+                }
+            }
+        }
+    }
+
+    return sweep;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "util/Logger.h"
+#include "world/Direction.h"
+
+class World;
+
+// Axis-aligned box queries against the solid voxels of the resident world. Whole runs of voxels
+// along z are tested at once by masking the rows of each chunk's solid bitmap, and moves along x
+// and y scan layer by layer from the leading face so they stop at the first layer that is hit.
+// Boxes only collide with voxels they overlap by more than sSkin, so resting on a surface or
+// rounding errors from a previous move never count as being inside it.
+class Collision final {
+public:
+    static constexpr float sSkin = 1e-4f;
+
+    struct Box {
+        glm::vec3 m_min = {0.0f, 0.0f, 0.0f};
+        glm::vec3 m_max = {0.0f, 0.0f, 0.0f};
+    };
+
+    struct Sweep {
+        bool m_hit = false;
+        float m_fraction = 1.0f; // Fraction of the motion the box can travel.
+        glm::ivec3 m_block = {0, 0, 0}; // World position of the block that was hit.
+        Direction m_face = Direction::eNegX; // Face of the block that was hit.
+    };
+
+    // Whether any solid block overlaps the box.
+    static bool IsSolid(const World& world, const Box& box);
+
+    // Finds how far the box can move along the motion before touching a solid block. Blocks the box
+    // already overlaps at the start are ignored, so a stuck box can always move out.
+    static Sweep SweepBox(const World& world, const Box& box, const glm::vec3& motion);
+
+    // Moves the box one axis at a time, y first, stopping each axis at the first solid block so
+    // that the box slides along walls and floors. Returns the motion that was applied.
+    static glm::vec3 Move(const World& world, Box& box, const glm::vec3& motion);
+
+    // Moves every box across the job system. The world must not be modified until it returns.
+    static void MoveBatch(const World& world, std::vector<Box>& boxes, const std::vector<glm::vec3>& motions);
+
+    // Reference versions that look up every block through World::GetBlock.
+    static bool IsSolidNaive(const World& world, const Box& box);
+    static Sweep SweepBoxNaive(const World& world, const Box& box, const glm::vec3& motion);
+private:
+    static Logger sLogger;
+};
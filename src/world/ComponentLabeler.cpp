@@ -0,0 +1,319 @@
+#include "world/ComponentLabeler.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include "util/JobSystem.h"
+#include "world/World.h"
+
+Logger ComponentLabeler::sLogger = Logger("ComponentLabeler");
+
+// Finds the root of a union-find node, halving the path along the way.
+template<typename T>
+static T FindRoot(std::vector<T>& parents, T node) {
+    while (parents[node] != node) {
+        parents[node] = parents[parents[node]];
+        node = parents[node];
+    }
+    return node;
+}
+
+// Joins two sets under the lower root, so that roots don't depend on the order of the joins.
+template<typename T>
+static void Unite(std::vector<T>& parents, const T a, const T b) {
+    const T rootA = FindRoot(parents, a);
+    const T rootB = FindRoot(parents, b);
+    if (rootA < rootB)
+        parents[rootB] = rootA;
+    else
+        parents[rootA] = rootB;
+}
+
+// Calls the function for every pair of overlapping runs of two rows. Runs are ordered along z, so a
+// run that ends before the other can't overlap any further ones.
+template<typename Func>
+static void ForEachOverlap(const uint32_t* runs, const uint32_t first, const uint32_t last, const uint32_t* otherRuns, const uint32_t otherFirst, const uint32_t otherLast, Func&& func) {
+    uint32_t i = first, j = otherFirst;
+    while (i < last && j < otherLast) {
+        if ((runs[i] & otherRuns[j]) != 0)
+            func(i, j);
+        if (std::bit_width(runs[i]) < std::bit_width(otherRuns[j]))
+            i++;
+        else
+            j++;
+    }
+}
+
+void ComponentLabeler::Label() {
+    std::vector<std::pair<ChunkLabels*, const ChunkNode*>> stale;
+    std::unordered_map<uint64_t, ChunkLabels> chunks;
+    m_world.GetChunks().ForEach([&](const ChunkNode& node) {
+        if (node.m_state == ChunkState::eEmpty)
+            return;
+
+        const auto it = m_chunks.find(node.m_pos.Pack());
+        if (it != m_chunks.end() && it->second.m_generation == node.m_generation) {
+            chunks.insert(m_chunks.extract(it));
+            return;
+        }
+
+        ChunkLabels& labels = chunks[node.m_pos.Pack()];
+        labels.m_node = &node;
+        labels.m_generation = node.m_generation;
+        labels.m_version = ++m_version;
+        stale.push_back({&labels, &node});
+    });
+    // Chunks that weren't seen were unloaded.
+    m_chunks = std::move(chunks);
+    m_relabeled = static_cast<uint32_t>(stale.size());
+
+    JobSystem::ParallelFor(static_cast<uint32_t>(stale.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            LabelChunk(*stale[i].first, stale[i].second->m_solid);
+    });
+
+    // Number the components of every chunk and find its loaded neighbors.
+    std::vector<ChunkLabels*> order;
+    std::vector<std::array<const ChunkLabels*, 6>> neighbors;
+    uint32_t nodes = 0;
+    for (auto& [key, labels] : m_chunks) {
+        labels.m_first = nodes;
+        nodes += static_cast<uint32_t>(labels.m_components.size());
+        order.push_back(&labels);
+
+        std::array<const ChunkLabels*, 6>& adjacent = neighbors.emplace_back();
+        for (const Direction direction : Directions::sAll) {
+            const auto it = m_chunks.find(labels.m_node->m_pos.Offset(direction).Pack());
+            adjacent[direction] = it != m_chunks.end() ? &it->second : nullptr;
+        }
+    }
+
+    // Joins only need to be found again if either chunk was relabeled.
+    constexpr std::array<Direction, 3> sPositive = {Direction::ePosX, Direction::ePosY, Direction::ePosZ};
+    JobSystem::ParallelFor(static_cast<uint32_t>(order.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            for (uint8_t axis = 0; axis < 3; axis++) {
+                const ChunkLabels* neighbor = neighbors[i][sPositive[axis]];
+                const uint32_t version = neighbor != nullptr ? neighbor->m_version : 0;
+                if (order[i]->m_joinVersions[axis] == version)
+                    continue;
+
+                order[i]->m_joins[axis].clear();
+                order[i]->m_joinVersions[axis] = version;
+                if (neighbor != nullptr)
+                    JoinChunks(*order[i], *neighbor, axis);
+            }
+        }
+    });
+
+    std::vector<uint32_t> parents(nodes);
+    std::iota(parents.begin(), parents.end(), 0u);
+    for (size_t i = 0; i < order.size(); i++) {
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            for (const auto [component, other] : order[i]->m_joins[axis])
+                Unite(parents, order[i]->m_first + component, neighbors[i][sPositive[axis]]->m_first + other);
+        }
+    }
+
+    // Every root gets the next label, then the components of the chunks are merged into it.
+    m_labels.assign(nodes, sNone);
+    m_components.clear();
+    for (size_t i = 0; i < order.size(); i++) {
+        const ChunkLabels& labels = *order[i];
+        uint8_t open = 0;
+        for (const Direction direction : Directions::sAll)
+            open |= (neighbors[i][direction] == nullptr) << direction;
+
+        for (uint32_t component = 0; component < labels.m_components.size(); component++) {
+            const uint32_t root = FindRoot(parents, labels.m_first + component);
+            if (m_labels[root] == sNone) {
+                m_labels[root] = static_cast<uint32_t>(m_components.size());
+                m_components.emplace_back();
+            }
+
+            const uint32_t label = m_labels[root];
+            m_labels[labels.m_first + component] = label;
+            const Component& part = labels.m_components[component];
+            Component& whole = m_components[label];
+            whole.m_blocks += part.m_blocks;
+            whole.m_min = glm::min(whole.m_min, part.m_min);
+            whole.m_max = glm::max(whole.m_max, part.m_max);
+            whole.m_bounded &= (labels.m_faces[component] & open) == 0;
+        }
+    }
+}
+
+std::vector<ComponentLabeler::Component> ComponentLabeler::LabelNaive() const {
+    const auto isLoaded = [&](const ChunkNode* node) {
+        return node != nullptr && node->m_state != ChunkState::eEmpty;
+    };
+
+    std::vector<Component> components;
+    std::unordered_map<uint64_t, ChunkBitmap> visited;
+    std::vector<glm::ivec3> stack;
+    m_world.GetChunks().ForEach([&](const ChunkNode& start) {
+        if (!isLoaded(&start))
+            return;
+
+        for (uint32_t index = 0; index < 32768; index++) {
+            const uint8_t x = index >> 10, y = (index >> 5) & 31, z = index & 31;
+            ChunkBitmap& startVisited = visited.try_emplace(start.m_pos.Pack(), std::array<uint32_t, 1024>{}).first->second;
+            if (start.m_solid.GetBit(x, y, z) == m_settings.m_air || startVisited.GetBit(x, y, z))
+                continue;
+
+            Component& component = components.emplace_back();
+            startVisited.SetBit(x, y, z, true);
+            stack.push_back(glm::ivec3(start.m_pos.m_x * 32 + x, start.m_pos.m_y * 32 + y, start.m_pos.m_z * 32 + z));
+            while (!stack.empty()) {
+                const glm::ivec3 pos = stack.back();
+                stack.pop_back();
+                component.m_blocks++;
+                component.m_min = glm::min(component.m_min, pos);
+                component.m_max = glm::max(component.m_max, pos);
+
+                for (const Direction direction : Directions::sAll) {
+                    const glm::ivec3 next = pos + glm::ivec3(Directions::Offset(direction, 0), Directions::Offset(direction, 1), Directions::Offset(direction, 2));
+                    const ChunkPos chunk = ChunkPos::FromBlock(next.x, next.y, next.z);
+                    const ChunkNode* node = m_world.GetChunk(chunk);
+                    if (!isLoaded(node)) {
+                        component.m_bounded = false;
+                        continue;
+                    }
+
+                    const uint8_t nx = next.x & 31, ny = next.y & 31, nz = next.z & 31;
+                    ChunkBitmap& nextVisited = visited.try_emplace(chunk.Pack(), std::array<uint32_t, 1024>{}).first->second;
+                    if (node->m_solid.GetBit(nx, ny, nz) == m_settings.m_air || nextVisited.GetBit(nx, ny, nz))
+                        continue;
+
+                    nextVisited.SetBit(nx, ny, nz, true);
+                    stack.push_back(next);
+                }
+            }
+        }
+    });
+
+    return components;
+}
+
+uint32_t ComponentLabeler::GetLabel(const int32_t x, const int32_t y, const int32_t z) const {
+    const auto it = m_chunks.find(ChunkPos::FromBlock(x, y, z).Pack());
+    if (it == m_chunks.end())
+        return sNone;
+
+    const ChunkLabels& labels = it->second;
+    const uint32_t row = ((x & 31) << 5) | (y & 31);
+    for (uint32_t run = labels.m_rowRuns[row]; run < labels.m_rowRuns[row + 1]; run++) {
+        if ((labels.m_runs[run] >> (z & 31)) & 1)
+            return m_labels[labels.m_first + labels.m_runComponents[run]];
+    }
+
+    return sNone;
+}
+
+ChunkBitmap ComponentLabeler::GetMask(const ChunkPos& pos, const uint32_t label) const {
+    ChunkBitmap mask = ChunkBitmap(std::array<uint32_t, 1024>{});
+    const auto it = m_chunks.find(pos.Pack());
+    if (it == m_chunks.end())
+        return mask;
+
+    const ChunkLabels& labels = it->second;
+    for (uint32_t row = 0; row < 1024; row++) {
+        for (uint32_t run = labels.m_rowRuns[row]; run < labels.m_rowRuns[row + 1]; run++) {
+            if (m_labels[labels.m_first + labels.m_runComponents[run]] == label)
+                mask[row] |= labels.m_runs[run];
+        }
+    }
+
+    return mask;
+}
+
+void ComponentLabeler::LabelChunk(ChunkLabels& labels, const ChunkBitmap& solid) const {
+    // Rows hold at most 16 runs, so a chunk's runs fit in 16 bits.
+    std::vector<uint32_t>& runs = labels.m_runs;
+    runs.clear();
+    for (uint32_t row = 0; row < 1024; row++) {
+        labels.m_rowRuns[row] = static_cast<uint16_t>(runs.size());
+        for (uint32_t bits = m_settings.m_air ? ~solid[row] : solid[row]; bits != 0;) {
+            // Adding the lowest bit carries through the lowest run and clears it.
+            const uint32_t run = bits & ~(bits + (bits & (0u - bits)));
+            runs.push_back(run);
+            bits &= ~run;
+        }
+    }
+    labels.m_rowRuns[1024] = static_cast<uint16_t>(runs.size());
+
+    // Runs are joined to the runs they overlap in the rows before along x and y.
+    std::vector<uint16_t> parents(runs.size());
+    std::iota(parents.begin(), parents.end(), uint16_t(0));
+    const auto joinRows = [&](const uint32_t row, const uint32_t other) {
+        ForEachOverlap(runs.data(), labels.m_rowRuns[row], labels.m_rowRuns[row + 1], runs.data(), labels.m_rowRuns[other], labels.m_rowRuns[other + 1], [&](const uint32_t i, const uint32_t j) {
+            Unite(parents, static_cast<uint16_t>(i), static_cast<uint16_t>(j));
+        });
+    };
+    for (uint32_t row = 0; row < 1024; row++) {
+        if ((row & 31) > 0)
+            joinRows(row, row - 1);
+        if (row >= 32)
+            joinRows(row, row - 32);
+    }
+
+    labels.m_runComponents.assign(runs.size(), 0);
+    labels.m_components.clear();
+    labels.m_faces.clear();
+    std::vector<uint16_t> rootComponents(runs.size(), UINT16_MAX);
+    const glm::ivec3 origin = glm::ivec3(labels.m_node->m_pos.m_x, labels.m_node->m_pos.m_y, labels.m_node->m_pos.m_z) * 32;
+    for (uint32_t row = 0; row < 1024; row++) {
+        const int32_t x = static_cast<int32_t>(row >> 5), y = static_cast<int32_t>(row & 31);
+        for (uint32_t run = labels.m_rowRuns[row]; run < labels.m_rowRuns[row + 1]; run++) {
+            const uint16_t root = FindRoot(parents, static_cast<uint16_t>(run));
+            if (rootComponents[root] == UINT16_MAX) {
+                rootComponents[root] = static_cast<uint16_t>(labels.m_components.size());
+                labels.m_components.emplace_back();
+                labels.m_faces.push_back(0);
+            }
+
+            const uint16_t index = rootComponents[root];
+            labels.m_runComponents[run] = index;
+            Component& component = labels.m_components[index];
+            component.m_blocks += std::popcount(runs[run]);
+            component.m_min = glm::min(component.m_min, origin + glm::ivec3(x, y, std::countr_zero(runs[run])));
+            component.m_max = glm::max(component.m_max, origin + glm::ivec3(x, y, 31 - std::countl_zero(runs[run])));
+
+            uint8_t& faces = labels.m_faces[index];
+            faces |= (x == 0) << Direction::eNegX;
+            faces |= (x == 31) << Direction::ePosX;
+            faces |= (y == 0) << Direction::eNegY;
+            faces |= (y == 31) << Direction::ePosY;
+            faces |= (runs[run] & 1u) << Direction::eNegZ;
+            faces |= (runs[run] >> 31) << Direction::ePosZ;
+        }
+    }
+}
+
+void ComponentLabeler::JoinChunks(ChunkLabels& labels, const ChunkLabels& neighbor, const uint8_t axis) {
+    std::vector<std::pair<uint16_t, uint16_t>>& joins = labels.m_joins[axis];
+    const auto joinRows = [&](const uint32_t row, const uint32_t other) {
+        ForEachOverlap(labels.m_runs.data(), labels.m_rowRuns[row], labels.m_rowRuns[row + 1], neighbor.m_runs.data(), neighbor.m_rowRuns[other], neighbor.m_rowRuns[other + 1], [&](const uint32_t i, const uint32_t j) {
+            joins.push_back({labels.m_runComponents[i], neighbor.m_runComponents[j]});
+        });
+    };
+
+    if (axis == 0) {
+        for (uint32_t y = 0; y < 32; y++)
+            joinRows((31 << 5) | y, y);
+    } else if (axis == 1) {
+        for (uint32_t x = 0; x < 32; x++)
+            joinRows((x << 5) | 31, x << 5);
+    } else {
+        // Only the last run of the row can reach the end, and only the first one the start.
+        for (uint32_t row = 0; row < 1024; row++) {
+            const uint32_t last = labels.m_rowRuns[row + 1], first = neighbor.m_rowRuns[row];
+            if (last > labels.m_rowRuns[row] && first < neighbor.m_rowRuns[row + 1] && (labels.m_runs[last - 1] >> 31) & neighbor.m_runs[first] & 1)
+                joins.push_back({labels.m_runComponents[last - 1], neighbor.m_runComponents[first]});
+        }
+    }
+
+    // Components usually touch over many runs.
+    std::sort(joins.begin(), joins.end());
+    joins.erase(std::unique(joins.begin(), joins.end()), joins.end());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+
+class World;
+struct ChunkNode;
+
+// Labels the 6-connected components of the solid blocks, or of the air, across the loaded chunks
+// of the world. Components that don't reach past the loaded chunks are bounded: solid ones are
+// floating islands or debris, air ones are enclosed rooms.
+//
+// Every chunk is labeled on its own first. Each row of its bitmap is split into runs of set bits,
+// and runs overlapping a run of the row before along x or y are joined with union-find, so the work
+// scales with the runs instead of the blocks. The components of the chunks are then joined across
+// their faces. Chunks keep their labels until their blocks change, so labeling again after edits
+// only relabels the edited chunks and joins the much smaller graph of chunk components.
+class ComponentLabeler final {
+public:
+    struct Settings {
+        bool m_air = false; // Labels air instead of solid blocks.
+    };
+
+    struct Component {
+        uint32_t m_blocks = 0;
+        glm::ivec3 m_min = glm::ivec3(INT32_MAX); // Bounds in world coordinates, inclusive.
+        glm::ivec3 m_max = glm::ivec3(INT32_MIN);
+        bool m_bounded = true; // Doesn't touch a chunk that isn't loaded.
+    };
+
+    static constexpr uint32_t sNone = ~0u;
+
+    ComponentLabeler(const World& world, const Settings& settings) : m_world(world), m_settings(settings) {}
+
+    // Labels the loaded chunks, relabeling only the chunks whose blocks changed since the last call.
+    void Label();
+
+    // Reference flood fill over single blocks, giving the components in no particular order.
+    std::vector<Component> LabelNaive() const;
+
+    // Component of a block in world coordinates as of the last Label, sNone if it isn't in any.
+    uint32_t GetLabel(const int32_t x, const int32_t y, const int32_t z) const;
+
+    // Blocks of a component within a chunk in the xyz order.
+    ChunkBitmap GetMask(const ChunkPos& pos, const uint32_t label) const;
+
+    VXL_INLINE const std::vector<Component>& GetComponents() const noexcept {
+        return m_components;
+    }
+
+    // Chunks the last Label had to label from scratch.
+    VXL_INLINE uint32_t GetRelabeledCount() const noexcept {
+        return m_relabeled;
+    }
+private:
+    static Logger sLogger;
+
+    // Runs and components of a chunk, valid as long as its blocks weren't set since.
+    struct ChunkLabels {
+        const ChunkNode* m_node = nullptr;
+        uint64_t m_generation = 0; // See ChunkNode::m_generation.
+        uint32_t m_version = 0; // Unique across chunks, changes whenever the chunk is relabeled.
+
+        std::array<uint16_t, 1025> m_rowRuns; // First run of every row, and the end of the last.
+        std::vector<uint32_t> m_runs; // Bits of every run.
+        std::vector<uint16_t> m_runComponents; // Chunk component of every run.
+        std::vector<Component> m_components;
+        std::vector<uint8_t> m_faces; // Faces of the chunk every component touches, a bit per Direction.
+
+        // Components joined to the ones of the neighbor on the positive side of each axis, along
+        // with the version of the neighbor they were found with.
+        std::array<std::vector<std::pair<uint16_t, uint16_t>>, 3> m_joins;
+        std::array<uint32_t, 3> m_joinVersions = {};
+
+        uint32_t m_first = 0; // First node of the chunk's components in the world's union-find.
+    };
+
+    // Splits the rows of the bitmap into runs and joins them into the chunk's components.
+    void LabelChunk(ChunkLabels& labels, const ChunkBitmap& solid) const;
+
+    // Finds the components of the chunk that touch the ones of its neighbor along the axis.
+    static void JoinChunks(ChunkLabels& labels, const ChunkLabels& neighbor, const uint8_t axis);
+
+    const World& m_world;
+    Settings m_settings;
+    std::unordered_map<uint64_t, ChunkLabels> m_chunks; // Packed chunk position to its labels.
+    std::vector<uint32_t> m_labels; // Component of every chunk component, by its node.
+    std::vector<Component> m_components;
+    uint32_t m_version = 0;
+    uint32_t m_relabeled = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// The six axis-aligned directions of a voxel face or chunk neighbor. Ordered so that the opposite
+// direction is always the neighbouring value with the lowest bit flipped.
+enum Direction : uint8_t {
+    eNegX = 0,
+    ePosX = 1,
+    eNegY = 2,
+    ePosY = 3,
+    eNegZ = 4,
+    ePosZ = 5
+};
+
+// Helper functions for working with directions.
+namespace Directions {
+    // All directions in order, for range-based iteration.
+    inline constexpr std::array<Direction, 6> sAll = {
+        Direction::eNegX, Direction::ePosX,
+        Direction::eNegY, Direction::ePosY,
+        Direction::eNegZ, Direction::ePosZ
+    };
+
+    VXL_INLINE Direction Opposite(const Direction direction) noexcept {
+        return static_cast<Direction>(direction ^ 1);
+    }
+
+    // Gets the axis of the direction (0 = x, 1 = y, 2 = z).
+    VXL_INLINE uint8_t Axis(const Direction direction) noexcept {
+        return direction >> 1;
+    }
+
+    VXL_INLINE bool IsPositive(const Direction direction) noexcept {
+        return (direction & 1) != 0;
+    }
+
+    // Gets the unit offset of the direction along the given axis.
+    VXL_INLINE int32_t Offset(const Direction direction, const uint8_t axis) noexcept {
+        if (Axis(direction) != axis)
+            return 0;
+        return IsPositive(direction) ? 1 : -1;
+    }
+}
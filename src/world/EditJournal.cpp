@@ -0,0 +1,207 @@
+#include "world/EditJournal.h"
+
+#include <cstring>
+#include "util/JobSystem.h"
+#include "world/ChunkStreamer.h"
+#include "world/World.h"
+#include "world/chunk/ChunkCodec.h"
+#include "world/chunk/ChunkInterner.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+// ========== SIMD ==========
+
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+
+namespace HWY_NAMESPACE {
+namespace hw = hwy::HWY_NAMESPACE;
+
+const hw::CappedTag<uint8_t, 64> u8Tag;
+const size_t numLanes = hw::Lanes(u8Tag);
+
+// Writes the XOR of the blocks of two chunks and returns whether any of them differ. The output
+// may be either input.
+bool XorBlocksImpl(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    auto differences = hw::Zero(u8Tag);
+    for (uint32_t i = 0; i < 32768; i += numLanes) {
+        const auto xorVec = hw::Xor(hw::LoadU(u8Tag, a + i), hw::LoadU(u8Tag, b + i));
+        hw::StoreU(xorVec, u8Tag, out + i);
+        differences = hw::Or(differences, xorVec);
+    }
+
+    return !hw::AllFalse(u8Tag, hw::Ne(differences, hw::Zero(u8Tag)));
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+// ========== SIMD Wrappers ==========
+
+#if HWY_ONCE
+
+static bool XorBlocks(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    return HWY_STATIC_DISPATCH(XorBlocksImpl)(a, b, out);
+}
+
+// ========== Scalar ==========
+
+Logger EditJournal::sLogger = Logger("EditJournal");
+
+void EditJournal::Begin() {
+    m_recording = true;
+    m_snapshots.clear();
+    m_captured.clear();
+}
+
+void EditJournal::Capture(const ChunkPos& pos) {
+    if (!m_recording)
+        throw sLogger.RuntimeError("Chunks can only be captured while recording an edit!");
+
+    ChunkNode* node = m_world.GetChunk(pos);
+    if (node == nullptr || node->m_state == ChunkState::eEmpty || !m_captured.try_emplace(pos.Pack(), m_snapshots.size()).second)
+        return;
+
+    m_world.DecompressChunk(*node);
+    const EightBitChunk* chunk = dynamic_cast<const EightBitChunk*>(node->m_chunk.get());
+    if (chunk == nullptr) {
+        m_captured.erase(pos.Pack());
+        return;
+    }
+
+    Snapshot& snapshot = m_snapshots.emplace_back(Snapshot{.m_pos = pos, .m_blocks = std::make_unique<uint8_t[]>(32768)});
+    std::memcpy(snapshot.m_blocks.get(), chunk->Data(), 32768);
+}
+
+void EditJournal::Capture(const glm::ivec3& min, const glm::ivec3& max) {
+    const ChunkPos first = ChunkPos::FromBlock(min.x, min.y, min.z);
+    const ChunkPos last = ChunkPos::FromBlock(max.x, max.y, max.z);
+    for (int32_t x = first.m_x; x <= last.m_x; x++) {
+        for (int32_t y = first.m_y; y <= last.m_y; y++) {
+            for (int32_t z = first.m_z; z <= last.m_z; z++)
+                Capture({.m_x = x, .m_y = y, .m_z = z});
+        }
+    }
+}
+
+bool EditJournal::Commit() {
+    if (!m_recording)
+        throw sLogger.RuntimeError("Can't commit without recording an edit!");
+    m_recording = false;
+
+    // Looking chunks up touches the map, so the current blocks are gathered here.
+    std::vector<const uint8_t*> current(m_snapshots.size(), nullptr);
+    for (size_t i = 0; i < m_snapshots.size(); i++) {
+        ChunkNode* node = m_world.GetChunk(m_snapshots[i].m_pos);
+        if (node == nullptr)
+            continue;
+
+        m_world.DecompressChunk(*node);
+        if (const EightBitChunk* chunk = dynamic_cast<const EightBitChunk*>(node->m_chunk.get()))
+            current[i] = chunk->Data();
+    }
+
+    // Most of a delta is zero, which the codec stores as uniform rows.
+    Edit edit;
+    edit.m_deltas.resize(m_snapshots.size());
+    JobSystem::ParallelFor(static_cast<uint32_t>(m_snapshots.size()), 4, [&](uint32_t begin, uint32_t end) {
+        std::unique_ptr<EightBitChunk> difference = std::make_unique<EightBitChunk>();
+        for (uint32_t i = begin; i < end; i++) {
+            edit.m_deltas[i].m_pos = m_snapshots[i].m_pos;
+            if (current[i] == nullptr || !XorBlocks(m_snapshots[i].m_blocks.get(), current[i], difference->Data()))
+                continue;
+
+            difference->RecountPalette();
+            ChunkCodec::Encode(*difference, edit.m_deltas[i].m_data);
+            edit.m_deltas[i].m_before = ChunkInterner::Hash(m_snapshots[i].m_blocks.get());
+            edit.m_deltas[i].m_after = ChunkInterner::Hash(current[i]);
+        }
+    });
+
+    std::erase_if(edit.m_deltas, [](const Delta& delta) {
+        return delta.m_data.empty();
+    });
+    m_snapshots.clear();
+    m_captured.clear();
+    if (edit.m_deltas.empty())
+        return false;
+
+    for (const Delta& delta : edit.m_deltas)
+        edit.m_bytes += sizeof(Delta) + delta.m_data.capacity();
+
+    // A new edit replaces everything that could be redone, and pushes out the oldest ones.
+    while (m_edits.size() > m_applied) {
+        m_bytes -= m_edits.back().m_bytes;
+        m_edits.pop_back();
+    }
+    m_bytes += edit.m_bytes;
+    m_edits.push_back(std::move(edit));
+    m_applied++;
+    while (m_bytes > m_settings.m_maxBytes && m_edits.size() > 1) {
+        m_bytes -= m_edits.front().m_bytes;
+        m_edits.pop_front();
+        m_applied--;
+    }
+
+    return true;
+}
+
+bool EditJournal::Undo(ChunkStreamer* streamer) {
+    if (!CanUndo())
+        return false;
+
+    Apply(m_edits[--m_applied], true, streamer);
+    return true;
+}
+
+bool EditJournal::Redo(ChunkStreamer* streamer) {
+    if (!CanRedo())
+        return false;
+
+    Apply(m_edits[m_applied++], false, streamer);
+    return true;
+}
+
+void EditJournal::Apply(const Edit& edit, const bool undo, ChunkStreamer* streamer) {
+    std::vector<std::pair<ChunkNode*, const Delta*>> targets;
+    for (const Delta& delta : edit.m_deltas) {
+        ChunkNode* node = m_world.GetChunk(delta.m_pos);
+        if (node != nullptr && node->m_state != ChunkState::eEmpty && m_world.BeginBulkEdit(*node))
+            targets.push_back({node, &delta});
+    }
+
+    // The delta only leads to the other state from the one it was made against, anything else
+    // would come out as arbitrary blocks.
+    std::vector<uint8_t> matches(targets.size());
+    JobSystem::ParallelFor(static_cast<uint32_t>(targets.size()), 1, [&](uint32_t begin, uint32_t end) {
+        std::unique_ptr<EightBitChunk> difference = std::make_unique<EightBitChunk>();
+        for (uint32_t i = begin; i < end; i++) {
+            ChunkNode& node = *targets[i].first;
+            EightBitChunk& chunk = static_cast<EightBitChunk&>(*node.m_chunk);
+            const Delta& delta = *targets[i].second;
+            matches[i] = ChunkInterner::Hash(chunk) == (undo ? delta.m_after : delta.m_before);
+            if (!matches[i])
+                continue;
+
+            ChunkCodec::Decode(delta.m_data, *difference);
+            XorBlocks(chunk.Data(), difference->Data(), chunk.Data());
+
+            chunk.RecountPalette();
+            node.m_solid = chunk.GetBlockBitmap(BlockTypes::eAir, true);
+        }
+    });
+
+    std::vector<ChunkNode*> written;
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (matches[i])
+            written.push_back(targets[i].first);
+    }
+    m_world.EndBulkEdit(written, streamer);
+
+    const size_t skipped = targets.size() - written.size();
+    if (skipped > 0)
+        sLogger.Warning("Skipped ", skipped, " chunks that were changed outside of the journal!");
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+
+class World;
+class ChunkStreamer;
+
+// Undo and redo of edits to the world's blocks. The chunks an edit touches are captured before it
+// changes them, and committing stores the XOR of every chunk's blocks before and after, encoded
+// with ChunkCodec. Applying the same XOR again turns one state into the other, so undo and redo
+// share a single delta, and chunks are restored in parallel. Chunks that aren't resident anymore
+// are skipped, and so are chunks whose blocks were changed outside of the journal since, which
+// are recognized by a hash of the blocks the delta expects to find.
+class EditJournal final {
+public:
+    struct Settings {
+        size_t m_maxBytes = 256ull << 20; // Deltas kept, the oldest edits are dropped beyond it.
+    };
+
+    EditJournal(World& world, const Settings& settings) : m_world(world), m_settings(settings) {}
+
+    // Starts recording an edit, discarding the captures of one that was never committed.
+    void Begin();
+
+    // Remembers the blocks of a resident chunk before the edit changes them. Chunks that were
+    // already captured during the edit are ignored.
+    void Capture(const ChunkPos& pos);
+
+    // Captures every resident chunk overlapping the box of blocks, in world coordinates and inclusive.
+    void Capture(const glm::ivec3& min, const glm::ivec3& max);
+
+    // Stores the changes since the captures as a new edit and drops anything that could be redone.
+    // Returns false if no captured block changed.
+    bool Commit();
+
+    // Reverts the last committed or redone edit, queueing the changed chunks for remeshing on the
+    // streamer, which may be null. Returns false if there is none.
+    bool Undo(ChunkStreamer* streamer);
+
+    // Applies the last undone edit again, like Undo(). Returns false if there is none.
+    bool Redo(ChunkStreamer* streamer);
+
+    VXL_INLINE bool IsRecording() const noexcept {
+        return m_recording;
+    }
+
+    VXL_INLINE bool CanUndo() const noexcept {
+        return m_applied > 0;
+    }
+
+    VXL_INLINE bool CanRedo() const noexcept {
+        return m_applied < m_edits.size();
+    }
+
+    // Bytes held by the deltas of every edit.
+    VXL_INLINE size_t GetMemoryUsage() const noexcept {
+        return m_bytes;
+    }
+private:
+    static Logger sLogger;
+
+    struct Delta {
+        ChunkPos m_pos;
+        std::vector<uint8_t> m_data; // XOR of the blocks before and after.
+        uint64_t m_before = 0; // ChunkInterner::Hash() of the blocks before.
+        uint64_t m_after = 0;
+    };
+
+    struct Edit {
+        std::vector<Delta> m_deltas;
+        size_t m_bytes = 0;
+    };
+
+    struct Snapshot {
+        ChunkPos m_pos;
+        std::unique_ptr<uint8_t[]> m_blocks;
+    };
+
+    // XORs the deltas into the chunks that still hold the blocks from before or after the edit,
+    // whichever is being undone, rebuilding each chunk's palette, solid voxels and connectivity,
+    // and queues them for relighting and remeshing.
+    void Apply(const Edit& edit, const bool undo, ChunkStreamer* streamer);
+
+    World& m_world;
+    Settings m_settings;
+    std::deque<Edit> m_edits;
+    size_t m_applied = 0; // Edits before this one can be undone, the rest redone.
+    size_t m_bytes = 0;
+
+    bool m_recording = false;
+    std::vector<Snapshot> m_snapshots;
+    std::unordered_map<uint64_t, size_t> m_captured; // Packed chunk position to its snapshot.
+};
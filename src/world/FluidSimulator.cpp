@@ -0,0 +1,497 @@
+#include "world/FluidSimulator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "util/JobSystem.h"
+#include "world/ChunkStreamer.h"
+#include "world/World.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+// ========== SIMD ==========
+
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+
+namespace HWY_NAMESPACE {
+namespace hw = hwy::HWY_NAMESPACE;
+
+// Plane k of the spread sets plane k of the blocks around it, the x neighbors are 32 rows away and
+// the z neighbors a bit. The layers of the neighboring chunks fill in across the borders.
+void FlowImpl(const uint32_t* spread, const uint32_t* negX, const uint32_t* posX, const uint32_t* negZ, const uint32_t* posZ,
+    const uint32_t* feed, const uint32_t* open, uint32_t* out) {
+    const hw::ScalableTag<uint32_t> u32Tag;
+    const size_t numLanes = hw::Lanes(u32Tag);
+
+    for (uint32_t i = 0; i < 1024; i += numLanes) {
+        const auto spreadVec = hw::LoadU(u32Tag, spread + i);
+        const auto lowerX = hw::LoadU(u32Tag, i < 32 ? negX + 992 + i : spread + i - 32);
+        const auto upperX = hw::LoadU(u32Tag, i >= 992 ? posX + i - 992 : spread + i + 32);
+        const auto alongZ = hw::Or(hw::ShiftLeft<1>(spreadVec), hw::ShiftRight<1>(spreadVec));
+        const auto acrossZ = hw::Or(hw::ShiftRight<31>(hw::LoadU(u32Tag, negZ + i)), hw::ShiftLeft<31>(hw::LoadU(u32Tag, posZ + i)));
+        const auto inflow = hw::Or(hw::Or(lowerX, upperX), hw::Or(alongZ, acrossZ));
+        hw::StoreU(hw::And(hw::Or(inflow, hw::LoadU(u32Tag, feed + i)), hw::LoadU(u32Tag, open + i)), u32Tag, out + i);
+    }
+}
+
+void SpreadImpl(const uint32_t* level, const uint32_t* rests, uint32_t* out) {
+    const hw::ScalableTag<uint32_t> u32Tag;
+    const size_t numLanes = hw::Lanes(u32Tag);
+
+    for (uint32_t i = 0; i < 1024; i += numLanes)
+        hw::StoreU(hw::And(hw::LoadU(u32Tag, level + i), hw::LoadU(u32Tag, rests + i)), u32Tag, out + i);
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+// ========== SIMD Wrappers ==========
+
+#if HWY_ONCE
+
+// Stands in for the layers of neighbors without fluid.
+static const std::array<uint32_t, 1024> sNone{};
+
+static const uint32_t* GetData(const ChunkBitmap* bitmap) {
+    return bitmap != nullptr ? bitmap->Data() : sNone.data();
+}
+
+// ========== Scalar ==========
+
+Logger FluidSimulator::sLogger = Logger("FluidSimulator");
+
+static void Clear(ChunkBitmap& bitmap) {
+    std::fill_n(bitmap.Data(), 1024, 0u);
+}
+
+static bool IsEmpty(const ChunkBitmap& bitmap) {
+    return std::all_of(bitmap.Data(), bitmap.Data() + 1024, [](const uint32_t row) {
+        return row == 0;
+    });
+}
+
+// Whether any bit of the bitmap lies on the given side of the chunk.
+static bool TouchesFace(const ChunkBitmap& bitmap, const Direction face) {
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < 32; i++) {
+        for (uint32_t j = 0; j < 32; j++) {
+            switch (face) {
+                case Direction::eNegX: bits |= bitmap[(i << 5) | j] & (i == 0 ? ~0u : 0u); break;
+                case Direction::ePosX: bits |= bitmap[(i << 5) | j] & (i == 31 ? ~0u : 0u); break;
+                case Direction::eNegY: bits |= bitmap[(i << 5) | j] & (j == 0 ? ~0u : 0u); break;
+                case Direction::ePosY: bits |= bitmap[(i << 5) | j] & (j == 31 ? ~0u : 0u); break;
+                case Direction::eNegZ: bits |= bitmap[(i << 5) | j] & 1u; break;
+                case Direction::ePosZ: bits |= bitmap[(i << 5) | j] & (1u << 31); break;
+            }
+        }
+    }
+
+    return bits != 0;
+}
+
+bool FluidSimulator::AddSource(const int32_t x, const int32_t y, const int32_t z) {
+    const ChunkPos pos = ChunkPos::FromBlock(x, y, z);
+    if (m_world.GetChunk(pos) == nullptr || m_world.GetBlock(x, y, z) != BlockTypes::eAir)
+        return false;
+
+    FluidChunk* fluid = Acquire(pos);
+    if (fluid == nullptr)
+        return false;
+
+    fluid->m_sources.SetBit(x & 31, y & 31, z & 31, true);
+    for (ChunkBitmap& level : fluid->m_levels)
+        level.SetBit(x & 31, y & 31, z & 31, true);
+    m_world.SetBlock(m_settings.m_block, x, y, z);
+    Activate(pos);
+    return true;
+}
+
+bool FluidSimulator::RemoveSource(const int32_t x, const int32_t y, const int32_t z) {
+    const ChunkPos pos = ChunkPos::FromBlock(x, y, z);
+    const auto it = m_chunks.find(pos.Pack());
+    if (it == m_chunks.end() || !it->second.m_sources.GetBit(x & 31, y & 31, z & 31))
+        return false;
+
+    it->second.m_sources.SetBit(x & 31, y & 31, z & 31, false);
+    Activate(pos);
+    return true;
+}
+
+void FluidSimulator::Wake(const ChunkPos& pos) {
+    if (Acquire(pos) != nullptr)
+        Activate(pos);
+}
+
+void FluidSimulator::Update(ChunkStreamer* streamer) {
+    if (++m_frame >= m_settings.m_interval) {
+        m_frame = 0;
+        Step(streamer);
+    }
+}
+
+uint32_t FluidSimulator::Step(ChunkStreamer* streamer) {
+    // Chunks that were unloaded take their fluid with them.
+    std::erase_if(m_chunks, [&](const auto& entry) {
+        const ChunkNode* node = m_world.GetChunk(ChunkPos::Unpack(entry.first));
+        return node == nullptr || node->m_state == ChunkState::eEmpty;
+    });
+
+    // Stepped chunks come first, followed by the neighbors they read the borders of.
+    std::unordered_map<uint64_t, int32_t> indices;
+    m_work.clear();
+    for (auto& [key, fluid] : m_chunks) {
+        if (!fluid.m_active)
+            continue;
+
+        indices[key] = static_cast<int32_t>(m_work.size());
+        Work& work = m_work.emplace_back();
+        work.m_pos = ChunkPos::Unpack(key);
+        work.m_fluid = &fluid;
+        work.m_stepped = true;
+    }
+    const size_t stepped = m_work.size();
+    if (stepped == 0)
+        return 0;
+
+    for (size_t i = 0; i < stepped; i++) {
+        for (const Direction direction : Directions::sAll) {
+            const ChunkPos pos = m_work[i].m_pos.Offset(direction);
+            const auto it = m_chunks.find(pos.Pack());
+            if (it == m_chunks.end() || !indices.try_emplace(pos.Pack(), static_cast<int32_t>(m_work.size())).second)
+                continue;
+
+            Work& work = m_work.emplace_back();
+            work.m_pos = pos;
+            work.m_fluid = &it->second;
+        }
+    }
+
+    // Decompressing isn't thread safe.
+    for (Work& work : m_work) {
+        work.m_node = m_world.GetChunk(work.m_pos);
+        work.m_changed = false;
+        work.m_written = false;
+        for (const Direction direction : Directions::sAll) {
+            const auto it = indices.find(work.m_pos.Offset(direction).Pack());
+            work.m_neighbors[direction] = it != indices.end() ? it->second : -1;
+        }
+
+        if (work.m_stepped) {
+            m_world.DecompressChunk(*work.m_node);
+            work.m_stepped = dynamic_cast<const EightBitChunk*>(work.m_node->m_chunk.get()) != nullptr;
+        }
+    }
+
+    JobSystem::ParallelFor(static_cast<uint32_t>(stepped), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            if (m_work[i].m_stepped)
+                Reconcile(m_work[i]);
+        }
+    });
+    JobSystem::ParallelFor(static_cast<uint32_t>(m_work.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            Support(m_work[i]);
+    });
+    JobSystem::ParallelFor(static_cast<uint32_t>(stepped), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            if (m_work[i].m_stepped)
+                Flow(m_work[i]);
+        }
+    });
+
+    for (size_t i = 0; i < stepped; i++) {
+        if (m_work[i].m_written)
+            m_world.BeginBulkEdit(*m_work[i].m_node);
+    }
+    JobSystem::ParallelFor(static_cast<uint32_t>(stepped), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            if (m_work[i].m_stepped)
+                WriteBack(m_work[i]);
+        }
+    });
+
+    for (size_t i = 0; i < stepped; i++)
+        m_work[i].m_fluid->m_active = false;
+    std::vector<ChunkNode*> written;
+    for (size_t i = 0; i < stepped; i++) {
+        Work& work = m_work[i];
+        if (work.m_changed) {
+            Activate(work.m_pos);
+        } else if (IsEmpty(work.m_fluid->m_levels[0])) {
+            m_chunks.erase(work.m_pos.Pack());
+            continue;
+        }
+
+        if (!work.m_written)
+            continue;
+
+        ChunkNode* node = work.m_node;
+        written.push_back(node);
+        if (node->m_light == nullptr)
+            continue;
+
+        const int32_t baseX = node->m_pos.m_x * 32, baseY = node->m_pos.m_y * 32, baseZ = node->m_pos.m_z * 32;
+        for (uint32_t row = 0; row < 1024; row++) {
+            const int32_t x = baseX + static_cast<int32_t>(row >> 5), y = baseY + static_cast<int32_t>(row & 31);
+            for (uint32_t bits = work.m_added[row]; bits != 0; bits &= bits - 1)
+                m_world.GetLight().QueueChange(x, y, baseZ + std::countr_zero(bits), BlockTypes::eAir, m_settings.m_block);
+            for (uint32_t bits = work.m_removed[row]; bits != 0; bits &= bits - 1)
+                m_world.GetLight().QueueChange(x, y, baseZ + std::countr_zero(bits), m_settings.m_block, BlockTypes::eAir);
+        }
+    }
+    m_world.EndBulkEdit(written, streamer, false);
+
+    return static_cast<uint32_t>(stepped);
+}
+
+uint32_t FluidSimulator::StepNaive() {
+    std::erase_if(m_chunks, [&](const auto& entry) {
+        const ChunkNode* node = m_world.GetChunk(ChunkPos::Unpack(entry.first));
+        return node == nullptr || node->m_state == ChunkState::eEmpty;
+    });
+
+    const auto isSource = [&](const int32_t x, const int32_t y, const int32_t z) {
+        const auto it = m_chunks.find(ChunkPos::FromBlock(x, y, z).Pack());
+        return it != m_chunks.end() && it->second.m_sources.GetBit(x & 31, y & 31, z & 31);
+    };
+    const auto isResident = [&](const int32_t x, const int32_t y, const int32_t z) {
+        const ChunkNode* node = m_world.GetChunk(ChunkPos::FromBlock(x, y, z));
+        return node != nullptr && node->m_state != ChunkState::eEmpty;
+    };
+
+    // Blocks of the fluid follow the world, and those without a level become sources.
+    for (auto& [key, fluid] : m_chunks) {
+        const ChunkPos pos = ChunkPos::Unpack(key);
+        for (int32_t x = 0; x < 32; x++) {
+            for (int32_t y = 0; y < 32; y++) {
+                for (int32_t z = 0; z < 32; z++) {
+                    const bool present = m_world.GetBlock(pos.m_x * 32 + x, pos.m_y * 32 + y, pos.m_z * 32 + z) == m_settings.m_block;
+                    const bool source = present && (fluid.m_sources.GetBit(x, y, z) || !fluid.m_levels[0].GetBit(x, y, z));
+                    fluid.m_sources.SetBit(x, y, z, source);
+                    for (ChunkBitmap& level : fluid.m_levels)
+                        level.SetBit(x, y, z, source || (present && level.GetBit(x, y, z)));
+                }
+            }
+        }
+    }
+
+    // Every chunk with fluid and the resident chunks around it.
+    std::vector<ChunkPos> positions;
+    std::unordered_map<uint64_t, std::vector<uint8_t>> levels;
+    for (const auto& [key, fluid] : m_chunks) {
+        for (uint32_t i = 0; i <= Directions::sAll.size(); i++) {
+            const ChunkPos pos = i == 0 ? ChunkPos::Unpack(key) : ChunkPos::Unpack(key).Offset(Directions::sAll[i - 1]);
+            if (isResident(pos.m_x * 32, pos.m_y * 32, pos.m_z * 32) && levels.try_emplace(pos.Pack(), 32768).second)
+                positions.push_back(pos);
+        }
+    }
+
+    for (const ChunkPos& pos : positions) {
+        std::vector<uint8_t>& next = levels[pos.Pack()];
+        for (int32_t x = 0; x < 32; x++) {
+            for (int32_t y = 0; y < 32; y++) {
+                for (int32_t z = 0; z < 32; z++) {
+                    const int32_t wx = pos.m_x * 32 + x, wy = pos.m_y * 32 + y, wz = pos.m_z * 32 + z;
+                    const uint16_t block = m_world.GetBlock(wx, wy, wz);
+                    if (block != BlockTypes::eAir && block != m_settings.m_block)
+                        continue;
+                    if (isSource(wx, wy, wz) || GetLevel(wx, wy + 1, wz) > 0) {
+                        next[(x << 10) | (y << 5) | z] = sMaxLevel;
+                        continue;
+                    }
+
+                    uint8_t level = 0;
+                    for (const auto [dx, dz] : {std::pair(-1, 0), std::pair(1, 0), std::pair(0, -1), std::pair(0, 1)}) {
+                        const uint8_t neighbor = GetLevel(wx + dx, wy, wz + dz);
+                        if (neighbor < 2)
+                            continue;
+
+                        // Fluid spreads over anything but air and falling fluid, and stops at chunks that aren't resident.
+                        const bool falling = GetLevel(wx + dx, wy - 1, wz + dz) == sMaxLevel && !isSource(wx + dx, wy - 1, wz + dz);
+                        if (!isResident(wx + dx, wy - 1, wz + dz) || (m_world.GetBlock(wx + dx, wy - 1, wz + dz) != BlockTypes::eAir && !falling))
+                            level = std::max<uint8_t>(level, neighbor - 1);
+                    }
+                    next[(x << 10) | (y << 5) | z] = level;
+                }
+            }
+        }
+    }
+
+    for (const ChunkPos& pos : positions) {
+        const std::vector<uint8_t>& next = levels[pos.Pack()];
+        if (!m_chunks.contains(pos.Pack()) && std::all_of(next.begin(), next.end(), [](const uint8_t level) { return level == 0; }))
+            continue;
+
+        FluidChunk* fluid = Acquire(pos);
+        for (int32_t x = 0; x < 32; x++) {
+            for (int32_t y = 0; y < 32; y++) {
+                for (int32_t z = 0; z < 32; z++) {
+                    const uint8_t level = next[(x << 10) | (y << 5) | z];
+                    if ((level > 0) != fluid->m_levels[0].GetBit(x, y, z))
+                        m_world.SetBlock(level > 0 ? m_settings.m_block : BlockTypes::eAir, pos.m_x * 32 + x, pos.m_y * 32 + y, pos.m_z * 32 + z);
+                    for (uint32_t k = 0; k < sMaxLevel; k++)
+                        fluid->m_levels[k].SetBit(x, y, z, level > k);
+                }
+            }
+        }
+    }
+
+    std::erase_if(m_chunks, [](const auto& entry) {
+        return IsEmpty(entry.second.m_levels[0]);
+    });
+    return static_cast<uint32_t>(positions.size());
+}
+
+uint8_t FluidSimulator::GetLevel(const int32_t x, const int32_t y, const int32_t z) const {
+    const auto it = m_chunks.find(ChunkPos::FromBlock(x, y, z).Pack());
+    if (it == m_chunks.end())
+        return 0;
+
+    uint8_t level = 0;
+    for (const ChunkBitmap& plane : it->second.m_levels)
+        level += plane.GetBit(x & 31, y & 31, z & 31);
+    return level;
+}
+
+size_t FluidSimulator::GetActiveCount() const {
+    return std::count_if(m_chunks.begin(), m_chunks.end(), [](const auto& entry) {
+        return entry.second.m_active;
+    });
+}
+
+FluidSimulator::FluidChunk* FluidSimulator::Acquire(const ChunkPos& pos) {
+    const ChunkNode* node = m_world.GetChunk(pos);
+    if (node == nullptr || node->m_state == ChunkState::eEmpty)
+        return nullptr;
+
+    const auto [it, inserted] = m_chunks.try_emplace(pos.Pack());
+    if (inserted) {
+        for (ChunkBitmap& level : it->second.m_levels)
+            Clear(level);
+        Clear(it->second.m_sources);
+    }
+    return &it->second;
+}
+
+void FluidSimulator::Activate(const ChunkPos& pos) {
+    const auto it = m_chunks.find(pos.Pack());
+    if (it == m_chunks.end())
+        return;
+    it->second.m_active = true;
+
+    // Fluid never flows up, and only into the neighbors it touches.
+    for (const Direction direction : Directions::sAll) {
+        const auto neighbor = m_chunks.find(pos.Offset(direction).Pack());
+        if (neighbor != m_chunks.end())
+            neighbor->second.m_active = true;
+        else if (direction != Direction::ePosY && TouchesFace(it->second.m_levels[0], direction) && Acquire(pos.Offset(direction)) != nullptr)
+            m_chunks.at(pos.Offset(direction).Pack()).m_active = true;
+    }
+}
+
+void FluidSimulator::Reconcile(Work& work) {
+    const EightBitChunk& chunk = static_cast<const EightBitChunk&>(*work.m_node->m_chunk);
+    const ChunkBitmap present = chunk.GetBlockBitmap(static_cast<BlockTypes>(m_settings.m_block));
+
+    FluidChunk& fluid = *work.m_fluid;
+    for (uint32_t row = 0; row < 1024; row++) {
+        const uint32_t sources = (fluid.m_sources[row] | ~fluid.m_levels[0][row]) & present[row];
+        work.m_changed |= sources != fluid.m_sources[row];
+        fluid.m_sources[row] = sources;
+        for (ChunkBitmap& level : fluid.m_levels) {
+            const uint32_t bits = (level[row] & present[row]) | sources;
+            work.m_changed |= bits != level[row];
+            level[row] = bits;
+        }
+
+        work.m_open[row] = ~work.m_node->m_solid[row] | present[row];
+    }
+}
+
+void FluidSimulator::Support(Work& work) {
+    const FluidChunk& fluid = *work.m_fluid;
+    const ChunkNode* below = work.m_node->GetNeighbor(Direction::eNegY);
+    const auto belowIt = m_chunks.find(work.m_pos.Offset(Direction::eNegY).Pack());
+    const FluidChunk* belowFluid = belowIt != m_chunks.end() ? &belowIt->second : nullptr;
+
+    // Blocks rest on the one below unless it's air or falling fluid. Chunks that aren't resident hold
+    // everything up.
+    ChunkBitmap rests;
+    for (uint32_t x = 0; x < 32; x++) {
+        for (uint32_t y = 0; y < 32; y++) {
+            const uint32_t row = (x << 5) | y;
+            if (y > 0) {
+                rests[row] = work.m_node->m_solid[row - 1] & ~(fluid.m_levels[sMaxLevel - 1][row - 1] & ~fluid.m_sources[row - 1]);
+            } else if (below == nullptr || below->m_state == ChunkState::eEmpty) {
+                rests[row] = ~0u;
+            } else {
+                const uint32_t top = (x << 5) | 31;
+                const uint32_t falling = belowFluid != nullptr ? belowFluid->m_levels[sMaxLevel - 1][top] & ~belowFluid->m_sources[top] : 0;
+                rests[row] = below->m_solid[top] & ~falling;
+            }
+        }
+    }
+
+    for (uint32_t k = 0; k < sMaxLevel - 1; k++)
+        HWY_STATIC_DISPATCH(SpreadImpl)(fluid.m_levels[k + 1].Data(), rests.Data(), work.m_spread[k].Data());
+}
+
+void FluidSimulator::Flow(Work& work) {
+    const FluidChunk& fluid = *work.m_fluid;
+    const auto aboveIt = m_chunks.find(work.m_pos.Offset(Direction::ePosY).Pack());
+    const FluidChunk* aboveFluid = aboveIt != m_chunks.end() ? &aboveIt->second : nullptr;
+
+    // Sources and blocks below fluid are at the full level.
+    for (uint32_t x = 0; x < 32; x++) {
+        for (uint32_t y = 0; y < 32; y++) {
+            const uint32_t row = (x << 5) | y;
+            const uint32_t above = y < 31 ? fluid.m_levels[0][row + 1] : aboveFluid != nullptr ? aboveFluid->m_levels[0][x << 5] : 0;
+            work.m_feed[row] = fluid.m_sources[row] | above;
+        }
+    }
+
+    const auto getSpread = [&](const Direction direction, const uint32_t k) -> const ChunkBitmap* {
+        const int32_t neighbor = work.m_neighbors[direction];
+        return neighbor >= 0 && k < sMaxLevel - 1 ? &m_work[neighbor].m_spread[k] : nullptr;
+    };
+    for (uint32_t k = 0; k < sMaxLevel; k++) {
+        HWY_STATIC_DISPATCH(FlowImpl)(GetData(k < sMaxLevel - 1 ? &work.m_spread[k] : nullptr),
+            GetData(getSpread(Direction::eNegX, k)), GetData(getSpread(Direction::ePosX, k)),
+            GetData(getSpread(Direction::eNegZ, k)), GetData(getSpread(Direction::ePosZ, k)),
+            work.m_feed.Data(), work.m_open.Data(), work.m_next[k].Data());
+        work.m_changed |= std::memcmp(work.m_next[k].Data(), fluid.m_levels[k].Data(), 1024 * sizeof(uint32_t)) != 0;
+    }
+    work.m_written = std::memcmp(work.m_next[0].Data(), fluid.m_levels[0].Data(), 1024 * sizeof(uint32_t)) != 0;
+}
+
+void FluidSimulator::WriteBack(Work& work) {
+    FluidChunk& fluid = *work.m_fluid;
+    if (work.m_written) {
+        ChunkNode& node = *work.m_node;
+        EightBitChunk& chunk = static_cast<EightBitChunk&>(*node.m_chunk);
+        ChunkBitmap& added = work.m_added;
+        ChunkBitmap& removed = work.m_removed;
+        for (uint32_t row = 0; row < 1024; row++) {
+            added[row] = work.m_next[0][row] & ~fluid.m_levels[0][row];
+            removed[row] = fluid.m_levels[0][row] & ~work.m_next[0][row];
+            node.m_solid[row] = (node.m_solid[row] | added[row]) & ~removed[row];
+        }
+        chunk.FillMasked(added, static_cast<uint8_t>(m_settings.m_block));
+        chunk.FillMasked(removed, BlockTypes::eAir);
+
+        std::array<uint16_t, 64> types;
+        size_t numTypes = 0;
+        for (uint16_t type = 0; type < 64; type++) {
+            if (chunk.m_blockPaletteCounts[type] != 0 || type == m_settings.m_block || type == BlockTypes::eAir)
+                types[numTypes++] = type;
+        }
+        if (!chunk.RecountPalette(types.data(), numTypes))
+            chunk.RecountPalette();
+    }
+
+    fluid.m_levels = work.m_next;
+}
+
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/Block.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+
+class World;
+class ChunkStreamer;
+struct ChunkNode;
+
+// Flowing fluid of one block type as a cellular automaton on bitmaps. Levels go from 1 to
+// sMaxLevel and are stored in thermometer form, one bitmap per level, so that the highest level
+// among a block's neighbors is the OR of their bitmaps and a whole chunk flows with a few shifts
+// and masks per level. Each step, a block is at the full level if it's a source or fluid is above
+// it, and one level below its highest sideways neighbor otherwise. Only fluid that rests on
+// something other than falling fluid spreads sideways.
+//
+// Only chunks whose fluid or neighbors changed are stepped, in parallel, in two passes so that
+// each chunk reads the borders its neighbors computed in the first. Blocks are written back to the
+// world and relit one by one, as a step only changes the edge of the fluid, and chunks that aren't
+// resident stop the fluid.
+class FluidSimulator final {
+public:
+    struct Settings {
+        uint16_t m_block = BlockTypes::eWater;
+        uint32_t m_interval = 5; // Frames between steps, see Update().
+    };
+
+    static constexpr uint32_t sMaxLevel = 7;
+
+    FluidSimulator(World& world, const Settings& settings) : m_world(world), m_settings(settings) {}
+
+    // Places a source that keeps the fluid at its full level. Returns false if the chunk isn't
+    // resident or the block isn't air.
+    bool AddSource(const int32_t x, const int32_t y, const int32_t z);
+
+    // Removes a source, the fluid it fed drains over the following steps. Returns false if there
+    // was no source.
+    bool RemoveSource(const int32_t x, const int32_t y, const int32_t z);
+
+    // Simulates a resident chunk again after its blocks were edited. Blocks of the fluid that have
+    // no level yet, like those loaded from storage, become sources.
+    void Wake(const ChunkPos& pos);
+
+    // Steps once every interval frames.
+    void Update(ChunkStreamer* streamer);
+
+    // Advances the fluid by one step, queueing the chunks it wrote to for remeshing on the streamer,
+    // which may be null. Returns the number of chunks that were stepped.
+    uint32_t Step(ChunkStreamer* streamer);
+
+    // Reference step going through every block of the chunks with fluid and their neighbors.
+    uint32_t StepNaive();
+
+    // Level of the fluid at a block in world coordinates, 0 if there is none.
+    uint8_t GetLevel(const int32_t x, const int32_t y, const int32_t z) const;
+
+    VXL_INLINE size_t GetChunkCount() const noexcept {
+        return m_chunks.size();
+    }
+
+    // Chunks that will be stepped next.
+    size_t GetActiveCount() const;
+private:
+    static Logger sLogger;
+
+    struct FluidChunk {
+        std::array<ChunkBitmap, sMaxLevel> m_levels; // Plane k is set where the level is above k.
+        ChunkBitmap m_sources;
+        bool m_active = true;
+    };
+
+    // State of a chunk during a step. Neighbors only read it between the passes.
+    struct Work {
+        ChunkPos m_pos;
+        FluidChunk* m_fluid = nullptr;
+        ChunkNode* m_node = nullptr;
+        bool m_stepped = false; // Neighbors of stepped chunks only run the first pass.
+        bool m_changed = false; // Levels or sources changed, so the neighbors step next.
+        bool m_written = false; // Blocks of the fluid appeared or drained.
+        std::array<int32_t, 6> m_neighbors; // Index of the neighbor's work, or -1.
+
+        ChunkBitmap m_open; // Blocks the fluid may take.
+        ChunkBitmap m_feed; // Blocks at the full level.
+        std::array<ChunkBitmap, sMaxLevel - 1> m_spread; // Plane k is set where the level above k + 1 spreads.
+        std::array<ChunkBitmap, sMaxLevel> m_next;
+        ChunkBitmap m_added, m_removed; // Blocks of the fluid written back.
+    };
+
+    // Gets the fluid of a resident chunk, creating it if there's none. Returns null if the chunk
+    // isn't resident.
+    FluidChunk* Acquire(const ChunkPos& pos);
+
+    // Steps the chunk and its neighbors next, creating those the fluid reaches.
+    void Activate(const ChunkPos& pos);
+
+    // Syncs the levels with the blocks of the chunk and finds where the fluid may flow.
+    void Reconcile(Work& work);
+
+    // First pass, where the fluid of the chunk rests on something it can spread over.
+    void Support(Work& work);
+
+    // Second pass, the new levels from the chunk and its neighbors.
+    void Flow(Work& work);
+
+    // Writes the fluid's blocks where the presence changed, and swaps in the new levels.
+    void WriteBack(Work& work);
+
+    World& m_world;
+    Settings m_settings;
+    uint32_t m_frame = 0;
+    std::unordered_map<uint64_t, FluidChunk> m_chunks; // Packed chunk position to its fluid.
+    std::vector<Work> m_work;
+};
@@ -0,0 +1,334 @@
+#include "world/LightEngine.h"
+
+#include <algorithm>
+#include <bit>
+#include "world/Block.h"
+#include "world/World.h"
+
+Logger LightEngine::sLogger = Logger("LightEngine");
+
+// Moves from a block to its neighbor in the direction, crossing into the neighboring chunk at the
+// border. Returns false if the neighbor's chunk isn't resident or lit.
+static bool Step(ChunkNode*& node, uint16_t& index, const Direction direction) {
+    const uint32_t shift = 10 - Directions::Axis(direction) * 5;
+    const uint32_t coord = (index >> shift) & 31;
+    if (coord == (Directions::IsPositive(direction) ? 31u : 0u)) {
+        node = node->GetNeighbor(direction);
+        if (node == nullptr || node->m_light == nullptr)
+            return false;
+        index ^= 31 << shift; // 0 and 31 swap.
+        return true;
+    }
+
+    index = Directions::IsPositive(direction) ? index + (1 << shift) : index - (1 << shift);
+    return true;
+}
+
+static bool IsSolid(const ChunkNode& node, const uint16_t index) {
+    return (node.m_solid[index >> 5] >> (index & 31)) & 1;
+}
+
+// Index of the block at (a, b) on the face, a and b being the other two axes in xyz order.
+static uint16_t FaceIndex(const Direction face, const uint32_t a, const uint32_t b) {
+    const uint32_t coord = Directions::IsPositive(face) ? 31 : 0;
+    switch (Directions::Axis(face)) {
+        case 0: return (coord << 10) | (a << 5) | b;
+        case 1: return (a << 10) | (coord << 5) | b;
+        default: return (a << 10) | (b << 5) | coord;
+    }
+}
+
+void LightEngine::QueueChunk(const ChunkPos& pos) {
+    m_pendingChunks.push_back(pos);
+}
+
+void LightEngine::RelightChunk(const ChunkPos& pos) {
+    m_relitChunks.push_back(pos);
+}
+
+void LightEngine::QueueChange(const int32_t x, const int32_t y, const int32_t z, const uint16_t oldBlock, const uint16_t newBlock) {
+    if (oldBlock != newBlock)
+        m_changes.push_back({.m_x = x, .m_y = y, .m_z = z, .m_oldBlock = oldBlock, .m_newBlock = newBlock});
+}
+
+void LightEngine::Update() {
+    if (!HasPending())
+        return;
+
+    // Light that relit chunks fed into their neighbors goes before anything is lit again, so that
+    // it doesn't shine back in through their faces.
+    for (const ChunkPos& pos : m_relitChunks) {
+        ChunkNode* node = m_world.GetChunk(pos);
+        if (node == nullptr || node->m_state == ChunkState::eEmpty || node->m_light == nullptr)
+            continue;
+
+        ClearChunk(*node);
+        m_pendingChunks.push_back(pos);
+    }
+    m_relitChunks.clear();
+    for (const ChunkLight::Channel channel : {ChunkLight::eSky, ChunkLight::eBlock})
+        RunRemovals(channel);
+
+    // Chunks above light first, so the ones below start from their sky light instead of fixing it up.
+    std::sort(m_pendingChunks.begin(), m_pendingChunks.end(), [](const ChunkPos& a, const ChunkPos& b) {
+        return a.m_y > b.m_y;
+    });
+    for (const ChunkPos& pos : m_pendingChunks) {
+        ChunkNode* node = m_world.GetChunk(pos);
+        if (node != nullptr && node->m_state != ChunkState::eEmpty)
+            LightChunk(*node);
+    }
+    m_pendingChunks.clear();
+
+    for (const Change& change : m_changes)
+        ApplyChange(change);
+    m_changes.clear();
+
+    for (const ChunkLight::Channel channel : {ChunkLight::eSky, ChunkLight::eBlock}) {
+        RunRemovals(channel);
+        RunAdditions(channel);
+    }
+}
+
+void LightEngine::Relight() {
+    m_changes.clear();
+    m_pendingChunks.clear();
+    m_relitChunks.clear();
+    m_world.GetChunks().ForEach([&](ChunkNode& node) {
+        node.m_light.reset();
+        if (node.m_state != ChunkState::eEmpty)
+            m_pendingChunks.push_back(node.m_pos);
+    });
+
+    Update();
+}
+
+uint8_t LightEngine::GetLight(const int32_t x, const int32_t y, const int32_t z, const ChunkLight::Channel channel) const {
+    const ChunkNode* node = m_world.GetChunk(ChunkPos::FromBlock(x, y, z));
+    if (node == nullptr || node->m_light == nullptr)
+        return 0;
+
+    return node->m_light->Get(static_cast<uint16_t>(((x & 31) << 10) | ((y & 31) << 5) | (z & 31)), channel);
+}
+
+void LightEngine::LightChunk(ChunkNode& node) {
+    if (node.m_light == nullptr)
+        node.m_light = std::make_unique<ChunkLight>();
+    else
+        node.m_light->m_levels.fill(0);
+    ChunkLight& light = *node.m_light;
+    std::vector<Entry>& skyAdditions = m_additions[ChunkLight::eSky];
+    std::vector<Entry>& blockAdditions = m_additions[ChunkLight::eBlock];
+
+    // Full sky light falls down every column until the first solid block, a row of 32 columns at a
+    // time. Columns are open at the top unless a lit chunk above has already blocked them.
+    const ChunkNode* above = node.GetNeighbor(Direction::ePosY);
+    const bool covered = above != nullptr && above->m_light != nullptr;
+    std::array<uint32_t, 1024> lit;
+    for (uint32_t x = 0; x < 32; x++) {
+        uint32_t open = ~0u;
+        if (covered) {
+            open = 0;
+            for (uint32_t z = 0; z < 32; z++)
+                open |= static_cast<uint32_t>(above->m_light->Get(static_cast<uint16_t>((x << 10) | z), ChunkLight::eSky) == sMaxLevel) << z;
+        }
+
+        for (uint32_t y = 32; y-- > 0;) {
+            const uint32_t row = (x << 5) | y;
+            open &= ~node.m_solid[row];
+            lit[row] = open;
+            for (uint32_t bits = open; bits != 0; bits &= bits - 1)
+                light.m_levels[(row << 5) | std::countr_zero(bits)] = sMaxLevel << 4;
+        }
+    }
+
+    // Only lit blocks next to an unlit column spread sideways, which are the ones on the edge of
+    // their row's runs and those whose neighboring rows along x are darker. Blocks on the border of
+    // the chunk always spread, into the neighbors and down into the chunk below.
+    ChunkNode* below = node.GetNeighbor(Direction::eNegY);
+    for (uint32_t row = 0; row < 1024; row++) {
+        const uint32_t x = row >> 5;
+        uint32_t interior = lit[row] & (lit[row] << 1) & (lit[row] >> 1);
+        interior &= x > 0 ? lit[row - 32] : 0;
+        interior &= x < 31 ? lit[row + 32] : 0;
+        if ((row & 31) == 0 && below != nullptr)
+            interior = 0;
+
+        for (uint32_t bits = lit[row] & ~interior; bits != 0; bits &= bits - 1)
+            skyAdditions.push_back({.m_node = &node, .m_index = static_cast<uint16_t>((row << 5) | std::countr_zero(bits)), .m_level = sMaxLevel});
+    }
+
+    // A chunk below that was lit before this one assumed open sky above it, which this chunk may block.
+    if (below != nullptr && below->m_light != nullptr) {
+        for (uint32_t x = 0; x < 32; x++) {
+            const uint32_t blocked = ~lit[x << 5];
+            for (uint32_t z = 0; z < 32; z++) {
+                const uint16_t index = static_cast<uint16_t>((x << 10) | (31 << 5) | z);
+                if (((blocked >> z) & 1) && below->m_light->Get(index, ChunkLight::eSky) == sMaxLevel) {
+                    below->m_light->Set(index, ChunkLight::eSky, 0);
+                    m_removals[ChunkLight::eSky].push_back({.m_node = below, .m_index = index, .m_level = sMaxLevel});
+                }
+            }
+        }
+    }
+
+    // Emitters are rare, so only the block types the palette holds are looked for.
+    m_world.DecompressChunk(node);
+    for (uint16_t block = 0; block < node.m_chunk->m_blockPaletteCounts.size(); block++) {
+        const uint8_t emission = GetBlockEmission(block);
+        if (emission == 0 || node.m_chunk->m_blockPaletteCounts[block] == 0)
+            continue;
+
+        const ChunkBitmap emitters = node.m_chunk->GetBlockBitmap(static_cast<BlockTypes>(block));
+        for (uint32_t row = 0; row < 1024; row++) {
+            for (uint32_t bits = emitters[row]; bits != 0; bits &= bits - 1) {
+                const uint16_t index = static_cast<uint16_t>((row << 5) | std::countr_zero(bits));
+                light.Set(index, ChunkLight::eBlock, emission);
+                blockAdditions.push_back({.m_node = &node, .m_index = index, .m_level = emission});
+            }
+        }
+    }
+
+    // Lit neighbors shine in through their faces towards this chunk.
+    for (const Direction direction : Directions::sAll) {
+        ChunkNode* neighbor = node.GetNeighbor(direction);
+        if (neighbor == nullptr || neighbor->m_light == nullptr)
+            continue;
+
+        const Direction face = Directions::Opposite(direction);
+        for (uint32_t a = 0; a < 32; a++) {
+            for (uint32_t b = 0; b < 32; b++) {
+                const uint16_t index = FaceIndex(face, a, b);
+                if (neighbor->m_light->Get(index, ChunkLight::eSky) > 1)
+                    skyAdditions.push_back({.m_node = neighbor, .m_index = index, .m_level = 0});
+                if (neighbor->m_light->Get(index, ChunkLight::eBlock) > 1)
+                    blockAdditions.push_back({.m_node = neighbor, .m_index = index, .m_level = 0});
+            }
+        }
+    }
+}
+
+void LightEngine::ClearChunk(ChunkNode& node) {
+    ChunkLight& light = *node.m_light;
+    for (const Direction face : Directions::sAll) {
+        for (uint32_t a = 0; a < 32; a++) {
+            for (uint32_t b = 0; b < 32; b++) {
+                const uint16_t index = FaceIndex(face, a, b);
+                for (const ChunkLight::Channel channel : {ChunkLight::eSky, ChunkLight::eBlock}) {
+                    const uint8_t level = light.Get(index, channel);
+                    if (level > 0)
+                        m_removals[channel].push_back({.m_node = &node, .m_index = index, .m_level = level});
+                }
+            }
+        }
+    }
+
+    light.m_levels.fill(0);
+}
+
+void LightEngine::ApplyChange(const Change& change) {
+    ChunkNode* node = m_world.GetChunk(ChunkPos::FromBlock(change.m_x, change.m_y, change.m_z));
+    if (node == nullptr || node->m_light == nullptr)
+        return;
+
+    ChunkLight& light = *node->m_light;
+    const uint16_t index = static_cast<uint16_t>(((change.m_x & 31) << 10) | ((change.m_y & 31) << 5) | (change.m_z & 31));
+    const bool solid = change.m_newBlock != BlockTypes::eAir;
+
+    // Whatever the old block let through or emitted goes, then the new block's own light comes in.
+    for (const ChunkLight::Channel channel : {ChunkLight::eSky, ChunkLight::eBlock}) {
+        const uint8_t source = channel == ChunkLight::eBlock ? GetBlockEmission(change.m_newBlock) : 0;
+        const uint8_t level = light.Get(index, channel);
+        if (level > source || (solid && level > 0)) {
+            light.Set(index, channel, 0);
+            m_removals[channel].push_back({.m_node = node, .m_index = index, .m_level = level});
+        }
+        if (source > 0) {
+            light.Set(index, channel, source);
+            m_additions[channel].push_back({.m_node = node, .m_index = index, .m_level = source});
+        }
+    }
+
+    if (solid)
+        return;
+
+    // An opened block takes in the light around it, and the open sky if it's at the top of the world.
+    const ChunkNode* above = node->GetNeighbor(Direction::ePosY);
+    if ((change.m_y & 31) == 31 && (above == nullptr || above->m_light == nullptr)) {
+        light.Set(index, ChunkLight::eSky, sMaxLevel);
+        m_additions[ChunkLight::eSky].push_back({.m_node = node, .m_index = index, .m_level = sMaxLevel});
+    }
+    for (const Direction direction : Directions::sAll) {
+        ChunkNode* neighbor = node;
+        uint16_t neighborIndex = index;
+        if (!Step(neighbor, neighborIndex, direction))
+            continue;
+
+        for (const ChunkLight::Channel channel : {ChunkLight::eSky, ChunkLight::eBlock}) {
+            if (neighbor->m_light->Get(neighborIndex, channel) > 1)
+                m_additions[channel].push_back({.m_node = neighbor, .m_index = neighborIndex, .m_level = 0});
+        }
+    }
+}
+
+void LightEngine::RunRemovals(const ChunkLight::Channel channel) {
+    std::vector<Entry>& removals = m_removals[channel];
+    std::vector<Entry>& additions = m_additions[channel];
+
+    for (size_t head = 0; head < removals.size(); head++) {
+        const Entry entry = removals[head];
+
+        for (const Direction direction : Directions::sAll) {
+            ChunkNode* node = entry.m_node;
+            uint16_t index = entry.m_index;
+            if (!Step(node, index, direction))
+                continue;
+
+            // Dimmer light was fed by the removed light and goes too, unless it's full sky light
+            // falling down a column. Anything at least as bright has another source and spreads back
+            // in. Emitters are at the maximum level, so a removal never runs over them.
+            const uint8_t level = node->m_light->Get(index, channel);
+            if (level == 0)
+                continue;
+
+            const bool falling = channel == ChunkLight::eSky && direction == Direction::eNegY && entry.m_level == sMaxLevel;
+            if (level < entry.m_level || falling) {
+                node->m_light->Set(index, channel, 0);
+                removals.push_back({.m_node = node, .m_index = index, .m_level = level});
+            } else {
+                additions.push_back({.m_node = node, .m_index = index, .m_level = level});
+            }
+        }
+    }
+
+    removals.clear();
+}
+
+void LightEngine::RunAdditions(const ChunkLight::Channel channel) {
+    std::vector<Entry>& additions = m_additions[channel];
+
+    for (size_t head = 0; head < additions.size(); head++) {
+        const Entry entry = additions[head];
+        // The level may have changed since the entry was queued, the current one is what spreads.
+        const uint8_t level = entry.m_node->m_light->Get(entry.m_index, channel);
+        if (level <= 1)
+            continue;
+
+        for (const Direction direction : Directions::sAll) {
+            ChunkNode* node = entry.m_node;
+            uint16_t index = entry.m_index;
+            if (!Step(node, index, direction) || IsSolid(*node, index))
+                continue;
+
+            const bool falling = channel == ChunkLight::eSky && direction == Direction::eNegY && level == sMaxLevel;
+            const uint8_t next = falling ? level : level - 1;
+            if (node->m_light->Get(index, channel) >= next)
+                continue;
+
+            node->m_light->Set(index, channel, next);
+            additions.push_back({.m_node = node, .m_index = index, .m_level = next});
+        }
+    }
+
+    additions.clear();
+}
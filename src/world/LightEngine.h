@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkNode.h"
+#include "world/ChunkPos.h"
+
+class World;
+
+// Sky and block light of the resident chunks. Light spreads breadth first through non-solid blocks
+// and across chunk borders, losing a level per block, except full sky light which falls straight
+// down without loss. Block changes are queued and relit incrementally in batches: light that came
+// through or from the changed blocks is removed first, then the light around the removed region
+// spreads back in, so an explosion costs one pass over the affected region instead of one per block.
+class LightEngine final {
+public:
+    static constexpr uint8_t sMaxLevel = 15;
+
+    LightEngine(World& world) : m_world(world) {}
+
+    LightEngine(const LightEngine&) = delete;
+    LightEngine& operator=(const LightEngine&) = delete;
+
+    // Queues a chunk whose voxel data just became ready, to be lit along with what its lit
+    // neighbors shine into it.
+    void QueueChunk(const ChunkPos& pos);
+
+    // Queues a lit chunk whose blocks changed too much to relight them one by one. The light it
+    // spread into its neighbors is removed first, then it is lit again like a new chunk. The chunk's
+    // solid bitmap must already be updated.
+    void RelightChunk(const ChunkPos& pos);
+
+    // Queues a block change in world coordinates. The chunk's solid bitmap must already be updated.
+    void QueueChange(const int32_t x, const int32_t y, const int32_t z, const uint16_t oldBlock, const uint16_t newBlock);
+
+    // Lights the queued chunks, then relights around the queued changes.
+    void Update();
+
+    // Drops all light and lights every loaded chunk from scratch.
+    void Relight();
+
+    // Light level in world coordinates, 0 in chunks that aren't lit.
+    uint8_t GetLight(const int32_t x, const int32_t y, const int32_t z, const ChunkLight::Channel channel) const;
+
+    VXL_INLINE bool HasPending() const noexcept {
+        return !m_pendingChunks.empty() || !m_relitChunks.empty() || !m_changes.empty();
+    }
+private:
+    static Logger sLogger;
+
+    struct Entry {
+        ChunkNode* m_node;
+        uint16_t m_index;
+        uint8_t m_level; // Level before the removal, only used by removals.
+    };
+
+    struct Change {
+        int32_t m_x, m_y, m_z;
+        uint16_t m_oldBlock;
+        uint16_t m_newBlock;
+    };
+
+    void LightChunk(ChunkNode& node);
+
+    // Clears a chunk's light and queues removals for the light on its faces, which is all that
+    // could have spread into its neighbors.
+    void ClearChunk(ChunkNode& node);
+    void ApplyChange(const Change& change);
+
+    // Clears the light that the removed entries fed and queues the light bordering it for additions.
+    void RunRemovals(const ChunkLight::Channel channel);
+
+    // Spreads the light of the added entries.
+    void RunAdditions(const ChunkLight::Channel channel);
+
+    World& m_world;
+    std::vector<ChunkPos> m_pendingChunks;
+    std::vector<ChunkPos> m_relitChunks;
+    std::vector<Change> m_changes;
+
+    // Queues per channel. Everything before the head has been expanded, so they are only cleared
+    // once a pass is done.
+    std::array<std::vector<Entry>, 2> m_removals;
+    std::array<std::vector<Entry>, 2> m_additions;
+};
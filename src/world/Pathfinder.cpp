@@ -0,0 +1,357 @@
+#include "world/Pathfinder.h"
+
+#include <algorithm>
+#include <bit>
+#include <queue>
+#include "world/World.h"
+
+Logger Pathfinder::sLogger = Logger("Pathfinder");
+
+namespace {
+    // A block a search reached, along with the direction it was reached in. The start has none.
+    struct JumpPoint {
+        glm::ivec3 m_parent;
+        uint32_t m_cost = 0;
+        int32_t m_dx = 0;
+        int32_t m_dz = 0;
+        bool m_closed = false;
+    };
+
+    using OpenEntry = std::pair<uint64_t, uint64_t>; // Priority and packed block.
+    using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>>;
+}
+
+// Packs a block in world coordinates with 21 bits per axis, like ChunkPos::Pack.
+static uint64_t PackBlock(const glm::ivec3& pos) {
+    return ((static_cast<uint64_t>(pos.x) & 0x1FFFFF) << 42)
+        | ((static_cast<uint64_t>(pos.y) & 0x1FFFFF) << 21)
+        | (static_cast<uint64_t>(pos.z) & 0x1FFFFF);
+}
+
+static glm::ivec3 UnpackBlock(const uint64_t key) {
+    return {
+        static_cast<int32_t>(static_cast<int64_t>(key << 1) >> 43),
+        static_cast<int32_t>(static_cast<int64_t>(key << 22) >> 43),
+        static_cast<int32_t>(static_cast<int64_t>(key << 43) >> 43)
+    };
+}
+
+// Lower bound of the moves between two blocks, as every move goes a block along x or z.
+static uint32_t GetDistance(const glm::ivec3& a, const glm::ivec3& b) {
+    return static_cast<uint32_t>(std::abs(a.x - b.x) + std::abs(a.z - b.z));
+}
+
+// Orders by the estimated cost, then by the distance left. Preferring the blocks closest to the goal
+// among the many paths of the same length saves expanding the others.
+static uint64_t GetPriority(const uint32_t cost, const uint32_t distance) {
+    return (static_cast<uint64_t>(cost + distance) << 32) | distance;
+}
+
+bool Pathfinder::FindPath(const glm::ivec3& start, const glm::ivec3& goal, std::vector<glm::ivec3>& path) {
+    path.clear();
+    m_search++;
+    m_expanded = 0;
+
+    // Chunks unloaded since the last search take their entries with them.
+    std::erase_if(m_cache, [&](const auto& entry) {
+        const ChunkNode* node = m_world.GetChunk(ChunkPos::Unpack(entry.first));
+        return node == nullptr || node->m_state == ChunkState::eEmpty;
+    });
+    m_recent.fill({});
+
+    if (!IsWalkable(start.x, start.y, start.z) || !IsWalkable(goal.x, goal.y, goal.z))
+        return false;
+
+    std::unordered_map<uint64_t, JumpPoint> points;
+    OpenList open;
+    points[PackBlock(start)] = {.m_parent = start};
+    open.push({GetPriority(0, GetDistance(start, goal)), PackBlock(start)});
+
+    while (!open.empty()) {
+        const uint64_t key = open.top().second;
+        open.pop();
+        JumpPoint& point = points[key];
+        if (point.m_closed)
+            continue;
+        point.m_closed = true;
+
+        const glm::ivec3 pos = UnpackBlock(key);
+        if (pos == goal)
+            break;
+        if (++m_expanded > m_settings.m_maxExpanded)
+            return false;
+
+        const auto consider = [&](const glm::ivec3& next, const int32_t dx, const int32_t dz) {
+            const uint32_t cost = point.m_cost + GetDistance(pos, next);
+            const auto [it, inserted] = points.try_emplace(PackBlock(next));
+            if (!inserted && (it->second.m_closed || it->second.m_cost <= cost))
+                return;
+
+            it->second = {.m_parent = pos, .m_cost = cost, .m_dx = dx, .m_dz = dz};
+            open.push({GetPriority(cost, GetDistance(next, goal)), it->first});
+        };
+
+        // Runs along x branch into both directions along z, runs along z only continue, unless a
+        // block along x can't be reached as fast any other way.
+        const bool free = point.m_dx == 0 && point.m_dz == 0;
+        glm::ivec3 found;
+        for (const int32_t dz : {-1, 1}) {
+            if ((free || point.m_dx != 0 || point.m_dz == dz) && ScanZ(pos, dz, goal, found))
+                consider(found, 0, dz);
+        }
+        for (const int32_t dx : {-1, 1}) {
+            bool branch = free || point.m_dx == dx;
+            if (point.m_dz != 0) {
+                // Moves are reversible, so moving back gives the block before on the run.
+                glm::ivec3 previous;
+                Move(pos, 0, -point.m_dz, previous);
+                branch = IsForced(previous, pos, dx);
+            }
+            if (branch && JumpX(pos, dx, goal, found))
+                consider(found, dx, 0);
+        }
+    }
+
+    const auto it = points.find(PackBlock(goal));
+    if (it == points.end() || !it->second.m_closed)
+        return false;
+
+    std::vector<glm::ivec3> jumps = {goal};
+    while (jumps.back() != start)
+        jumps.push_back(points[PackBlock(jumps.back())].m_parent);
+    std::reverse(jumps.begin(), jumps.end());
+
+    // Every jump is a straight run, so retracing its moves gives the blocks in between.
+    path.push_back(start);
+    for (size_t i = 1; i < jumps.size(); i++) {
+        const int32_t dx = (jumps[i].x > jumps[i - 1].x) - (jumps[i].x < jumps[i - 1].x);
+        const int32_t dz = (jumps[i].z > jumps[i - 1].z) - (jumps[i].z < jumps[i - 1].z);
+        const uint32_t steps = GetDistance(jumps[i - 1], jumps[i]);
+        for (uint32_t step = 0; step < steps; step++) {
+            glm::ivec3 next;
+            if (!Move(path.back(), dx, dz, next))
+                throw sLogger.RuntimeError("Jump from ", path.back().x, ", ", path.back().y, ", ", path.back().z, " can't be retraced!");
+            path.push_back(next);
+        }
+    }
+
+    return true;
+}
+
+bool Pathfinder::FindPathNaive(const glm::ivec3& start, const glm::ivec3& goal, std::vector<glm::ivec3>& path) const {
+    path.clear();
+    const auto isSolid = [&](const glm::ivec3& pos) {
+        return m_world.GetBlock(pos.x, pos.y, pos.z) != BlockTypes::eAir;
+    };
+    const auto isWalkable = [&](const glm::ivec3& pos) {
+        const ChunkNode* node = m_world.GetChunk(ChunkPos::FromBlock(pos.x, pos.y, pos.z));
+        return node != nullptr && node->m_state != ChunkState::eEmpty && isSolid(pos - glm::ivec3(0, 1, 0)) && !isSolid(pos) && !isSolid(pos + glm::ivec3(0, 1, 0));
+    };
+    if (!isWalkable(start) || !isWalkable(goal))
+        return false;
+
+    std::unordered_map<uint64_t, JumpPoint> points;
+    OpenList open;
+    points[PackBlock(start)] = {.m_parent = start};
+    open.push({GetPriority(0, GetDistance(start, goal)), PackBlock(start)});
+
+    while (!open.empty()) {
+        const uint64_t key = open.top().second;
+        open.pop();
+        JumpPoint& point = points[key];
+        if (point.m_closed)
+            continue;
+        point.m_closed = true;
+
+        const glm::ivec3 pos = UnpackBlock(key);
+        if (pos == goal)
+            break;
+
+        for (const auto [dx, dz] : {std::pair(-1, 0), std::pair(1, 0), std::pair(0, -1), std::pair(0, 1)}) {
+            const glm::ivec3 side = pos + glm::ivec3(dx, 0, dz);
+            glm::ivec3 next;
+            if (isWalkable(side))
+                next = side;
+            else if (isWalkable(side + glm::ivec3(0, 1, 0)) && !isSolid(pos + glm::ivec3(0, 2, 0)))
+                next = side + glm::ivec3(0, 1, 0);
+            else if (isWalkable(side - glm::ivec3(0, 1, 0)) && !isSolid(side + glm::ivec3(0, 1, 0)))
+                next = side - glm::ivec3(0, 1, 0);
+            else
+                continue;
+
+            const auto [it, inserted] = points.try_emplace(PackBlock(next));
+            if (!inserted && (it->second.m_closed || it->second.m_cost <= point.m_cost + 1))
+                continue;
+
+            it->second = {.m_parent = pos, .m_cost = point.m_cost + 1};
+            open.push({GetPriority(point.m_cost + 1, GetDistance(next, goal)), it->first});
+        }
+    }
+
+    const auto it = points.find(PackBlock(goal));
+    if (it == points.end() || !it->second.m_closed)
+        return false;
+
+    path.push_back(goal);
+    while (path.back() != start)
+        path.push_back(points[PackBlock(path.back())].m_parent);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+bool Pathfinder::IsWalkable(const int32_t x, const int32_t y, const int32_t z) {
+    return (GetWalkableRow(x, y, z >> 5) >> (z & 31)) & 1;
+}
+
+bool Pathfinder::Move(const glm::ivec3& from, const int32_t dx, const int32_t dz, glm::ivec3& to) {
+    const glm::ivec3 side = from + glm::ivec3(dx, 0, dz);
+    const auto isAir = [&](const int32_t x, const int32_t y, const int32_t z) {
+        return (GetAirRow(x, y, z >> 5) >> (z & 31)) & 1;
+    };
+
+    // At most one of the three can be walkable, as each needs the others' blocks to be different.
+    if (IsWalkable(side.x, side.y, side.z))
+        to = side;
+    else if (IsWalkable(side.x, side.y + 1, side.z) && isAir(from.x, from.y + 2, from.z))
+        to = side + glm::ivec3(0, 1, 0);
+    else if (IsWalkable(side.x, side.y - 1, side.z) && isAir(side.x, side.y + 1, side.z))
+        to = side - glm::ivec3(0, 1, 0);
+    else
+        return false;
+
+    return true;
+}
+
+Pathfinder::NavChunk& Pathfinder::GetNavChunk(const ChunkPos& pos) {
+    // Scans keep coming back to the same few chunks.
+    auto& [recentPos, recent] = m_recent[static_cast<uint32_t>(pos.m_x * 5 + pos.m_y * 3 + pos.m_z) & 63];
+    if (recent != nullptr && recentPos == pos && recent->m_search == m_search)
+        return *recent;
+
+    recentPos = pos;
+    const ChunkNode* node = m_world.GetChunk(pos);
+    if (node == nullptr || node->m_state == ChunkState::eEmpty) {
+        m_unloaded.m_search = m_search;
+        recent = &m_unloaded;
+        return m_unloaded;
+    }
+
+    NavChunk& nav = m_cache[pos.Pack()];
+    recent = &nav;
+    if (nav.m_search == m_search)
+        return nav;
+    nav.m_search = m_search;
+
+    const std::array<const ChunkNode*, 3> nodes = {node, m_world.GetChunk(pos.Offset(Direction::eNegY)), m_world.GetChunk(pos.Offset(Direction::ePosY))};
+    bool current = true;
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        const uint64_t generation = nodes[i] != nullptr ? nodes[i]->m_generation : 0;
+        const bool loaded = nodes[i] != nullptr && nodes[i]->m_state != ChunkState::eEmpty;
+        current &= nav.m_generations[i] == generation && nav.m_loaded[i] == loaded;
+        nav.m_nodes[i] = nodes[i];
+        nav.m_generations[i] = generation;
+        nav.m_loaded[i] = loaded;
+    }
+    if (current)
+        return nav;
+
+    // Solid below, with air in the block and the one above, each a row apart in the xyz order.
+    const ChunkNode* below = nodes[1];
+    const ChunkNode* above = nodes[2];
+    for (uint32_t x = 0; x < 32; x++) {
+        for (uint32_t y = 0; y < 32; y++) {
+            const uint32_t row = (x << 5) | y;
+            const uint32_t ground = y > 0 ? node->m_solid[row - 1] : below != nullptr ? below->m_solid[(x << 5) | 31] : 0;
+            const uint32_t head = y < 31 ? node->m_solid[row + 1] : above != nullptr ? above->m_solid[x << 5] : 0;
+            nav.m_walkable[row] = ground & ~node->m_solid[row] & ~head;
+        }
+    }
+
+    return nav;
+}
+
+uint32_t Pathfinder::GetWalkableRow(const int32_t x, const int32_t y, const int32_t chunkZ) {
+    const NavChunk& nav = GetNavChunk({.m_x = x >> 5, .m_y = y >> 5, .m_z = chunkZ});
+    return nav.m_loaded[0] ? nav.m_walkable[((x & 31) << 5) | (y & 31)] : 0;
+}
+
+uint32_t Pathfinder::GetAirRow(const int32_t x, const int32_t y, const int32_t chunkZ) {
+    const ChunkNode* node = GetNavChunk({.m_x = x >> 5, .m_y = y >> 5, .m_z = chunkZ}).m_nodes[0];
+    return node != nullptr ? ~node->m_solid[((x & 31) << 5) | (y & 31)] : ~0u;
+}
+
+uint32_t Pathfinder::GetMoveRow(const int32_t x, const int32_t y, const int32_t chunkZ, const int32_t dx) {
+    return GetWalkableRow(x + dx, y, chunkZ)
+        | (GetWalkableRow(x + dx, y + 1, chunkZ) & GetAirRow(x, y + 2, chunkZ))
+        | (GetWalkableRow(x + dx, y - 1, chunkZ) & GetAirRow(x + dx, y + 1, chunkZ));
+}
+
+bool Pathfinder::IsForced(const glm::ivec3& previous, const glm::ivec3& pos, const int32_t dx) {
+    glm::ivec3 side, other;
+    if (!Move(pos, dx, 0, side))
+        return false;
+    return !Move(previous, dx, 0, other) || !Move(other, 0, pos.z - previous.z, other) || other != side;
+}
+
+bool Pathfinder::ScanZ(const glm::ivec3& from, const int32_t dz, const glm::ivec3& goal, glm::ivec3& found) {
+    const int32_t x = from.x;
+    int32_t y = from.y, z = from.z; // Last block of the run.
+    for (;;) {
+        const int32_t chunkZ = (z + dz) >> 5;
+        const uint32_t walkable = GetWalkableRow(x, y, chunkZ);
+
+        // Within the row the run stays at the same height. A block along x is forced unless it
+        // and the one next to the block before are level, as then it is as close going through it.
+        uint32_t forced = 0;
+        for (const int32_t dx : {-1, 1}) {
+            const uint32_t level = GetWalkableRow(x + dx, y, chunkZ);
+            const uint32_t edge = GetWalkableRow(x + dx, y, chunkZ - dz);
+            const uint32_t previous = dz > 0 ? (level << 1) | (edge >> 31) : (level >> 1) | (edge << 31);
+            forced |= GetMoveRow(x, y, chunkZ, dx) & ~(level & previous);
+        }
+
+        uint32_t stops = ~walkable | forced;
+        if (goal.x == x && goal.y == y && (goal.z >> 5) == chunkZ)
+            stops |= 1u << (goal.z & 31);
+        const uint32_t first = static_cast<uint32_t>((z + dz) & 31);
+        stops &= dz > 0 ? ~0u << first : ~0u >> (31 - first);
+        if (stops == 0) {
+            z = chunkZ * 32 + (dz > 0 ? 31 : 0);
+            continue;
+        }
+
+        const int32_t stop = chunkZ * 32 + (dz > 0 ? std::countr_zero(stops) : 31 - std::countl_zero(stops));
+        if ((walkable >> (stop & 31)) & 1) {
+            found = glm::ivec3(x, y, stop);
+            return true;
+        }
+
+        // The run goes on a block up or down, where the first block is checked on its own.
+        const glm::ivec3 last = glm::ivec3(x, y, stop - dz);
+        glm::ivec3 next;
+        if (!Move(last, 0, dz, next))
+            return false;
+        if (next == goal || IsForced(last, next, -1) || IsForced(last, next, 1)) {
+            found = next;
+            return true;
+        }
+        y = next.y;
+        z = next.z;
+    }
+}
+
+bool Pathfinder::JumpX(const glm::ivec3& from, const int32_t dx, const glm::ivec3& goal, glm::ivec3& found) {
+    glm::ivec3 current = from;
+    glm::ivec3 branch;
+    for (;;) {
+        glm::ivec3 next;
+        if (!Move(current, dx, 0, next))
+            return false;
+
+        if (next == goal || ScanZ(next, 1, goal, branch) || ScanZ(next, -1, goal, branch)) {
+            found = next;
+            return true;
+        }
+        current = next;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+
+class World;
+struct ChunkNode;
+
+// Shortest paths for agents two blocks tall. A block is walkable if the block below it is solid and
+// it and the block above are air. Agents move a block along x or z at a time, stepping up or down a
+// block along the way if there is headroom, and every move costs the same.
+//
+// Searches are A* over jump points. Runs along z are scanned 32 blocks at a time with bit scans
+// over the rows of walkable blocks, stopping only where the run is blocked or a neighbor along x
+// can't be reached just as fast from the block before, and following the run a block up or down
+// where it changes height. Runs along x branch into z scans at every block. The walkable blocks of
+// every loaded chunk are derived from its solid voxels with row shifts and masks, and cached until
+// the chunk or the ones above and below it change, or it's unloaded. Not thread safe, as searches
+// fill the cache.
+class Pathfinder final {
+public:
+    struct Settings {
+        uint32_t m_maxExpanded = 1u << 16; // Jump points expanded before a search gives up.
+    };
+
+    Pathfinder(const World& world, const Settings& settings) : m_world(world), m_settings(settings) {}
+
+    // Finds a shortest path between two walkable blocks in world coordinates. The path holds every
+    // block the agent stands in, from the start to the goal. Returns false if there is none.
+    bool FindPath(const glm::ivec3& start, const glm::ivec3& goal, std::vector<glm::ivec3>& path);
+
+    // Reference A* over single moves, reading blocks through the world.
+    bool FindPathNaive(const glm::ivec3& start, const glm::ivec3& goal, std::vector<glm::ivec3>& path) const;
+
+    bool IsWalkable(const int32_t x, const int32_t y, const int32_t z);
+
+    // Moves from a walkable block a block along x or z, to where the agent ends up standing.
+    // Returns false if it can't move that way.
+    bool Move(const glm::ivec3& from, const int32_t dx, const int32_t dz, glm::ivec3& to);
+
+    VXL_INLINE size_t GetCachedCount() const noexcept {
+        return m_cache.size();
+    }
+
+    // Jump points the last search expanded.
+    VXL_INLINE uint32_t GetExpandedCount() const noexcept {
+        return m_expanded;
+    }
+private:
+    static Logger sLogger;
+
+    // Walkable blocks of a chunk in the xyz order, along with the chunk, the one below and the one
+    // above and their generations when it was derived.
+    struct NavChunk {
+        std::array<const ChunkNode*, 3> m_nodes = {};
+        std::array<uint64_t, 3> m_generations = {};
+        std::array<bool, 3> m_loaded = {};
+        uint32_t m_search = 0; // Last search that checked it is up to date.
+        ChunkBitmap m_walkable;
+    };
+
+    // Cache entry of a chunk, brought up to date once per search. Chunks that aren't loaded all
+    // share an entry without walkable blocks, so the cache only holds loaded chunks.
+    NavChunk& GetNavChunk(const ChunkPos& pos);
+
+    uint32_t GetWalkableRow(const int32_t x, const int32_t y, const int32_t chunkZ);
+
+    // Air along z, chunks that aren't resident are air like in World::GetBlock.
+    uint32_t GetAirRow(const int32_t x, const int32_t y, const int32_t chunkZ);
+
+    // Blocks of the row that can move a block along x.
+    uint32_t GetMoveRow(const int32_t x, const int32_t y, const int32_t chunkZ, const int32_t dx);
+
+    // Whether a block reached along z from the one before can't reach its neighbor along x just as
+    // fast going through the neighbor of the block before.
+    bool IsForced(const glm::ivec3& previous, const glm::ivec3& pos, const int32_t dx);
+
+    // Scans from a block along z for the next jump point.
+    bool ScanZ(const glm::ivec3& from, const int32_t dz, const glm::ivec3& goal, glm::ivec3& found);
+
+    // Moves from a block along x until reaching a jump point, scanning along z at every block.
+    bool JumpX(const glm::ivec3& from, const int32_t dx, const glm::ivec3& goal, glm::ivec3& found);
+
+    const World& m_world;
+    Settings m_settings;
+    std::unordered_map<uint64_t, NavChunk> m_cache; // Packed chunk position to its walkable blocks.
+    NavChunk m_unloaded;
+    // Chunks looked up lately, indexed by a hash of their positions.
+    std::array<std::pair<ChunkPos, NavChunk*>, 64> m_recent = {};
+    uint32_t m_search = 0;
+    uint32_t m_expanded = 0;
+};
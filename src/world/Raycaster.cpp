@@ -0,0 +1,242 @@
+#include "world/Raycaster.h"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include "util/JobSystem.h"
+#include "world/World.h"
+
+Logger Raycaster::sLogger = Logger("Raycaster");
+
+// State of a DDA walk. Boundary distances are always computed from the voxel index instead of
+// being accumulated, so skipping ahead lands on exactly the values a step by step walk would see.
+struct RayWalker final {
+    glm::vec3 m_origin;
+    std::array<float, 3> m_invDirection;
+    std::array<int32_t, 3> m_voxel;
+    std::array<int32_t, 3> m_step;
+    float m_enterDistance = 0.0f; // Distance at which the ray entered the current voxel.
+    Direction m_face;
+
+    RayWalker(const glm::vec3& origin, const glm::vec3& direction) : m_origin(origin) {
+        uint32_t dominantAxis = 0;
+        for (uint32_t axis = 0; axis < 3; axis++) {
+            m_voxel[axis] = static_cast<int32_t>(std::floor(origin[axis]));
+            m_step[axis] = direction[axis] > 0.0f ? 1 : (direction[axis] < 0.0f ? -1 : 0);
+            m_invDirection[axis] = 1.0f / direction[axis];
+
+            if (std::abs(direction[axis]) > std::abs(direction[dominantAxis]))
+                dominantAxis = axis;
+        }
+
+        m_face = EnteredFace(dominantAxis);
+    }
+
+    // Distance at which the ray leaves the voxel with the given index along the axis.
+    VXL_INLINE float Boundary(const uint32_t axis, const int32_t index) const {
+        if (m_step[axis] == 0)
+            return INFINITY;
+        return (static_cast<float>(index + (m_step[axis] > 0 ? 1 : 0)) - m_origin[axis]) * m_invDirection[axis];
+    }
+
+    VXL_INLINE float NextBoundary(const uint32_t axis) const {
+        return Boundary(axis, m_voxel[axis]);
+    }
+
+    // Axis of the next step. Ties go to x, then y.
+    VXL_INLINE uint32_t NextAxis() const {
+        const float x = NextBoundary(0);
+        const float y = NextBoundary(1);
+        const float z = NextBoundary(2);
+        if (x <= y && x <= z)
+            return 0;
+        return y <= z ? 1 : 2;
+    }
+
+    VXL_INLINE Direction EnteredFace(const uint32_t axis) const {
+        return static_cast<Direction>(axis * 2 + (m_step[axis] > 0 ? 0 : 1));
+    }
+
+    VXL_INLINE void Step(const uint32_t axis) {
+        m_enterDistance = NextBoundary(axis);
+        m_voxel[axis] += m_step[axis];
+        m_face = EnteredFace(axis);
+    }
+
+    // Moves steps voxels along the axis at once.
+    VXL_INLINE void Skip(const uint32_t axis, const int32_t steps) {
+        if (steps == 0)
+            return;
+
+        m_voxel[axis] += steps * m_step[axis];
+        m_enterDistance = Boundary(axis, m_voxel[axis] - m_step[axis]);
+        m_face = EnteredFace(axis);
+    }
+
+    // Number of boundaries along the axis the ray crosses before the limit, at most maxSteps.
+    // Boundaries at exactly the limit count if inclusive is set.
+    int32_t CountCrossings(const uint32_t axis, const float limit, const bool inclusive, const int32_t maxSteps) const {
+        if (m_step[axis] == 0 || maxSteps <= 0)
+            return 0;
+
+        const auto isCrossed = [&](const int32_t steps) {
+            const float distance = Boundary(axis, m_voxel[axis] + steps * m_step[axis]);
+            return inclusive ? distance <= limit : distance < limit;
+        };
+
+        // Estimate from the spacing between boundaries, then correct for rounding.
+        const float estimate = std::floor((limit - NextBoundary(axis)) / std::abs(m_invDirection[axis])) + 1.0f;
+        int32_t count = estimate >= static_cast<float>(maxSteps) ? maxSteps : (estimate > 0.0f ? static_cast<int32_t>(estimate) : 0);
+        while (count > 0 && !isCrossed(count - 1))
+            count--;
+        while (count < maxSteps && isCrossed(count))
+            count++;
+
+        return count;
+    }
+
+    // Moves to the first voxel outside the chunk with the given origin without looking at any blocks.
+    void SkipChunk(const std::array<int32_t, 3>& base) {
+        std::array<int32_t, 3> edge;
+        uint32_t exitAxis = 0;
+        float exitDistance = INFINITY;
+        for (uint32_t axis = 0; axis < 3; axis++) {
+            edge[axis] = m_step[axis] > 0 ? base[axis] + 31 : base[axis];
+            const float distance = Boundary(axis, edge[axis]);
+            if (distance < exitDistance) {
+                exitDistance = distance;
+                exitAxis = axis;
+            }
+        }
+
+        // Everything that a plain DDA would step before the exit step. Axes that win ties against
+        // the exit axis also take the steps that land exactly on it.
+        for (uint32_t axis = 0; axis < 3; axis++) {
+            if (axis != exitAxis) {
+                const int32_t maxSteps = std::abs(edge[axis] - m_voxel[axis]);
+                m_voxel[axis] += CountCrossings(axis, exitDistance, axis < exitAxis, maxSteps) * m_step[axis];
+            }
+        }
+
+        m_voxel[exitAxis] = edge[exitAxis] + m_step[exitAxis];
+        m_enterDistance = exitDistance;
+        m_face = EnteredFace(exitAxis);
+    }
+
+    // Walks until a solid voxel or the edge of the chunk with the given origin. Returns true if it
+    // stopped on a solid voxel within the maximum distance.
+    bool WalkChunk(const ChunkBitmap& solid, const std::array<int32_t, 3>& base, const float maxDistance) {
+        while (m_enterDistance <= maxDistance) {
+            const uint32_t x = m_voxel[0] - base[0];
+            const uint32_t y = m_voxel[1] - base[1];
+            const uint32_t z = m_voxel[2] - base[2];
+            const uint32_t row = solid[(x << 5) | y];
+
+            if (m_step[2] != 0) {
+                // Voxels the ray passes along this row before leaving it through x or y, which win ties.
+                const float leaveDistance = std::min(NextBoundary(0), NextBoundary(1));
+                const int32_t maxSteps = m_step[2] > 0 ? 31 - z : z;
+                const int32_t steps = CountCrossings(2, leaveDistance, false, maxSteps);
+
+                const uint32_t low = m_step[2] > 0 ? z : z - steps;
+                const uint32_t high = m_step[2] > 0 ? z + steps : z;
+                const uint32_t run = row & ((2u << high) - 1) & ~((1u << low) - 1);
+
+                if (run != 0) {
+                    const uint32_t hitZ = m_step[2] > 0 ? std::countr_zero(run) : 31 - std::countl_zero(run);
+                    Skip(2, std::abs(static_cast<int32_t>(hitZ) - static_cast<int32_t>(z)));
+                    return m_enterDistance <= maxDistance;
+                }
+
+                Skip(2, steps);
+            } else if ((row >> z) & 1) {
+                return true;
+            }
+
+            const uint32_t axis = NextAxis();
+            Step(axis);
+            if (m_voxel[axis] < base[axis] || m_voxel[axis] > base[axis] + 31)
+                return false;
+        }
+
+        return false;
+    }
+};
+
+Raycaster::Hit Raycaster::Cast(const World& world, const Ray& ray) {
+    const float length = glm::length(ray.m_direction);
+    if (length == 0.0f)
+        return {};
+
+    RayWalker walker(ray.m_origin, ray.m_direction / length);
+    while (walker.m_enterDistance <= ray.m_maxDistance) {
+        const ChunkPos chunkPos = ChunkPos::FromBlock(walker.m_voxel[0], walker.m_voxel[1], walker.m_voxel[2]);
+        const std::array<int32_t, 3> base = {chunkPos.m_x * 32, chunkPos.m_y * 32, chunkPos.m_z * 32};
+        const ChunkNode* node = world.GetChunk(chunkPos);
+
+        const bool empty = node == nullptr || (node->m_chunk == nullptr ? !node->IsCompressed() : node->m_chunk->m_blockPaletteCounts[BlockTypes::eAir] == 32768);
+        if (empty) {
+            walker.SkipChunk(base);
+            continue;
+        }
+
+        if (walker.WalkChunk(node->m_solid, base, ray.m_maxDistance)) {
+            return {
+                .m_hit = true,
+                .m_block = {walker.m_voxel[0], walker.m_voxel[1], walker.m_voxel[2]},
+                .m_face = walker.m_face,
+                .m_distance = walker.m_enterDistance,
+                .m_blockType = world.GetBlock(walker.m_voxel[0], walker.m_voxel[1], walker.m_voxel[2])
+            };
+        }
+    }
+
+    return {};
+}
+
+void Raycaster::CastBatch(const World& world, const std::vector<Ray>& rays, std::vector<Hit>& hits) {
+    hits.resize(rays.size());
+    JobSystem::ParallelFor(static_cast<uint32_t>(rays.size()), 256, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            hits[i] = Cast(world, rays[i]);
+    });
+}
+
+bool Raycaster::HasLineOfSight(const World& world, const glm::vec3& from, const glm::vec3& to) {
+    const glm::vec3 offset = to - from;
+    const float distance = glm::length(offset);
+    if (distance == 0.0f)
+        return true;
+
+    const Hit hit = Cast(world, {.m_origin = from, .m_direction = offset, .m_maxDistance = distance});
+    if (!hit.m_hit)
+        return true;
+
+    return hit.m_block.x == static_cast<int32_t>(std::floor(to.x))
+        && hit.m_block.y == static_cast<int32_t>(std::floor(to.y))
+        && hit.m_block.z == static_cast<int32_t>(std::floor(to.z));
+}
+
+Raycaster::Hit Raycaster::CastNaive(const World& world, const Ray& ray) {
+    const float length = glm::length(ray.m_direction);
+    if (length == 0.0f)
+        return {};
+
+    RayWalker walker(ray.m_origin, ray.m_direction / length);
+    while (walker.m_enterDistance <= ray.m_maxDistance) {
+        const uint16_t block = world.GetBlock(walker.m_voxel[0], walker.m_voxel[1], walker.m_voxel[2]);
+        if (block != BlockTypes::eAir) {
+            return {
+                .m_hit = true,
+                .m_block = {walker.m_voxel[0], walker.m_voxel[1], walker.m_voxel[2]},
+                .m_face = walker.m_face,
+                .m_distance = walker.m_enterDistance,
+                .m_blockType = block
+            };
+        }
+
+        walker.Step(walker.NextAxis());
+    }
+
+    return {};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "util/Logger.h"
+#include "world/Direction.h"
+
+class World;
+
+// Voxel raycasts against the resident world. Rays walk the voxel grid with a 3D DDA, but skip
+// chunks that are empty or not resident in one step and skip air runs along z with a single bit
+// scan over the chunk's solid bitmap row. The fast path visits exactly the voxels of a plain DDA.
+class Raycaster final {
+public:
+    struct Ray {
+        glm::vec3 m_origin = {0.0f, 0.0f, 0.0f};
+        glm::vec3 m_direction = {0.0f, 0.0f, 1.0f}; // Doesn't need to be normalized.
+        float m_maxDistance = 64.0f;
+    };
+
+    struct Hit {
+        bool m_hit = false;
+        glm::ivec3 m_block = {0, 0, 0}; // World position of the block that was hit.
+        Direction m_face = Direction::eNegX; // Face of the block the ray entered through.
+        float m_distance = 0.0f; // Distance along the ray to the face that was hit.
+        uint16_t m_blockType = 0;
+    };
+
+    // Finds the first solid block along the ray. A ray starting inside a block hits it at
+    // distance 0 through the face facing back along the ray.
+    static Hit Cast(const World& world, const Ray& ray);
+
+    // Casts every ray across the job system. The world must not be modified until it returns.
+    static void CastBatch(const World& world, const std::vector<Ray>& rays, std::vector<Hit>& hits);
+
+    // Whether no solid block lies between the points. The block containing the end point doesn't count.
+    static bool HasLineOfSight(const World& world, const glm::vec3& from, const glm::vec3& to);
+
+    // Reference DDA that looks up every voxel through World::GetBlock.
+    static Hit CastNaive(const World& world, const Ray& ray);
+private:
+    static Logger sLogger;
+};
@@ -0,0 +1,213 @@
+#include "world/SparseVoxelDAG.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include "util/Morton.h"
+
+Logger SparseVoxelDAG::sLogger = Logger("SparseVoxelDAG");
+
+uint32_t SparseVoxelDAG::Build(const ChunkBitmap& solid) {
+    std::array<uint64_t, 512> leaves{};
+    for (uint32_t i = 0; i < 1024; i++) {
+        uint32_t row = solid[i];
+        const uint16_t rowCode = Morton::Encode3DMorton(i >> 5, i & 31, 0);
+        while (row != 0) {
+            const uint16_t code = rowCode | Morton::Encode3DMorton(0, 0, std::countr_zero(row));
+            leaves[code >> 6] |= 1ull << (code & 63);
+            row &= row - 1;
+        }
+    }
+
+    std::array<uint32_t, 512> references;
+    for (uint32_t i = 0; i < 512; i++)
+        references[i] = leaves[i] == 0 ? sEmpty : InternLeaf(leaves[i]);
+
+    // Every level has an eighth of the references of the one below. Node i only overwrites
+    // references that were already read.
+    for (uint32_t level = 1, count = 64; level <= 3; level++, count /= 8) {
+        for (uint32_t node = 0; node < count; node++) {
+            uint32_t mask = 0;
+            uint32_t numChildren = 0;
+            std::array<uint32_t, 8> children;
+            for (uint32_t child = 0; child < 8; child++) {
+                const uint32_t reference = references[node * 8 + child];
+                if (reference != sEmpty) {
+                    mask |= 1u << child;
+                    children[numChildren++] = reference;
+                }
+            }
+
+            references[node] = mask == 0 ? sEmpty : InternNode(mask | (level << 8), children.data());
+        }
+    }
+
+    return references[0];
+}
+
+bool SparseVoxelDAG::GetBit(const uint32_t root, const uint8_t x, const uint8_t y, const uint8_t z) const {
+    if (root == sEmpty)
+        return false;
+
+    // Every three bits of the Morton code pick a child, from the root down.
+    const uint16_t code = Morton::Encode3DMorton(x, y, z);
+    uint32_t reference = root;
+    for (uint32_t shift = 12; shift >= 6; shift -= 3) {
+        const uint32_t mask = m_nodes[reference] & 0xFF;
+        const uint32_t child = (code >> shift) & 7;
+        if (((mask >> child) & 1) == 0)
+            return false;
+
+        reference = m_nodes[reference + 1 + std::popcount(mask & ((1u << child) - 1))];
+    }
+
+    return (m_leaves[reference] >> (code & 63)) & 1;
+}
+
+void SparseVoxelDAG::Extract(const uint32_t root, ChunkBitmap& solid) const {
+    for (uint32_t i = 0; i < 1024; i++)
+        solid[i] = 0;
+    if (root == sEmpty)
+        return;
+
+    struct Entry {
+        uint32_t m_reference;
+        uint32_t m_level;
+        uint16_t m_code; // Morton code of the first voxel of the subtree.
+    };
+
+    std::array<Entry, 32> stack;
+    uint32_t size = 0;
+    stack[size++] = {.m_reference = root, .m_level = 3, .m_code = 0};
+    while (size > 0) {
+        const Entry entry = stack[--size];
+
+        if (entry.m_level == 0) {
+            uint64_t leaf = m_leaves[entry.m_reference];
+            while (leaf != 0) {
+                const uint16_t packed = Morton::Decode3DMorton(entry.m_code | std::countr_zero(leaf));
+                solid[packed >> 5] |= 1u << (packed & 31);
+                leaf &= leaf - 1;
+            }
+            continue;
+        }
+
+        const uint32_t mask = m_nodes[entry.m_reference] & 0xFF;
+        uint32_t index = 0;
+        for (uint32_t child = 0; child < 8; child++) {
+            if ((mask >> child) & 1) {
+                stack[size++] = {
+                    .m_reference = m_nodes[entry.m_reference + 1 + index++],
+                    .m_level = entry.m_level - 1,
+                    .m_code = static_cast<uint16_t>(entry.m_code | (child << (entry.m_level * 3 + 3)))
+                };
+            }
+        }
+    }
+}
+
+void SparseVoxelDAG::SetChunk(const ChunkPos& pos, const ChunkBitmap& solid) {
+    const uint32_t root = Build(solid);
+    const auto [it, inserted] = m_chunks.try_emplace(pos.Pack(), root);
+    if (!inserted) {
+        it->second = root;
+        OnStaleRoot();
+    }
+}
+
+bool SparseVoxelDAG::RemoveChunk(const ChunkPos& pos) {
+    if (m_chunks.erase(pos.Pack()) == 0)
+        return false;
+
+    OnStaleRoot();
+    return true;
+}
+
+bool SparseVoxelDAG::FindChunk(const ChunkPos& pos, uint32_t& root) const {
+    const auto it = m_chunks.find(pos.Pack());
+    if (it == m_chunks.end())
+        return false;
+
+    root = it->second;
+    return true;
+}
+
+bool SparseVoxelDAG::IsSolid(const int32_t x, const int32_t y, const int32_t z) const {
+    uint32_t root;
+    if (!FindChunk(ChunkPos::FromBlock(x, y, z), root))
+        return false;
+
+    return GetBit(root, x & 31, y & 31, z & 31);
+}
+
+void SparseVoxelDAG::Compact() {
+    const size_t before = GetMemoryUsage();
+
+    // Copying only what the roots reach keeps the sharing, since copies of a shared subtree intern
+    // to the same node.
+    SparseVoxelDAG compacted;
+    std::unordered_map<uint64_t, uint32_t> copied;
+    for (const auto& [key, root] : m_chunks)
+        compacted.m_chunks[key] = root == sEmpty ? sEmpty : compacted.CopyFrom(*this, root, 3, copied);
+
+    *this = std::move(compacted);
+    sLogger.Verbose("Compacted ", m_chunks.size(), " chunks from ", before, " to ", GetMemoryUsage(), " bytes!");
+}
+
+size_t SparseVoxelDAG::GetMemoryUsage() const {
+    return m_nodes.size() * sizeof(uint32_t) + m_leaves.size() * sizeof(uint64_t)
+        + m_chunks.size() * (sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+uint32_t SparseVoxelDAG::InternLeaf(const uint64_t leaf) {
+    const auto [it, inserted] = m_leafLookup.try_emplace(leaf, static_cast<uint32_t>(m_leaves.size()));
+    if (inserted)
+        m_leaves.push_back(leaf);
+    return it->second;
+}
+
+uint32_t SparseVoxelDAG::InternNode(const uint32_t mask, const uint32_t* children) {
+    // The mask carries the level above the child mask, so nodes on different levels never match.
+    const uint32_t numChildren = std::popcount(mask & 0xFF);
+    uint64_t hash = mask;
+    for (uint32_t i = 0; i < numChildren; i++)
+        hash = (hash ^ children[i]) * 0x9E3779B97F4A7C15ull;
+
+    const auto [begin, end] = m_nodeLookup.equal_range(hash);
+    for (auto it = begin; it != end; it++) {
+        const uint32_t* node = m_nodes.data() + it->second;
+        if (node[0] == mask && std::equal(children, children + numChildren, node + 1))
+            return it->second;
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(mask);
+    m_nodes.insert(m_nodes.end(), children, children + numChildren);
+    m_nodeLookup.emplace(hash, offset);
+    m_nodeCount++;
+    return offset;
+}
+
+uint32_t SparseVoxelDAG::CopyFrom(const SparseVoxelDAG& other, const uint32_t reference, const uint32_t level, std::unordered_map<uint64_t, uint32_t>& copied) {
+    if (level == 0)
+        return InternLeaf(other.m_leaves[reference]);
+
+    const auto it = copied.find(reference);
+    if (it != copied.end())
+        return it->second;
+
+    const uint32_t mask = other.m_nodes[reference];
+    const uint32_t numChildren = std::popcount(mask & 0xFF);
+    std::array<uint32_t, 8> children;
+    for (uint32_t i = 0; i < numChildren; i++)
+        children[i] = CopyFrom(other, other.m_nodes[reference + 1 + i], level - 1, copied);
+
+    const uint32_t copy = InternNode(mask, children.data());
+    copied.emplace(reference, copy);
+    return copy;
+}
+
+void SparseVoxelDAG::OnStaleRoot() {
+    if (++m_staleRoots > std::max<size_t>(64, m_chunks.size()))
+        Compact();
+}
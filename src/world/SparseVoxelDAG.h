@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+
+// Compressed solid voxels of far field chunks. Every chunk is a sparse octree of depth three over
+// 4x4x4 leaf masks, with children in Morton order so that a voxel's Morton code is its path from
+// the root. Identical leaves and subtrees are stored once across all chunks, turning the trees
+// into a directed acyclic graph.
+class SparseVoxelDAG final {
+public:
+    static constexpr uint32_t sEmpty = ~0u; // Root of a chunk without any solid voxels.
+
+    // Adds the tree of a solid bitmap in the xyz order and returns its root.
+    uint32_t Build(const ChunkBitmap& solid);
+
+    // Voxel of the tree with the given root, in chunk coordinates.
+    bool GetBit(const uint32_t root, const uint8_t x, const uint8_t y, const uint8_t z) const;
+
+    // Decompresses the tree with the given root back into a bitmap in the xyz order.
+    void Extract(const uint32_t root, ChunkBitmap& solid) const;
+
+    // Stores the chunk, replacing what was stored at its position before.
+    void SetChunk(const ChunkPos& pos, const ChunkBitmap& solid);
+
+    // Returns false if nothing was stored at the position.
+    bool RemoveChunk(const ChunkPos& pos);
+
+    // Whether a chunk is stored at the position. Its root is written to root if so.
+    bool FindChunk(const ChunkPos& pos, uint32_t& root) const;
+
+    // Solid voxel in world coordinates, false for chunks that aren't stored.
+    bool IsSolid(const int32_t x, const int32_t y, const int32_t z) const;
+
+    // Drops the nodes no stored chunk refers to anymore. Runs by itself once replaced and removed
+    // chunks outnumber the stored ones.
+    void Compact();
+
+    // Bytes used by the nodes, leaves and chunk roots. The lookup tables that deduplicate new
+    // subtrees aren't counted.
+    size_t GetMemoryUsage() const;
+
+    VXL_INLINE size_t GetChunkCount() const noexcept {
+        return m_chunks.size();
+    }
+
+    VXL_INLINE size_t GetNodeCount() const noexcept {
+        return m_nodeCount;
+    }
+
+    VXL_INLINE size_t GetLeafCount() const noexcept {
+        return m_leaves.size();
+    }
+private:
+    static Logger sLogger;
+
+    uint32_t InternLeaf(const uint64_t leaf);
+
+    // Interns a node from its child mask and the references of its present children.
+    uint32_t InternNode(const uint32_t mask, const uint32_t* children);
+
+    // Interns a copy of a subtree of another DAG. Levels count down from 3 at the root to 0 at the leaves.
+    uint32_t CopyFrom(const SparseVoxelDAG& other, const uint32_t reference, const uint32_t level, std::unordered_map<uint64_t, uint32_t>& copied);
+
+    void OnStaleRoot();
+
+    // Nodes are a child mask with the node's level above its lowest byte, followed by the reference
+    // of every present child. Children of the nodes on level 1 index the leaves.
+    std::vector<uint32_t> m_nodes;
+    std::vector<uint64_t> m_leaves; // 4x4x4 voxels, bit i at the i-th Morton code of the leaf.
+    size_t m_nodeCount = 0;
+
+    std::unordered_map<uint64_t, uint32_t> m_leafLookup;
+    std::unordered_multimap<uint64_t, uint32_t> m_nodeLookup; // Hash of a node to its offset.
+
+    std::unordered_map<uint64_t, uint32_t> m_chunks; // Packed chunk position to root.
+    size_t m_staleRoots = 0;
+};
@@ -0,0 +1,179 @@
+#include "world/TickScheduler.h"
+
+#include "util/JobSystem.h"
+#include "world/World.h"
+
+Logger TickScheduler::sLogger = Logger("TickScheduler");
+
+// Finalizer from SplitMix64.
+static uint64_t Mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+uint16_t TickScheduler::Context::GetBlock(const int32_t x, const int32_t y, const int32_t z) const {
+    // Chunks that are still being generated or read belong to other threads.
+    const ChunkNode* node = m_world.GetChunk(ChunkPos::FromBlock(x, y, z));
+    if (node == nullptr || node->m_state == ChunkState::eEmpty)
+        return BlockTypes::eAir;
+
+    return m_world.GetBlock(x, y, z);
+}
+
+uint16_t TickScheduler::Context::SetBlock(const uint16_t block, const int32_t x, const int32_t y, const int32_t z) {
+    ChunkNode* node = m_world.GetChunk(ChunkPos::FromBlock(x, y, z));
+    if (node == nullptr || node->m_state == ChunkState::eEmpty)
+        return BlockTypes::eAir;
+
+    // Every chunk holding a shared payload copies it, so no thread writes to one another reads.
+    const auto it = m_shared.find(node);
+    if (it != m_shared.end() && it->second == node->m_chunk.get())
+        node->m_chunk = node->m_chunk->Clone();
+
+    const uint16_t oldBlock = m_world.SetBlockUnlit(block, x, y, z);
+    if (node->m_light != nullptr && oldBlock != block)
+        m_changes.push_back({.m_x = x, .m_y = y, .m_z = z, .m_oldBlock = oldBlock, .m_newBlock = block});
+    return oldBlock;
+}
+
+uint32_t TickScheduler::Context::Random() {
+    m_state += 0x9E3779B97F4A7C15ULL;
+    return static_cast<uint32_t>(Mix(m_state) >> 32);
+}
+
+void TickScheduler::SetRandomTicker(const uint16_t block, RandomTicker ticker) {
+    if (block >= m_randomTickers.size())
+        throw sLogger.RuntimeError("Block type ", block, " is out of range for random ticks!");
+
+    if (!m_randomTickers[block])
+        m_tickableBlocks.push_back(block);
+    m_randomTickers[block] = std::move(ticker);
+    // The bitmaps don't hold the new type yet.
+    m_tickable.clear();
+}
+
+void TickScheduler::Tick() {
+    m_tick++;
+    Prepare();
+
+    std::vector<std::vector<Context::Change>> changes;
+    std::vector<uint32_t> hits;
+    for (const std::vector<ChunkNode*>& nodes : m_phases) {
+        changes.assign(nodes.size(), {});
+        hits.assign(nodes.size(), 0);
+        JobSystem::ParallelFor(static_cast<uint32_t>(nodes.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                Context context = Context(m_world, *nodes[i], Mix(m_settings.m_seed + Mix(m_tick ^ Mix(nodes[i]->m_pos.Pack()))), m_shared);
+                hits[i] = TickChunk(context);
+                changes[i] = std::move(context.m_changes);
+            }
+        });
+
+        // The light engine's queues are shared, so the phase's changes are queued in one go.
+        for (size_t i = 0; i < nodes.size(); i++) {
+            m_randomTickCount += hits[i];
+            for (const Context::Change& change : changes[i])
+                m_world.GetLight().QueueChange(change.m_x, change.m_y, change.m_z, change.m_oldBlock, change.m_newBlock);
+        }
+    }
+}
+
+void TickScheduler::TickNaive() {
+    m_tick++;
+    Prepare();
+
+    for (const std::vector<ChunkNode*>& nodes : m_phases) {
+        for (ChunkNode* node : nodes) {
+            Context context = Context(m_world, *node, Mix(m_settings.m_seed + Mix(m_tick ^ Mix(node->m_pos.Pack()))), m_shared);
+            m_randomTickCount += TickChunk(context);
+            for (const Context::Change& change : context.m_changes)
+                m_world.GetLight().QueueChange(change.m_x, change.m_y, change.m_z, change.m_oldBlock, change.m_newBlock);
+        }
+    }
+}
+
+void TickScheduler::Prepare() {
+    for (std::vector<ChunkNode*>& nodes : m_phases)
+        nodes.clear();
+    m_shared.clear();
+
+    std::vector<std::pair<Tickable*, const ChunkNode*>> stale;
+    std::unordered_map<uint64_t, Tickable> tickable;
+    m_world.GetChunks().ForEach([&](ChunkNode& node) {
+        if (node.m_state == ChunkState::eEmpty)
+            return;
+        m_phases[GetPhase(node.m_pos)].push_back(&node);
+        if (node.m_chunk.use_count() > 1)
+            m_shared[&node] = node.m_chunk.get();
+
+        // Bitmaps stay as long as the chunk's blocks do. Compressed chunks are idle (see
+        // ChunkResidency), so they aren't sampled until they are decompressed.
+        const auto it = m_tickable.find(node.m_pos.Pack());
+        if (it != m_tickable.end() && it->second.m_generation == node.m_generation && it->second.m_compressed == (node.m_chunk == nullptr)) {
+            tickable.insert(m_tickable.extract(it));
+            return;
+        }
+
+        Tickable& entry = tickable[node.m_pos.Pack()];
+        entry = {.m_generation = node.m_generation, .m_compressed = node.m_chunk == nullptr};
+        if (node.m_chunk == nullptr)
+            return;
+
+        // The palette tells whether there is anything to find without looking at the blocks.
+        for (const uint16_t block : m_tickableBlocks) {
+            if (node.m_chunk->m_blockPaletteCounts[block] != 0) {
+                stale.push_back({&entry, &node});
+                break;
+            }
+        }
+    });
+    // Chunks that weren't seen were unloaded.
+    m_tickable = std::move(tickable);
+
+    JobSystem::ParallelFor(static_cast<uint32_t>(stale.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            Tickable& entry = *stale[i].first;
+            const IChunk& chunk = *stale[i].second->m_chunk;
+            std::fill_n(entry.m_bitmap.Data(), 1024, 0u);
+            for (const uint16_t block : m_tickableBlocks) {
+                if (chunk.m_blockPaletteCounts[block] == 0)
+                    continue;
+
+                const ChunkBitmap bitmap = chunk.GetBlockBitmap(static_cast<BlockTypes>(block));
+                for (uint32_t row = 0; row < 1024; row++)
+                    entry.m_bitmap[row] |= bitmap[row];
+            }
+            entry.m_any = true;
+        }
+    });
+}
+
+uint32_t TickScheduler::TickChunk(Context& context) {
+    for (const Ticker& ticker : m_tickers)
+        ticker(context);
+
+    const auto it = m_tickable.find(context.m_node.m_pos.Pack());
+    if (it == m_tickable.end() || !it->second.m_any)
+        return 0;
+
+    // Samples that miss the tickable blocks cost a bit test.
+    const ChunkPos& pos = context.m_node.m_pos;
+    uint32_t hits = 0;
+    for (uint32_t i = 0; i < m_settings.m_randomTicks; i++) {
+        const uint32_t index = context.Random() & 32767;
+        const uint8_t x = index >> 10, y = (index >> 5) & 31, z = index & 31;
+        if (!it->second.m_bitmap.GetBit(x, y, z))
+            continue;
+
+        // Earlier ticks may have changed the block since the bitmap was built.
+        const int32_t wx = pos.m_x * 32 + x, wy = pos.m_y * 32 + y, wz = pos.m_z * 32 + z;
+        const uint16_t block = context.GetBlock(wx, wy, wz);
+        if (block < m_randomTickers.size() && m_randomTickers[block]) {
+            m_randomTickers[block](context, wx, wy, wz);
+            hits++;
+        }
+    }
+
+    return hits;
+}
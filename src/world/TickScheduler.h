@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+
+class IChunk;
+class World;
+struct ChunkNode;
+
+// Ticks simulations that read and write the blocks around a chunk. Chunks are colored into 27
+// phases by their position modulo 3 on each axis, so two chunks of the same phase are always at
+// least 3 chunks apart and their 3x3x3 neighborhoods never overlap. Each phase runs across the job
+// system without locks, and ticks may touch any block of the chunk or its 26 neighbors.
+//
+// Block types with a random ticker get that many blocks per chunk sampled every tick, where only
+// the samples that land on a tickable block are ticked. Which blocks are tickable is kept as a
+// bitmap per chunk, so chunks without any are skipped without looking at their blocks.
+class TickScheduler final {
+public:
+    // Blocks of the chunk being ticked and its neighbors, in world coordinates.
+    class Context final {
+    public:
+        VXL_INLINE ChunkNode& GetNode() noexcept {
+            return m_node;
+        }
+
+        uint16_t GetBlock(const int32_t x, const int32_t y, const int32_t z) const;
+
+        // Sets a block and returns the old one. Relighting is queued once the phase is done.
+        uint16_t SetBlock(const uint16_t block, const int32_t x, const int32_t y, const int32_t z);
+
+        // Random number that only depends on the tick, the chunk and how often it was called.
+        uint32_t Random();
+    private:
+        friend class TickScheduler;
+
+        struct Change {
+            int32_t m_x, m_y, m_z;
+            uint16_t m_oldBlock;
+            uint16_t m_newBlock;
+        };
+
+        Context(World& world, ChunkNode& node, const uint64_t seed, const std::unordered_map<const ChunkNode*, const IChunk*>& shared) :
+            m_world(world), m_node(node), m_state(seed), m_shared(shared) {}
+
+        World& m_world;
+        ChunkNode& m_node;
+        uint64_t m_state;
+        const std::unordered_map<const ChunkNode*, const IChunk*>& m_shared;
+        std::vector<Change> m_changes;
+    };
+
+    // Called once per tick for every loaded chunk.
+    using Ticker = std::function<void(Context& context)>;
+    // Called for a sampled block of the type, given in world coordinates.
+    using RandomTicker = std::function<void(Context& context, const int32_t x, const int32_t y, const int32_t z)>;
+
+    struct Settings {
+        uint32_t m_randomTicks = 48; // Blocks sampled per chunk and tick.
+        uint64_t m_seed = 0;
+    };
+
+    TickScheduler(World& world, const Settings& settings) : m_world(world), m_settings(settings) {}
+
+    VXL_INLINE void AddTicker(Ticker ticker) {
+        m_tickers.push_back(std::move(ticker));
+    }
+
+    // Makes blocks of the type tickable, replacing its previous random ticker.
+    void SetRandomTicker(const uint16_t block, RandomTicker ticker);
+
+    // Ticks every loaded chunk, a phase at a time.
+    void Tick();
+
+    // Reference tick running the chunks of each phase one after another.
+    void TickNaive();
+
+    // Phase of a chunk, from 0 to 26.
+    static VXL_INLINE uint32_t GetPhase(const ChunkPos& pos) noexcept {
+        const auto mod3 = [](const int32_t value) {
+            return static_cast<uint32_t>(((value % 3) + 3) % 3);
+        };
+        return mod3(pos.m_x) + 3 * mod3(pos.m_y) + 9 * mod3(pos.m_z);
+    }
+
+    VXL_INLINE uint64_t GetTickCount() const noexcept {
+        return m_tick;
+    }
+
+    // Random ticks that landed on a tickable block so far.
+    VXL_INLINE uint64_t GetRandomTickCount() const noexcept {
+        return m_randomTickCount;
+    }
+private:
+    static Logger sLogger;
+
+    // Tickable blocks of a chunk, valid as long as its blocks weren't set since.
+    struct Tickable {
+        uint64_t m_generation = 0; // See ChunkNode::m_generation.
+        bool m_compressed = false; // Compressed chunks have no bitmap until they are decompressed.
+        bool m_any = false;
+        ChunkBitmap m_bitmap;
+    };
+
+    // Sorts the loaded chunks into their phases, finds their tickable blocks and which of them share
+    // their payloads.
+    void Prepare();
+
+    // Runs the tickers on a chunk. Returns the random ticks that landed.
+    uint32_t TickChunk(Context& context);
+
+    World& m_world;
+    Settings m_settings;
+    uint64_t m_tick = 0;
+    uint64_t m_randomTickCount = 0;
+    std::vector<Ticker> m_tickers;
+    std::array<RandomTicker, 64> m_randomTickers;
+    std::vector<uint16_t> m_tickableBlocks;
+
+    std::array<std::vector<ChunkNode*>, 27> m_phases;
+    std::unordered_map<uint64_t, Tickable> m_tickable; // Packed chunk position to its tickable blocks.
+    // Chunks whose payloads were shared when the tick began, to that payload. Threads copying a shared
+    // payload change its use count under the others, so it can't tell who may write in place.
+    std::unordered_map<const ChunkNode*, const IChunk*> m_shared;
+};
@@ -0,0 +1,164 @@
+#include "world/World.h"
+
+#include "util/JobSystem.h"
+#include "world/ChunkStreamer.h"
+#include "world/chunk/ChunkCodec.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+Logger World::sLogger = Logger("World");
+
+ChunkNode* World::LoadChunk(const ChunkPos& pos) {
+    ChunkNode* node = m_chunks.Insert(pos);
+    if (node->m_chunk == nullptr && !node->IsCompressed()) {
+        node->m_chunk = std::make_unique<EightBitChunk>();
+        Stamp(*node);
+    }
+
+    if (node->m_cullSlot == FrustumCuller::sInvalidSlot) {
+        const glm::vec3 min = glm::vec3(pos.m_x * 32.0f, pos.m_y * 32.0f, pos.m_z * 32.0f);
+        node->m_cullSlot = m_culler.Insert(min, min + glm::vec3(32.0f, 32.0f, 32.0f));
+        m_cullNodes.push_back(node);
+        // The resident chunk is what counts from now on, the far field gets it back on unload.
+        m_farField.RemoveChunk(pos);
+    }
+
+    return node;
+}
+
+bool World::UnloadChunk(const ChunkPos& pos) {
+    ChunkNode* node = m_chunks.Find(pos);
+    if (node == nullptr)
+        return false;
+
+    // The last box moves into the freed slot.
+    const uint32_t slot = node->m_cullSlot;
+    if (slot != FrustumCuller::sInvalidSlot) {
+        if (m_culler.Remove(slot) != FrustumCuller::sInvalidSlot) {
+            m_cullNodes[slot] = m_cullNodes.back();
+            m_cullNodes[slot]->m_cullSlot = slot;
+        }
+        m_cullNodes.pop_back();
+        node->m_cullSlot = FrustumCuller::sInvalidSlot;
+    }
+
+    if (node->m_state != ChunkState::eEmpty)
+        m_farField.SetChunk(pos, node->m_solid);
+    if (node->m_modified && m_saver) {
+        DecompressChunk(*node);
+        m_saver(*node);
+    }
+
+    return m_chunks.Remove(pos);
+}
+
+void World::SaveAll() {
+    if (!m_saver)
+        return;
+
+    m_chunks.ForEach([this](ChunkNode& node) {
+        if (!node.m_modified)
+            return;
+
+        DecompressChunk(node);
+        m_saver(node);
+        node.m_modified = false;
+    });
+}
+
+void World::CullChunks(const FrustumCuller::Planes& planes, std::vector<ChunkNode*>& visible) const {
+    m_culler.Cull(planes, m_visibleSlots);
+
+    visible.resize(m_visibleSlots.size());
+    for (size_t i = 0; i < m_visibleSlots.size(); i++)
+        visible[i] = m_cullNodes[m_visibleSlots[i]];
+}
+
+uint16_t World::GetBlock(const int32_t x, const int32_t y, const int32_t z) const {
+    const ChunkNode* node = m_chunks.Find(ChunkPos::FromBlock(x, y, z));
+    if (node == nullptr)
+        return BlockTypes::eAir;
+    if (node->IsCompressed())
+        return ChunkCodec::GetBlock(node->m_compressed, x & 31, y & 31, z & 31);
+    if (node->m_chunk == nullptr)
+        return BlockTypes::eAir;
+
+    return node->m_chunk->GetBlock(x & 31, y & 31, z & 31);
+}
+
+uint16_t World::SetBlock(const uint16_t block, const int32_t x, const int32_t y, const int32_t z) {
+    const uint16_t oldBlock = SetBlockUnlit(block, x, y, z);
+    const ChunkNode* node = m_chunks.Find(ChunkPos::FromBlock(x, y, z));
+    if (node != nullptr && node->m_chunk != nullptr && node->m_light != nullptr)
+        m_light.QueueChange(x, y, z, oldBlock, block);
+    return oldBlock;
+}
+
+uint16_t World::SetBlockUnlit(const uint16_t block, const int32_t x, const int32_t y, const int32_t z) {
+    ChunkNode* node = m_chunks.Find(ChunkPos::FromBlock(x, y, z));
+    if (node == nullptr)
+        return BlockTypes::eAir;
+    DecompressChunk(*node);
+    if (node->m_chunk == nullptr)
+        return BlockTypes::eAir;
+
+    // Payloads shared with other chunks are copied on the first write.
+    if (node->m_chunk.use_count() > 1)
+        node->m_chunk = node->m_chunk->Clone();
+
+    node->m_meshDirty = true;
+    node->m_modified = true;
+    Stamp(*node);
+    node->m_solid.SetBit(x & 31, y & 31, z & 31, block != BlockTypes::eAir);
+    // Only blocks on the boundary of the chunk can change its full faces.
+    if (((x + 1) & 31) < 2 || ((y + 1) & 31) < 2 || ((z + 1) & 31) < 2)
+        node->m_fullFaces = node->m_solid.GetFullFaces();
+
+    return node->m_chunk->SetBlock(block, x & 31, y & 31, z & 31);
+}
+
+bool World::BeginBulkEdit(ChunkNode& node) {
+    DecompressChunk(node);
+    if (node.m_chunk.use_count() > 1)
+        node.m_chunk = node.m_chunk->Clone();
+    return dynamic_cast<EightBitChunk*>(node.m_chunk.get()) != nullptr;
+}
+
+void World::EndBulkEdit(std::span<ChunkNode* const> nodes, ChunkStreamer* streamer, const bool relight) {
+    JobSystem::ParallelFor(static_cast<uint32_t>(nodes.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            nodes[i]->m_fullFaces = nodes[i]->m_solid.GetFullFaces();
+            nodes[i]->m_connectivity = ChunkConnectivity::Compute(nodes[i]->m_solid);
+        }
+    });
+
+    // Too many blocks change for relighting them one by one.
+    for (ChunkNode* node : nodes) {
+        node->m_meshDirty = true;
+        node->m_modified = true;
+        Stamp(*node);
+        if (relight && node->m_light != nullptr)
+            m_light.RelightChunk(node->m_pos);
+        if (streamer != nullptr)
+            streamer->QueueMesh(node->m_pos);
+    }
+}
+
+void World::CompressChunk(ChunkNode& node) {
+    const EightBitChunk* chunk = dynamic_cast<const EightBitChunk*>(node.m_chunk.get());
+    // A shared payload stays alive for the other chunks, so compressing it would only add memory.
+    if (chunk == nullptr || node.m_state == ChunkState::eEmpty || node.m_chunk.use_count() > 1)
+        return;
+
+    ChunkCodec::Encode(*chunk, node.m_compressed);
+    node.m_chunk.reset();
+}
+
+void World::DecompressChunk(ChunkNode& node) {
+    if (!node.IsCompressed())
+        return;
+
+    std::unique_ptr<EightBitChunk> chunk = std::make_unique<EightBitChunk>();
+    ChunkCodec::Decode(node.m_compressed, *chunk);
+    node.m_chunk = std::move(chunk);
+    node.m_compressed = std::vector<uint8_t>();
+}
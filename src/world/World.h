@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include "renderer/FrustumCuller.h"
+#include "util/Logger.h"
+#include "world/Block.h"
+#include "world/ChunkMap.h"
+#include "world/ChunkPos.h"
+#include "world/LightEngine.h"
+#include "world/SparseVoxelDAG.h"
+#include "world/chunk/ChunkInterner.h"
+
+// Container for every chunk resident in the world. Blocks are addressed in world coordinates.
+class ChunkStreamer;
+
+class World final {
+public:
+    // Writes a modified chunk to storage.
+    using Saver = std::function<void(ChunkNode&)>;
+
+    World() = default;
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    // Creates an empty (all air) chunk at the given position, or returns the resident one. A created
+    // chunk takes over from what the far field kept of it.
+    ChunkNode* LoadChunk(const ChunkPos& pos);
+
+    // Removes the chunk at the given position, keeping its solid voxels in the far field if it was
+    // loaded and saving it if it was modified. Returns false if it wasn't resident.
+    bool UnloadChunk(const ChunkPos& pos);
+
+    // Saves every modified chunk.
+    void SaveAll();
+
+    VXL_INLINE void SetSaver(Saver saver) {
+        m_saver = std::move(saver);
+    }
+
+    // Gets a block in world coordinates. Blocks in chunks that aren't resident are air.
+    uint16_t GetBlock(const int32_t x, const int32_t y, const int32_t z) const;
+
+    // Sets a block in world coordinates and returns the old one, queueing the change for relighting if
+    // the chunk is lit. Does nothing if the chunk isn't resident.
+    uint16_t SetBlock(const uint16_t block, const int32_t x, const int32_t y, const int32_t z);
+
+    // Sets a block like SetBlock() but leaves relighting to the caller. Only touches the chunk's own
+    // node, so threads may set blocks of different chunks at once.
+    uint16_t SetBlockUnlit(const uint16_t block, const int32_t x, const int32_t y, const int32_t z);
+
+    // Replaces the voxel data of a loaded chunk with its compressed form. Its solid bitmap stays, and
+    // blocks can still be read. Setting a block decompresses it again.
+    void CompressChunk(ChunkNode& node);
+
+    // Restores the voxel data of a compressed chunk. Does nothing if it isn't compressed.
+    void DecompressChunk(ChunkNode& node);
+
+    // Readies a resident chunk for many of its blocks to be written from a job, decompressing its
+    // payload and copying it if it's shared, as neither is thread safe. Returns false if the payload
+    // isn't eight bits per block, the only kind written in bulk.
+    bool BeginBulkEdit(ChunkNode& node);
+
+    // Finishes chunks whose blocks were written in bulk after their solid bitmaps were updated,
+    // queueing them for remeshing on the streamer, which may be null. Lit chunks are relit as a whole
+    // unless the caller relights the changed blocks itself.
+    void EndBulkEdit(std::span<ChunkNode* const> nodes, ChunkStreamer* streamer, const bool relight = true);
+
+    // Marks the blocks of a chunk as changed for caches built from them, see ChunkNode::m_generation.
+    // Can be called from any thread.
+    VXL_INLINE void Stamp(ChunkNode& node) noexcept {
+        node.m_generation = m_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Writes every resident chunk that is at least partially inside the frustum.
+    void CullChunks(const FrustumCuller::Planes& planes, std::vector<ChunkNode*>& visible) const;
+
+    VXL_INLINE ChunkNode* GetChunk(const ChunkPos& pos) const noexcept {
+        return m_chunks.Find(pos);
+    }
+
+    VXL_INLINE ChunkMap& GetChunks() noexcept {
+        return m_chunks;
+    }
+
+    VXL_INLINE const ChunkMap& GetChunks() const noexcept {
+        return m_chunks;
+    }
+
+    // Compressed solid voxels of chunks that were unloaded.
+    VXL_INLINE SparseVoxelDAG& GetFarField() noexcept {
+        return m_farField;
+    }
+
+    VXL_INLINE const SparseVoxelDAG& GetFarField() const noexcept {
+        return m_farField;
+    }
+
+    // Shares the payloads of chunks with identical blocks.
+    VXL_INLINE ChunkInterner& GetInterner() noexcept {
+        return m_interner;
+    }
+
+    VXL_INLINE const ChunkInterner& GetInterner() const noexcept {
+        return m_interner;
+    }
+
+    // Sky and block light of the resident chunks, relit on Update after blocks change.
+    VXL_INLINE LightEngine& GetLight() noexcept {
+        return m_light;
+    }
+
+    VXL_INLINE const LightEngine& GetLight() const noexcept {
+        return m_light;
+    }
+private:
+    static Logger sLogger;
+
+    ChunkMap m_chunks;
+
+    // Bounding boxes of the resident chunks, along with the node in every slot.
+    FrustumCuller m_culler;
+    std::vector<ChunkNode*> m_cullNodes;
+    mutable std::vector<uint32_t> m_visibleSlots;
+
+    SparseVoxelDAG m_farField;
+    ChunkInterner m_interner;
+    std::atomic<uint64_t> m_generation = 0;
+    LightEngine m_light = LightEngine(*this);
+    Saver m_saver;
+};
@@ -1,5 +1,6 @@
 #include "world/chunk/ChunkBitmap.h"
 
+#include <bit>
 #include <bitset>
 
 // ========== SIMD ==========
@@ -35,7 +36,7 @@ std::array<uint32_t, 32> GetActiveRows(uint32_t* bitmap) {
         for (uint32_t j = 0; j < 32; j += numLanes) {
             auto data = hw::Load(u32Tag, bitmap + (i * 32) + j);
             auto results = hw::Ne(data, zero);
-            uint32_t maskBits;
+            uint32_t maskBits = 0; // StoreMaskBits only writes the bytes needed for the lanes.
             hw::StoreMaskBits(u32Tag, results, reinterpret_cast<uint8_t*>(&maskBits));
             slice |= maskBits << j;
         }
@@ -54,7 +55,7 @@ uint32_t GetActiveSlices(std::array<uint32_t, 32>& activeRows) {
     for (uint32_t i = 0; i < 32; i += numLanes) {
         auto data = hw::Load(u32Tag, activeRows.data() + i);
         auto results = hw::Ne(data, zero);
-        uint32_t maskBits;
+        uint32_t maskBits = 0;
         hw::StoreMaskBits(u32Tag, results, reinterpret_cast<uint8_t*>(&maskBits));
         activeSlices |= maskBits << i;
     }
@@ -64,7 +65,7 @@ uint32_t GetActiveSlices(std::array<uint32_t, 32>& activeRows) {
 
 // Potential future optimization: parallelize width expansion.
 template<AxisOrder order>
-void GreedyMeshBitmapImpl(uint32_t* bitmap, std::vector<uint32_t>& vertices) {
+void GreedyMeshBitmapImpl(uint32_t* bitmap, std::vector<uint32_t>& vertices, const uint32_t face) {
     const hw::FixedTag<uint32_t, 4> u32Tag;
     const uint32_t numLanes = hw::Lanes(u32Tag);
 
@@ -73,7 +74,7 @@ void GreedyMeshBitmapImpl(uint32_t* bitmap, std::vector<uint32_t>& vertices) {
 
     // alignas(16) std::array<uint32_t, 1025> endPoints = GetGreedyEnds(bitmap, activeSlices);
 
-    uint32_t code = 0;
+    const uint32_t facePacked = face << 25;
     while (activeSlices != 0) {
         const uint32_t slice = std::countr_zero(activeSlices);
         // const uint32_t slicePacked = slice << sliceShift;
@@ -100,17 +101,17 @@ void GreedyMeshBitmapImpl(uint32_t* bitmap, std::vector<uint32_t>& vertices) {
                 }
 
                 if constexpr (order == AxisOrder::eXYZ)
-                    vertices.push_back(((height - 1) << 20) | ((width - 1) << 15) | (slice << 10) | (row << 5) | (bottom << 0));
+                    vertices.push_back(facePacked | ((height - 1) << 20) | ((width - 1) << 15) | (slice << 10) | (row << 5) | (bottom << 0));
                 else if constexpr (order == AxisOrder::eXZY)
-                    vertices.push_back(((height - 1) << 20) | ((width - 1) << 15) | (slice << 10) | (row << 0) | (bottom << 5));
+                    vertices.push_back(facePacked | ((height - 1) << 20) | ((width - 1) << 15) | (slice << 10) | (row << 0) | (bottom << 5));
                 else if constexpr (order == AxisOrder::eYXZ)
-                    vertices.push_back(((height - 1) << 20) | ((width - 1) << 15) | (slice << 5) | (row << 10) | (bottom << 0));
+                    vertices.push_back(facePacked | ((height - 1) << 20) | ((width - 1) << 15) | (slice << 5) | (row << 10) | (bottom << 0));
                 else if constexpr (order == AxisOrder::eYZX)
-                    vertices.push_back(((height - 1) << 20) | ((width - 1) << 15) | (slice << 5) | (row << 0) | (bottom << 10));
+                    vertices.push_back(facePacked | ((height - 1) << 20) | ((width - 1) << 15) | (slice << 5) | (row << 0) | (bottom << 10));
                 else if constexpr (order == AxisOrder::eZXY)
-                    vertices.push_back(((height - 1) << 20) | ((width - 1) << 15) | (slice << 0) | (row << 10) | (bottom << 5));
+                    vertices.push_back(facePacked | ((height - 1) << 20) | ((width - 1) << 15) | (slice << 0) | (row << 10) | (bottom << 5));
                 else if constexpr (order == AxisOrder::eZYX)
-                    vertices.push_back(((height - 1) << 20) | ((width - 1) << 15) | (slice << 0) | (row << 5) | (bottom << 10));
+                    vertices.push_back(facePacked | ((height - 1) << 20) | ((width - 1) << 15) | (slice << 0) | (row << 5) | (bottom << 10));
             }
             activeRows[slice] ^= 1U << row;
         }
@@ -333,14 +334,14 @@ ChunkBitmap& ChunkBitmap::And(const ChunkBitmap& otherBitmap) {
     return *this;
 }
 
-void ChunkBitmap::GreedyMeshBitmap(std::vector<uint32_t>& vertices) {
+void ChunkBitmap::GreedyMeshBitmap(std::vector<uint32_t>& vertices, Direction face) {
     switch (m_axisOrder) {
-        case AxisOrder::eXYZ: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eXYZ>)(m_bitmap.data(), vertices);
-        case AxisOrder::eXZY: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eXZY>)(m_bitmap.data(), vertices);
-        case AxisOrder::eYXZ: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eYXZ>)(m_bitmap.data(), vertices);
-        case AxisOrder::eYZX: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eYZX>)(m_bitmap.data(), vertices);
-        case AxisOrder::eZXY: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eZXY>)(m_bitmap.data(), vertices);
-        case AxisOrder::eZYX: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eZYX>)(m_bitmap.data(), vertices);
+        case AxisOrder::eXYZ: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eXYZ>)(m_bitmap.data(), vertices, face);
+        case AxisOrder::eXZY: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eXZY>)(m_bitmap.data(), vertices, face);
+        case AxisOrder::eYXZ: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eYXZ>)(m_bitmap.data(), vertices, face);
+        case AxisOrder::eYZX: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eYZX>)(m_bitmap.data(), vertices, face);
+        case AxisOrder::eZXY: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eZXY>)(m_bitmap.data(), vertices, face);
+        case AxisOrder::eZYX: return HWY_STATIC_DISPATCH(GreedyMeshBitmapImpl<AxisOrder::eZYX>)(m_bitmap.data(), vertices, face);
     }
 };
 
@@ -507,8 +508,8 @@ bool ChunkBitmap::TestOuterTransposes() const {
     ChunkBitmap naive;
     ChunkBitmap simd = Copy();
 
-    (*this).Copy().InnerTransposeNaive(naive);
-    simd.InnerTranspose();
+    (*this).Copy().OuterTransposeNaive(naive);
+    simd.OuterTranspose();
 
     if (naive != simd) {
         sLogger.Verbose("Source:");
@@ -524,7 +525,7 @@ bool ChunkBitmap::TestOuterTransposes() const {
         return false;
     }
 
-    sLogger.Warning("Verified the accuracy of outer transpositions!");
+    sLogger.Verbose("Verified the accuracy of outer transpositions!");
 
     return true;
 }
@@ -537,6 +538,27 @@ bool ChunkBitmap::operator==(const ChunkBitmap& otherBitmap) const {
     return true;
 }
 
+uint8_t ChunkBitmap::GetFullFaces() const {
+    uint32_t negX = ~0u, posX = ~0u, negY = ~0u, posY = ~0u, allRows = ~0u;
+    for (uint32_t i = 0; i < 32; i++) {
+        negX &= m_bitmap[i];
+        posX &= m_bitmap[(31 << 5) | i];
+        negY &= m_bitmap[i << 5];
+        posY &= m_bitmap[(i << 5) | 31];
+    }
+    for (uint32_t i = 0; i < 1024; i++)
+        allRows &= m_bitmap[i];
+
+    uint8_t faces = 0;
+    faces |= (negX == ~0u) << Direction::eNegX;
+    faces |= (posX == ~0u) << Direction::ePosX;
+    faces |= (negY == ~0u) << Direction::eNegY;
+    faces |= (posY == ~0u) << Direction::ePosY;
+    faces |= (allRows & 1u) << Direction::eNegZ;
+    faces |= (allRows >> 31) << Direction::ePosZ;
+    return faces;
+}
+
 void ChunkBitmap::LogInnerSlice(uint8_t layer) const {
     for (int i = 0; i < 32; i++) {
         sLogger.Verbose(std::bitset<32>(m_bitmap[i + (32 * layer)]));
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <vector>
 #include "util/Logger.h"
+#include "world/Direction.h"
 
 enum AxisOrder : uint8_t {
     eXYZ = 0,
@@ -22,7 +23,9 @@ public:
 
     ChunkBitmap(const std::array<uint32_t, 1024>& otherBitmap) : m_bitmap(otherBitmap) {};
 
-    void GreedyMeshBitmap(std::vector<uint32_t>& vertices);
+    // Greedy meshes the bitmap into packed quads, consuming the set bits. The face is stored in
+    // the upper bits of every quad (see ChunkMesh::Greedy).
+    void GreedyMeshBitmap(std::vector<uint32_t>& vertices, Direction face);
     
     ChunkBitmap& CullMostSigBits();
 
@@ -49,11 +52,33 @@ public:
     void LogOuterSlice(uint8_t layer = 0) const;
 
     ChunkBitmap& And(const ChunkBitmap& otherMap);
+
+    // Bit per Direction, set if the boundary layer of the chunk on that side is entirely set.
+    // Only valid for bitmaps in the xyz order.
+    uint8_t GetFullFaces() const;
+
+    // Bit access for bitmaps in the xyz order.
+    VXL_INLINE bool GetBit(const uint8_t x, const uint8_t y, const uint8_t z) const noexcept {
+        return (m_bitmap[(x << 5) | y] >> z) & 1;
+    }
+
+    VXL_INLINE void SetBit(const uint8_t x, const uint8_t y, const uint8_t z, const bool value) noexcept {
+        const uint32_t bit = 1u << z;
+        m_bitmap[(x << 5) | y] = value ? (m_bitmap[(x << 5) | y] | bit) : (m_bitmap[(x << 5) | y] & ~bit);
+    }
     
     VXL_INLINE uint32_t* Data() noexcept {
         return m_bitmap.data();
     }
 
+    VXL_INLINE const uint32_t* Data() const noexcept {
+        return m_bitmap.data();
+    }
+
+    VXL_INLINE AxisOrder GetAxisOrder() const noexcept {
+        return m_axisOrder;
+    }
+
     VXL_INLINE ChunkBitmap Copy() const {
         return ChunkBitmap(*this);
     }
@@ -81,19 +106,20 @@ private:
         m_axisOrder = sAxisOrderAfterInner[m_axisOrder];
     }
 
+    // Swaps the masked low bits of b with the bits of a that sit shift bits higher.
     static void VXL_INLINE SwapBits32(uint32_t& a, uint32_t& b, uint32_t mask, uint32_t shift) {
-        uint32_t t = ((b >> shift) ^ a) & mask;
-        a ^= t;
-        b ^= (t << shift);
+        uint32_t t = ((a >> shift) ^ b) & mask;
+        b ^= t;
+        a ^= (t << shift);
     }
 
     static void VXL_INLINE SwapBits64(uint64_t& a, uint64_t& b, uint64_t mask, uint64_t shift) {
-        uint64_t t = ((b >> shift) ^ a) & mask;
-        a ^= t;
-        b ^= (t << shift);
+        uint64_t t = ((a >> shift) ^ b) & mask;
+        b ^= t;
+        a ^= (t << shift);
     }
 
     alignas(16) std::array<uint32_t, 1024> m_bitmap;
 
-    AxisOrder m_axisOrder;
+    AxisOrder m_axisOrder = AxisOrder::eXYZ;
 };
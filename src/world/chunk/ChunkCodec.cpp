@@ -0,0 +1,281 @@
+#include "world/chunk/ChunkCodec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// ========== SIMD ==========
+
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+
+namespace HWY_NAMESPACE {
+namespace hw = hwy::HWY_NAMESPACE;
+
+const hw::CappedTag<uint8_t, 64> u8Tag;
+const size_t numLanes = hw::Lanes(u8Tag);
+
+// Maps every byte below 16 through the table, 16 bytes at a time per 128 bit block.
+void LookupImpl(const uint8_t* in, uint8_t* out, const size_t count, const uint8_t* table) {
+    const auto tableVec = hw::LoadDup128(u8Tag, table);
+    size_t i = 0;
+    for (; i + numLanes <= count; i += numLanes)
+        hw::StoreU(hw::TableLookupBytes(tableVec, hw::LoadU(u8Tag, in + i)), u8Tag, out + i);
+    for (; i < count; i++)
+        out[i] = table[in[i]];
+}
+
+// Plane k of the indices goes into the bits of every packed byte starting at k * bits.
+void PackImpl(const uint8_t* indices, uint8_t* packed, const size_t planeSize, const uint32_t bits) {
+    const uint32_t planes = 8 / bits;
+    size_t j = 0;
+    for (; j + numLanes <= planeSize; j += numLanes) {
+        auto packedVec = hw::LoadU(u8Tag, indices + j);
+        for (uint32_t k = 1; k < planes; k++)
+            packedVec = hw::Or(packedVec, hw::ShiftLeftSame(hw::LoadU(u8Tag, indices + k * planeSize + j), k * bits));
+        hw::StoreU(packedVec, u8Tag, packed + j);
+    }
+    for (; j < planeSize; j++) {
+        uint8_t value = 0;
+        for (uint32_t k = 0; k < planes; k++)
+            value |= indices[k * planeSize + j] << (k * bits);
+        packed[j] = value;
+    }
+}
+
+void UnpackImpl(const uint8_t* packed, uint8_t* indices, const size_t planeSize, const uint32_t bits) {
+    const uint32_t planes = 8 / bits;
+    const uint8_t mask = static_cast<uint8_t>((1u << bits) - 1);
+    const auto maskVec = hw::Set(u8Tag, mask);
+    size_t j = 0;
+    for (; j + numLanes <= planeSize; j += numLanes) {
+        const auto packedVec = hw::LoadU(u8Tag, packed + j);
+        for (uint32_t k = 0; k < planes; k++)
+            hw::StoreU(hw::And(hw::ShiftRightSame(packedVec, k * bits), maskVec), u8Tag, indices + k * planeSize + j);
+    }
+    for (; j < planeSize; j++) {
+        for (uint32_t k = 0; k < planes; k++)
+            indices[k * planeSize + j] = (packed[j] >> (k * bits)) & mask;
+    }
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+// ========== SIMD Wrappers ==========
+
+#if HWY_ONCE
+
+// Maps the bytes through a table of 64 entries, using byte shuffles if they all index its first 16.
+static void Lookup(const uint8_t* in, uint8_t* out, const size_t count, const std::array<uint8_t, 64>& table, const bool small) {
+    if (small) {
+        HWY_STATIC_DISPATCH(LookupImpl)(in, out, count, table.data());
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        out[i] = table[in[i] & 63];
+}
+
+// Packs a padded count of indices, see ChunkCodec::GetPackedSize.
+static void Pack(const uint8_t* indices, uint8_t* packed, const size_t count, const uint32_t bits) {
+    const size_t planeSize = ((count + 7) & ~size_t(7)) * bits / 8;
+    HWY_STATIC_DISPATCH(PackImpl)(indices, packed, planeSize, bits);
+}
+
+static void Unpack(const uint8_t* packed, uint8_t* indices, const size_t count, const uint32_t bits) {
+    const size_t planeSize = ((count + 7) & ~size_t(7)) * bits / 8;
+    HWY_STATIC_DISPATCH(UnpackImpl)(packed, indices, planeSize, bits);
+}
+
+// ========== Scalar ==========
+
+Logger ChunkCodec::sLogger = Logger("ChunkCodec");
+
+void ChunkCodec::Encode(const EightBitChunk& chunk, std::vector<uint8_t>& data) {
+    const uint8_t* blocks = chunk.Data();
+
+    // The palette's counts can be trusted as long as they cover the chunk.
+    std::array<uint16_t, 64> counts = chunk.m_blockPaletteCounts;
+    uint32_t total = 0;
+    for (const uint16_t count : counts)
+        total += count;
+    if (total != 32768) {
+        counts.fill(0);
+        for (uint32_t i = 0; i < 32768; i++)
+            counts[blocks[i] & 63]++;
+    }
+
+    Header header = {};
+    std::array<uint8_t, 64> palette{};
+    std::array<uint8_t, 64> indexOf{};
+    for (uint32_t block = 0; block < 64; block++) {
+        if (counts[block] == 0)
+            continue;
+
+        indexOf[block] = header.m_paletteSize;
+        palette[header.m_paletteSize++] = static_cast<uint8_t>(block);
+    }
+    header.m_bits = GetBits(header.m_paletteSize);
+
+    data.clear();
+    data.resize(GetMaskOffset(header));
+    uint8_t* entries = data.data() + sizeof(Header);
+    for (uint32_t i = 0; i < header.m_paletteSize; i++) {
+        entries[i] = palette[i];
+        std::memcpy(entries + header.m_paletteSize + i * sizeof(uint16_t), &counts[palette[i]], sizeof(uint16_t));
+    }
+
+    if (header.m_bits == 0) {
+        std::memcpy(data.data(), &header, sizeof(Header));
+        data.shrink_to_fit();
+        return;
+    }
+
+    alignas(64) std::array<uint8_t, 32768> indices;
+    Lookup(blocks, indices.data(), indices.size(), indexOf, palette[header.m_paletteSize - 1] < 16);
+
+    // Mixed rows are moved down over the uniform ones, so they end up back to back.
+    std::array<uint64_t, 16> uniformMask{};
+    std::array<uint8_t, 1024> uniformIndices{};
+    for (uint32_t row = 0; row < 1024; row++) {
+        const uint8_t* rowIndices = indices.data() + row * 32;
+        std::array<uint64_t, 4> words;
+        std::memcpy(words.data(), rowIndices, sizeof(words));
+        if (words[0] == rowIndices[0] * 0x0101010101010101ull && words[1] == words[0] && words[2] == words[0] && words[3] == words[0]) {
+            uniformMask[row >> 6] |= 1ull << (row & 63);
+            uniformIndices[header.m_uniformRows++] = rowIndices[0];
+        } else {
+            if (header.m_mixedRows != row)
+                std::memcpy(indices.data() + header.m_mixedRows * 32, rowIndices, 32);
+            header.m_mixedRows++;
+        }
+    }
+
+    const size_t maskOffset = data.size();
+    const size_t uniformSize = GetPackedSize(header.m_uniformRows, header.m_bits);
+    data.resize(maskOffset + sMaskSize + uniformSize + GetPackedSize(header.m_mixedRows * 32, header.m_bits));
+    std::memcpy(data.data(), &header, sizeof(Header));
+    std::memcpy(data.data() + maskOffset, uniformMask.data(), sMaskSize);
+    Pack(uniformIndices.data(), data.data() + maskOffset + sMaskSize, header.m_uniformRows, header.m_bits);
+    Pack(indices.data(), data.data() + maskOffset + sMaskSize + uniformSize, header.m_mixedRows * 32, header.m_bits);
+    data.shrink_to_fit();
+}
+
+ChunkCodec::Header ChunkCodec::ReadHeader(const std::vector<uint8_t>& data) {
+    Header header;
+    if (data.size() < sizeof(Header))
+        throw sLogger.RuntimeError("Encoded chunk is missing its header!");
+    std::memcpy(&header, data.data(), sizeof(Header));
+
+    const size_t maskOffset = GetMaskOffset(header);
+    const size_t expected = header.m_bits == 0 ? maskOffset : maskOffset + sMaskSize + GetPackedSize(header.m_uniformRows, header.m_bits) + GetPackedSize(header.m_mixedRows * 32, header.m_bits);
+    if (header.m_paletteSize == 0 || header.m_paletteSize > 64 || header.m_bits != GetBits(header.m_paletteSize) || data.size() != expected || (header.m_bits != 0 && header.m_uniformRows + header.m_mixedRows != 1024))
+        throw sLogger.RuntimeError("Encoded chunk is malformed!");
+
+    // Block IDs are ascending and fit a chunk's palette, and the counts cover the chunk.
+    const uint8_t* entries = data.data() + sizeof(Header);
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < header.m_paletteSize; i++) {
+        uint16_t count;
+        std::memcpy(&count, entries + header.m_paletteSize + i * sizeof(uint16_t), sizeof(uint16_t));
+        total += count;
+        if (entries[i] >= 64 || (i > 0 && entries[i] <= entries[i - 1]))
+            throw sLogger.RuntimeError("Encoded chunk is malformed!");
+    }
+    if (total != 32768)
+        throw sLogger.RuntimeError("Encoded chunk is malformed!");
+    if (header.m_bits == 0)
+        return header;
+
+    uint32_t uniformRows = 0;
+    for (uint32_t i = 0; i < sMaskSize / sizeof(uint64_t); i++) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + maskOffset + i * sizeof(uint64_t), sizeof(uint64_t));
+        uniformRows += std::popcount(word);
+    }
+    if (uniformRows != header.m_uniformRows)
+        throw sLogger.RuntimeError("Encoded chunk is malformed!");
+
+    return header;
+}
+
+void ChunkCodec::Decode(const std::vector<uint8_t>& data, EightBitChunk& chunk) {
+    const Header header = ReadHeader(data);
+    const size_t maskOffset = GetMaskOffset(header);
+    const size_t uniformSize = GetPackedSize(header.m_uniformRows, header.m_bits);
+
+    std::array<uint8_t, 64> palette{};
+    std::array<uint16_t, 64> counts{};
+    const uint8_t* entries = data.data() + sizeof(Header);
+    for (uint32_t i = 0; i < header.m_paletteSize; i++) {
+        palette[i] = entries[i];
+        std::memcpy(&counts[entries[i]], entries + header.m_paletteSize + i * sizeof(uint16_t), sizeof(uint16_t));
+    }
+
+    uint8_t* blocks = chunk.Data();
+    if (header.m_bits == 0) {
+        std::memset(blocks, palette[0], 32768);
+        chunk.ResetPalette(counts);
+        return;
+    }
+
+    std::array<uint64_t, 16> uniformMask;
+    std::memcpy(uniformMask.data(), data.data() + maskOffset, sMaskSize);
+    std::array<uint8_t, 1024> uniformIndices;
+    Unpack(data.data() + maskOffset + sMaskSize, uniformIndices.data(), header.m_uniformRows, header.m_bits);
+
+    // Mixed rows unpack to the front of the chunk and move up to their rows, from the last one
+    // down, so that no row is overwritten before it has moved.
+    Unpack(data.data() + maskOffset + sMaskSize + uniformSize, blocks, header.m_mixedRows * 32, header.m_bits);
+    uint32_t uniformRow = header.m_uniformRows;
+    uint32_t mixedRow = header.m_mixedRows;
+    for (uint32_t row = 1024; row-- > 0;) {
+        if ((uniformMask[row >> 6] >> (row & 63)) & 1)
+            std::memset(blocks + row * 32, uniformIndices[--uniformRow], 32);
+        else if (--mixedRow != row)
+            std::memcpy(blocks + row * 32, blocks + mixedRow * 32, 32);
+    }
+
+    // Indices past the palette would look up blocks it doesn't hold.
+    uint8_t maxIndex = 0;
+    for (uint32_t i = 0; i < 32768; i++)
+        maxIndex = std::max(maxIndex, blocks[i]);
+    if (maxIndex >= header.m_paletteSize)
+        throw sLogger.RuntimeError("Encoded chunk is malformed!");
+
+    Lookup(blocks, blocks, 32768, palette, header.m_paletteSize <= 16);
+    chunk.ResetPalette(counts);
+}
+
+uint16_t ChunkCodec::GetBlock(const std::vector<uint8_t>& data, const uint8_t x, const uint8_t y, const uint8_t z) {
+    const Header header = ReadHeader(data);
+    const uint8_t* palette = data.data() + sizeof(Header);
+    if (header.m_bits == 0)
+        return palette[0];
+
+    // Uniform rows before this one give its place among the uniform or the mixed rows.
+    const uint32_t row = (x << 5) | y;
+    const uint8_t* mask = data.data() + GetMaskOffset(header);
+    uint32_t rank = 0;
+    uint64_t word;
+    for (uint32_t i = 0; i < row >> 6; i++) {
+        std::memcpy(&word, mask + i * sizeof(uint64_t), sizeof(uint64_t));
+        rank += std::popcount(word);
+    }
+    std::memcpy(&word, mask + (row >> 6) * sizeof(uint64_t), sizeof(uint64_t));
+    rank += std::popcount(word & ((1ull << (row & 63)) - 1));
+
+    const uint8_t* uniformIndices = mask + sMaskSize;
+    const uint8_t* mixedIndices = uniformIndices + GetPackedSize(header.m_uniformRows, header.m_bits);
+    const uint8_t index = (word >> (row & 63)) & 1 ? GetPacked(uniformIndices, header.m_uniformRows, header.m_bits, rank)
+        : GetPacked(mixedIndices, header.m_mixedRows * 32, header.m_bits, (row - rank) * 32 + z);
+    if (index >= header.m_paletteSize)
+        throw sLogger.RuntimeError("Encoded chunk is malformed!");
+
+    return palette[index];
+}
+
+#endif
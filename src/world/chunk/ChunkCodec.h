@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "util/Logger.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+// Compact encoding of the voxel data of chunks that aren't in use. Blocks are reindexed into the
+// chunk's own palette, z rows of a single index are stored as just that index, and the indices of
+// every other row are bit-packed. Rows keep fixed sizes, so single blocks can be read without
+// decoding and the packing runs over whole vectors.
+class ChunkCodec final {
+public:
+    static void Encode(const EightBitChunk& chunk, std::vector<uint8_t>& data);
+
+    // Writes the blocks back and restores the chunk's palette. Throws if the data is malformed.
+    static void Decode(const std::vector<uint8_t>& data, EightBitChunk& chunk);
+
+    // Reads a block in chunk coordinates from encoded data. Throws if the data is malformed.
+    static uint16_t GetBlock(const std::vector<uint8_t>& data, const uint8_t x, const uint8_t y, const uint8_t z);
+private:
+    static Logger sLogger;
+
+    // Followed by the palette's block IDs, its counts as 16 bits each and, unless every block is
+    // the same, a bit per row marking the uniform ones, their packed indices and the packed
+    // indices of the other rows.
+    struct Header {
+        uint8_t m_paletteSize;
+        uint8_t m_bits; // Per index, 0 for a single block type, otherwise 1, 2, 4 or 8.
+        uint16_t m_uniformRows;
+        uint16_t m_mixedRows;
+    };
+    static_assert(sizeof(Header) == 6);
+
+    static constexpr size_t sMaskSize = 1024 / 8;
+
+    // Reads the header and checks it against the data: the sizes it gives, the palette's block IDs
+    // and counts, and the uniform rows it marks. Throws if they don't match.
+    static Header ReadHeader(const std::vector<uint8_t>& data);
+
+    // Bits per index of a palette, the fewest that divide a byte evenly.
+    static VXL_INLINE uint8_t GetBits(const uint32_t paletteSize) noexcept {
+        return paletteSize <= 1 ? 0 : static_cast<uint8_t>(std::bit_ceil(static_cast<uint32_t>(std::bit_width(paletteSize - 1u))));
+    }
+
+    // Packed indices are split into 8 / bits planes of equal size, and byte j of the packed data
+    // holds index j of every plane, the first plane in the lowest bits. Counts are padded to a
+    // multiple of 8 so that the planes come out even.
+    static VXL_INLINE size_t GetPackedSize(const size_t count, const uint32_t bits) noexcept {
+        return ((count + 7) & ~size_t(7)) * bits / 8;
+    }
+
+    static VXL_INLINE uint8_t GetPacked(const uint8_t* packed, const size_t count, const uint32_t bits, const size_t index) noexcept {
+        const size_t planeSize = GetPackedSize(count, bits);
+        return (packed[index % planeSize] >> (index / planeSize * bits)) & ((1u << bits) - 1);
+    }
+
+    static VXL_INLINE size_t GetMaskOffset(const Header& header) noexcept {
+        return sizeof(Header) + header.m_paletteSize * (sizeof(uint8_t) + sizeof(uint16_t));
+    }
+};
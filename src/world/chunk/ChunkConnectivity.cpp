@@ -0,0 +1,165 @@
+#include "world/chunk/ChunkConnectivity.h"
+
+#include <vector>
+
+Logger ChunkConnectivity::sLogger = Logger("ChunkConnectivity");
+
+// Spreads the seeds along z through the set bits of open, in both directions (Kogge-Stone fill).
+static VXL_INLINE uint32_t FillRow(uint32_t seeds, const uint32_t open) {
+    uint32_t up = seeds & open, down = up;
+    uint32_t upOpen = open, downOpen = open;
+    for (uint32_t shift = 1; shift < 32; shift <<= 1) {
+        up |= upOpen & (up << shift);
+        upOpen &= upOpen << shift;
+        down |= downOpen & (down >> shift);
+        downOpen &= downOpen >> shift;
+    }
+    return up | down;
+}
+
+// Bit per face that the set bits of the bitmap touch.
+static uint8_t TouchedFaces(const std::array<uint32_t, 1024>& bitmap) {
+    uint32_t negX = 0, posX = 0, negY = 0, posY = 0, allRows = 0;
+    for (uint32_t i = 0; i < 32; i++) {
+        negX |= bitmap[i];
+        posX |= bitmap[(31 << 5) | i];
+        negY |= bitmap[i << 5];
+        posY |= bitmap[(i << 5) | 31];
+    }
+    for (uint32_t i = 0; i < 1024; i++)
+        allRows |= bitmap[i];
+
+    uint8_t faces = 0;
+    faces |= (negX != 0) << Direction::eNegX;
+    faces |= (posX != 0) << Direction::ePosX;
+    faces |= (negY != 0) << Direction::eNegY;
+    faces |= (posY != 0) << Direction::ePosY;
+    faces |= (allRows & 1u) << Direction::eNegZ;
+    faces |= (allRows >> 31) << Direction::ePosZ;
+    return faces;
+}
+
+// Sets the open voxels on the face of the chunk.
+static void SeedFace(std::array<uint32_t, 1024>& filled, const std::array<uint32_t, 1024>& open, const Direction face) {
+    filled.fill(0);
+    for (uint32_t i = 0; i < 32; i++) {
+        switch (face) {
+            case Direction::eNegX: filled[i] = open[i]; break;
+            case Direction::ePosX: filled[(31 << 5) | i] = open[(31 << 5) | i]; break;
+            case Direction::eNegY: filled[i << 5] = open[i << 5]; break;
+            case Direction::ePosY: filled[(i << 5) | 31] = open[(i << 5) | 31]; break;
+            case Direction::eNegZ:
+            case Direction::ePosZ:
+                for (uint32_t j = 0; j < 32; j++)
+                    filled[(i << 5) | j] = open[(i << 5) | j] & (face == Direction::eNegZ ? 1u : 1u << 31);
+                break;
+        }
+    }
+}
+
+// Grows the filled voxels through the open ones until nothing changes. Every row takes the bits of
+// its four neighbouring rows and then fills its own runs completely, sweeping forward and backward
+// so that fills travel far within a single pass.
+static void Flood(std::array<uint32_t, 1024>& filled, const std::array<uint32_t, 1024>& open) {
+    const auto update = [&](const uint32_t i) {
+        const uint32_t x = i >> 5;
+        const uint32_t y = i & 31;
+        uint32_t seeds = filled[i];
+        if (x > 0) seeds |= filled[i - 32];
+        if (x < 31) seeds |= filled[i + 32];
+        if (y > 0) seeds |= filled[i - 1];
+        if (y < 31) seeds |= filled[i + 1];
+
+        const uint32_t row = FillRow(seeds, open[i]);
+        const bool changed = row != filled[i];
+        filled[i] = row;
+        return changed;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint32_t i = 0; i < 1024; i++)
+            changed |= update(i);
+        for (uint32_t i = 1024; i-- > 0;)
+            changed |= update(i);
+    }
+}
+
+ChunkConnectivity::Mask ChunkConnectivity::Compute(const ChunkBitmap& solid) {
+    std::array<uint32_t, 1024> open;
+    for (uint32_t i = 0; i < 1024; i++)
+        open[i] = ~solid[i];
+
+    const uint8_t openFaces = TouchedFaces(open);
+    std::array<uint32_t, 1024> filled;
+    Mask mask = sNone;
+
+    // Two faces are connected if a fill from every open voxel of one reaches the other. The last
+    // face never needs its own fill.
+    for (const Direction face : Directions::sAll) {
+        const uint8_t remaining = openFaces & ~((2u << face) - 1);
+        if (((openFaces >> face) & 1) == 0 || remaining == 0)
+            continue;
+
+        SeedFace(filled, open, face);
+        Flood(filled, open);
+
+        const uint8_t reached = TouchedFaces(filled) & remaining;
+        for (const Direction other : Directions::sAll) {
+            if ((reached >> other) & 1)
+                mask |= Pair(face, other);
+        }
+    }
+
+    return mask;
+}
+
+ChunkConnectivity::Mask ChunkConnectivity::ComputeNaive(const ChunkBitmap& solid) {
+    std::vector<bool> visited(32768, false);
+    std::vector<uint32_t> stack;
+    Mask mask = sNone;
+
+    for (uint32_t start = 0; start < 32768; start++) {
+        if (visited[start] || solid.GetBit(start >> 10, (start >> 5) & 31, start & 31))
+            continue;
+
+        // Every face the component touches is connected to every other one.
+        uint8_t faces = 0;
+        visited[start] = true;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const uint32_t index = stack.back();
+            stack.pop_back();
+            const int32_t position[3] = {static_cast<int32_t>(index >> 10), static_cast<int32_t>((index >> 5) & 31), static_cast<int32_t>(index & 31)};
+
+            for (const Direction direction : Directions::sAll) {
+                int32_t next[3];
+                for (uint8_t axis = 0; axis < 3; axis++)
+                    next[axis] = position[axis] + Directions::Offset(direction, axis);
+
+                const uint8_t axis = Directions::Axis(direction);
+                if (next[axis] < 0 || next[axis] > 31) {
+                    faces |= 1u << direction;
+                    continue;
+                }
+
+                const uint32_t nextIndex = (next[0] << 10) | (next[1] << 5) | next[2];
+                if (visited[nextIndex] || solid.GetBit(next[0], next[1], next[2]))
+                    continue;
+
+                visited[nextIndex] = true;
+                stack.push_back(nextIndex);
+            }
+        }
+
+        for (const Direction a : Directions::sAll) {
+            for (const Direction b : Directions::sAll) {
+                if (a != b && ((faces >> a) & 1) && ((faces >> b) & 1))
+                    mask |= Pair(a, b);
+            }
+        }
+    }
+
+    return mask;
+}
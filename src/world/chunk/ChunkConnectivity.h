@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "util/Logger.h"
+#include "world/Direction.h"
+#include "world/chunk/ChunkBitmap.h"
+
+// Which faces of a chunk are connected to each other through non-solid voxels, one bit per
+// unordered pair of distinct faces. Computed with a flood fill over whole bitmap rows.
+class ChunkConnectivity final {
+public:
+    using Mask = uint16_t;
+
+    static constexpr Mask sNone = 0;
+    static constexpr Mask sAll = 0x7FFF; // All 15 pairs, used for chunks that haven't been computed.
+
+    // Connectivity of a solid bitmap in the xyz order.
+    static Mask Compute(const ChunkBitmap& solid);
+
+    // Reference that labels every air voxel with a breadth first search.
+    static Mask ComputeNaive(const ChunkBitmap& solid);
+
+    // Bit of the pair of faces, the faces must differ.
+    VXL_INLINE static Mask Pair(const Direction a, const Direction b) noexcept {
+        return static_cast<Mask>(1u << sPairBits[a * 6 + b]);
+    }
+
+    VXL_INLINE static bool IsConnected(const Mask mask, const Direction a, const Direction b) noexcept {
+        return (mask & Pair(a, b)) != 0;
+    }
+private:
+    static Logger sLogger;
+
+    // Bit index of every ordered pair of faces, symmetric. The diagonal is unused.
+    static constexpr std::array<uint8_t, 36> sPairBits = {
+        15, 0, 1, 2, 3, 4,
+        0, 15, 5, 6, 7, 8,
+        1, 5, 15, 9, 10, 11,
+        2, 6, 9, 15, 12, 13,
+        3, 7, 10, 12, 15, 14,
+        4, 8, 11, 13, 14, 15
+    };
+};
@@ -0,0 +1,76 @@
+#include "world/chunk/ChunkInterner.h"
+
+#include <array>
+#include <cstring>
+
+Logger ChunkInterner::sLogger = Logger("ChunkInterner");
+
+uint64_t ChunkInterner::Hash(const EightBitChunk& chunk) {
+    return Hash(chunk.Data());
+}
+
+uint64_t ChunkInterner::Hash(const uint8_t* blocks) {
+    // Four independent lanes keep the multiplies from waiting on each other.
+    std::array<uint64_t, 4> lanes = {0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull, 0x082EFA98EC4E6C89ull};
+    for (uint32_t i = 0; i < 32768; i += sizeof(lanes)) {
+        std::array<uint64_t, 4> words;
+        std::memcpy(words.data(), blocks + i, sizeof(words));
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            lanes[lane] = (lanes[lane] ^ words[lane]) * 0x9E3779B97F4A7C15ull;
+            lanes[lane] ^= lanes[lane] >> 32;
+        }
+    }
+
+    uint64_t hash = 0;
+    for (const uint64_t lane : lanes)
+        hash = (hash ^ lane) * 0xBF58476D1CE4E5B9ull;
+    return hash ^ (hash >> 31);
+}
+
+std::shared_ptr<IChunk> ChunkInterner::Intern(std::shared_ptr<IChunk> chunk, const uint64_t hash) {
+    Sweep(sSweepsPerIntern);
+
+    const EightBitChunk* blocks = dynamic_cast<const EightBitChunk*>(chunk.get());
+    if (blocks == nullptr)
+        return chunk;
+
+    std::vector<std::weak_ptr<IChunk>>& bucket = m_table[hash];
+    for (const std::weak_ptr<IChunk>& entry : bucket) {
+        std::shared_ptr<IChunk> interned = entry.lock();
+        if (interned == nullptr || interned == chunk)
+            continue;
+
+        // Interned payloads are only ever EightBitChunks.
+        if (std::memcmp(static_cast<const EightBitChunk*>(interned.get())->Data(), blocks->Data(), 32768) == 0) {
+            m_hits++;
+            return interned;
+        }
+    }
+
+    bucket.push_back(chunk);
+    m_entryCount++;
+    return chunk;
+}
+
+void ChunkInterner::Sweep(size_t count) {
+    if (m_sweepKeys.empty()) {
+        // A new sweep starts over every bucket there is now.
+        m_sweepKeys.reserve(m_table.size());
+        for (const auto& [hash, bucket] : m_table)
+            m_sweepKeys.push_back(hash);
+    }
+
+    while (count > 0 && !m_sweepKeys.empty()) {
+        const auto it = m_table.find(m_sweepKeys.back());
+        m_sweepKeys.pop_back();
+        count--;
+        if (it == m_table.end())
+            continue;
+
+        m_entryCount -= std::erase_if(it->second, [](const std::weak_ptr<IChunk>& entry) {
+            return entry.expired();
+        });
+        if (it->second.empty())
+            m_table.erase(it);
+    }
+}
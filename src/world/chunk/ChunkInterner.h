@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "util/Logger.h"
+#include "world/chunk/IChunk.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+// Shares the payloads of chunks with identical blocks, such as all air or all stone. Payloads are
+// looked up by a hash of their blocks and compared in full on a match. The table only holds weak
+// references, so a payload goes away with the last chunk using it, and the entries left behind are
+// swept a few buckets at a time. Shared payloads are copied before they are written to, see
+// World::SetBlock.
+class ChunkInterner final {
+public:
+    // Hash of the chunk's blocks. Can be called from any thread.
+    static uint64_t Hash(const EightBitChunk& chunk);
+
+    // Hash of 32768 blocks laid out like EightBitChunk::Data(), like Hash() of such a chunk.
+    static uint64_t Hash(const uint8_t* blocks);
+
+    // Returns the interned payload with the same blocks as the chunk, interning the chunk if there
+    // is none. Chunks other than EightBitChunks are returned as they are.
+    std::shared_ptr<IChunk> Intern(std::shared_ptr<IChunk> chunk, const uint64_t hash);
+
+    // Visits up to count buckets, dropping entries whose payloads are gone. The visits continue
+    // where the last call stopped, and every Intern() makes a few.
+    void Sweep(size_t count);
+
+    // Entries in the table, including ones whose payloads are gone but haven't been swept yet.
+    VXL_INLINE size_t GetEntryCount() const noexcept {
+        return m_entryCount;
+    }
+
+    // Interned chunks that were replaced by an existing payload.
+    VXL_INLINE uint64_t GetHits() const noexcept {
+        return m_hits;
+    }
+private:
+    static Logger sLogger;
+    static constexpr size_t sSweepsPerIntern = 2;
+
+    std::unordered_map<uint64_t, std::vector<std::weak_ptr<IChunk>>> m_table; // Hash to the payloads with it.
+    std::vector<uint64_t> m_sweepKeys; // Buckets the current sweep still has to visit.
+    size_t m_entryCount = 0;
+    uint64_t m_hits = 0;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Light levels of every block of a chunk in the xyz order. Sky light is in the high nibble of each
+// byte and block light in the low one.
+struct ChunkLight final {
+    enum Channel : uint8_t {
+        eSky = 0,
+        eBlock = 1
+    };
+
+    std::array<uint8_t, 32768> m_levels{};
+
+    VXL_INLINE uint8_t Get(const uint16_t index, const Channel channel) const noexcept {
+        return (m_levels[index] >> Shift(channel)) & 15;
+    }
+
+    VXL_INLINE void Set(const uint16_t index, const Channel channel, const uint8_t level) noexcept {
+        const uint8_t shift = Shift(channel);
+        m_levels[index] = static_cast<uint8_t>((m_levels[index] & ~(15u << shift)) | (level << shift));
+    }
+
+    static VXL_INLINE uint8_t Shift(const Channel channel) noexcept {
+        return channel == eSky ? 4 : 0;
+    }
+};
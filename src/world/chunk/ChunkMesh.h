@@ -13,6 +13,9 @@ public:
         }
     };
 
+    // Greedy quads are packed as (face << 25) | ((height - 1) << 20) | ((width - 1) << 15) |
+    // (x << 10) | (y << 5) | z. X faces extend along y (width) and z (height), Y faces along x and
+    // z, and Z faces along x and y.
     struct Greedy {
         std::vector<uint32_t> m_vertices;
 
@@ -0,0 +1,76 @@
+#include "world/chunk/ChunkSerializer.h"
+
+#include <array>
+#include <cstring>
+
+Logger ChunkSerializer::sLogger = Logger("ChunkSerializer");
+
+// Block IDs present in the chunk, the ones with a palette count.
+static uint8_t GetPalette(const EightBitChunk& chunk, std::array<uint16_t, 64>& palette) {
+    uint8_t size = 0;
+    for (uint16_t block = 0; block < chunk.m_blockPaletteCounts.size(); block++) {
+        if (chunk.m_blockPaletteCounts[block] != 0)
+            palette[size++] = block;
+    }
+    return size;
+}
+
+size_t ChunkSerializer::GetSerializedSize(const EightBitChunk& chunk) {
+    std::array<uint16_t, 64> palette;
+    return GetPayloadOffset(GetPalette(chunk, palette)) + 32768;
+}
+
+size_t ChunkSerializer::Serialize(const EightBitChunk& chunk, std::vector<uint8_t>& out) {
+    std::array<uint16_t, 64> palette;
+    const uint8_t paletteSize = GetPalette(chunk, palette);
+
+    const Header header = {
+        .m_magic = sMagic,
+        .m_version = sVersion,
+        .m_packing = static_cast<uint8_t>(ChunkPacking::Eight),
+        .m_paletteSize = paletteSize,
+        .m_payloadOffset = static_cast<uint32_t>(GetPayloadOffset(paletteSize)),
+        .m_payloadSize = 32768
+    };
+
+    // Padding between the palette and the block data stays zeroed.
+    const size_t start = out.size();
+    const size_t size = header.m_payloadOffset + header.m_payloadSize;
+    out.resize(start + size);
+    uint8_t* record = out.data() + start;
+    std::memcpy(record, &header, sizeof(Header));
+    std::memcpy(record + sizeof(Header), palette.data(), paletteSize * sizeof(uint16_t));
+    std::memcpy(record + header.m_payloadOffset, chunk.Data(), header.m_payloadSize);
+    return size;
+}
+
+const uint8_t* ChunkSerializer::GetPayload(const uint8_t* record, const size_t size, Header& header) {
+    if (size < sizeof(Header))
+        throw sLogger.RuntimeError("Chunk record is smaller than its header!");
+
+    std::memcpy(&header, record, sizeof(Header));
+    if (header.m_magic != sMagic)
+        throw sLogger.RuntimeError("Chunk record has the wrong magic number!");
+    if (header.m_version != sVersion)
+        throw sLogger.RuntimeError("Unsupported chunk record version ", header.m_version, "!");
+    if (header.m_packing != static_cast<uint8_t>(ChunkPacking::Eight) || header.m_payloadSize != 32768)
+        throw sLogger.RuntimeError("Chunk record has an unsupported packing!");
+    if (header.m_payloadOffset != GetPayloadOffset(header.m_paletteSize) || size < header.m_payloadOffset + header.m_payloadSize)
+        throw sLogger.RuntimeError("Chunk record is truncated!");
+
+    return record + header.m_payloadOffset;
+}
+
+void ChunkSerializer::Deserialize(const uint8_t* record, const size_t size, EightBitChunk& chunk) {
+    Header header;
+    const uint8_t* payload = GetPayload(record, size, header);
+
+    std::array<uint16_t, 64> palette;
+    if (header.m_paletteSize > palette.size())
+        throw sLogger.RuntimeError("Chunk record has more palette entries than block types!");
+    std::memcpy(palette.data(), record + sizeof(Header), header.m_paletteSize * sizeof(uint16_t));
+
+    std::memcpy(chunk.Data(), payload, header.m_payloadSize);
+    if (!chunk.RecountPalette(palette.data(), header.m_paletteSize))
+        throw sLogger.RuntimeError("Chunk record holds blocks its palette doesn't list!");
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "util/Logger.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+// Versioned binary format for a single chunk, little endian. A fixed header is followed by the
+// palette and then the packed block data, which starts on a 64 byte boundary of the record. Records
+// placed at aligned offsets of a memory mapped file can hand out their block data without a parse
+// step or a copy.
+class ChunkSerializer final {
+public:
+    static constexpr uint32_t sMagic = 0x434C5856; // "VXLC"
+    static constexpr uint16_t sVersion = 1;
+    static constexpr size_t sPayloadAlignment = 64;
+
+    struct Header {
+        uint32_t m_magic;
+        uint16_t m_version;
+        uint8_t m_packing; // ChunkPacking of the block data.
+        uint8_t m_paletteSize; // Block IDs of the palette that follow the header.
+        uint32_t m_payloadOffset; // From the start of the record.
+        uint32_t m_payloadSize;
+    };
+    static_assert(sizeof(Header) == 16);
+
+    // Size of the record of a chunk.
+    static size_t GetSerializedSize(const EightBitChunk& chunk);
+
+    // Appends the record of a chunk and returns its size.
+    static size_t Serialize(const EightBitChunk& chunk, std::vector<uint8_t>& out);
+
+    // Validates a record in place and returns its block data, in the xyz order with z changing
+    // fastest, which points into the record. Throws if the record is malformed.
+    static const uint8_t* GetPayload(const uint8_t* record, const size_t size, Header& header);
+
+    // Copies a record into the chunk and rebuilds its palette. Throws if the record is malformed or
+    // holds blocks its palette doesn't list.
+    static void Deserialize(const uint8_t* record, const size_t size, EightBitChunk& chunk);
+private:
+    static Logger sLogger;
+
+    static VXL_INLINE size_t GetPayloadOffset(const size_t paletteSize) noexcept {
+        const size_t end = sizeof(Header) + paletteSize * sizeof(uint16_t);
+        return (end + sPayloadAlignment - 1) & ~(sPayloadAlignment - 1);
+    }
+};
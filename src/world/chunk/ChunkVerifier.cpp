@@ -0,0 +1,299 @@
+#include "world/chunk/ChunkVerifier.h"
+
+#include <bitset>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "world/chunk/ChunkConnectivity.h"
+#include "world/chunk/IChunk.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+Logger ChunkVerifier::sLogger = Logger("ChunkVerifier");
+
+bool ChunkVerifier::Run(uint32_t seed, uint32_t iterations) {
+    std::mt19937 gen(seed);
+    bool passed = true;
+
+    for (uint32_t i = 0; i < sNumPatterns + iterations; i++) {
+        std::unique_ptr<EightBitChunk> chunk = std::make_unique<EightBitChunk>();
+
+        if (i < sNumPatterns)
+            FillPattern(*chunk, i);
+        else
+            FillRandom(*chunk, gen);
+
+        const ChunkBitmap solid = chunk->GetBlockBitmap(BlockTypes::eAir, true);
+        const bool casePassed = VerifyBitmapKernels(solid, RandomBitmap(gen))
+            && VerifyBitmapKernels(RandomBitmap(gen), solid)
+            && VerifyBlockBitmaps(*chunk)
+            && VerifyConnectivity(solid)
+            && VerifyGreedyMesh(*chunk);
+
+        if (!casePassed) {
+            if (i < sNumPatterns)
+                sLogger.Warning("Adversarial pattern ", i, " failed verification!");
+            else
+                sLogger.Warning("Random chunk ", i - sNumPatterns, " failed verification! (seed: ", seed, ")");
+            passed = false;
+        }
+    }
+
+    if (passed)
+        sLogger.Verbose("Verified ", sNumPatterns + iterations, " chunks against the naive kernels!");
+
+    return passed;
+}
+
+bool ChunkVerifier::VerifyBitmapKernels(const ChunkBitmap& bitmap, const ChunkBitmap& otherBitmap) {
+    // Both the SIMD and scalar transposes have to agree with the naive ones.
+    ChunkBitmap naive;
+    ChunkBitmap simd = bitmap.Copy().InnerTranspose();
+    ChunkBitmap scalar = bitmap.Copy();
+    bitmap.Copy().InnerTransposeNaive(naive);
+    scalar.InnerTransposeScalar();
+    if (naive != simd || naive != scalar) {
+        sLogger.Warning("Inner transposes do not match the naive transpose! (simd: ", naive == simd,
+            ", scalar: ", naive == scalar, ")");
+        return false;
+    }
+
+    simd = bitmap.Copy().OuterTranspose();
+    scalar = bitmap.Copy();
+    bitmap.Copy().OuterTransposeNaive(naive);
+    scalar.OuterTransposeScalar();
+    if (naive != simd || naive != scalar) {
+        sLogger.Warning("Outer transposes do not match the naive transpose! (simd: ", naive == simd,
+            ", scalar: ", naive == scalar, ")");
+        return false;
+    }
+
+    // Transposes have to track the axis order the same way regardless of the variant.
+    ChunkBitmap axisNaive = bitmap.Copy();
+    ChunkBitmap axisSimd = bitmap.Copy();
+    axisNaive.InnerTransposeNaive(naive);
+    axisNaive.OuterTransposeNaive(naive);
+    axisSimd.InnerTranspose().OuterTranspose();
+    if (axisNaive.GetAxisOrder() != axisSimd.GetAxisOrder()) {
+        sLogger.Warning("Axis orders differ after transposing!");
+        return false;
+    }
+
+    ChunkBitmap andMap = bitmap.Copy().And(otherBitmap);
+    ChunkBitmap mostCulled = bitmap.Copy().CullMostSigBits();
+    ChunkBitmap leastCulled = bitmap.Copy().CullLeastSigBits();
+
+    for (uint32_t i = 0; i < 1024; i++) {
+        if (andMap[i] != (bitmap[i] & otherBitmap[i])) {
+            sLogger.Warning("And mismatch at row ", i, "!");
+            return false;
+        }
+
+        for (uint32_t bit = 0; bit < 32; bit++) {
+            const bool set = GetBit(bitmap, i >> 5, i & 31, bit);
+            const bool below = bit > 0 && GetBit(bitmap, i >> 5, i & 31, bit - 1);
+            const bool above = bit < 31 && GetBit(bitmap, i >> 5, i & 31, bit + 1);
+
+            if (GetBit(mostCulled, i >> 5, i & 31, bit) != (set && !below)) {
+                sLogger.Warning("Most significant bit cull mismatch at row ", i, ", bit ", bit, "!");
+                return false;
+            }
+
+            if (GetBit(leastCulled, i >> 5, i & 31, bit) != (set && !above)) {
+                sLogger.Warning("Least significant bit cull mismatch at row ", i, ", bit ", bit, "!");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ChunkVerifier::VerifyBlockBitmaps(const IChunk& chunk) {
+    for (uint32_t block = 0; block < chunk.m_blockPaletteCounts.size(); block++) {
+        if (block != BlockTypes::eAir && chunk.m_blockPaletteCounts[block] == 0)
+            continue;
+
+        for (const bool invert : {false, true}) {
+            const ChunkBitmap bitmap = chunk.GetBlockBitmap(static_cast<BlockTypes>(block), invert);
+            uint32_t count = 0;
+
+            for (uint8_t x = 0; x < 32; x++) {
+                for (uint8_t y = 0; y < 32; y++) {
+                    for (uint8_t z = 0; z < 32; z++) {
+                        const bool expected = (chunk.GetBlock(x, y, z) == block) != invert;
+                        if (GetBit(bitmap, x, y, z) != expected) {
+                            sLogger.Warning("Block bitmap mismatch for block ", block, " (invert: ", invert,
+                                ") at x: ", +x, ", y: ", +y, ", z: ", +z, "!");
+                            return false;
+                        }
+                        count += expected && !invert;
+                    }
+                }
+            }
+
+            if (!invert && count != chunk.m_blockPaletteCounts[block]) {
+                sLogger.Warning("Palette count for block ", block, " is ", chunk.m_blockPaletteCounts[block],
+                    " but the chunk holds ", count, "!");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ChunkVerifier::VerifyConnectivity(const ChunkBitmap& solid) {
+    const ChunkConnectivity::Mask mask = ChunkConnectivity::Compute(solid);
+    const ChunkConnectivity::Mask naive = ChunkConnectivity::ComputeNaive(solid);
+    if (mask != naive) {
+        sLogger.Warning("Connectivity ", std::bitset<15>(mask), " does not match the naive ", std::bitset<15>(naive), "!");
+        return false;
+    }
+    return true;
+}
+
+bool ChunkVerifier::VerifyGreedyMesh(IChunk& chunk) {
+    ChunkMesh::Greedy mesh;
+    chunk.MeshGreedy(mesh);
+
+    // Number of quads covering each face, indexed by (direction << 15) | (x << 10) | (y << 5) | z.
+    std::vector<uint8_t> coverage(6 * 32768, 0);
+
+    for (const uint32_t quad : mesh.m_vertices) {
+        const uint32_t face = quad >> 25;
+        const uint32_t height = ((quad >> 20) & 31) + 1;
+        const uint32_t width = ((quad >> 15) & 31) + 1;
+        const uint32_t origin[3] = {(quad >> 10) & 31, (quad >> 5) & 31, quad & 31};
+
+        if (face > Direction::ePosZ) {
+            sLogger.Warning("Greedy quad has an invalid face ", face, "!");
+            return false;
+        }
+
+        // Axes the quad extends along, see ChunkMesh::Greedy.
+        const uint8_t axis = Directions::Axis(static_cast<Direction>(face));
+        const uint8_t widthAxis = axis == 0 ? 1 : 0;
+        const uint8_t heightAxis = axis == 2 ? 1 : 2;
+
+        if (origin[widthAxis] + width > 32 || origin[heightAxis] + height > 32) {
+            sLogger.Warning("Greedy quad extends outside of the chunk!");
+            return false;
+        }
+
+        const uint16_t quadBlock = chunk.GetBlock(origin[0], origin[1], origin[2]);
+        for (uint32_t w = 0; w < width; w++) {
+            for (uint32_t h = 0; h < height; h++) {
+                uint32_t pos[3] = {origin[0], origin[1], origin[2]};
+                pos[widthAxis] += w;
+                pos[heightAxis] += h;
+
+                if (chunk.GetBlock(pos[0], pos[1], pos[2]) != quadBlock) {
+                    sLogger.Warning("Greedy quad spans more than one block type!");
+                    return false;
+                }
+
+                coverage[(face << 15) | (pos[0] << 10) | (pos[1] << 5) | pos[2]]++;
+            }
+        }
+    }
+
+    // Brute force mesher: a face is exposed if its neighbor is air or outside of the chunk.
+    for (const Direction direction : Directions::sAll) {
+        for (int32_t x = 0; x < 32; x++) {
+            for (int32_t y = 0; y < 32; y++) {
+                for (int32_t z = 0; z < 32; z++) {
+                    const int32_t nx = x + Directions::Offset(direction, 0);
+                    const int32_t ny = y + Directions::Offset(direction, 1);
+                    const int32_t nz = z + Directions::Offset(direction, 2);
+                    const bool outside = nx < 0 || nx > 31 || ny < 0 || ny > 31 || nz < 0 || nz > 31;
+
+                    const bool exposed = chunk.GetBlock(x, y, z) != BlockTypes::eAir
+                        && (outside || chunk.GetBlock(nx, ny, nz) == BlockTypes::eAir);
+                    const uint8_t covered = coverage[(direction << 15) | (x << 10) | (y << 5) | z];
+
+                    if (covered != (exposed ? 1 : 0)) {
+                        sLogger.Warning("Face ", +direction, " at x: ", x, ", y: ", y, ", z: ", z,
+                            " is covered ", +covered, " times but exposed: ", exposed, "!");
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void ChunkVerifier::FillPattern(IChunk& chunk, uint32_t pattern) {
+    for (uint8_t x = 0; x < 32; x++) {
+        for (uint8_t y = 0; y < 32; y++) {
+            for (uint8_t z = 0; z < 32; z++) {
+                const bool edge = x == 0 || x == 31 || y == 0 || y == 31 || z == 0 || z == 31;
+                const bool corner = (x == 0 || x == 31) && (y == 0 || y == 31) && (z == 0 || z == 31);
+                uint16_t block = BlockTypes::eAir;
+
+                switch (pattern) {
+                case 0: break; // Empty.
+                case 1: block = BlockTypes::eDirt; break; // Full.
+                case 2: block = ((x + y + z) & 1) ? BlockTypes::eDirt : BlockTypes::eAir; break; // Checkerboard.
+                case 3: block = (x & 1) ? BlockTypes::eDirt : BlockTypes::eAir; break; // X stripes.
+                case 4: block = (y & 1) ? BlockTypes::eDirt : BlockTypes::eAir; break; // Y stripes.
+                case 5: block = (z & 1) ? BlockTypes::eDirt : BlockTypes::eAir; break; // Z stripes.
+                case 6: block = edge ? BlockTypes::eDirt : BlockTypes::eAir; break; // Hollow shell.
+                case 7: block = corner ? BlockTypes::eGrass : BlockTypes::eAir; break; // Corners only.
+                case 8: block = edge ? BlockTypes::eAir : BlockTypes::eDirt; break; // Floating cube.
+                case 9: block = ((x + y + z) & 1) ? BlockTypes::eDirt : BlockTypes::eGrass; break; // Full, two blocks.
+                case 10: block = 1 + ((x ^ y ^ z) % 63); break; // Every block ID.
+                case 11: block = (x == 31 || z == 0) ? BlockTypes::eGrass : BlockTypes::eAir; break; // Border walls.
+                }
+
+                if (block != BlockTypes::eAir)
+                    chunk.SetBlock(block, x, y, z);
+            }
+        }
+    }
+}
+
+void ChunkVerifier::FillRandom(IChunk& chunk, std::mt19937& gen) {
+    constexpr uint32_t densities[] = {1, 10, 50, 90, 99};
+    constexpr uint32_t blockCounts[] = {1, 2, 8, 63};
+
+    const uint32_t density = densities[gen() % std::size(densities)];
+    const uint32_t blockCount = blockCounts[gen() % std::size(blockCounts)];
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+    // Half of the random chunks are made from solid boxes, which produces long greedy runs.
+    if (gen() & 1) {
+        for (uint8_t x = 0; x < 32; x++) {
+            for (uint8_t y = 0; y < 32; y++) {
+                for (uint8_t z = 0; z < 32; z++) {
+                    if (percent(gen) < density)
+                        chunk.SetBlock(1 + gen() % blockCount, x, y, z);
+                }
+            }
+        }
+    } else {
+        const uint32_t boxes = 1 + gen() % 16;
+        for (uint32_t i = 0; i < boxes; i++) {
+            const uint8_t minX = gen() % 32, minY = gen() % 32, minZ = gen() % 32;
+            const uint8_t maxX = minX + gen() % (32 - minX);
+            const uint8_t maxY = minY + gen() % (32 - minY);
+            const uint8_t maxZ = minZ + gen() % (32 - minZ);
+            const uint16_t block = (gen() % 4 == 0) ? BlockTypes::eAir : 1 + gen() % blockCount;
+
+            for (uint8_t x = minX; x <= maxX; x++) {
+                for (uint8_t y = minY; y <= maxY; y++) {
+                    for (uint8_t z = minZ; z <= maxZ; z++)
+                        chunk.SetBlock(block, x, y, z);
+                }
+            }
+        }
+    }
+}
+
+ChunkBitmap ChunkVerifier::RandomBitmap(std::mt19937& gen) {
+    ChunkBitmap bitmap;
+    for (uint32_t i = 0; i < 1024; i++)
+        bitmap[i] = gen();
+    return bitmap;
+}
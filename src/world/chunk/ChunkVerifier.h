@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include "util/Logger.h"
+#include "world/chunk/ChunkBitmap.h"
+
+class IChunk;
+
+// Property based verification of the SIMD chunk kernels against their naive versions. Every check
+// logs the failing case and returns false instead of throwing, so it can run inside the test program.
+class ChunkVerifier final {
+public:
+    // Runs every check over the adversarial chunk patterns followed by the given number of random chunks.
+    static bool Run(uint32_t seed, uint32_t iterations);
+
+    // Checks the bitmap kernels (and, culling, transposes) against bit-by-bit versions.
+    static bool VerifyBitmapKernels(const ChunkBitmap& bitmap, const ChunkBitmap& otherBitmap);
+
+    // Checks the SIMD block bitmaps of every block in the chunk palette against GetBlock().
+    static bool VerifyBlockBitmaps(const IChunk& chunk);
+
+    // Checks the row flood fill connectivity of the solid bitmap against a voxel by voxel search.
+    static bool VerifyConnectivity(const ChunkBitmap& solid);
+
+    // Checks that the union of the greedy quads covers every exposed face exactly once.
+    static bool VerifyGreedyMesh(IChunk& chunk);
+private:
+    static Logger sLogger;
+
+    static constexpr uint32_t sNumPatterns = 12;
+
+    static void FillPattern(IChunk& chunk, uint32_t pattern);
+    static void FillRandom(IChunk& chunk, std::mt19937& gen);
+    static ChunkBitmap RandomBitmap(std::mt19937& gen);
+
+    static VXL_INLINE bool GetBit(const ChunkBitmap& bitmap, uint32_t slice, uint32_t row, uint32_t bit) {
+        return (bitmap[(slice << 5) | row] >> bit) & 1u;
+    }
+};
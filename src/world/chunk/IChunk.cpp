@@ -44,10 +44,23 @@ uint16_t IChunk::SetBlock(const uint16_t newBlock, const uint8_t x, const uint8_
     return oldBlock;
 }
 
+void IChunk::ResetPalette(const std::array<uint16_t, 64>& counts) {
+    m_blockPalette = SparseVector<uint16_t, uint16_t>();
+    m_blockPalette.Reserve(1 << static_cast<uint8_t>(m_packingMode));
+
+    for (uint16_t block = 0; block < counts.size(); block++) {
+        m_blockPaletteCounts[block] = counts[block];
+        if (counts[block] != 0)
+            m_blockPaletteIndices[block] = m_blockPalette.Insert(block);
+    }
+
+    m_hasAir = counts[BlockTypes::eAir] != 0;
+}
+
 ChunkMesh::Naive IChunk::MeshNaive() {
     ChunkMesh::Naive mesh;
 
-    uint16_t index;
+    uint16_t index = 0;
     for (uint8_t x = 0; x < 32; x++) {
         for (uint8_t y = 0; y < 32; y++) {
             for (uint8_t z = 0; z < 32; z++) {
@@ -99,12 +112,14 @@ void IChunk::MeshGreedy(ChunkMesh::Greedy& mesh) {
         ChunkBitmap yxzNegCulled = yxz.And(yxzNegCulledMask);
         ChunkBitmap zxyNegCulled = zxy.And(zxyNegCulledMask);
 
-        xyzPosCulled.GreedyMeshBitmap(mesh.m_vertices);
-        yxzPosCulled.GreedyMeshBitmap(mesh.m_vertices);
-        zxyPosCulled.GreedyMeshBitmap(mesh.m_vertices);
+        // Culling the most significant bits keeps faces whose lower neighbor is empty, so the
+        // "Pos" culled views hold the negative facing faces.
+        xyzPosCulled.GreedyMeshBitmap(mesh.m_vertices, Direction::eNegX);
+        yxzPosCulled.GreedyMeshBitmap(mesh.m_vertices, Direction::eNegY);
+        zxyPosCulled.GreedyMeshBitmap(mesh.m_vertices, Direction::eNegZ);
 
-        xyzNegCulled.GreedyMeshBitmap(mesh.m_vertices);
-        yxzNegCulled.GreedyMeshBitmap(mesh.m_vertices);
-        zxyNegCulled.GreedyMeshBitmap(mesh.m_vertices);
+        xyzNegCulled.GreedyMeshBitmap(mesh.m_vertices, Direction::ePosX);
+        yxzNegCulled.GreedyMeshBitmap(mesh.m_vertices, Direction::ePosY);
+        zxyNegCulled.GreedyMeshBitmap(mesh.m_vertices, Direction::ePosZ);
     }
 }
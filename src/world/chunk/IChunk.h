@@ -3,6 +3,7 @@
 #include <vector>
 #include <cstdint>
 #include <array>
+#include <memory>
 #include "util/SparseVector.h"
 #include "util/Logger.h"
 #include "world/chunk/ChunkMesh.h"
@@ -14,6 +15,8 @@ class IChunk {
 public:
     IChunk() = default;
 
+    virtual ~IChunk() = default;
+
     void Initialize(ChunkPacking packingType);
 
     uint16_t GetBlock(const uint8_t x, const uint8_t y, const uint8_t z) const;
@@ -25,22 +28,31 @@ public:
     void MeshGreedy(ChunkMesh::Greedy& mesh);
 
     void GreedyMeshBitmap(std::vector<uint32_t>& vertices, std::array<uint32_t, 1024>& bitmap, int normal) const;
+
+    // Replaces the palette after the block data was written directly. Counts are indexed by block ID.
+    void ResetPalette(const std::array<uint16_t, 64>& counts);
 // protected:
     ChunkPacking m_packingMode;
 
     SparseVector<uint16_t, uint16_t> m_blockPalette; // List of block IDs.
 
     // Sacrifice a little bit of memory for faster deletes. Hash maps are way too slow.
-    std::array<uint8_t, 64> m_blockPaletteIndices;
-    std::array<uint16_t, 64> m_blockPaletteCounts;
+    std::array<uint8_t, 64> m_blockPaletteIndices{};
+    std::array<uint16_t, 64> m_blockPaletteCounts{};
 
-    bool m_hasAir;
+    bool m_hasAir = true;
 
     virtual uint16_t RawGetBlock(const uint16_t index) const = 0;
 
     virtual void RawSetBlock(const uint16_t index, const uint16_t newBlock) = 0;
 
     virtual ChunkBitmap GetBlockBitmap(const BlockTypes block, const bool invert = false) const = 0;
+
+    // Bytes held by the chunk, including its block data.
+    virtual size_t GetMemoryUsage() const = 0;
+
+    // Copy of the chunk with its block data and palette.
+    virtual std::unique_ptr<IChunk> Clone() const = 0;
 private:
     static Logger sLogger;
 };
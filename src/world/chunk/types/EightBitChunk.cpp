@@ -1,5 +1,6 @@
 #include "world/chunk/types/EightBitChunk.h"
 
+#include <algorithm>
 #include <cstring>
 
 // ========== SIMD ==========
@@ -34,6 +35,39 @@ void GetSolidBitmapImpl(const uint8_t* blockData, const BlockTypes block, ChunkB
     }
 }
 
+void CountBlocksImpl(const uint8_t* blockData, const uint16_t* blocks, const size_t numBlocks, uint16_t* counts) {
+    // Every vector is loaded once and compared against each block type.
+    std::array<uint32_t, 64> totals{};
+    for (uint32_t i = 0; i < 32768; i += numLanes) {
+        auto dataVec = hw::Load(u8Tag, blockData + i);
+        for (size_t j = 0; j < numBlocks; j++)
+            totals[j] += hw::CountTrue(u8Tag, hw::Eq(dataVec, hw::Set(u8Tag, static_cast<uint8_t>(blocks[j]))));
+    }
+
+    for (size_t j = 0; j < numBlocks; j++)
+        counts[j] = static_cast<uint16_t>(totals[j]);
+}
+
+// Skips the vectors the mask doesn't touch, as masks tend to be sparse.
+void FillMaskedImpl(uint8_t* blockData, const uint32_t* mask, const uint8_t block) {
+    const uint8_t* maskBytes = reinterpret_cast<const uint8_t*>(mask);
+    const auto blockVec = hw::Set(u8Tag, block);
+    for (uint32_t i = 0; i < 32768; i += numLanes) {
+        const auto fillMask = hw::LoadMaskBits(u8Tag, maskBytes + i / 8);
+        if (!hw::AllFalse(u8Tag, fillMask))
+            hw::BlendedStore(blockVec, fillMask, u8Tag, blockData + i);
+    }
+}
+
+void OverlayImpl(uint8_t* blockData, const uint8_t* otherData) {
+    const auto airVec = hw::Zero(u8Tag);
+    for (uint32_t i = 0; i < 32768; i += numLanes) {
+        const auto otherVec = hw::LoadU(u8Tag, otherData + i);
+        const auto blockVec = hw::LoadU(u8Tag, blockData + i);
+        hw::StoreU(hw::IfThenElse(hw::Eq(otherVec, airVec), blockVec, otherVec), u8Tag, blockData + i);
+    }
+}
+
 }
 
 HWY_AFTER_NAMESPACE();
@@ -48,6 +82,35 @@ ChunkBitmap EightBitChunk::GetBlockBitmap(const BlockTypes block, const bool inv
     return bitmap;
 }
 
+void EightBitChunk::FillMasked(const ChunkBitmap& mask, const uint8_t block) {
+    HWY_STATIC_DISPATCH(FillMaskedImpl)(m_blockData.data(), mask.Data(), block);
+}
+
+void EightBitChunk::Overlay(const EightBitChunk& other) {
+    HWY_STATIC_DISPATCH(OverlayImpl)(m_blockData.data(), other.m_blockData.data());
+}
+
+bool EightBitChunk::RecountPalette(const uint16_t* blocks, const size_t numBlocks) {
+    std::array<uint16_t, 64> found;
+    HWY_STATIC_DISPATCH(CountBlocksImpl)(m_blockData.data(), blocks, std::min<size_t>(numBlocks, found.size()), found.data());
+
+    std::array<uint16_t, 64> counts{};
+    uint32_t total = 0;
+    for (size_t i = 0; i < numBlocks && i < found.size(); i++) {
+        if (blocks[i] >= counts.size())
+            return false;
+        counts[blocks[i]] = found[i];
+        total += found[i];
+    }
+
+    // Blocks outside the expected types would go uncounted.
+    if (total != 32768)
+        return false;
+
+    ResetPalette(counts);
+    return true;
+}
+
 // ========== Scalar ==========
 
 Logger EightBitChunk::sLogger = Logger("EightBitChunk");
@@ -68,4 +131,27 @@ void EightBitChunk::RawSetBlock(const uint16_t index, const uint16_t newBlock) {
     m_blockData[index] = newBlock;
 }
 
+size_t EightBitChunk::GetMemoryUsage() const {
+    return sizeof(EightBitChunk);
+}
+
+std::unique_ptr<IChunk> EightBitChunk::Clone() const {
+    // Copies of a vector don't keep its capacity, which the palette reads as its size limit.
+    std::unique_ptr<EightBitChunk> copy = std::make_unique<EightBitChunk>(*this);
+    copy->m_blockPalette.Reserve(1 << static_cast<uint8_t>(m_packingMode));
+    return copy;
+}
+
+void EightBitChunk::RecountPalette() {
+    // Only 32768 blocks, so every count fits even if the chunk is a single block type.
+    std::array<uint16_t, 64> counts{};
+    for (const uint8_t block : m_blockData) {
+        if (block >= counts.size())
+            throw sLogger.RuntimeError("Block ", block, " doesn't fit a chunk's palette!");
+        counts[block]++;
+    }
+
+    ResetPalette(counts);
+}
+
 #endif
@@ -9,6 +9,30 @@ public:
 
     EightBitChunk(std::array<uint8_t, 32768>& blockData); // Has to copy, less efficient than building here directly.
 
+    // Direct access to the block IDs in x, y, z order with z changing fastest. Call RecountPalette()
+    // after writing.
+    VXL_INLINE uint8_t* Data() noexcept {
+        return m_blockData.data();
+    }
+
+    VXL_INLINE const uint8_t* Data() const noexcept {
+        return m_blockData.data();
+    }
+
+    // Sets every block where the xyz ordered mask is set. Call RecountPalette() after writing.
+    void FillMasked(const ChunkBitmap& mask, const uint8_t block);
+
+    // Lays the blocks of the other chunk over this one's, where air keeps this chunk's block. Call
+    // RecountPalette() after writing.
+    void Overlay(const EightBitChunk& other);
+
+    // Rebuilds the palette from the block data. Throws if a block doesn't fit the palette.
+    void RecountPalette();
+
+    // Rebuilds the palette counting only the given block types, one vector compare per type. Returns
+    // false without touching the palette if they don't cover every block.
+    bool RecountPalette(const uint16_t* blocks, const size_t numBlocks);
+
     // Efficient load data functions TODO.
 // protected:
     uint16_t RawGetBlock(const uint16_t index) const override;
@@ -16,6 +40,10 @@ public:
     void RawSetBlock(const uint16_t index, const uint16_t newBlock) override;
 
     ChunkBitmap GetBlockBitmap(const BlockTypes block, const bool invert = false) const override;
+
+    size_t GetMemoryUsage() const override;
+
+    std::unique_ptr<IChunk> Clone() const override;
 private:
     static Logger sLogger;
 
@@ -0,0 +1,793 @@
+#include "world/gen/Noise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+// Skew factors between the square and simplex grids.
+#define NOISE_F2 0.36602540378f // (sqrt(3) - 1) / 2
+#define NOISE_G2 0.21132486540f // (3 - sqrt(3)) / 6
+#define NOISE_F3 0.33333333333f
+#define NOISE_G3 0.16666666667f
+
+// Scales that bring each type to about [-1, 1].
+#define NOISE_PERLIN_2D_SCALE 1.25f
+#define NOISE_PERLIN_3D_SCALE 0.95f
+#define NOISE_SIMPLEX_2D_SCALE 90.0f
+#define NOISE_SIMPLEX_3D_SCALE 32.0f
+
+// Added to the seed for every octave.
+#define NOISE_OCTAVE_SEED 0x9E3779B9u
+
+// ========== SIMD ==========
+
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+
+namespace HWY_NAMESPACE {
+namespace hw = hwy::HWY_NAMESPACE;
+
+using FloatTag = hw::ScalableTag<float>;
+using IntTag = hw::RebindToSigned<FloatTag>;
+using UintTag = hw::RebindToUnsigned<FloatTag>;
+using FloatVec = hw::VFromD<FloatTag>;
+using UintVec = hw::VFromD<UintTag>;
+
+const FloatTag f32Tag;
+const IntTag i32Tag;
+const UintTag u32Tag;
+
+// Integer hash of a lattice point. Multiplication by large odd constants spreads each axis over
+// all bits, the final xorshift-multiply mixes them together.
+HWY_INLINE UintVec NoiseHash(const UintVec seed, const UintVec x, const UintVec y, const UintVec z) {
+    UintVec hash = hw::Xor(seed, hw::Mul(x, hw::Set(u32Tag, 0x8DA6B343u)));
+    hash = hw::Xor(hash, hw::Mul(y, hw::Set(u32Tag, 0xD8163841u)));
+    hash = hw::Xor(hash, hw::Mul(z, hw::Set(u32Tag, 0xCB1AB31Fu)));
+    hash = hw::Mul(hw::Xor(hash, hw::ShiftRight<15>(hash)), hw::Set(u32Tag, 0x2C1B3C6Du));
+    return hw::Xor(hash, hw::ShiftRight<13>(hash));
+}
+
+// Cell coordinate of an already floored value, wrapped to unsigned for hashing.
+HWY_INLINE UintVec NoiseCell(const FloatVec floored) {
+    return hw::BitCast(u32Tag, hw::ConvertTo(i32Tag, floored));
+}
+
+// Flips the sign of every lane where the lowest bit of bits is set.
+HWY_INLINE FloatVec NoiseFlipSign(const FloatVec value, const UintVec bits) {
+    return hw::BitCast(f32Tag, hw::Xor(hw::BitCast(u32Tag, value), hw::ShiftLeft<31>(bits)));
+}
+
+// Dot product with one of the eight gradients (+-1, +-0.5) and (+-0.5, +-1).
+HWY_INLINE FloatVec NoiseGrad2(const UintVec hash, const FloatVec x, const FloatVec z) {
+    const auto swap = hw::RebindMask(f32Tag, hw::Ne(hw::And(hash, hw::Set(u32Tag, 4)), hw::Zero(u32Tag)));
+    const FloatVec u = hw::IfThenElse(swap, z, x);
+    const FloatVec v = hw::IfThenElse(swap, x, z);
+    return hw::MulAdd(NoiseFlipSign(v, hw::ShiftRight<1>(hash)), hw::Set(f32Tag, 0.5f), NoiseFlipSign(u, hash));
+}
+
+// Dot product with one of the twelve cube edge gradients (Perlin 2002).
+HWY_INLINE FloatVec NoiseGrad3(const UintVec hash, const FloatVec x, const FloatVec y, const FloatVec z) {
+    const UintVec low = hw::And(hash, hw::Set(u32Tag, 15));
+    const auto useX = hw::RebindMask(f32Tag, hw::Lt(low, hw::Set(u32Tag, 8)));
+    const auto useY = hw::RebindMask(f32Tag, hw::Lt(low, hw::Set(u32Tag, 4)));
+    const auto useXForV = hw::RebindMask(f32Tag, hw::Or(hw::Eq(low, hw::Set(u32Tag, 12)), hw::Eq(low, hw::Set(u32Tag, 14))));
+
+    const FloatVec u = hw::IfThenElse(useX, x, y);
+    const FloatVec v = hw::IfThenElse(useY, y, hw::IfThenElse(useXForV, x, z));
+    return hw::Add(NoiseFlipSign(u, hash), NoiseFlipSign(v, hw::ShiftRight<1>(hash)));
+}
+
+// Random value in [-1, 1] from a hash.
+HWY_INLINE FloatVec NoiseHashToFloat(const UintVec hash) {
+    return hw::Mul(hw::ConvertTo(f32Tag, hw::BitCast(i32Tag, hash)), hw::Set(f32Tag, 1.0f / 2147483648.0f));
+}
+
+// Quintic smoothstep, 6t^5 - 15t^4 + 10t^3.
+HWY_INLINE FloatVec NoiseFade(const FloatVec t) {
+    const FloatVec poly = hw::MulAdd(t, hw::MulAdd(t, hw::Set(f32Tag, 6.0f), hw::Set(f32Tag, -15.0f)), hw::Set(f32Tag, 10.0f));
+    return hw::Mul(hw::Mul(hw::Mul(t, t), t), poly);
+}
+
+HWY_INLINE FloatVec NoiseLerp(const FloatVec t, const FloatVec a, const FloatVec b) {
+    return hw::MulAdd(t, hw::Sub(b, a), a);
+}
+
+HWY_INLINE FloatVec NoisePerlin2D(const UintVec seed, const FloatVec x, const FloatVec z) {
+    const FloatVec floorX = hw::Floor(x);
+    const FloatVec floorZ = hw::Floor(z);
+    const UintVec cellX = NoiseCell(floorX);
+    const UintVec cellZ = NoiseCell(floorZ);
+    const UintVec one = hw::Set(u32Tag, 1);
+    const UintVec zero = hw::Zero(u32Tag);
+
+    const FloatVec fx = hw::Sub(x, floorX);
+    const FloatVec fz = hw::Sub(z, floorZ);
+    const FloatVec fx1 = hw::Sub(fx, hw::Set(f32Tag, 1.0f));
+    const FloatVec fz1 = hw::Sub(fz, hw::Set(f32Tag, 1.0f));
+
+    const FloatVec g00 = NoiseGrad2(NoiseHash(seed, cellX, zero, cellZ), fx, fz);
+    const FloatVec g10 = NoiseGrad2(NoiseHash(seed, hw::Add(cellX, one), zero, cellZ), fx1, fz);
+    const FloatVec g01 = NoiseGrad2(NoiseHash(seed, cellX, zero, hw::Add(cellZ, one)), fx, fz1);
+    const FloatVec g11 = NoiseGrad2(NoiseHash(seed, hw::Add(cellX, one), zero, hw::Add(cellZ, one)), fx1, fz1);
+
+    const FloatVec u = NoiseFade(fx);
+    const FloatVec result = NoiseLerp(NoiseFade(fz), NoiseLerp(u, g00, g10), NoiseLerp(u, g01, g11));
+    return hw::Mul(result, hw::Set(f32Tag, NOISE_PERLIN_2D_SCALE));
+}
+
+HWY_INLINE FloatVec NoisePerlin3D(const UintVec seed, const FloatVec x, const FloatVec y, const FloatVec z) {
+    const FloatVec floorX = hw::Floor(x);
+    const FloatVec floorY = hw::Floor(y);
+    const FloatVec floorZ = hw::Floor(z);
+    const UintVec x0 = NoiseCell(floorX);
+    const UintVec y0 = NoiseCell(floorY);
+    const UintVec z0 = NoiseCell(floorZ);
+    const UintVec one = hw::Set(u32Tag, 1);
+    const UintVec x1 = hw::Add(x0, one);
+    const UintVec y1 = hw::Add(y0, one);
+    const UintVec z1 = hw::Add(z0, one);
+
+    const FloatVec fx = hw::Sub(x, floorX);
+    const FloatVec fy = hw::Sub(y, floorY);
+    const FloatVec fz = hw::Sub(z, floorZ);
+    const FloatVec fx1 = hw::Sub(fx, hw::Set(f32Tag, 1.0f));
+    const FloatVec fy1 = hw::Sub(fy, hw::Set(f32Tag, 1.0f));
+    const FloatVec fz1 = hw::Sub(fz, hw::Set(f32Tag, 1.0f));
+
+    const FloatVec g000 = NoiseGrad3(NoiseHash(seed, x0, y0, z0), fx, fy, fz);
+    const FloatVec g100 = NoiseGrad3(NoiseHash(seed, x1, y0, z0), fx1, fy, fz);
+    const FloatVec g010 = NoiseGrad3(NoiseHash(seed, x0, y1, z0), fx, fy1, fz);
+    const FloatVec g110 = NoiseGrad3(NoiseHash(seed, x1, y1, z0), fx1, fy1, fz);
+    const FloatVec g001 = NoiseGrad3(NoiseHash(seed, x0, y0, z1), fx, fy, fz1);
+    const FloatVec g101 = NoiseGrad3(NoiseHash(seed, x1, y0, z1), fx1, fy, fz1);
+    const FloatVec g011 = NoiseGrad3(NoiseHash(seed, x0, y1, z1), fx, fy1, fz1);
+    const FloatVec g111 = NoiseGrad3(NoiseHash(seed, x1, y1, z1), fx1, fy1, fz1);
+
+    const FloatVec u = NoiseFade(fx);
+    const FloatVec v = NoiseFade(fy);
+    const FloatVec nearZ = NoiseLerp(v, NoiseLerp(u, g000, g100), NoiseLerp(u, g010, g110));
+    const FloatVec farZ = NoiseLerp(v, NoiseLerp(u, g001, g101), NoiseLerp(u, g011, g111));
+    return hw::Mul(NoiseLerp(NoiseFade(fz), nearZ, farZ), hw::Set(f32Tag, NOISE_PERLIN_3D_SCALE));
+}
+
+HWY_INLINE FloatVec NoiseValue2D(const UintVec seed, const FloatVec x, const FloatVec z) {
+    const FloatVec floorX = hw::Floor(x);
+    const FloatVec floorZ = hw::Floor(z);
+    const UintVec cellX = NoiseCell(floorX);
+    const UintVec cellZ = NoiseCell(floorZ);
+    const UintVec one = hw::Set(u32Tag, 1);
+    const UintVec zero = hw::Zero(u32Tag);
+
+    const FloatVec v00 = NoiseHashToFloat(NoiseHash(seed, cellX, zero, cellZ));
+    const FloatVec v10 = NoiseHashToFloat(NoiseHash(seed, hw::Add(cellX, one), zero, cellZ));
+    const FloatVec v01 = NoiseHashToFloat(NoiseHash(seed, cellX, zero, hw::Add(cellZ, one)));
+    const FloatVec v11 = NoiseHashToFloat(NoiseHash(seed, hw::Add(cellX, one), zero, hw::Add(cellZ, one)));
+
+    const FloatVec u = NoiseFade(hw::Sub(x, floorX));
+    return NoiseLerp(NoiseFade(hw::Sub(z, floorZ)), NoiseLerp(u, v00, v10), NoiseLerp(u, v01, v11));
+}
+
+HWY_INLINE FloatVec NoiseValue3D(const UintVec seed, const FloatVec x, const FloatVec y, const FloatVec z) {
+    const FloatVec floorX = hw::Floor(x);
+    const FloatVec floorY = hw::Floor(y);
+    const FloatVec floorZ = hw::Floor(z);
+    const UintVec x0 = NoiseCell(floorX);
+    const UintVec y0 = NoiseCell(floorY);
+    const UintVec z0 = NoiseCell(floorZ);
+    const UintVec one = hw::Set(u32Tag, 1);
+    const UintVec x1 = hw::Add(x0, one);
+    const UintVec y1 = hw::Add(y0, one);
+    const UintVec z1 = hw::Add(z0, one);
+
+    const FloatVec v000 = NoiseHashToFloat(NoiseHash(seed, x0, y0, z0));
+    const FloatVec v100 = NoiseHashToFloat(NoiseHash(seed, x1, y0, z0));
+    const FloatVec v010 = NoiseHashToFloat(NoiseHash(seed, x0, y1, z0));
+    const FloatVec v110 = NoiseHashToFloat(NoiseHash(seed, x1, y1, z0));
+    const FloatVec v001 = NoiseHashToFloat(NoiseHash(seed, x0, y0, z1));
+    const FloatVec v101 = NoiseHashToFloat(NoiseHash(seed, x1, y0, z1));
+    const FloatVec v011 = NoiseHashToFloat(NoiseHash(seed, x0, y1, z1));
+    const FloatVec v111 = NoiseHashToFloat(NoiseHash(seed, x1, y1, z1));
+
+    const FloatVec u = NoiseFade(hw::Sub(x, floorX));
+    const FloatVec v = NoiseFade(hw::Sub(y, floorY));
+    const FloatVec nearZ = NoiseLerp(v, NoiseLerp(u, v000, v100), NoiseLerp(u, v010, v110));
+    const FloatVec farZ = NoiseLerp(v, NoiseLerp(u, v001, v101), NoiseLerp(u, v011, v111));
+    return NoiseLerp(NoiseFade(hw::Sub(z, floorZ)), nearZ, farZ);
+}
+
+// Contribution of one simplex corner, (0.5 - r^2)^4 times the gradient.
+HWY_INLINE FloatVec NoiseSimplexCorner2D(const UintVec hash, const FloatVec x, const FloatVec z) {
+    FloatVec t = hw::Sub(hw::Sub(hw::Set(f32Tag, 0.5f), hw::Mul(x, x)), hw::Mul(z, z));
+    t = hw::Max(t, hw::Zero(f32Tag));
+    t = hw::Mul(t, t);
+    return hw::Mul(hw::Mul(t, t), NoiseGrad2(hash, x, z));
+}
+
+HWY_INLINE FloatVec NoiseSimplexCorner3D(const UintVec hash, const FloatVec x, const FloatVec y, const FloatVec z) {
+    FloatVec t = hw::Sub(hw::Sub(hw::Sub(hw::Set(f32Tag, 0.6f), hw::Mul(x, x)), hw::Mul(y, y)), hw::Mul(z, z));
+    t = hw::Max(t, hw::Zero(f32Tag));
+    t = hw::Mul(t, t);
+    return hw::Mul(hw::Mul(t, t), NoiseGrad3(hash, x, y, z));
+}
+
+HWY_INLINE FloatVec NoiseSimplex2D(const UintVec seed, const FloatVec x, const FloatVec z) {
+    const FloatVec skew = hw::Mul(hw::Add(x, z), hw::Set(f32Tag, NOISE_F2));
+    const FloatVec floorX = hw::Floor(hw::Add(x, skew));
+    const FloatVec floorZ = hw::Floor(hw::Add(z, skew));
+    const FloatVec unskew = hw::Mul(hw::Add(floorX, floorZ), hw::Set(f32Tag, NOISE_G2));
+    const FloatVec x0 = hw::Sub(x, hw::Sub(floorX, unskew));
+    const FloatVec z0 = hw::Sub(z, hw::Sub(floorZ, unskew));
+
+    // The lower or upper triangle of the skewed cell.
+    const auto lower = hw::Gt(x0, z0);
+    const FloatVec oneF = hw::Set(f32Tag, 1.0f);
+    const UintVec oneU = hw::Set(u32Tag, 1);
+    const UintVec stepX = hw::IfThenElseZero(hw::RebindMask(u32Tag, lower), oneU);
+    const UintVec stepZ = hw::Sub(oneU, stepX);
+
+    const FloatVec g2 = hw::Set(f32Tag, NOISE_G2);
+    const FloatVec x1 = hw::Add(hw::Sub(x0, hw::IfThenElseZero(lower, oneF)), g2);
+    const FloatVec z1 = hw::Add(hw::Sub(z0, hw::IfThenZeroElse(lower, oneF)), g2);
+    const FloatVec x2 = hw::Add(hw::Sub(x0, oneF), hw::Set(f32Tag, 2.0f * NOISE_G2));
+    const FloatVec z2 = hw::Add(hw::Sub(z0, oneF), hw::Set(f32Tag, 2.0f * NOISE_G2));
+
+    const UintVec cellX = NoiseCell(floorX);
+    const UintVec cellZ = NoiseCell(floorZ);
+    const UintVec zero = hw::Zero(u32Tag);
+
+    FloatVec result = NoiseSimplexCorner2D(NoiseHash(seed, cellX, zero, cellZ), x0, z0);
+    result = hw::Add(result, NoiseSimplexCorner2D(NoiseHash(seed, hw::Add(cellX, stepX), zero, hw::Add(cellZ, stepZ)), x1, z1));
+    result = hw::Add(result, NoiseSimplexCorner2D(NoiseHash(seed, hw::Add(cellX, oneU), zero, hw::Add(cellZ, oneU)), x2, z2));
+    return hw::Mul(result, hw::Set(f32Tag, NOISE_SIMPLEX_2D_SCALE));
+}
+
+HWY_INLINE FloatVec NoiseSimplex3D(const UintVec seed, const FloatVec x, const FloatVec y, const FloatVec z) {
+    const FloatVec skew = hw::Mul(hw::Add(hw::Add(x, y), z), hw::Set(f32Tag, NOISE_F3));
+    const FloatVec floorX = hw::Floor(hw::Add(x, skew));
+    const FloatVec floorY = hw::Floor(hw::Add(y, skew));
+    const FloatVec floorZ = hw::Floor(hw::Add(z, skew));
+    const FloatVec unskew = hw::Mul(hw::Add(hw::Add(floorX, floorY), floorZ), hw::Set(f32Tag, NOISE_G3));
+    const FloatVec x0 = hw::Sub(x, hw::Sub(floorX, unskew));
+    const FloatVec y0 = hw::Sub(y, hw::Sub(floorY, unskew));
+    const FloatVec z0 = hw::Sub(z, hw::Sub(floorZ, unskew));
+
+    // Rank the offsets to find which of the six tetrahedra the point is in.
+    const auto xGeY = hw::Ge(x0, y0);
+    const auto yGeZ = hw::Ge(y0, z0);
+    const auto xGeZ = hw::Ge(x0, z0);
+    const auto firstX = hw::And(xGeY, xGeZ);
+    const auto firstY = hw::AndNot(xGeY, yGeZ);
+    const auto firstZ = hw::And(hw::Not(xGeZ), hw::Not(yGeZ));
+    const auto secondX = hw::Or(xGeY, xGeZ);
+    const auto secondY = hw::Or(hw::Not(xGeY), yGeZ);
+    const auto secondZ = hw::Or(hw::Not(xGeZ), hw::Not(yGeZ));
+
+    const FloatVec oneF = hw::Set(f32Tag, 1.0f);
+    const UintVec oneU = hw::Set(u32Tag, 1);
+    const FloatVec g3 = hw::Set(f32Tag, NOISE_G3);
+    const FloatVec g3x2 = hw::Set(f32Tag, 2.0f * NOISE_G3);
+    const FloatVec g3x3 = hw::Set(f32Tag, 3.0f * NOISE_G3);
+
+    const FloatVec x1 = hw::Add(hw::Sub(x0, hw::IfThenElseZero(firstX, oneF)), g3);
+    const FloatVec y1 = hw::Add(hw::Sub(y0, hw::IfThenElseZero(firstY, oneF)), g3);
+    const FloatVec z1 = hw::Add(hw::Sub(z0, hw::IfThenElseZero(firstZ, oneF)), g3);
+    const FloatVec x2 = hw::Add(hw::Sub(x0, hw::IfThenElseZero(secondX, oneF)), g3x2);
+    const FloatVec y2 = hw::Add(hw::Sub(y0, hw::IfThenElseZero(secondY, oneF)), g3x2);
+    const FloatVec z2 = hw::Add(hw::Sub(z0, hw::IfThenElseZero(secondZ, oneF)), g3x2);
+    const FloatVec x3 = hw::Add(hw::Sub(x0, oneF), g3x3);
+    const FloatVec y3 = hw::Add(hw::Sub(y0, oneF), g3x3);
+    const FloatVec z3 = hw::Add(hw::Sub(z0, oneF), g3x3);
+
+    const UintVec cellX = NoiseCell(floorX);
+    const UintVec cellY = NoiseCell(floorY);
+    const UintVec cellZ = NoiseCell(floorZ);
+    const UintVec cellX1 = hw::Add(cellX, hw::IfThenElseZero(hw::RebindMask(u32Tag, firstX), oneU));
+    const UintVec cellY1 = hw::Add(cellY, hw::IfThenElseZero(hw::RebindMask(u32Tag, firstY), oneU));
+    const UintVec cellZ1 = hw::Add(cellZ, hw::IfThenElseZero(hw::RebindMask(u32Tag, firstZ), oneU));
+    const UintVec cellX2 = hw::Add(cellX, hw::IfThenElseZero(hw::RebindMask(u32Tag, secondX), oneU));
+    const UintVec cellY2 = hw::Add(cellY, hw::IfThenElseZero(hw::RebindMask(u32Tag, secondY), oneU));
+    const UintVec cellZ2 = hw::Add(cellZ, hw::IfThenElseZero(hw::RebindMask(u32Tag, secondZ), oneU));
+
+    FloatVec result = NoiseSimplexCorner3D(NoiseHash(seed, cellX, cellY, cellZ), x0, y0, z0);
+    result = hw::Add(result, NoiseSimplexCorner3D(NoiseHash(seed, cellX1, cellY1, cellZ1), x1, y1, z1));
+    result = hw::Add(result, NoiseSimplexCorner3D(NoiseHash(seed, cellX2, cellY2, cellZ2), x2, y2, z2));
+    result = hw::Add(result, NoiseSimplexCorner3D(NoiseHash(seed, hw::Add(cellX, oneU), hw::Add(cellY, oneU), hw::Add(cellZ, oneU)), x3, y3, z3));
+    return hw::Mul(result, hw::Set(f32Tag, NOISE_SIMPLEX_3D_SCALE));
+}
+
+template<Noise::Type type>
+HWY_INLINE FloatVec NoiseSample2D(const UintVec seed, const FloatVec x, const FloatVec z) {
+    if constexpr (type == Noise::Type::ePerlin)
+        return NoisePerlin2D(seed, x, z);
+    else if constexpr (type == Noise::Type::eSimplex)
+        return NoiseSimplex2D(seed, x, z);
+    else
+        return NoiseValue2D(seed, x, z);
+}
+
+template<Noise::Type type>
+HWY_INLINE FloatVec NoiseSample3D(const UintVec seed, const FloatVec x, const FloatVec y, const FloatVec z) {
+    if constexpr (type == Noise::Type::ePerlin)
+        return NoisePerlin3D(seed, x, y, z);
+    else if constexpr (type == Noise::Type::eSimplex)
+        return NoiseSimplex3D(seed, x, y, z);
+    else
+        return NoiseValue3D(seed, x, y, z);
+}
+
+// Octaves are summed per vector so that a row never leaves the registers between octaves.
+template<Noise::Type type>
+void NoiseFractal2DImpl(const float* x, const float* z, float* out, const uint32_t seed, const Noise::Fractal& fractal) {
+    const size_t numLanes = hw::Lanes(f32Tag);
+
+    float totalAmplitude = 0.0f;
+    float amplitude = 1.0f;
+    for (uint32_t octave = 0; octave < fractal.m_octaves; octave++) {
+        totalAmplitude += amplitude;
+        amplitude *= fractal.m_gain;
+    }
+
+    const FloatVec frequency = hw::Set(f32Tag, fractal.m_frequency);
+    const FloatVec lacunarity = hw::Set(f32Tag, fractal.m_lacunarity);
+    for (size_t i = 0; i < 32; i += numLanes) {
+        FloatVec sampleX = hw::Mul(hw::LoadU(f32Tag, x + i), frequency);
+        FloatVec sampleZ = hw::Mul(hw::LoadU(f32Tag, z + i), frequency);
+        FloatVec sum = hw::Zero(f32Tag);
+
+        amplitude = 1.0f;
+        uint32_t octaveSeed = seed;
+        for (uint32_t octave = 0; octave < fractal.m_octaves; octave++) {
+            const FloatVec sample = NoiseSample2D<type>(hw::Set(u32Tag, octaveSeed), sampleX, sampleZ);
+            sum = hw::MulAdd(hw::Set(f32Tag, amplitude), sample, sum);
+
+            sampleX = hw::Mul(sampleX, lacunarity);
+            sampleZ = hw::Mul(sampleZ, lacunarity);
+            amplitude *= fractal.m_gain;
+            octaveSeed += NOISE_OCTAVE_SEED;
+        }
+
+        hw::StoreU(hw::Mul(sum, hw::Set(f32Tag, 1.0f / totalAmplitude)), f32Tag, out + i);
+    }
+}
+
+template<Noise::Type type>
+void NoiseFractal3DImpl(const float* x, const float* y, const float* z, float* out, const uint32_t seed, const Noise::Fractal& fractal) {
+    const size_t numLanes = hw::Lanes(f32Tag);
+
+    float totalAmplitude = 0.0f;
+    float amplitude = 1.0f;
+    for (uint32_t octave = 0; octave < fractal.m_octaves; octave++) {
+        totalAmplitude += amplitude;
+        amplitude *= fractal.m_gain;
+    }
+
+    const FloatVec frequency = hw::Set(f32Tag, fractal.m_frequency);
+    const FloatVec lacunarity = hw::Set(f32Tag, fractal.m_lacunarity);
+    for (size_t i = 0; i < 32; i += numLanes) {
+        FloatVec sampleX = hw::Mul(hw::LoadU(f32Tag, x + i), frequency);
+        FloatVec sampleY = hw::Mul(hw::LoadU(f32Tag, y + i), frequency);
+        FloatVec sampleZ = hw::Mul(hw::LoadU(f32Tag, z + i), frequency);
+        FloatVec sum = hw::Zero(f32Tag);
+
+        amplitude = 1.0f;
+        uint32_t octaveSeed = seed;
+        for (uint32_t octave = 0; octave < fractal.m_octaves; octave++) {
+            const FloatVec sample = NoiseSample3D<type>(hw::Set(u32Tag, octaveSeed), sampleX, sampleY, sampleZ);
+            sum = hw::MulAdd(hw::Set(f32Tag, amplitude), sample, sum);
+
+            sampleX = hw::Mul(sampleX, lacunarity);
+            sampleY = hw::Mul(sampleY, lacunarity);
+            sampleZ = hw::Mul(sampleZ, lacunarity);
+            amplitude *= fractal.m_gain;
+            octaveSeed += NOISE_OCTAVE_SEED;
+        }
+
+        hw::StoreU(hw::Mul(sum, hw::Set(f32Tag, 1.0f / totalAmplitude)), f32Tag, out + i);
+    }
+}
+
+void NoiseAddScaledImpl(float* row, const float* offset, const float scale) {
+    const size_t numLanes = hw::Lanes(f32Tag);
+    const FloatVec scaleVec = hw::Set(f32Tag, scale);
+
+    for (size_t i = 0; i < 32; i += numLanes) {
+        const FloatVec result = hw::MulAdd(hw::LoadU(f32Tag, offset + i), scaleVec, hw::LoadU(f32Tag, row + i));
+        hw::StoreU(result, f32Tag, row + i);
+    }
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+// ========== SIMD Wrappers ==========
+
+#if HWY_ONCE
+
+static void DispatchFractal2D(const Noise::Fractal& fractal, const uint32_t seed, const Noise::Row& x, const Noise::Row& z, Noise::Row& out) {
+    switch (fractal.m_type) {
+        case Noise::Type::ePerlin: return HWY_STATIC_DISPATCH(NoiseFractal2DImpl<Noise::Type::ePerlin>)(x.data(), z.data(), out.data(), seed, fractal);
+        case Noise::Type::eSimplex: return HWY_STATIC_DISPATCH(NoiseFractal2DImpl<Noise::Type::eSimplex>)(x.data(), z.data(), out.data(), seed, fractal);
+        case Noise::Type::eValue: return HWY_STATIC_DISPATCH(NoiseFractal2DImpl<Noise::Type::eValue>)(x.data(), z.data(), out.data(), seed, fractal);
+    }
+}
+
+static void DispatchFractal3D(const Noise::Fractal& fractal, const uint32_t seed, const Noise::Row& x, const Noise::Row& y, const Noise::Row& z, Noise::Row& out) {
+    switch (fractal.m_type) {
+        case Noise::Type::ePerlin: return HWY_STATIC_DISPATCH(NoiseFractal3DImpl<Noise::Type::ePerlin>)(x.data(), y.data(), z.data(), out.data(), seed, fractal);
+        case Noise::Type::eSimplex: return HWY_STATIC_DISPATCH(NoiseFractal3DImpl<Noise::Type::eSimplex>)(x.data(), y.data(), z.data(), out.data(), seed, fractal);
+        case Noise::Type::eValue: return HWY_STATIC_DISPATCH(NoiseFractal3DImpl<Noise::Type::eValue>)(x.data(), y.data(), z.data(), out.data(), seed, fractal);
+    }
+}
+
+void Noise::Sample2D(const Type type, const Row& x, const Row& z, Row& out) const {
+    const Fractal single = {.m_type = type, .m_octaves = 1, .m_frequency = 1.0f};
+    DispatchFractal2D(single, m_seed, x, z, out);
+}
+
+void Noise::Sample3D(const Type type, const Row& x, const Row& y, const Row& z, Row& out) const {
+    const Fractal single = {.m_type = type, .m_octaves = 1, .m_frequency = 1.0f};
+    DispatchFractal3D(single, m_seed, x, y, z, out);
+}
+
+void Noise::Fractal2D(const Fractal& fractal, const Row& x, const Row& z, Row& out) const {
+    DispatchFractal2D(fractal, m_seed, x, z, out);
+}
+
+void Noise::Fractal3D(const Fractal& fractal, const Row& x, const Row& y, const Row& z, Row& out) const {
+    DispatchFractal3D(fractal, m_seed, x, y, z, out);
+}
+
+void Noise::Warp2D(const Fractal& fractal, const float amplitude, Row& x, Row& z) const {
+    Row offsetX, offsetZ;
+    DispatchFractal2D(fractal, m_seed ^ sWarpSeeds[0], x, z, offsetX);
+    DispatchFractal2D(fractal, m_seed ^ sWarpSeeds[2], x, z, offsetZ);
+
+    HWY_STATIC_DISPATCH(NoiseAddScaledImpl)(x.data(), offsetX.data(), amplitude);
+    HWY_STATIC_DISPATCH(NoiseAddScaledImpl)(z.data(), offsetZ.data(), amplitude);
+}
+
+void Noise::Warp3D(const Fractal& fractal, const float amplitude, Row& x, Row& y, Row& z) const {
+    Row offsetX, offsetY, offsetZ;
+    DispatchFractal3D(fractal, m_seed ^ sWarpSeeds[0], x, y, z, offsetX);
+    DispatchFractal3D(fractal, m_seed ^ sWarpSeeds[1], x, y, z, offsetY);
+    DispatchFractal3D(fractal, m_seed ^ sWarpSeeds[2], x, y, z, offsetZ);
+
+    HWY_STATIC_DISPATCH(NoiseAddScaledImpl)(x.data(), offsetX.data(), amplitude);
+    HWY_STATIC_DISPATCH(NoiseAddScaledImpl)(y.data(), offsetY.data(), amplitude);
+    HWY_STATIC_DISPATCH(NoiseAddScaledImpl)(z.data(), offsetZ.data(), amplitude);
+}
+
+// ========== Scalar ==========
+
+Logger Noise::sLogger = Logger("Noise");
+
+static uint32_t ScalarHash(const uint32_t seed, const uint32_t x, const uint32_t y, const uint32_t z) {
+    uint32_t hash = seed ^ (x * 0x8DA6B343u);
+    hash ^= y * 0xD8163841u;
+    hash ^= z * 0xCB1AB31Fu;
+    hash = (hash ^ (hash >> 15)) * 0x2C1B3C6Du;
+    return hash ^ (hash >> 13);
+}
+
+static uint32_t ScalarCell(const float floored) {
+    return static_cast<uint32_t>(static_cast<int32_t>(floored));
+}
+
+static float ScalarGrad2(const uint32_t hash, const float x, const float z) {
+    const float u = (hash & 4) ? z : x;
+    const float v = (hash & 4) ? x : z;
+    return ((hash & 2) ? -v : v) * 0.5f + ((hash & 1) ? -u : u);
+}
+
+static float ScalarGrad3(const uint32_t hash, const float x, const float y, const float z) {
+    const uint32_t low = hash & 15;
+    const float u = low < 8 ? x : y;
+    const float v = low < 4 ? y : (low == 12 || low == 14 ? x : z);
+    return ((hash & 1) ? -u : u) + ((hash & 2) ? -v : v);
+}
+
+static float ScalarHashToFloat(const uint32_t hash) {
+    return static_cast<float>(static_cast<int32_t>(hash)) * (1.0f / 2147483648.0f);
+}
+
+static float ScalarFade(const float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static float ScalarLerp(const float t, const float a, const float b) {
+    return t * (b - a) + a;
+}
+
+static float ScalarPerlin2D(const uint32_t seed, const float x, const float z) {
+    const float floorX = std::floor(x);
+    const float floorZ = std::floor(z);
+    const uint32_t cellX = ScalarCell(floorX);
+    const uint32_t cellZ = ScalarCell(floorZ);
+    const float fx = x - floorX;
+    const float fz = z - floorZ;
+
+    const float g00 = ScalarGrad2(ScalarHash(seed, cellX, 0, cellZ), fx, fz);
+    const float g10 = ScalarGrad2(ScalarHash(seed, cellX + 1, 0, cellZ), fx - 1.0f, fz);
+    const float g01 = ScalarGrad2(ScalarHash(seed, cellX, 0, cellZ + 1), fx, fz - 1.0f);
+    const float g11 = ScalarGrad2(ScalarHash(seed, cellX + 1, 0, cellZ + 1), fx - 1.0f, fz - 1.0f);
+
+    const float u = ScalarFade(fx);
+    return ScalarLerp(ScalarFade(fz), ScalarLerp(u, g00, g10), ScalarLerp(u, g01, g11)) * NOISE_PERLIN_2D_SCALE;
+}
+
+static float ScalarPerlin3D(const uint32_t seed, const float x, const float y, const float z) {
+    const float floorX = std::floor(x);
+    const float floorY = std::floor(y);
+    const float floorZ = std::floor(z);
+    const uint32_t x0 = ScalarCell(floorX);
+    const uint32_t y0 = ScalarCell(floorY);
+    const uint32_t z0 = ScalarCell(floorZ);
+    const float fx = x - floorX;
+    const float fy = y - floorY;
+    const float fz = z - floorZ;
+
+    const float g000 = ScalarGrad3(ScalarHash(seed, x0, y0, z0), fx, fy, fz);
+    const float g100 = ScalarGrad3(ScalarHash(seed, x0 + 1, y0, z0), fx - 1.0f, fy, fz);
+    const float g010 = ScalarGrad3(ScalarHash(seed, x0, y0 + 1, z0), fx, fy - 1.0f, fz);
+    const float g110 = ScalarGrad3(ScalarHash(seed, x0 + 1, y0 + 1, z0), fx - 1.0f, fy - 1.0f, fz);
+    const float g001 = ScalarGrad3(ScalarHash(seed, x0, y0, z0 + 1), fx, fy, fz - 1.0f);
+    const float g101 = ScalarGrad3(ScalarHash(seed, x0 + 1, y0, z0 + 1), fx - 1.0f, fy, fz - 1.0f);
+    const float g011 = ScalarGrad3(ScalarHash(seed, x0, y0 + 1, z0 + 1), fx, fy - 1.0f, fz - 1.0f);
+    const float g111 = ScalarGrad3(ScalarHash(seed, x0 + 1, y0 + 1, z0 + 1), fx - 1.0f, fy - 1.0f, fz - 1.0f);
+
+    const float u = ScalarFade(fx);
+    const float v = ScalarFade(fy);
+    const float nearZ = ScalarLerp(v, ScalarLerp(u, g000, g100), ScalarLerp(u, g010, g110));
+    const float farZ = ScalarLerp(v, ScalarLerp(u, g001, g101), ScalarLerp(u, g011, g111));
+    return ScalarLerp(ScalarFade(fz), nearZ, farZ) * NOISE_PERLIN_3D_SCALE;
+}
+
+static float ScalarValue2D(const uint32_t seed, const float x, const float z) {
+    const float floorX = std::floor(x);
+    const float floorZ = std::floor(z);
+    const uint32_t cellX = ScalarCell(floorX);
+    const uint32_t cellZ = ScalarCell(floorZ);
+
+    const float v00 = ScalarHashToFloat(ScalarHash(seed, cellX, 0, cellZ));
+    const float v10 = ScalarHashToFloat(ScalarHash(seed, cellX + 1, 0, cellZ));
+    const float v01 = ScalarHashToFloat(ScalarHash(seed, cellX, 0, cellZ + 1));
+    const float v11 = ScalarHashToFloat(ScalarHash(seed, cellX + 1, 0, cellZ + 1));
+
+    const float u = ScalarFade(x - floorX);
+    return ScalarLerp(ScalarFade(z - floorZ), ScalarLerp(u, v00, v10), ScalarLerp(u, v01, v11));
+}
+
+static float ScalarValue3D(const uint32_t seed, const float x, const float y, const float z) {
+    const float floorX = std::floor(x);
+    const float floorY = std::floor(y);
+    const float floorZ = std::floor(z);
+    const uint32_t x0 = ScalarCell(floorX);
+    const uint32_t y0 = ScalarCell(floorY);
+    const uint32_t z0 = ScalarCell(floorZ);
+
+    const float v000 = ScalarHashToFloat(ScalarHash(seed, x0, y0, z0));
+    const float v100 = ScalarHashToFloat(ScalarHash(seed, x0 + 1, y0, z0));
+    const float v010 = ScalarHashToFloat(ScalarHash(seed, x0, y0 + 1, z0));
+    const float v110 = ScalarHashToFloat(ScalarHash(seed, x0 + 1, y0 + 1, z0));
+    const float v001 = ScalarHashToFloat(ScalarHash(seed, x0, y0, z0 + 1));
+    const float v101 = ScalarHashToFloat(ScalarHash(seed, x0 + 1, y0, z0 + 1));
+    const float v011 = ScalarHashToFloat(ScalarHash(seed, x0, y0 + 1, z0 + 1));
+    const float v111 = ScalarHashToFloat(ScalarHash(seed, x0 + 1, y0 + 1, z0 + 1));
+
+    const float u = ScalarFade(x - floorX);
+    const float v = ScalarFade(y - floorY);
+    const float nearZ = ScalarLerp(v, ScalarLerp(u, v000, v100), ScalarLerp(u, v010, v110));
+    const float farZ = ScalarLerp(v, ScalarLerp(u, v001, v101), ScalarLerp(u, v011, v111));
+    return ScalarLerp(ScalarFade(z - floorZ), nearZ, farZ);
+}
+
+static float ScalarSimplexCorner2D(const uint32_t hash, const float x, const float z) {
+    float t = std::max(0.5f - x * x - z * z, 0.0f);
+    t *= t;
+    return t * t * ScalarGrad2(hash, x, z);
+}
+
+static float ScalarSimplexCorner3D(const uint32_t hash, const float x, const float y, const float z) {
+    float t = std::max(0.6f - x * x - y * y - z * z, 0.0f);
+    t *= t;
+    return t * t * ScalarGrad3(hash, x, y, z);
+}
+
+static float ScalarSimplex2D(const uint32_t seed, const float x, const float z) {
+    const float skew = (x + z) * NOISE_F2;
+    const float floorX = std::floor(x + skew);
+    const float floorZ = std::floor(z + skew);
+    const float unskew = (floorX + floorZ) * NOISE_G2;
+    const float x0 = x - (floorX - unskew);
+    const float z0 = z - (floorZ - unskew);
+
+    const uint32_t stepX = x0 > z0 ? 1 : 0;
+    const uint32_t stepZ = 1 - stepX;
+    const float x1 = x0 - static_cast<float>(stepX) + NOISE_G2;
+    const float z1 = z0 - static_cast<float>(stepZ) + NOISE_G2;
+    const float x2 = x0 - 1.0f + 2.0f * NOISE_G2;
+    const float z2 = z0 - 1.0f + 2.0f * NOISE_G2;
+
+    const uint32_t cellX = ScalarCell(floorX);
+    const uint32_t cellZ = ScalarCell(floorZ);
+
+    float result = ScalarSimplexCorner2D(ScalarHash(seed, cellX, 0, cellZ), x0, z0);
+    result += ScalarSimplexCorner2D(ScalarHash(seed, cellX + stepX, 0, cellZ + stepZ), x1, z1);
+    result += ScalarSimplexCorner2D(ScalarHash(seed, cellX + 1, 0, cellZ + 1), x2, z2);
+    return result * NOISE_SIMPLEX_2D_SCALE;
+}
+
+static float ScalarSimplex3D(const uint32_t seed, const float x, const float y, const float z) {
+    const float skew = (x + y + z) * NOISE_F3;
+    const float floorX = std::floor(x + skew);
+    const float floorY = std::floor(y + skew);
+    const float floorZ = std::floor(z + skew);
+    const float unskew = (floorX + floorY + floorZ) * NOISE_G3;
+    const float x0 = x - (floorX - unskew);
+    const float y0 = y - (floorY - unskew);
+    const float z0 = z - (floorZ - unskew);
+
+    const bool xGeY = x0 >= y0;
+    const bool yGeZ = y0 >= z0;
+    const bool xGeZ = x0 >= z0;
+    const uint32_t firstX = xGeY && xGeZ;
+    const uint32_t firstY = !xGeY && yGeZ;
+    const uint32_t firstZ = !xGeZ && !yGeZ;
+    const uint32_t secondX = xGeY || xGeZ;
+    const uint32_t secondY = !xGeY || yGeZ;
+    const uint32_t secondZ = !xGeZ || !yGeZ;
+
+    const float x1 = x0 - static_cast<float>(firstX) + NOISE_G3;
+    const float y1 = y0 - static_cast<float>(firstY) + NOISE_G3;
+    const float z1 = z0 - static_cast<float>(firstZ) + NOISE_G3;
+    const float x2 = x0 - static_cast<float>(secondX) + 2.0f * NOISE_G3;
+    const float y2 = y0 - static_cast<float>(secondY) + 2.0f * NOISE_G3;
+    const float z2 = z0 - static_cast<float>(secondZ) + 2.0f * NOISE_G3;
+    const float x3 = x0 - 1.0f + 3.0f * NOISE_G3;
+    const float y3 = y0 - 1.0f + 3.0f * NOISE_G3;
+    const float z3 = z0 - 1.0f + 3.0f * NOISE_G3;
+
+    const uint32_t cellX = ScalarCell(floorX);
+    const uint32_t cellY = ScalarCell(floorY);
+    const uint32_t cellZ = ScalarCell(floorZ);
+
+    float result = ScalarSimplexCorner3D(ScalarHash(seed, cellX, cellY, cellZ), x0, y0, z0);
+    result += ScalarSimplexCorner3D(ScalarHash(seed, cellX + firstX, cellY + firstY, cellZ + firstZ), x1, y1, z1);
+    result += ScalarSimplexCorner3D(ScalarHash(seed, cellX + secondX, cellY + secondY, cellZ + secondZ), x2, y2, z2);
+    result += ScalarSimplexCorner3D(ScalarHash(seed, cellX + 1, cellY + 1, cellZ + 1), x3, y3, z3);
+    return result * NOISE_SIMPLEX_3D_SCALE;
+}
+
+static float ScalarSample2D(const Noise::Type type, const uint32_t seed, const float x, const float z) {
+    switch (type) {
+        case Noise::Type::ePerlin: return ScalarPerlin2D(seed, x, z);
+        case Noise::Type::eSimplex: return ScalarSimplex2D(seed, x, z);
+        case Noise::Type::eValue: return ScalarValue2D(seed, x, z);
+    }
+    return 0.0f;
+}
+
+static float ScalarSample3D(const Noise::Type type, const uint32_t seed, const float x, const float y, const float z) {
+    switch (type) {
+        case Noise::Type::ePerlin: return ScalarPerlin3D(seed, x, y, z);
+        case Noise::Type::eSimplex: return ScalarSimplex3D(seed, x, y, z);
+        case Noise::Type::eValue: return ScalarValue3D(seed, x, y, z);
+    }
+    return 0.0f;
+}
+
+void Noise::FillRow(Row& row, const float start, const float step) {
+    for (uint32_t i = 0; i < row.size(); i++)
+        row[i] = start + static_cast<float>(i) * step;
+}
+
+float Noise::SampleScalar2D(const Type type, const float x, const float z) const {
+    return ScalarSample2D(type, m_seed, x, z);
+}
+
+float Noise::SampleScalar3D(const Type type, const float x, const float y, const float z) const {
+    return ScalarSample3D(type, m_seed, x, y, z);
+}
+
+float Noise::FractalScalar2D(const Fractal& fractal, const float x, const float z) const {
+    float sampleX = x * fractal.m_frequency;
+    float sampleZ = z * fractal.m_frequency;
+    float sum = 0.0f;
+    float totalAmplitude = 0.0f;
+    float amplitude = 1.0f;
+    uint32_t octaveSeed = m_seed;
+
+    for (uint32_t octave = 0; octave < fractal.m_octaves; octave++) {
+        sum += amplitude * ScalarSample2D(fractal.m_type, octaveSeed, sampleX, sampleZ);
+        totalAmplitude += amplitude;
+
+        sampleX *= fractal.m_lacunarity;
+        sampleZ *= fractal.m_lacunarity;
+        amplitude *= fractal.m_gain;
+        octaveSeed += NOISE_OCTAVE_SEED;
+    }
+
+    return sum * (1.0f / totalAmplitude);
+}
+
+float Noise::FractalScalar3D(const Fractal& fractal, const float x, const float y, const float z) const {
+    float sampleX = x * fractal.m_frequency;
+    float sampleY = y * fractal.m_frequency;
+    float sampleZ = z * fractal.m_frequency;
+    float sum = 0.0f;
+    float totalAmplitude = 0.0f;
+    float amplitude = 1.0f;
+    uint32_t octaveSeed = m_seed;
+
+    for (uint32_t octave = 0; octave < fractal.m_octaves; octave++) {
+        sum += amplitude * ScalarSample3D(fractal.m_type, octaveSeed, sampleX, sampleY, sampleZ);
+        totalAmplitude += amplitude;
+
+        sampleX *= fractal.m_lacunarity;
+        sampleY *= fractal.m_lacunarity;
+        sampleZ *= fractal.m_lacunarity;
+        amplitude *= fractal.m_gain;
+        octaveSeed += NOISE_OCTAVE_SEED;
+    }
+
+    return sum * (1.0f / totalAmplitude);
+}
+
+bool Noise::TestAccuracy() const {
+    std::mt19937 gen(m_seed);
+    std::uniform_real_distribution<float> coord(-5000.0f, 5000.0f);
+
+    // Fused multiply-adds on some targets round differently than the scalar code.
+    constexpr float tolerance = 1e-3f;
+    float maxError = 0.0f;
+    const auto compare = [&](const char* name, const Row& vectorized, const std::function<float(uint32_t)>& scalar) {
+        for (uint32_t i = 0; i < 32; i++) {
+            const float error = std::abs(vectorized[i] - scalar(i));
+            maxError = std::max(maxError, error);
+            if (!(error <= tolerance)) {
+                sLogger.Warning(name, " differs from the scalar reference at lane ", i, ": ", vectorized[i], " vs ", scalar(i));
+                return false;
+            }
+        }
+        return true;
+    };
+
+    constexpr std::array<Type, 3> types = {Type::ePerlin, Type::eSimplex, Type::eValue};
+    constexpr std::array<const char*, 3> names = {"Perlin", "Simplex", "Value"};
+    for (uint32_t iteration = 0; iteration < 256; iteration++) {
+        Row x, y, z, out;
+        // Small steps keep neighboring lanes within a cell, large ones cross many.
+        const float step = iteration % 2 == 0 ? 0.03125f : 1.7f;
+        FillRow(x, coord(gen), step);
+        FillRow(y, coord(gen), step * 0.5f);
+        FillRow(z, coord(gen), -step);
+
+        for (uint32_t t = 0; t < types.size(); t++) {
+            const Type type = types[t];
+            Sample2D(type, x, z, out);
+            if (!compare(names[t], out, [&](uint32_t i) { return SampleScalar2D(type, x[i], z[i]); }))
+                return false;
+
+            Sample3D(type, x, y, z, out);
+            if (!compare(names[t], out, [&](uint32_t i) { return SampleScalar3D(type, x[i], y[i], z[i]); }))
+                return false;
+
+            const Fractal fractal = {.m_type = type, .m_octaves = 5, .m_frequency = 0.02f};
+            Fractal2D(fractal, x, z, out);
+            if (!compare(names[t], out, [&](uint32_t i) { return FractalScalar2D(fractal, x[i], z[i]); }))
+                return false;
+
+            Fractal3D(fractal, x, y, z, out);
+            if (!compare(names[t], out, [&](uint32_t i) { return FractalScalar3D(fractal, x[i], y[i], z[i]); }))
+                return false;
+        }
+    }
+
+    sLogger.Verbose("Verified noise against the scalar reference! Max error: ", maxError);
+    return true;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "util/Logger.h"
+
+// Deterministic procedural noise for world generation. Samples are evaluated a chunk row (32
+// samples) at a time with Highway, and every vectorized function has a scalar reference that
+// computes the same values for testing.
+class Noise final {
+public:
+    using Row = std::array<float, 32>;
+
+    enum class Type : uint8_t {
+        ePerlin = 0, // Gradient noise on a square grid.
+        eSimplex = 1, // Gradient noise on a simplex grid, fewer directional artifacts.
+        eValue = 2 // Interpolated random values, cheapest but blocky.
+    };
+
+    // Fractal Brownian motion, octaves of noise at rising frequency and falling amplitude.
+    struct Fractal {
+        Type m_type = Type::ePerlin;
+        uint32_t m_octaves = 4;
+        float m_frequency = 0.01f;
+        float m_lacunarity = 2.0f; // Frequency multiplier per octave.
+        float m_gain = 0.5f; // Amplitude multiplier per octave.
+    };
+
+    explicit Noise(const uint32_t seed = 0) : m_seed(seed) {}
+
+    // Fills a row with start, start + step, start + 2 * step, ...
+    static void FillRow(Row& row, const float start, const float step);
+
+    // Single octave noise at the given coordinates, within about [-1, 1].
+    void Sample2D(const Type type, const Row& x, const Row& z, Row& out) const;
+    void Sample3D(const Type type, const Row& x, const Row& y, const Row& z, Row& out) const;
+
+    // Fractal noise at the given coordinates, normalized to about [-1, 1].
+    void Fractal2D(const Fractal& fractal, const Row& x, const Row& z, Row& out) const;
+    void Fractal3D(const Fractal& fractal, const Row& x, const Row& y, const Row& z, Row& out) const;
+
+    // Domain warping, offsets the coordinates in place by fractal noise scaled by the amplitude.
+    void Warp2D(const Fractal& fractal, const float amplitude, Row& x, Row& z) const;
+    void Warp3D(const Fractal& fractal, const float amplitude, Row& x, Row& y, Row& z) const;
+
+    // Scalar references of the functions above, one sample at a time.
+    float SampleScalar2D(const Type type, const float x, const float z) const;
+    float SampleScalar3D(const Type type, const float x, const float y, const float z) const;
+    float FractalScalar2D(const Fractal& fractal, const float x, const float z) const;
+    float FractalScalar3D(const Fractal& fractal, const float x, const float y, const float z) const;
+
+    // Compares every vectorized function against its scalar reference over random rows.
+    bool TestAccuracy() const;
+
+    VXL_INLINE uint32_t GetSeed() const noexcept {
+        return m_seed;
+    }
+private:
+    static Logger sLogger;
+
+    // Per axis seeds for warping, so the offsets of each axis are unrelated.
+    static constexpr std::array<uint32_t, 3> sWarpSeeds = {0x5BD1E995u, 0x1B873593u, 0x85EBCA6Bu};
+
+    uint32_t m_seed;
+};
@@ -0,0 +1,82 @@
+#include "world/gen/TerrainGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include "world/ChunkNode.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+Logger TerrainGenerator::sLogger = Logger("TerrainGenerator");
+
+TerrainGenerator::TerrainGenerator(const Settings& settings)
+    : m_settings(settings), m_noise(settings.m_seed), m_caveNoise(settings.m_seed ^ 0xC2B2AE35u) {}
+
+void TerrainGenerator::Generate(EightBitChunk& chunk, const ChunkPos& pos) const {
+    const float originX = static_cast<float>(pos.m_x) * 32.0f;
+    const float originY = static_cast<float>(pos.m_y) * 32.0f;
+    const float originZ = static_cast<float>(pos.m_z) * 32.0f;
+
+    // Surface height of every column, in rows along z to match the block data.
+    std::array<Noise::Row, 32> heights;
+    std::array<float, 32> rowMaxHeights;
+    float maxHeight = -INFINITY;
+    Noise::Row rowX, rowZ;
+    for (uint32_t x = 0; x < 32; x++) {
+        rowX.fill(originX + static_cast<float>(x));
+        Noise::FillRow(rowZ, originZ, 1.0f);
+        m_noise.Warp2D(m_settings.m_warp, m_settings.m_warpAmplitude, rowX, rowZ);
+        m_noise.Fractal2D(m_settings.m_height, rowX, rowZ, heights[x]);
+
+        rowMaxHeights[x] = -INFINITY;
+        for (float& height : heights[x]) {
+            height = std::floor(m_settings.m_baseHeight + height * m_settings.m_heightScale);
+            rowMaxHeights[x] = std::max(rowMaxHeights[x], height);
+        }
+        maxHeight = std::max(maxHeight, rowMaxHeights[x]);
+    }
+
+    // Entirely above the surface, the chunk stays air.
+    if (originY > maxHeight)
+        return;
+
+    const float dirtDepth = static_cast<float>(m_settings.m_dirtDepth);
+    uint8_t* data = chunk.Data();
+    Noise::Row caveX, caveY, caveZ, caves;
+    Noise::FillRow(caveZ, originZ, 1.0f);
+
+    for (uint32_t x = 0; x < 32; x++) {
+        caveX.fill(originX + static_cast<float>(x));
+
+        for (uint32_t y = 0; y < 32; y++) {
+            const float worldY = originY + static_cast<float>(y);
+            if (worldY > rowMaxHeights[x])
+                continue;
+
+            uint8_t* row = data + ((x << 10) | (y << 5));
+            const Noise::Row& rowHeights = heights[x];
+            for (uint32_t z = 0; z < 32; z++) {
+                const float depth = rowHeights[z] - worldY;
+                row[z] = depth < 0.0f ? BlockTypes::eAir
+                    : depth == 0.0f ? BlockTypes::eGrass
+                    : depth <= dirtDepth ? BlockTypes::eDirt
+                    : BlockTypes::eStone;
+            }
+
+            caveY.fill(worldY);
+            m_caveNoise.Fractal3D(m_settings.m_caves, caveX, caveY, caveZ, caves);
+            for (uint32_t z = 0; z < 32; z++) {
+                if (caves[z] > m_settings.m_caveThreshold)
+                    row[z] = BlockTypes::eAir;
+            }
+        }
+    }
+
+    chunk.RecountPalette();
+}
+
+void TerrainGenerator::Generate(ChunkNode& node) const {
+    EightBitChunk* chunk = dynamic_cast<EightBitChunk*>(node.m_chunk.get());
+    if (chunk == nullptr)
+        throw sLogger.RuntimeError("Terrain can only be generated into eight bit chunks!");
+
+    Generate(*chunk, node.m_pos);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/gen/Noise.h"
+
+struct ChunkNode;
+class EightBitChunk;
+
+// Fills chunks with terrain from a domain warped height map, carved by 3D noise caves. Noise is
+// evaluated a row at a time straight into the chunk's block data. Generation only reads the
+// settings, so any number of chunks can be generated at once.
+class TerrainGenerator final {
+public:
+    struct Settings {
+        uint32_t m_seed = 0;
+        float m_baseHeight = 0.0f; // World height of the terrain where the height noise is 0.
+        float m_heightScale = 48.0f; // World height change where the height noise is +-1.
+        float m_warpAmplitude = 60.0f; // In blocks.
+        float m_caveThreshold = 0.45f; // Cave noise above this is carved out.
+        uint32_t m_dirtDepth = 3; // Blocks of dirt between the grass and the stone.
+        Noise::Fractal m_height = {.m_type = Noise::Type::ePerlin, .m_octaves = 5, .m_frequency = 0.004f};
+        Noise::Fractal m_warp = {.m_type = Noise::Type::eSimplex, .m_octaves = 2, .m_frequency = 0.002f};
+        Noise::Fractal m_caves = {.m_type = Noise::Type::eSimplex, .m_octaves = 2, .m_frequency = 0.03f};
+    };
+
+    explicit TerrainGenerator(const Settings& settings);
+
+    // Fills a chunk that is all air.
+    void Generate(EightBitChunk& chunk, const ChunkPos& pos) const;
+
+    void Generate(ChunkNode& node) const;
+
+    VXL_INLINE const Settings& GetSettings() const noexcept {
+        return m_settings;
+    }
+private:
+    static Logger sLogger;
+
+    Settings m_settings;
+    Noise m_noise;
+    Noise m_caveNoise;
+};
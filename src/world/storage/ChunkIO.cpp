@@ -0,0 +1,270 @@
+#include "world/storage/ChunkIO.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <iterator>
+#include <stdexcept>
+#include "world/chunk/ChunkSerializer.h"
+
+Logger ChunkIO::sLogger = Logger("ChunkIO");
+
+ChunkIO::ChunkIO(RegionStorage& storage, const Settings& settings) : m_storage(storage), m_settings(settings) {
+    m_settings.m_maxBatch = std::max<uint32_t>(m_settings.m_maxBatch, 1);
+
+#if VXL_IO_URING
+    // Rings can be unavailable at runtime, e.g. in sandboxes, so pread stays as the fallback.
+    m_ringReady = io_uring_queue_init(sQueueDepth, &m_ring, 0) == 0;
+    if (!m_ringReady)
+        sLogger.Warning("Failed to set up io_uring, falling back to pread!");
+    m_useRing = m_ringReady;
+#endif
+
+    m_thread = std::thread([this]() {
+        Run();
+    });
+}
+
+ChunkIO::~ChunkIO() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t dropped = std::erase_if(m_queue, [](const Request& request) {
+            return !request.m_write;
+        });
+        m_pending.fetch_sub(dropped, std::memory_order_relaxed);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+
+#if VXL_IO_URING
+    if (m_ringReady)
+        io_uring_queue_exit(&m_ring);
+#endif
+}
+
+bool ChunkIO::RequestLoad(const ChunkPos& pos) {
+    if (IsSaturated())
+        return false;
+
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({.m_pos = pos});
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void ChunkIO::RequestSave(const ChunkPos& pos, const EightBitChunk& chunk) {
+    // Serializing here snapshots the blocks, so the chunk can change or go away right after.
+    Request request = {.m_pos = pos, .m_write = true};
+    ChunkSerializer::Serialize(chunk, request.m_record);
+
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(request));
+        m_queuedWrites++;
+    }
+    m_wake.notify_one();
+}
+
+void ChunkIO::Poll(const LoadCallback& callback) {
+    m_polled.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_polled.swap(m_completed);
+    }
+
+    for (Completion& completion : m_polled) {
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        callback(completion.m_pos, std::move(completion.m_chunk));
+    }
+}
+
+void ChunkIO::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() {
+        return m_queuedWrites == 0;
+    });
+}
+
+void ChunkIO::Run() {
+    std::vector<Request> writes;
+    std::vector<Request> reads;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() {
+                return !m_queue.empty() || !m_running;
+            });
+            if (m_queue.empty())
+                return;
+
+            const size_t count = std::min<size_t>(m_queue.size(), m_settings.m_maxBatch);
+            for (size_t i = 0; i < count; i++) {
+                Request& request = m_queue.front();
+                (request.m_write ? writes : reads).push_back(std::move(request));
+                m_queue.pop_front();
+            }
+        }
+
+        // Writes go first, so a read queued after the write of the same chunk sees the new record.
+        if (!writes.empty())
+            WriteBatch(writes);
+        if (!reads.empty())
+            ReadBatch(reads);
+        writes.clear();
+        reads.clear();
+    }
+}
+
+void ChunkIO::WriteBatch(std::vector<Request>& writes) {
+    // Neighbouring chunks share region files, so their writes land close together.
+    std::stable_sort(writes.begin(), writes.end(), [](const Request& a, const Request& b) {
+        return RegionFile::GetRegion(a.m_pos).Pack() < RegionFile::GetRegion(b.m_pos).Pack();
+    });
+
+    for (const Request& write : writes) {
+        try {
+            m_storage.SaveRecord(write.m_pos, write.m_record.data(), write.m_record.size());
+        } catch (const std::runtime_error& error) {
+            sLogger.Error("Failed to save chunk ", write.m_pos.m_x, ", ", write.m_pos.m_y, ", ", write.m_pos.m_z, ": ", error.what());
+        }
+    }
+
+    m_pending.fetch_sub(writes.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queuedWrites -= writes.size();
+    }
+    m_idle.notify_all();
+}
+
+void ChunkIO::ReadBatch(std::vector<Request>& reads) {
+    std::sort(reads.begin(), reads.end(), [](const Request& a, const Request& b) {
+        return RegionFile::GetRegion(a.m_pos).Pack() < RegionFile::GetRegion(b.m_pos).Pack();
+    });
+
+    std::vector<Request*> group;
+    for (size_t first = 0; first < reads.size();) {
+        const ChunkPos region = RegionFile::GetRegion(reads[first].m_pos);
+        group.clear();
+        while (first + group.size() < reads.size() && RegionFile::GetRegion(reads[first + group.size()].m_pos) == region)
+            group.push_back(&reads[first + group.size()]);
+
+        // Chunks of regions without a file, or whose records can't be read, count as not stored.
+        try {
+            m_storage.WithRegion(region, [&](RegionFile& file) {
+                ReadRecords(file, group.data(), group.size());
+            });
+        } catch (const std::runtime_error& error) {
+            sLogger.Error("Failed to read from region ", region.m_x, ", ", region.m_y, ", ", region.m_z, ": ", error.what());
+            for (Request* read : group)
+                read->m_record.clear();
+        }
+
+        first += group.size();
+    }
+
+    for (Request& read : reads)
+        Complete(std::move(read));
+}
+
+void ChunkIO::ReadRecords(RegionFile& file, Request** reads, const size_t count) {
+    // In file order, so the disk moves forward through the region.
+    std::sort(reads, reads + count, [&file](const Request* a, const Request* b) {
+        return file.GetEntry(RegionFile::GetIndex(a->m_pos)).m_sector < file.GetEntry(RegionFile::GetIndex(b->m_pos)).m_sector;
+    });
+
+    size_t first = 0;
+#if VXL_IO_URING
+    for (; first < count && m_useRing.load(std::memory_order_relaxed); first += sQueueDepth)
+        ReadRing(file, reads + first, std::min<size_t>(count - first, sQueueDepth));
+#endif
+
+    for (size_t i = first; i < count; i++) {
+        if (!file.Read(RegionFile::GetIndex(reads[i]->m_pos), reads[i]->m_record))
+            reads[i]->m_record.clear();
+    }
+}
+
+#if VXL_IO_URING
+void ChunkIO::ReadRing(RegionFile& file, Request** reads, const size_t count) {
+    // Reads that got their whole record from the ring, or have none to read.
+    std::array<bool, sQueueDepth> done = {};
+    std::array<bool, sQueueDepth> inFlight = {};
+    uint32_t submitted = 0;
+    for (size_t i = 0; i < count; i++) {
+        const RegionFile::Entry& entry = file.GetEntry(RegionFile::GetIndex(reads[i]->m_pos));
+        reads[i]->m_record.clear();
+        done[i] = entry.m_sector == 0;
+        if (done[i])
+            continue;
+
+        reads[i]->m_record.resize(entry.m_size);
+        io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+        io_uring_prep_read(sqe, file.GetDescriptor(), reads[i]->m_record.data(), entry.m_size, RegionFile::GetOffset(entry.m_sector));
+        io_uring_sqe_set_data64(sqe, i);
+        submitted++;
+    }
+
+    // Reads that didn't go out stay in the submission queue, which is never submitted again once
+    // the ring is given up.
+    int32_t result = submitted > 0 ? io_uring_submit_and_wait(&m_ring, submitted) : 0;
+    uint32_t pending = result > 0 ? static_cast<uint32_t>(result) : 0;
+    for (size_t i = 0, queued = 0; i < count && queued < pending; i++) {
+        inFlight[i] = !done[i];
+        queued += inFlight[i];
+    }
+    if (pending < submitted) {
+        sLogger.Error("Failed to submit reads to io_uring, falling back to pread!");
+        m_useRing.store(false, std::memory_order_relaxed);
+    }
+
+    while (pending > 0) {
+        io_uring_cqe* cqe;
+        result = io_uring_wait_cqe(&m_ring, &cqe);
+        if (result == -EINTR || result == -EAGAIN)
+            continue;
+        if (result < 0) {
+            sLogger.Error("Failed to wait for io_uring completions, falling back to pread!");
+            m_useRing.store(false, std::memory_order_relaxed);
+            for (size_t i = 0; i < count; i++) {
+                if (inFlight[i])
+                    m_orphanedRecords.push_back(std::move(reads[i]->m_record));
+            }
+            break;
+        }
+
+        const size_t i = static_cast<size_t>(io_uring_cqe_get_data64(cqe));
+        done[i] = cqe->res == static_cast<int32_t>(reads[i]->m_record.size());
+        inFlight[i] = false;
+        io_uring_cqe_seen(&m_ring, cqe);
+        pending--;
+    }
+
+    // Short, failed and unsubmitted reads are retried through the regular path.
+    for (size_t i = 0; i < count; i++) {
+        if (!done[i] && !file.Read(RegionFile::GetIndex(reads[i]->m_pos), reads[i]->m_record))
+            reads[i]->m_record.clear();
+    }
+}
+#endif
+
+void ChunkIO::Complete(Request&& read) {
+    std::unique_ptr<EightBitChunk> chunk;
+    if (!read.m_record.empty()) {
+        chunk = std::make_unique<EightBitChunk>();
+        try {
+            ChunkSerializer::Deserialize(read.m_record.data(), read.m_record.size(), *chunk);
+        } catch (const std::runtime_error& error) {
+            sLogger.Error("Dropped the corrupt record of chunk ", read.m_pos.m_x, ", ", read.m_pos.m_y, ", ", read.m_pos.m_z, ": ", error.what());
+            chunk.reset();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    m_completed.push_back({.m_pos = read.m_pos, .m_chunk = std::move(chunk)});
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/types/EightBitChunk.h"
+#include "world/storage/RegionStorage.h"
+
+#if VXL_IO_URING
+#include <liburing.h>
+#endif
+
+// Asynchronous chunk reads and writes on a dedicated I/O thread, so the main thread never waits on
+// the disk. Requests are taken in batches, writes first so that a read always sees the latest
+// record, and reads are grouped by region and ordered by their place in the file. With VXL_IO_URING
+// a region's reads go out together through io_uring, otherwise one pread after another. Records
+// are decoded on the I/O thread as well, so loads finish without a worker pool, and are handed back
+// through Poll(). Once given to this class the storage must only be used through it until it is
+// destroyed.
+class ChunkIO final {
+public:
+    struct Settings {
+        size_t m_maxPending = 512; // Loads are refused while this many requests haven't been polled yet.
+        uint32_t m_maxBatch = 64; // Requests taken off the queue at once.
+    };
+
+    // A finished load, the chunk is null if it wasn't stored.
+    using LoadCallback = std::function<void(const ChunkPos& pos, std::unique_ptr<EightBitChunk> chunk)>;
+
+    ChunkIO(RegionStorage& storage, const Settings& settings);
+
+    // Finishes every queued write, while outstanding loads are dropped.
+    ~ChunkIO();
+
+    ChunkIO(const ChunkIO&) = delete;
+    ChunkIO& operator=(const ChunkIO&) = delete;
+
+    // Queues a read of the chunk. Returns false if too many requests are pending, in which case the
+    // load should be tried again later.
+    bool RequestLoad(const ChunkPos& pos);
+
+    // Serializes the chunk on the calling thread and queues the write. Writes are never refused, but
+    // count towards the pending requests.
+    void RequestSave(const ChunkPos& pos, const EightBitChunk& chunk);
+
+    // Hands the loads that finished so far to the callback on the calling thread. Never blocks on I/O.
+    void Poll(const LoadCallback& callback);
+
+    // Blocks until every queued write has reached the storage. Meant for shutdown.
+    void Flush();
+
+    // Requests queued, in flight or finished but not polled yet.
+    VXL_INLINE size_t GetPendingCount() const noexcept {
+        return m_pending.load(std::memory_order_relaxed);
+    }
+
+    VXL_INLINE bool IsSaturated() const noexcept {
+        return GetPendingCount() >= m_settings.m_maxPending;
+    }
+
+    // Whether reads go through io_uring rather than pread. A ring that fails stops being used.
+    VXL_INLINE bool IsUsingRing() const noexcept {
+        return m_useRing.load(std::memory_order_relaxed);
+    }
+private:
+    static Logger sLogger;
+    static constexpr uint32_t sQueueDepth = 64;
+
+    struct Request {
+        ChunkPos m_pos;
+        std::vector<uint8_t> m_record; // Serialized chunk of a write, the record read by a load.
+        bool m_write = false;
+    };
+
+    struct Completion {
+        ChunkPos m_pos;
+        std::unique_ptr<EightBitChunk> m_chunk;
+    };
+
+    void Run();
+    void WriteBatch(std::vector<Request>& writes);
+    void ReadBatch(std::vector<Request>& reads);
+
+    // Fills the records of the reads from the file, marking unstored chunks with an empty record.
+    void ReadRecords(RegionFile& file, Request** reads, const size_t count);
+
+#if VXL_IO_URING
+    // ReadRecords() for at most a queue's worth of reads through the ring. Waits for every read it
+    // submitted before returning, and reads what the ring didn't finish through pread.
+    void ReadRing(RegionFile& file, Request** reads, const size_t count);
+#endif
+
+    // Decodes a record and queues its completion.
+    void Complete(Request&& read);
+
+    RegionStorage& m_storage;
+    Settings m_settings;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // Signals new requests or shutdown to the I/O thread.
+    std::condition_variable m_idle; // Signals finished writes to Flush().
+    std::deque<Request> m_queue;
+    size_t m_queuedWrites = 0; // Writes queued or in flight.
+    bool m_running = true;
+
+    std::mutex m_completedMutex;
+    std::vector<Completion> m_completed;
+    std::vector<Completion> m_polled;
+    std::atomic<size_t> m_pending = 0;
+
+    bool m_ringReady = false;
+    std::atomic<bool> m_useRing = false;
+#if VXL_IO_URING
+    io_uring m_ring;
+    // Records of reads the ring lost track of. The kernel may still write into them, so they live
+    // as long as the ring.
+    std::vector<std::vector<uint8_t>> m_orphanedRecords;
+#endif
+};
@@ -0,0 +1,186 @@
+#include "world/storage/RegionFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+Logger RegionFile::sLogger = Logger("RegionFile");
+
+RegionFile::RegionFile(const std::string& path) : m_path(path), m_index(sChunkCount) {
+    m_file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_file < 0)
+        throw sLogger.RuntimeError("Failed to open region file ", path, ": ", std::strerror(errno));
+
+    const off_t fileSize = lseek(m_file, 0, SEEK_END);
+    if (fileSize == 0) {
+        // A new region, an empty index and nothing else.
+        std::vector<uint8_t> header(sIndexSectors * sSectorSize, 0);
+        const FileHeader fileHeader = {.m_magic = sMagic, .m_version = sVersion, .m_sectorSize = sSectorSize, .m_regionSize = sRegionSize};
+        std::memcpy(header.data(), &fileHeader, sizeof(FileHeader));
+        WriteAt(header.data(), header.size(), 0);
+        m_used.assign(sIndexSectors, true);
+        return;
+    }
+
+    // The header and the whole index come in with a single read.
+    if (fileSize < static_cast<off_t>(sIndexSectors * sSectorSize))
+        throw sLogger.RuntimeError("Region file ", path, " is smaller than its index!");
+
+    std::vector<uint8_t> header(sIndexSectors * sSectorSize);
+    ReadAt(header.data(), header.size(), 0);
+
+    FileHeader fileHeader;
+    std::memcpy(&fileHeader, header.data(), sizeof(FileHeader));
+    if (fileHeader.m_magic != sMagic || fileHeader.m_version != sVersion || fileHeader.m_sectorSize != sSectorSize || fileHeader.m_regionSize != sRegionSize)
+        throw sLogger.RuntimeError("Region file ", path, " has an unsupported header!");
+    std::memcpy(m_index.data(), header.data() + sSectorSize, sChunkCount * sizeof(Entry));
+
+    m_used.assign(GetSectors(fileSize), false);
+    MarkSectors(0, sIndexSectors, true);
+    for (const Entry& entry : m_index) {
+        if (entry.m_sector == 0)
+            continue;
+        if (entry.m_sector < sIndexSectors || entry.m_sector + GetSectors(entry.m_size) > m_used.size())
+            throw sLogger.RuntimeError("Region file ", path, " has a record outside the file!");
+
+        MarkSectors(entry.m_sector, GetSectors(entry.m_size), true);
+        m_usedSectors += GetSectors(entry.m_size);
+    }
+}
+
+RegionFile::~RegionFile() {
+    if (m_file >= 0)
+        close(m_file);
+}
+
+bool RegionFile::Read(const uint32_t index, std::vector<uint8_t>& record) const {
+    const Entry& entry = m_index[index];
+    if (entry.m_sector == 0)
+        return false;
+
+    record.resize(entry.m_size);
+    ReadAt(record.data(), entry.m_size, static_cast<uint64_t>(entry.m_sector) * sSectorSize);
+    return true;
+}
+
+void RegionFile::Write(const uint32_t index, const uint8_t* record, const size_t size) {
+    Entry& entry = m_index[index];
+    const uint32_t sectors = GetSectors(size);
+    const uint32_t oldSectors = entry.m_sector != 0 ? GetSectors(entry.m_size) : 0;
+
+    // The old sectors stay in use until the index points away from them, so a crash in between
+    // leaves the old record intact.
+    const uint32_t sector = Allocate(sectors);
+    WriteAt(record, size, static_cast<uint64_t>(sector) * sSectorSize);
+
+    const uint32_t oldSector = entry.m_sector;
+    entry = {.m_sector = sector, .m_size = static_cast<uint32_t>(size)};
+    WriteEntry(index);
+
+    if (oldSector != 0)
+        MarkSectors(oldSector, oldSectors, false);
+    m_usedSectors += sectors - oldSectors;
+}
+
+bool RegionFile::Remove(const uint32_t index) {
+    Entry& entry = m_index[index];
+    if (entry.m_sector == 0)
+        return false;
+
+    const Entry old = entry;
+    entry = {};
+    WriteEntry(index);
+    MarkSectors(old.m_sector, GetSectors(old.m_size), false);
+    m_usedSectors -= GetSectors(old.m_size);
+    return true;
+}
+
+void RegionFile::Compact() {
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < sChunkCount; i++) {
+        if (m_index[i].m_sector != 0)
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [this](const uint32_t a, const uint32_t b) {
+        return m_index[a].m_sector < m_index[b].m_sector;
+    });
+
+    // Records only ever move towards the start of the file, into sectors already passed over, so
+    // moving them in order never overwrites one that hasn't moved yet.
+    const size_t before = m_used.size();
+    uint32_t next = sIndexSectors;
+    std::vector<uint8_t> record;
+    for (const uint32_t index : order) {
+        Entry& entry = m_index[index];
+        if (entry.m_sector != next) {
+            Read(index, record);
+            WriteAt(record.data(), record.size(), static_cast<uint64_t>(next) * sSectorSize);
+            entry.m_sector = next;
+            WriteEntry(index);
+        }
+        next += GetSectors(entry.m_size);
+    }
+
+    if (ftruncate(m_file, static_cast<off_t>(next) * sSectorSize) != 0)
+        throw sLogger.RuntimeError("Failed to truncate region file ", m_path, ": ", std::strerror(errno));
+
+    m_used.assign(next, true);
+    sLogger.Verbose("Compacted ", m_path, " from ", before, " to ", next, " sectors!");
+}
+
+void RegionFile::Sync() {
+    if (fsync(m_file) != 0)
+        throw sLogger.RuntimeError("Failed to sync region file ", m_path, ": ", std::strerror(errno));
+}
+
+void RegionFile::ReadAt(void* data, const size_t size, const uint64_t offset) const {
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t result = pread(m_file, static_cast<uint8_t*>(data) + done, size - done, static_cast<off_t>(offset + done));
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            throw sLogger.RuntimeError("Failed to read region file ", m_path, "!");
+        done += result;
+    }
+}
+
+void RegionFile::WriteAt(const void* data, const size_t size, const uint64_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t result = pwrite(m_file, static_cast<const uint8_t*>(data) + done, size - done, static_cast<off_t>(offset + done));
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            throw sLogger.RuntimeError("Failed to write region file ", m_path, "!");
+        done += result;
+    }
+}
+
+void RegionFile::WriteEntry(const uint32_t index) {
+    WriteAt(&m_index[index], sizeof(Entry), sSectorSize + static_cast<uint64_t>(index) * sizeof(Entry));
+}
+
+uint32_t RegionFile::Allocate(const uint32_t sectors) {
+    // First fit, so holes left by records that moved fill up before the file grows.
+    uint32_t run = 0;
+    for (uint32_t sector = sIndexSectors; sector < m_used.size(); sector++) {
+        run = m_used[sector] ? 0 : run + 1;
+        if (run == sectors) {
+            MarkSectors(sector + 1 - sectors, sectors, true);
+            return sector + 1 - sectors;
+        }
+    }
+
+    // A free run at the end of the file is extended instead of left behind.
+    const uint32_t first = static_cast<uint32_t>(m_used.size()) - run;
+    m_used.resize(first + sectors, true);
+    MarkSectors(first, sectors, true);
+    return first;
+}
+
+void RegionFile::MarkSectors(const uint32_t first, const uint32_t count, const bool used) {
+    std::fill(m_used.begin() + first, m_used.begin() + first + count, used);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+
+// A file holding the chunk records of a 32x32x32 chunk region, see ChunkSerializer. The file starts
+// with a header sector and the index, which are read together in a single call on open. Records
+// start on sector boundaries and take whole sectors. Every write goes into the first free run large
+// enough for it or is appended, never over the live record, and the record is always written before
+// its index entry, so a crash leaves either the old or the new record. Compacting moves records
+// over the sectors of others and isn't crash safe.
+class RegionFile final {
+public:
+    static constexpr uint32_t sMagic = 0x52475856; // "VXGR"
+    static constexpr uint32_t sVersion = 1;
+    static constexpr size_t sSectorSize = 4096;
+    static constexpr uint32_t sRegionSize = 32; // In chunks along every axis.
+    static constexpr uint32_t sChunkCount = sRegionSize * sRegionSize * sRegionSize;
+
+    struct Entry {
+        uint32_t m_sector = 0; // First sector of the record, 0 if the chunk isn't stored.
+        uint32_t m_size = 0; // In bytes.
+    };
+
+    // The header sector and the index.
+    static constexpr uint32_t sIndexSectors = 1 + sChunkCount * sizeof(Entry) / sSectorSize;
+
+    // Opens the region file at the path, creating it if it doesn't exist.
+    RegionFile(const std::string& path);
+    ~RegionFile();
+
+    RegionFile(const RegionFile&) = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+
+    // Region holding the chunk.
+    static VXL_INLINE ChunkPos GetRegion(const ChunkPos& pos) noexcept {
+        return {.m_x = pos.m_x >> 5, .m_y = pos.m_y >> 5, .m_z = pos.m_z >> 5};
+    }
+
+    // Index of the chunk within its region.
+    static VXL_INLINE uint32_t GetIndex(const ChunkPos& pos) noexcept {
+        return ((pos.m_x & 31) << 10) | ((pos.m_y & 31) << 5) | (pos.m_z & 31);
+    }
+
+    // Reads the record of the chunk. Returns false if it isn't stored.
+    bool Read(const uint32_t index, std::vector<uint8_t>& record) const;
+
+    void Write(const uint32_t index, const uint8_t* record, const size_t size);
+
+    // Returns false if the chunk wasn't stored.
+    bool Remove(const uint32_t index);
+
+    // Moves every record down into the free space before it and truncates the file.
+    void Compact();
+
+    // Flushes the writes so far to disk.
+    void Sync();
+
+    VXL_INLINE const Entry& GetEntry(const uint32_t index) const noexcept {
+        return m_index[index];
+    }
+
+    // Byte offset of a sector in the file.
+    static VXL_INLINE uint64_t GetOffset(const uint32_t sector) noexcept {
+        return static_cast<uint64_t>(sector) * sSectorSize;
+    }
+
+    // File descriptor for reads issued outside this class, e.g. batched through io_uring. Only valid
+    // while the file is open.
+    VXL_INLINE int GetDescriptor() const noexcept {
+        return m_file;
+    }
+
+    // Sectors in the file, including the header, the index and free space.
+    VXL_INLINE uint32_t GetSectorCount() const noexcept {
+        return static_cast<uint32_t>(m_used.size());
+    }
+
+    // Sectors that hold records.
+    VXL_INLINE uint32_t GetUsedSectorCount() const noexcept {
+        return m_usedSectors;
+    }
+private:
+    static Logger sLogger;
+
+    struct FileHeader {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_sectorSize;
+        uint32_t m_regionSize;
+    };
+
+    static VXL_INLINE uint32_t GetSectors(const size_t size) noexcept {
+        return static_cast<uint32_t>((size + sSectorSize - 1) / sSectorSize);
+    }
+
+    void ReadAt(void* data, const size_t size, const uint64_t offset) const;
+    void WriteAt(const void* data, const size_t size, const uint64_t offset);
+    void WriteEntry(const uint32_t index);
+
+    // Finds room for the given number of sectors, growing the file if no free run is large enough.
+    uint32_t Allocate(const uint32_t sectors);
+    void MarkSectors(const uint32_t first, const uint32_t count, const bool used);
+
+    std::string m_path;
+    int m_file = -1;
+    std::vector<Entry> m_index;
+    std::vector<bool> m_used; // Per sector of the file.
+    uint32_t m_usedSectors = 0;
+};
@@ -0,0 +1,98 @@
+#include "world/storage/RegionStorage.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+#include "world/chunk/ChunkSerializer.h"
+
+Logger RegionStorage::sLogger = Logger("RegionStorage");
+
+RegionStorage::RegionStorage(const std::string& directory, const size_t maxOpenFiles) : m_directory(directory), m_maxOpenFiles(std::max<size_t>(maxOpenFiles, 1)) {
+    std::filesystem::create_directories(m_directory);
+}
+
+bool RegionStorage::Load(const ChunkPos& pos, EightBitChunk& chunk) {
+    std::vector<uint8_t> record;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        RegionFile* file = Open(RegionFile::GetRegion(pos), false);
+        if (file == nullptr || !file->Read(RegionFile::GetIndex(pos), record))
+            return false;
+    }
+
+    ChunkSerializer::Deserialize(record.data(), record.size(), chunk);
+    return true;
+}
+
+void RegionStorage::Save(const ChunkPos& pos, const EightBitChunk& chunk) {
+    std::vector<uint8_t> record;
+    ChunkSerializer::Serialize(chunk, record);
+    SaveRecord(pos, record.data(), record.size());
+}
+
+void RegionStorage::SaveRecord(const ChunkPos& pos, const uint8_t* record, const size_t size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Open(RegionFile::GetRegion(pos), true)->Write(RegionFile::GetIndex(pos), record, size);
+}
+
+bool RegionStorage::WithRegion(const ChunkPos& region, const std::function<void(RegionFile&)>& function) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RegionFile* file = Open(region, false);
+    if (file == nullptr)
+        return false;
+
+    function(*file);
+    return true;
+}
+
+bool RegionStorage::Remove(const ChunkPos& pos) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RegionFile* file = Open(RegionFile::GetRegion(pos), false);
+    return file != nullptr && file->Remove(RegionFile::GetIndex(pos));
+}
+
+void RegionStorage::CompactAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_directory)) {
+        ChunkPos region;
+        if (std::sscanf(entry.path().filename().string().c_str(), "r.%d.%d.%d.vxr", &region.m_x, &region.m_y, &region.m_z) == 3)
+            Open(region, false)->Compact();
+    }
+}
+
+void RegionStorage::Flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [key, open] : m_files)
+        open.m_file->Sync();
+}
+
+std::string RegionStorage::GetPath(const ChunkPos& region) const {
+    return (std::filesystem::path(m_directory) / ("r." + std::to_string(region.m_x) + "." + std::to_string(region.m_y) + "." + std::to_string(region.m_z) + ".vxr")).string();
+}
+
+RegionFile* RegionStorage::Open(const ChunkPos& region, const bool create) {
+    const auto it = m_files.find(region.Pack());
+    if (it != m_files.end()) {
+        it->second.m_lastUse = ++m_uses;
+        return it->second.m_file.get();
+    }
+
+    const std::string path = GetPath(region);
+    if (!create && !std::filesystem::exists(path))
+        return nullptr;
+
+    // Only files that opened make it into the map, a throwing constructor leaves it as it was.
+    std::unique_ptr<RegionFile> file = std::make_unique<RegionFile>(path);
+    if (m_files.size() >= m_maxOpenFiles) {
+        const auto oldest = std::min_element(m_files.begin(), m_files.end(), [](const auto& a, const auto& b) {
+            return a.second.m_lastUse < b.second.m_lastUse;
+        });
+        m_files.erase(oldest);
+    }
+
+    OpenFile& open = m_files[region.Pack()];
+    open.m_file = std::move(file);
+    open.m_lastUse = ++m_uses;
+    return open.m_file.get();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/types/EightBitChunk.h"
+#include "world/storage/RegionFile.h"
+
+// Chunk storage over a directory of region files. Regions are opened on demand, and the least
+// recently used ones are closed once too many are open. Every call may come from any thread, file
+// operations are serialized.
+class RegionStorage final {
+public:
+    RegionStorage(const std::string& directory, const size_t maxOpenFiles = 64);
+
+    RegionStorage(const RegionStorage&) = delete;
+    RegionStorage& operator=(const RegionStorage&) = delete;
+
+    // Fills the chunk from its stored record. Returns false if it isn't stored.
+    bool Load(const ChunkPos& pos, EightBitChunk& chunk);
+
+    void Save(const ChunkPos& pos, const EightBitChunk& chunk);
+
+    // Stores an already serialized record of the chunk.
+    void SaveRecord(const ChunkPos& pos, const uint8_t* record, const size_t size);
+
+    // Runs the function on the open file of the region while holding the lock, so that the file
+    // stays open throughout. Returns false without calling it if the region has no file.
+    bool WithRegion(const ChunkPos& region, const std::function<void(RegionFile&)>& function);
+
+    // Returns false if the chunk wasn't stored.
+    bool Remove(const ChunkPos& pos);
+
+    // Compacts every region file in the directory.
+    void CompactAll();
+
+    // Flushes the open region files to disk.
+    void Flush();
+
+    // Path of the region file holding the chunks of the region.
+    std::string GetPath(const ChunkPos& region) const;
+private:
+    static Logger sLogger;
+
+    struct OpenFile {
+        std::unique_ptr<RegionFile> m_file;
+        uint64_t m_lastUse = 0;
+    };
+
+    // Returns null if the region has no file and create isn't set.
+    RegionFile* Open(const ChunkPos& region, const bool create);
+
+    std::mutex m_mutex;
+    std::string m_directory;
+    size_t m_maxOpenFiles;
+    std::unordered_map<uint64_t, OpenFile> m_files; // Packed region position to its open file.
+    uint64_t m_uses = 0;
+};
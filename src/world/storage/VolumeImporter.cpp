@@ -0,0 +1,347 @@
+#include "world/storage/VolumeImporter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "util/JobSystem.h"
+#include "world/ChunkStreamer.h"
+#include "world/World.h"
+#include "world/chunk/types/EightBitChunk.h"
+
+Logger VolumeImporter::sLogger = Logger("VolumeImporter");
+
+namespace {
+    // Closes the file once the import is done or failed.
+    struct FileHandle {
+        int m_file = -1;
+
+        ~FileHandle() {
+            if (m_file >= 0)
+                close(m_file);
+        }
+    };
+}
+
+// Reads the whole range, returns false if the file ends before it.
+static bool ReadAt(const int file, void* data, const size_t size, const uint64_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t result = pread(file, static_cast<uint8_t*>(data) + done, size - done, static_cast<off_t>(offset + done));
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            return false;
+        done += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+static int32_t ReadInt(const uint8_t* data) {
+    int32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+VolumeImporter::Result VolumeImporter::ImportVox(World& world, const std::string& path, const Settings& settings, ChunkStreamer* streamer) {
+    const FileHandle file = {.m_file = open(path.c_str(), O_RDONLY)};
+    if (file.m_file < 0)
+        throw sLogger.RuntimeError("Failed to open ", path, ": ", std::strerror(errno));
+
+    const VoxModel model = ReadVoxModel(file.m_file, path, settings.m_model);
+    const std::array<uint8_t, 256> table = BuildTable(settings, model.m_colors);
+    if (model.m_voxelCount == 0)
+        return {};
+
+    // Models are at most 256 voxels on each side, so all of their chunks are staged at once.
+    const glm::ivec3 size = glm::ivec3(model.m_size.x, model.m_size.z, model.m_size.y);
+    const ChunkPos min = ChunkPos::FromBlock(settings.m_origin.x, settings.m_origin.y, settings.m_origin.z);
+    const ChunkPos max = ChunkPos::FromBlock(settings.m_origin.x + size.x - 1, settings.m_origin.y + size.y - 1, settings.m_origin.z + size.z - 1);
+    const glm::ivec3 grid = glm::ivec3(max.m_x - min.m_x + 1, max.m_y - min.m_y + 1, max.m_z - min.m_z + 1);
+    std::vector<Staged> staged(static_cast<size_t>(grid.x) * grid.y * grid.z);
+    JobSystem::ParallelFor(static_cast<uint32_t>(staged.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            staged[i].m_pos = {.m_x = min.m_x + static_cast<int32_t>(i / (grid.y * grid.z)), .m_y = min.m_y + static_cast<int32_t>(i / grid.z % grid.y), .m_z = min.m_z + static_cast<int32_t>(i % grid.z)};
+            staged[i].m_chunk = std::make_unique<EightBitChunk>();
+        }
+    });
+
+    // Voxels are distinct, so every batch is placed across the workers without locks.
+    const uint32_t batchVoxels = std::max(settings.m_batchVoxels, 1u);
+    std::vector<uint8_t> batch(static_cast<size_t>(std::min(batchVoxels, model.m_voxelCount)) * 4);
+    for (uint32_t first = 0; first < model.m_voxelCount; first += batchVoxels) {
+        const uint32_t count = std::min(batchVoxels, model.m_voxelCount - first);
+        if (!ReadAt(file.m_file, batch.data(), static_cast<size_t>(count) * 4, model.m_voxelOffset + static_cast<uint64_t>(first) * 4))
+            throw sLogger.RuntimeError("Vox file ", path, " ends within its voxels!");
+
+        JobSystem::ParallelFor(count, 1u << 16, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                const uint8_t* voxel = batch.data() + i * 4;
+                if (voxel[0] >= model.m_size.x || voxel[1] >= model.m_size.y || voxel[2] >= model.m_size.z)
+                    continue;
+
+                const int32_t x = settings.m_origin.x + voxel[0];
+                const int32_t y = settings.m_origin.y + voxel[2];
+                const int32_t z = settings.m_origin.z + model.m_size.y - 1 - voxel[1];
+                const uint32_t chunk = static_cast<uint32_t>((((x >> 5) - min.m_x) * grid.y + ((y >> 5) - min.m_y)) * grid.z + ((z >> 5) - min.m_z));
+                staged[chunk].m_chunk->Data()[((x & 31) << 10) | ((y & 31) << 5) | (z & 31)] = table[voxel[3]];
+            }
+        });
+    }
+
+    Result result;
+    Commit(world, staged, table, streamer, result);
+    if (result.m_dropped > 0)
+        sLogger.Warning("Dropped ", result.m_dropped, " voxels of chunks that aren't resident!");
+    return result;
+}
+
+VolumeImporter::Result VolumeImporter::ImportRaw(World& world, const std::string& path, const glm::uvec3& size, const Settings& settings, ChunkStreamer* streamer) {
+    const FileHandle file = {.m_file = open(path.c_str(), O_RDONLY)};
+    if (file.m_file < 0)
+        throw sLogger.RuntimeError("Failed to open ", path, ": ", std::strerror(errno));
+
+    const uint64_t layerSize = static_cast<uint64_t>(size.x) * size.y;
+    if (static_cast<uint64_t>(lseek(file.m_file, 0, SEEK_END)) != layerSize * size.z)
+        throw sLogger.RuntimeError("Raw volume ", path, " doesn't hold ", size.x, "x", size.y, "x", size.z, " voxels!");
+
+    const std::array<uint8_t, 256> table = BuildTable(settings, {});
+    if (layerSize * size.z == 0)
+        return {};
+
+    const glm::ivec3 origin = settings.m_origin;
+    const glm::ivec3 last = origin + glm::ivec3(size) - glm::ivec3(1);
+    const ChunkPos min = ChunkPos::FromBlock(origin.x, origin.y, origin.z);
+    const ChunkPos max = ChunkPos::FromBlock(last.x, last.y, last.z);
+    const int32_t gridX = max.m_x - min.m_x + 1, gridY = max.m_y - min.m_y + 1;
+
+    // A layer of chunks along z at a time, read in one go and handed over before the next.
+    Result result;
+    std::vector<uint8_t> slab;
+    std::vector<Staged> staged;
+    for (int32_t chunkZ = min.m_z; chunkZ <= max.m_z; chunkZ++) {
+        const int32_t zBegin = std::max(chunkZ * 32, origin.z) - origin.z;
+        const int32_t zEnd = std::min(chunkZ * 32 + 32, last.z + 1) - origin.z;
+        slab.resize(static_cast<size_t>(zEnd - zBegin) * layerSize);
+        if (!ReadAt(file.m_file, slab.data(), slab.size(), static_cast<uint64_t>(zBegin) * layerSize))
+            throw sLogger.RuntimeError("Failed to read raw volume ", path, "!");
+
+        staged.clear();
+        staged.resize(static_cast<size_t>(gridX) * gridY);
+        JobSystem::ParallelFor(static_cast<uint32_t>(staged.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                Staged& target = staged[i];
+                target.m_pos = {.m_x = min.m_x + static_cast<int32_t>(i) / gridY, .m_y = min.m_y + static_cast<int32_t>(i) % gridY, .m_z = chunkZ};
+                target.m_chunk = std::make_unique<EightBitChunk>();
+
+                // Rows of the volume run along x, so they are read in order and written 1024 apart.
+                uint8_t* data = target.m_chunk->Data();
+                const int32_t xBegin = std::max(target.m_pos.m_x * 32, origin.x), xEnd = std::min(target.m_pos.m_x * 32 + 32, last.x + 1);
+                const int32_t yBegin = std::max(target.m_pos.m_y * 32, origin.y), yEnd = std::min(target.m_pos.m_y * 32 + 32, last.y + 1);
+                for (int32_t z = zBegin; z < zEnd; z++) {
+                    for (int32_t y = yBegin; y < yEnd; y++) {
+                        const uint8_t* row = slab.data() + (static_cast<size_t>(z - zBegin) * size.y + (y - origin.y)) * size.x;
+                        const uint32_t local = ((y & 31) << 5) | ((z + origin.z) & 31);
+                        for (int32_t x = xBegin; x < xEnd; x++)
+                            data[((x & 31) << 10) | local] = table[row[x - origin.x]];
+                    }
+                }
+            }
+        });
+
+        Commit(world, staged, table, streamer, result);
+    }
+
+    if (result.m_dropped > 0)
+        sLogger.Warning("Dropped ", result.m_dropped, " voxels of chunks that aren't resident!");
+    return result;
+}
+
+uint64_t VolumeImporter::ImportVoxNaive(World& world, const std::string& path, const Settings& settings) {
+    const FileHandle file = {.m_file = open(path.c_str(), O_RDONLY)};
+    if (file.m_file < 0)
+        throw sLogger.RuntimeError("Failed to open ", path, ": ", std::strerror(errno));
+
+    const VoxModel model = ReadVoxModel(file.m_file, path, settings.m_model);
+    const std::array<uint8_t, 256> table = BuildTable(settings, model.m_colors);
+    std::vector<uint8_t> voxels(static_cast<size_t>(model.m_voxelCount) * 4);
+    if (!ReadAt(file.m_file, voxels.data(), voxels.size(), model.m_voxelOffset))
+        throw sLogger.RuntimeError("Vox file ", path, " ends within its voxels!");
+
+    uint64_t blocks = 0;
+    for (size_t i = 0; i < voxels.size(); i += 4) {
+        if (voxels[i] >= model.m_size.x || voxels[i + 1] >= model.m_size.y || voxels[i + 2] >= model.m_size.z || table[voxels[i + 3]] == BlockTypes::eAir)
+            continue;
+
+        const int32_t x = settings.m_origin.x + voxels[i];
+        const int32_t y = settings.m_origin.y + voxels[i + 2];
+        const int32_t z = settings.m_origin.z + model.m_size.y - 1 - voxels[i + 1];
+        const ChunkNode* node = world.GetChunk(ChunkPos::FromBlock(x, y, z));
+        if (node == nullptr || node->m_state == ChunkState::eEmpty)
+            continue;
+
+        world.SetBlockUnlit(table[voxels[i + 3]], x, y, z);
+        blocks++;
+    }
+
+    return blocks;
+}
+
+uint64_t VolumeImporter::ImportRawNaive(World& world, const std::string& path, const glm::uvec3& size, const Settings& settings) {
+    const FileHandle file = {.m_file = open(path.c_str(), O_RDONLY)};
+    if (file.m_file < 0)
+        throw sLogger.RuntimeError("Failed to open ", path, ": ", std::strerror(errno));
+
+    std::vector<uint8_t> voxels(static_cast<size_t>(size.x) * size.y * size.z);
+    if (static_cast<uint64_t>(lseek(file.m_file, 0, SEEK_END)) != voxels.size() || !ReadAt(file.m_file, voxels.data(), voxels.size(), 0))
+        throw sLogger.RuntimeError("Raw volume ", path, " doesn't hold ", size.x, "x", size.y, "x", size.z, " voxels!");
+
+    const std::array<uint8_t, 256> table = BuildTable(settings, {});
+    uint64_t blocks = 0;
+    size_t index = 0;
+    for (uint32_t z = 0; z < size.z; z++) {
+        for (uint32_t y = 0; y < size.y; y++) {
+            for (uint32_t x = 0; x < size.x; x++, index++) {
+                if (table[voxels[index]] == BlockTypes::eAir)
+                    continue;
+
+                const glm::ivec3 pos = settings.m_origin + glm::ivec3(x, y, z);
+                const ChunkNode* node = world.GetChunk(ChunkPos::FromBlock(pos.x, pos.y, pos.z));
+                if (node == nullptr || node->m_state == ChunkState::eEmpty)
+                    continue;
+
+                world.SetBlockUnlit(table[voxels[index]], pos.x, pos.y, pos.z);
+                blocks++;
+            }
+        }
+    }
+
+    return blocks;
+}
+
+VolumeImporter::VoxModel VolumeImporter::ReadVoxModel(const int file, const std::string& path, const uint32_t model) {
+    uint8_t header[20];
+    if (!ReadAt(file, header, sizeof(header), 0) || std::memcmp(header, "VOX ", 4) != 0 || std::memcmp(header + 8, "MAIN", 4) != 0)
+        throw sLogger.RuntimeError("File ", path, " isn't a vox file!");
+
+    // Models are a SIZE chunk followed by an XYZI chunk, among the children of MAIN.
+    VoxModel result;
+    uint32_t models = 0;
+    bool found = false;
+    uint64_t offset = 20 + static_cast<uint32_t>(ReadInt(header + 12));
+    const uint64_t end = offset + static_cast<uint32_t>(ReadInt(header + 16));
+    uint8_t chunk[12];
+    while (offset + sizeof(chunk) <= end && ReadAt(file, chunk, sizeof(chunk), offset)) {
+        const uint64_t content = offset + sizeof(chunk);
+        if (std::memcmp(chunk, "SIZE", 4) == 0 && models == model) {
+            uint8_t size[12];
+            if (!ReadAt(file, size, sizeof(size), content))
+                break;
+            result.m_size = glm::ivec3(ReadInt(size), ReadInt(size + 4), ReadInt(size + 8));
+        } else if (std::memcmp(chunk, "XYZI", 4) == 0) {
+            uint8_t count[4];
+            if (models++ == model && ReadAt(file, count, sizeof(count), content)) {
+                result.m_voxelOffset = content + sizeof(count);
+                result.m_voxelCount = static_cast<uint32_t>(ReadInt(count));
+                found = true;
+            }
+        } else if (std::memcmp(chunk, "RGBA", 4) == 0) {
+            // The palette starts at value 1, value 0 is always empty.
+            std::array<uint32_t, 256> colors;
+            if (!ReadAt(file, colors.data(), sizeof(colors), content))
+                break;
+            std::copy_n(colors.begin(), 255, result.m_colors.begin() + 1);
+        }
+
+        offset = content + static_cast<uint32_t>(ReadInt(chunk + 4)) + static_cast<uint32_t>(ReadInt(chunk + 8));
+    }
+
+    if (!found)
+        throw sLogger.RuntimeError("Vox file ", path, " has no model ", model, "!");
+    if (result.m_size.x <= 0 || result.m_size.y <= 0 || result.m_size.z <= 0)
+        throw sLogger.RuntimeError("Model ", model, " of vox file ", path, " has no size!");
+    if (result.m_size.x > 256 || result.m_size.y > 256 || result.m_size.z > 256)
+        throw sLogger.RuntimeError("Model ", model, " of vox file ", path, " is larger than 256 voxels on a side!");
+
+    return result;
+}
+
+std::array<uint8_t, 256> VolumeImporter::BuildTable(const Settings& settings, const std::array<uint32_t, 256>& colors) {
+    std::array<uint8_t, 256> table;
+    for (uint32_t value = 0; value < table.size(); value++) {
+        const uint16_t block = settings.m_mapper ? settings.m_mapper(static_cast<uint8_t>(value), colors[value]) : value == 0 ? BlockTypes::eAir : BlockTypes::eStone;
+        if (block >= 64)
+            throw sLogger.RuntimeError("Block ", block, " of voxel value ", value, " doesn't fit a chunk's palette!");
+        table[value] = static_cast<uint8_t>(block);
+    }
+
+    return table;
+}
+
+void VolumeImporter::Commit(World& world, std::vector<Staged>& staged, const std::array<uint8_t, 256>& table, ChunkStreamer* streamer, Result& result) {
+    JobSystem::ParallelFor(static_cast<uint32_t>(staged.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            staged[i].m_solid = staged[i].m_chunk->GetBlockBitmap(BlockTypes::eAir, true);
+            staged[i].m_empty = std::all_of(staged[i].m_solid.Data(), staged[i].m_solid.Data() + 1024, [](const uint32_t row) {
+                return row == 0;
+            });
+        }
+    });
+
+    // The blocks of chunks that aren't resident are still on disk or yet to be generated, so the
+    // model is laid over them once they are loaded.
+    std::vector<Staged*> targets;
+    std::vector<ChunkNode*> written;
+    for (Staged& target : staged) {
+        if (target.m_empty)
+            continue;
+
+        ChunkNode* node = world.GetChunk(target.m_pos);
+        const bool resident = node != nullptr && node->m_state != ChunkState::eEmpty;
+        if (resident && world.BeginBulkEdit(*node)) {
+            target.m_node = node;
+            targets.push_back(&target);
+            written.push_back(node);
+        } else if (!resident && streamer != nullptr) {
+            streamer->QueueOverlay(target.m_pos, std::move(target.m_chunk));
+            result.m_queued++;
+        } else {
+            for (uint32_t row = 0; row < 1024; row++)
+                result.m_dropped += std::popcount(target.m_solid[row]);
+        }
+    }
+
+    std::array<bool, 64> modelTypes{};
+    for (const uint8_t block : table)
+        modelTypes[block] = true;
+
+    JobSystem::ParallelFor(static_cast<uint32_t>(targets.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            Staged& target = *targets[i];
+            ChunkNode& node = *target.m_node;
+            EightBitChunk& chunk = static_cast<EightBitChunk&>(*node.m_chunk);
+            chunk.Overlay(*target.m_chunk);
+            for (uint32_t row = 0; row < 1024; row++)
+                node.m_solid[row] |= target.m_solid[row];
+
+            // Only the types the model maps to and the chunk held can be there.
+            std::array<uint16_t, 64> types;
+            size_t numTypes = 0;
+            for (uint16_t type = 0; type < 64; type++) {
+                if (modelTypes[type] || type == BlockTypes::eAir || chunk.m_blockPaletteCounts[type] != 0)
+                    types[numTypes++] = type;
+            }
+            if (!chunk.RecountPalette(types.data(), numTypes))
+                chunk.RecountPalette();
+            target.m_hash = ChunkInterner::Hash(chunk);
+        }
+    });
+
+    // The interning table isn't thread safe.
+    for (Staged* target : targets)
+        target->m_node->m_chunk = world.GetInterner().Intern(std::move(target->m_node->m_chunk), target->m_hash);
+    world.EndBulkEdit(written, streamer);
+    result.m_written += static_cast<uint32_t>(written.size());
+}
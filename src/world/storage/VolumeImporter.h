@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "util/Logger.h"
+#include "world/ChunkPos.h"
+#include "world/chunk/ChunkBitmap.h"
+
+class World;
+class ChunkStreamer;
+class EightBitChunk;
+struct ChunkNode;
+
+// Imports models from external voxel tools: MagicaVoxel .vox files and raw dense volumes of a byte
+// per voxel with x changing fastest, then y, then z. Voxels are mapped to blocks through a table
+// built once from the mapper, written into 32^3 chunk payloads in parallel, and handed to the world
+// a layer of chunks at a time, so raw volumes are only ever read a layer at a time. Palettes are
+// counted with vector compares over the block types the chunk can hold.
+//
+// Voxels that map to air keep the world's blocks, so models can be placed onto existing terrain.
+// The parts of the model in chunks that aren't resident are queued on the streamer and laid over
+// the chunks' saved or generated blocks once they are loaded. Without a streamer they are dropped
+// and counted. .vox models are turned upright, their z becomes y and their y becomes z, flipped so
+// that they aren't mirrored. Scene graph transforms of .vox files aren't applied.
+class VolumeImporter final {
+public:
+    // Block of a voxel value, given the color the .vox palette has for it, 0 for raw volumes.
+    using Mapper = std::function<uint16_t(const uint8_t value, const uint32_t color)>;
+
+    struct Settings {
+        glm::ivec3 m_origin = {0, 0, 0}; // World position of the model's lowest corner.
+        Mapper m_mapper; // Unset maps 0 to air and anything else to stone.
+        uint32_t m_model = 0; // Model of a .vox file holding several.
+        uint32_t m_batchVoxels = 1u << 20; // .vox voxels read and placed at a time.
+    };
+
+    struct Result {
+        uint32_t m_written = 0; // Resident chunks that were written to.
+        uint32_t m_queued = 0; // Chunks that weren't resident, queued on the streamer.
+        uint64_t m_dropped = 0; // Voxels of chunks that weren't resident without a streamer.
+    };
+
+    // Imports a model of a .vox file, queueing the changed chunks for remeshing on the streamer,
+    // which may be null. Warns if voxels were dropped.
+    static Result ImportVox(World& world, const std::string& path, const Settings& settings, ChunkStreamer* streamer);
+
+    // Imports a raw volume of the given size, like ImportVox().
+    static Result ImportRaw(World& world, const std::string& path, const glm::uvec3& size, const Settings& settings, ChunkStreamer* streamer);
+
+    // Reference versions that read the whole file and set every voxel that lands in a resident chunk
+    // through World::SetBlockUnlit. Return the number of blocks set.
+    static uint64_t ImportVoxNaive(World& world, const std::string& path, const Settings& settings);
+
+    static uint64_t ImportRawNaive(World& world, const std::string& path, const glm::uvec3& size, const Settings& settings);
+private:
+    static Logger sLogger;
+
+    // Payload of a chunk being imported, along with what the world needs to take it over.
+    struct Staged {
+        ChunkPos m_pos;
+        std::unique_ptr<EightBitChunk> m_chunk;
+        ChunkBitmap m_solid;
+        bool m_empty = true;
+        ChunkNode* m_node = nullptr;
+        uint64_t m_hash = 0;
+    };
+
+    // Where the model's voxels are in a .vox file.
+    struct VoxModel {
+        glm::ivec3 m_size;
+        uint64_t m_voxelOffset = 0; // Start of the XYZI voxels.
+        uint32_t m_voxelCount = 0;
+        std::array<uint32_t, 256> m_colors = {}; // RGBA of every value, 0 without a palette.
+    };
+
+    static VoxModel ReadVoxModel(const int file, const std::string& path, const uint32_t model);
+
+    // Block of every voxel value.
+    static std::array<uint8_t, 256> BuildTable(const Settings& settings, const std::array<uint32_t, 256>& colors);
+
+    // Hands the staged chunks to the world, or to the streamer for chunks that aren't resident.
+    static void Commit(World& world, std::vector<Staged>& staged, const std::array<uint8_t, 256>& table, ChunkStreamer* streamer, Result& result);
+};